@@ -0,0 +1,194 @@
+#include "ActuatorRing.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32-bit integer");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared memory atomics must be lock-free");
+
+namespace {
+
+size_t segmentSize(uint32_t slotCount) {
+    return sizeof(ActuatorRingHeader) + static_cast<size_t>(slotCount) * 2 * sizeof(ActuatorMessage);
+}
+
+} // namespace
+
+uint64_t ActuatorRing::nowNs() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+std::unique_ptr<ActuatorRing> ActuatorRing::create(const std::string &name, int slots,
+                                                   const std::vector<ActuatorToolDescriptor> &tools,
+                                                   std::string &error) {
+    if (tools.size() > static_cast<size_t>(ActuatorToolDescriptor::kMaxTools)) {
+        error = "too many tools";
+        return nullptr;
+    }
+    uint32_t slotCount = 1;
+    while (slotCount < static_cast<uint32_t>(slots < 2 ? 2 : slots)) {
+        slotCount <<= 1;
+    }
+
+    // 上次异常退出留下的段直接丢弃，控制进程重新 attach
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        error = std::string("shm_open: ") + std::strerror(errno);
+        return nullptr;
+    }
+    const size_t size = segmentSize(slotCount);
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        error = std::string("ftruncate: ") + std::strerror(errno);
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return nullptr;
+    }
+    void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        error = std::string("mmap: ") + std::strerror(errno);
+        shm_unlink(name.c_str());
+        return nullptr;
+    }
+
+    // 新段内容为全 0，原子量直接在映射区上构造
+    auto *header = new (base) ActuatorRingHeader();
+    header->version = ActuatorRingHeader::kVersion;
+    header->slotCount = slotCount;
+    header->messageSize = sizeof(ActuatorMessage);
+    header->toolCount = static_cast<uint32_t>(tools.size());
+    for (size_t i = 0; i < tools.size(); ++i) {
+        header->tools[i] = tools[i];
+    }
+    header->magic.store(ActuatorRingHeader::kMagic, std::memory_order_release);
+
+    std::unique_ptr<ActuatorRing> ring(new ActuatorRing());
+    ring->m_name = name;
+    ring->m_owner = true;
+    ring->m_base = base;
+    ring->m_mapSize = size;
+    ring->m_header = header;
+    ring->m_mask = slotCount - 1;
+    return ring;
+}
+
+std::unique_ptr<ActuatorRing> ActuatorRing::attach(const std::string &name, std::string &error) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        error = std::string("shm_open: ") + std::strerror(errno);
+        return nullptr;
+    }
+    struct stat st{};
+    fstat(fd, &st);
+    const size_t size = static_cast<size_t>(st.st_size);
+    void *base = size >= sizeof(ActuatorRingHeader)
+            ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        error = "mmap failed or segment too small";
+        return nullptr;
+    }
+
+    auto *header = static_cast<ActuatorRingHeader *>(base);
+    const uint32_t slotCount = header->slotCount;
+    if (header->magic.load(std::memory_order_acquire) != ActuatorRingHeader::kMagic
+        || header->version != ActuatorRingHeader::kVersion
+        || header->messageSize != sizeof(ActuatorMessage)
+        || slotCount == 0 || (slotCount & (slotCount - 1)) != 0
+        || header->toolCount > static_cast<uint32_t>(ActuatorToolDescriptor::kMaxTools)
+        || segmentSize(slotCount) > size) {
+        error = "invalid header";
+        munmap(base, size);
+        return nullptr;
+    }
+
+    std::unique_ptr<ActuatorRing> ring(new ActuatorRing());
+    ring->m_name = name;
+    ring->m_base = base;
+    ring->m_mapSize = size;
+    ring->m_header = header;
+    ring->m_mask = slotCount - 1;
+    return ring;
+}
+
+ActuatorRing::~ActuatorRing() {
+    if (m_base) {
+        munmap(m_base, m_mapSize);
+    }
+    if (m_owner) {
+        shm_unlink(m_name.c_str());
+    }
+}
+
+ActuatorRingHeader::Ring &ActuatorRing::ring(Direction direction) {
+    return direction == Direction::Command ? m_header->command : m_header->ack;
+}
+
+ActuatorMessage *ActuatorRing::slots(Direction direction) {
+    auto *first = reinterpret_cast<ActuatorMessage *>(static_cast<uint8_t *>(m_base) + sizeof(ActuatorRingHeader));
+    return direction == Direction::Command ? first : first + m_header->slotCount;
+}
+
+bool ActuatorRing::push(Direction direction, const ActuatorMessage &message) {
+    ActuatorRingHeader::Ring &r = ring(direction);
+    const uint32_t head = r.head.load(std::memory_order_relaxed);
+    if (head - r.tail.load(std::memory_order_acquire) > m_mask) {
+        return false;
+    }
+    slots(direction)[head & m_mask] = message;
+    r.head.store(head + 1, std::memory_order_release);
+
+    // 与消费者的 “置 waiting → 再检查 head” 配对，seq_cst 保证两边至少有一方看到对方的写入
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (r.waiting.load(std::memory_order_relaxed)) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&r.head), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+    }
+    return true;
+}
+
+bool ActuatorRing::pop(Direction direction, ActuatorMessage &message) {
+    ActuatorRingHeader::Ring &r = ring(direction);
+    const uint32_t tail = r.tail.load(std::memory_order_relaxed);
+    if (r.head.load(std::memory_order_acquire) == tail) {
+        return false;
+    }
+    message = slots(direction)[tail & m_mask];
+    r.tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool ActuatorRing::wait(Direction direction, int64_t timeoutUs, int spinUs) {
+    ActuatorRingHeader::Ring &r = ring(direction);
+    const uint32_t tail = r.tail.load(std::memory_order_relaxed);
+    const uint64_t start = nowNs();
+    const uint64_t deadline = start + static_cast<uint64_t>(timeoutUs > 0 ? timeoutUs : 0) * 1000;
+    const uint64_t spinUntil = start + static_cast<uint64_t>(spinUs > 0 ? spinUs : 0) * 1000;
+
+    for (;;) {
+        uint32_t head = r.head.load(std::memory_order_acquire);
+        if (head != tail) return true;
+        uint64_t now = nowNs();
+        if (now >= deadline) return false;
+        if (now < spinUntil) continue;
+
+        r.waiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        head = r.head.load(std::memory_order_acquire);
+        if (head == tail) {
+            const uint64_t remaining = deadline - now;
+            timespec ts{static_cast<time_t>(remaining / 1000000000ull), static_cast<long>(remaining % 1000000000ull)};
+            syscall(SYS_futex, reinterpret_cast<uint32_t *>(&r.head), FUTEX_WAIT, head, &ts, nullptr, 0);
+        }
+        r.waiting.store(0, std::memory_order_relaxed);
+    }
+}
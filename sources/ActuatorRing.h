@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * 执行器命令在共享内存中的格式（版本 1）
+ *
+ * 一个命令或应答占一个定长槽位，参数按工具描述中的字段顺序存放，
+ * 枚举参数存为取值在 enumLabels 中的序号。
+ */
+struct ActuatorValue {
+    enum Type : uint32_t {
+        kNone = 0,
+        kNumber = 1,
+        kInteger = 2,
+        kBoolean = 3,      // integer 为 0 / 1
+        kEnum = 4,         // integer 为序号
+        kString = 5,       // text，以 0 结尾，超长截断
+    };
+
+    uint32_t type;
+    uint32_t reserved;
+    union {
+        double number;
+        int64_t integer;
+        char text[24];
+    };
+};
+
+struct ActuatorMessage {
+    static constexpr int kMaxFields = 8;
+
+    uint64_t id;
+    uint32_t tool;            // 工具在描述表中的序号，应答原样带回
+    int32_t status;           // 应答：0 为成功，其他为控制进程定义的错误码
+    uint64_t sentNs;          // 命令写入时间（CLOCK_MONOTONIC，跨进程可比）
+    uint64_t receivedNs;      // 控制进程取出命令的时间
+    uint64_t ackNs;           // 控制进程写入应答的时间
+    uint32_t fieldCount;
+    uint32_t reserved;
+    ActuatorValue fields[kMaxFields];
+    char text[64];            // 应答说明，以 0 结尾
+};
+
+struct ActuatorFieldDescriptor {
+    char name[24];
+    uint32_t type;            // ActuatorValue::Type
+    uint32_t required;
+    char enumLabels[64];      // 枚举取值，以 '|' 分隔
+};
+
+struct ActuatorToolDescriptor {
+    static constexpr int kMaxTools = 32;
+
+    char name[32];
+    uint32_t fieldCount;
+    uint32_t reserved;
+    ActuatorFieldDescriptor fields[ActuatorMessage::kMaxFields];
+};
+
+/**
+ * 共享内存段的布局：ActuatorRingHeader 之后依次是 slotCount 个命令槽和 slotCount 个应答槽。
+ *
+ * - 本进程（MCP 工具一侧）创建并初始化共享内存段，最后写入 magic；控制进程看到 magic 后才可使用
+ * - 两个环各自只有一个生产者和一个消费者：命令环由本进程写、控制进程读，应答环反之
+ * - 生产者写好槽位后以 release 递增 head，消费者读完后以 release 递增 tail；
+ *   消费者在 waiting 置位后对 head 执行 FUTEX_WAIT，生产者看到 waiting 时 FUTEX_WAKE
+ */
+struct ActuatorRingHeader {
+    static constexpr uint32_t kMagic = 0x52415351;  // "QSAR"
+    static constexpr uint32_t kVersion = 1;
+
+    struct alignas(64) Ring {
+        alignas(64) std::atomic<uint32_t> head;
+        alignas(64) std::atomic<uint32_t> tail;
+        alignas(64) std::atomic<uint32_t> waiting;
+    };
+
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint32_t slotCount;       // 2 的幂
+    uint32_t messageSize;     // sizeof(ActuatorMessage)
+    uint32_t toolCount;
+    uint32_t reserved;
+    ActuatorToolDescriptor tools[ActuatorToolDescriptor::kMaxTools];
+    Ring command;
+    Ring ack;
+};
+
+/**
+ * 执行器命令环：映射上述共享内存段，提供两个方向的 SPSC 读写与等待
+ *
+ * 读写不加锁、不分配内存、不做系统调用（只有对方在等待时才 FUTEX_WAKE）。
+ * 同一方向的 push / pop 各自只能有一个线程调用，多个工具调用由使用方串行化。
+ * 不依赖 Qt，控制进程（见 tools/ActuatorControlStub.cpp）直接链接本文件。
+ */
+class ActuatorRing {
+public:
+    enum class Direction {
+        Command,
+        Ack,
+    };
+
+    /** 创建（或重建）共享内存段并写入工具描述，析构时删除该段 */
+    static std::unique_ptr<ActuatorRing> create(const std::string &name, int slots,
+                                                const std::vector<ActuatorToolDescriptor> &tools,
+                                                std::string &error);
+    /** 打开已创建的共享内存段，校验 magic / version / 大小 */
+    static std::unique_ptr<ActuatorRing> attach(const std::string &name, std::string &error);
+
+    ~ActuatorRing();
+
+    ActuatorRing(const ActuatorRing &) = delete;
+    ActuatorRing &operator=(const ActuatorRing &) = delete;
+
+    const ActuatorRingHeader &header() const { return *m_header; }
+
+    /** 环满时返回 false */
+    bool push(Direction direction, const ActuatorMessage &message);
+    /** 环空时返回 false */
+    bool pop(Direction direction, ActuatorMessage &message);
+
+    /**
+     * 等待该方向有可读的消息：先自旋 spinUs 微秒，再在 futex 上睡眠，总计不超过 timeoutUs。
+     * 返回是否有消息可读。
+     */
+    bool wait(Direction direction, int64_t timeoutUs, int spinUs);
+
+    /** CLOCK_MONOTONIC 纳秒 */
+    static uint64_t nowNs();
+
+private:
+    ActuatorRing() = default;
+
+    ActuatorRingHeader::Ring &ring(Direction direction);
+    ActuatorMessage *slots(Direction direction);
+
+    std::string m_name;
+    bool m_owner = false;
+    void *m_base = nullptr;
+    size_t m_mapSize = 0;
+    ActuatorRingHeader *m_header = nullptr;
+    uint32_t m_mask = 0;
+};
@@ -0,0 +1,335 @@
+#include "ActuatorToolAdapter.h"
+#include "MessageTracer.h"
+#include "MetricsExporter.h"
+#include <QDebug>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+ActuatorConfig ActuatorConfig::fromEnvironment() {
+    ActuatorConfig config;
+    const char *value = std::getenv("QUICKSTART_ACTUATOR");
+    if (!value) {
+        return config;
+    }
+
+    config.enabled = true;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item == "on") config.enabled = true;
+        else if (item == "off") config.enabled = false;
+        else if (item.compare(0, 4, "shm=") == 0) config.shmName = item.substr(4);
+        else if (item.compare(0, 6, "tools=") == 0) config.toolsPath = item.substr(6);
+        else if (item.compare(0, 6, "slots=") == 0) config.slots = std::atoi(item.c_str() + 6);
+        else if (item.compare(0, 11, "timeout_ms=") == 0) config.timeoutMs = std::atoi(item.c_str() + 11);
+        else if (item.compare(0, 8, "spin_us=") == 0) config.spinUs = std::atoi(item.c_str() + 8);
+        else if (!item.empty()) qWarning() << "QUICKSTART_ACTUATOR: unknown option" << item.c_str();
+    }
+
+    if (config.shmName.empty() || config.shmName[0] != '/') config.shmName = "/" + config.shmName;
+    config.slots = std::max(2, std::min(config.slots, 4096));
+    config.timeoutMs = std::max(1, config.timeoutMs);
+    config.spinUs = std::max(0, std::min(config.spinUs, 10000));
+    return config;
+}
+
+ActuatorToolAdapter::ActuatorToolAdapter(const ActuatorConfig &config)
+    : m_config(config) {
+    std::vector<mcp_mqtt::Tool> tools;
+    if (!loadTools(tools)) {
+        return;
+    }
+    for (const auto &tool : tools) {
+        ActuatorToolDescriptor descriptor{};
+        std::string error;
+        if (!describe(tool, descriptor, error)) {
+            qWarning() << "Actuator: skipping tool" << tool.name.c_str() << ":" << error.c_str();
+            continue;
+        }
+        if (m_tools.size() >= static_cast<size_t>(ActuatorToolDescriptor::kMaxTools)) {
+            qWarning() << "Actuator: too many tools, ignoring" << tool.name.c_str();
+            continue;
+        }
+        m_tools.push_back(tool);
+        m_descriptors.push_back(descriptor);
+    }
+
+    std::string error;
+    m_ring = ActuatorRing::create(m_config.shmName, m_config.slots, m_descriptors, error);
+    if (!m_ring) {
+        qWarning() << "Actuator: cannot create" << m_config.shmName.c_str() << ":" << error.c_str();
+        return;
+    }
+    qDebug() << "Actuator:" << m_config.shmName.c_str() << m_tools.size() << "tools,"
+             << m_ring->header().slotCount << "slots";
+}
+
+ActuatorToolAdapter::~ActuatorToolAdapter() = default;
+
+bool ActuatorToolAdapter::loadTools(std::vector<mcp_mqtt::Tool> &tools) {
+    if (m_config.toolsPath.empty()) {
+        tools = defaultTools();
+        return true;
+    }
+
+    std::ifstream file(m_config.toolsPath);
+    if (!file) {
+        qWarning() << "Actuator: cannot open" << m_config.toolsPath.c_str();
+        return false;
+    }
+    try {
+        auto json = nlohmann::json::parse(file);
+        for (const auto &entry : json) {
+            mcp_mqtt::Tool tool;
+            tool.name = entry.at("name").get<std::string>();
+            tool.description = entry.value("description", "");
+            const auto &schema = entry.at("inputSchema");
+            tool.inputSchema.properties = schema.value("properties", nlohmann::json::object());
+            tool.inputSchema.required = schema.value("required", std::vector<std::string>());
+            tools.push_back(std::move(tool));
+        }
+    } catch (const nlohmann::json::exception &e) {
+        qWarning() << "Actuator: invalid tools file" << m_config.toolsPath.c_str() << e.what();
+        return false;
+    }
+    return true;
+}
+
+std::vector<mcp_mqtt::Tool> ActuatorToolAdapter::defaultTools() {
+    mcp_mqtt::Tool gripper;
+    gripper.name = "gripper";
+    gripper.description = "Open or close the gripper";
+    gripper.inputSchema.properties = {
+        {"action", {
+            {"type", "string"},
+            {"description", "'open' or 'close'"},
+            {"enum", nlohmann::json::array({"open", "close"})}
+        }},
+        {"force", {
+            {"type", "number"},
+            {"description", "Grip force in newtons"}
+        }}
+    };
+    gripper.inputSchema.required = {"action"};
+
+    mcp_mqtt::Tool jointMove;
+    jointMove.name = "joint_move";
+    jointMove.description = "Move one arm joint to a target position";
+    jointMove.inputSchema.properties = {
+        {"joint", {
+            {"type", "integer"},
+            {"description", "Joint index, 0-5"}
+        }},
+        {"position", {
+            {"type", "number"},
+            {"description", "Target position in radians"}
+        }},
+        {"speed", {
+            {"type", "number"},
+            {"description", "Maximum speed in radians per second"}
+        }}
+    };
+    jointMove.inputSchema.required = {"joint", "position"};
+
+    return {gripper, jointMove};
+}
+
+bool ActuatorToolAdapter::describe(const mcp_mqtt::Tool &tool, ActuatorToolDescriptor &descriptor,
+                                   std::string &error) {
+    descriptor = ActuatorToolDescriptor{};
+    if (tool.name.empty() || tool.name.size() >= sizeof(descriptor.name)) {
+        error = "name is empty or too long";
+        return false;
+    }
+    std::snprintf(descriptor.name, sizeof(descriptor.name), "%s", tool.name.c_str());
+
+    const nlohmann::json &properties = tool.inputSchema.properties;
+    if (!properties.is_object()) {
+        return true;
+    }
+    if (properties.size() > static_cast<size_t>(ActuatorMessage::kMaxFields)) {
+        error = "too many parameters";
+        return false;
+    }
+
+    for (auto it = properties.begin(); it != properties.end(); ++it) {
+        ActuatorFieldDescriptor &field = descriptor.fields[descriptor.fieldCount];
+        if (it.key().size() >= sizeof(field.name)) {
+            error = "parameter name too long: " + it.key();
+            return false;
+        }
+        std::snprintf(field.name, sizeof(field.name), "%s", it.key().c_str());
+
+        const std::string type = it.value().value("type", "");
+        if (type == "number") {
+            field.type = ActuatorValue::kNumber;
+        } else if (type == "integer") {
+            field.type = ActuatorValue::kInteger;
+        } else if (type == "boolean") {
+            field.type = ActuatorValue::kBoolean;
+        } else if (type == "string" && it.value().contains("enum")) {
+            field.type = ActuatorValue::kEnum;
+            std::string labels;
+            for (const auto &label : it.value()["enum"]) {
+                if (!labels.empty()) labels += '|';
+                labels += label.get<std::string>();
+            }
+            if (labels.size() >= sizeof(field.enumLabels)) {
+                error = "enum values too long: " + it.key();
+                return false;
+            }
+            std::snprintf(field.enumLabels, sizeof(field.enumLabels), "%s", labels.c_str());
+        } else if (type == "string") {
+            field.type = ActuatorValue::kString;
+        } else {
+            error = "unsupported parameter type '" + type + "': " + it.key();
+            return false;
+        }
+
+        const auto &required = tool.inputSchema.required;
+        field.required = std::find(required.begin(), required.end(), it.key()) != required.end() ? 1 : 0;
+        ++descriptor.fieldCount;
+    }
+    return true;
+}
+
+bool ActuatorToolAdapter::encode(const ActuatorToolDescriptor &descriptor, const nlohmann::json &args,
+                                 ActuatorMessage &message, std::string &error) const {
+    message.fieldCount = descriptor.fieldCount;
+    for (uint32_t i = 0; i < descriptor.fieldCount; ++i) {
+        const ActuatorFieldDescriptor &field = descriptor.fields[i];
+        ActuatorValue &value = message.fields[i];
+        if (!args.contains(field.name) || args[field.name].is_null()) {
+            if (field.required) {
+                error = std::string("Missing parameter: ") + field.name;
+                return false;
+            }
+            value.type = ActuatorValue::kNone;
+            continue;
+        }
+
+        const nlohmann::json &arg = args[field.name];
+        value.type = field.type;
+        switch (field.type) {
+            case ActuatorValue::kNumber:
+                value.number = arg.get<double>();
+                break;
+            case ActuatorValue::kInteger:
+                value.integer = arg.get<int64_t>();
+                break;
+            case ActuatorValue::kBoolean:
+                value.integer = arg.get<bool>() ? 1 : 0;
+                break;
+            case ActuatorValue::kEnum: {
+                const std::string label = arg.get<std::string>();
+                std::stringstream labels(field.enumLabels);
+                std::string candidate;
+                int index = 0;
+                value.integer = -1;
+                while (std::getline(labels, candidate, '|')) {
+                    if (candidate == label) {
+                        value.integer = index;
+                        break;
+                    }
+                    ++index;
+                }
+                if (value.integer < 0) {
+                    error = std::string("Invalid value for ") + field.name + ": " + label;
+                    return false;
+                }
+                break;
+            }
+            case ActuatorValue::kString:
+                std::snprintf(value.text, sizeof(value.text), "%s", arg.get<std::string>().c_str());
+                break;
+            default:
+                value.type = ActuatorValue::kNone;
+                break;
+        }
+    }
+    return true;
+}
+
+void ActuatorToolAdapter::registerTools(mcp_mqtt::McpServer &server) {
+    if (!m_ring) return;
+    for (size_t i = 0; i < m_tools.size(); ++i) {
+        const int index = static_cast<int>(i);
+        server.registerTool(m_tools[i], [this, index](const nlohmann::json &args) -> mcp_mqtt::ToolCallResult {
+            MessageTracer::HandlerScope trace(m_tools[index].name.c_str());
+            return call(index, args);
+        });
+    }
+}
+
+mcp_mqtt::ToolCallResult ActuatorToolAdapter::call(int toolIndex, const nlohmann::json &args) {
+    if (!m_ring || toolIndex < 0 || toolIndex >= static_cast<int>(m_descriptors.size())) {
+        return mcp_mqtt::ToolCallResult::error("Actuator not available");
+    }
+
+    ActuatorMessage command{};
+    command.tool = static_cast<uint32_t>(toolIndex);
+    std::string error;
+    try {
+        if (!encode(m_descriptors[toolIndex], args, command, error)) {
+            return mcp_mqtt::ToolCallResult::error(error);
+        }
+    } catch (const nlohmann::json::exception &e) {
+        return mcp_mqtt::ToolCallResult::error(std::string("Invalid arguments: ") + e.what());
+    }
+
+    std::lock_guard<std::mutex> lock(m_callMutex);
+    m_calls.fetch_add(1, std::memory_order_relaxed);
+    command.id = ++m_nextId;
+    command.sentNs = ActuatorRing::nowNs();
+    if (!m_ring->push(ActuatorRing::Direction::Command, command)) {
+        return mcp_mqtt::ToolCallResult::error("Actuator command queue full");
+    }
+
+    // 先自旋等应答，控制进程忙轮询时往返只有几微秒；之前超时命令的迟到应答直接丢弃
+    const uint64_t deadline = command.sentNs + static_cast<uint64_t>(m_config.timeoutMs) * 1000000;
+    ActuatorMessage ack{};
+    for (;;) {
+        while (m_ring->pop(ActuatorRing::Direction::Ack, ack)) {
+            if (ack.id == command.id) {
+                const uint64_t roundTrip = ActuatorRing::nowNs() - command.sentNs;
+                m_lastRoundTripNs.store(roundTrip, std::memory_order_relaxed);
+                if (roundTrip > m_maxRoundTripNs.load(std::memory_order_relaxed)) {
+                    m_maxRoundTripNs.store(roundTrip, std::memory_order_relaxed);
+                }
+                ack.text[sizeof(ack.text) - 1] = '\0';
+                nlohmann::json result = {
+                    {"status", ack.status},
+                    {"message", ack.text},
+                    {"round_trip_us", roundTrip / 1000.0},
+                    {"control_us", ack.ackNs > ack.receivedNs ? (ack.ackNs - ack.receivedNs) / 1000.0 : 0.0}
+                };
+                if (ack.status != 0) {
+                    return mcp_mqtt::ToolCallResult::error(result.dump());
+                }
+                return mcp_mqtt::ToolCallResult::success(result.dump());
+            }
+            m_staleAcks.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        const uint64_t now = ActuatorRing::nowNs();
+        if (now >= deadline) break;
+        m_ring->wait(ActuatorRing::Direction::Ack, static_cast<int64_t>((deadline - now) / 1000), m_config.spinUs);
+    }
+
+    m_timeouts.fetch_add(1, std::memory_order_relaxed);
+    qWarning() << "Actuator:" << m_tools[toolIndex].name.c_str() << "timed out after" << m_config.timeoutMs << "ms";
+    return mcp_mqtt::ToolCallResult::error("Actuator did not respond");
+}
+
+void ActuatorToolAdapter::exportMetrics(MetricsRecord &record) {
+    record.add("actuator.calls", static_cast<double>(m_calls.load(std::memory_order_relaxed)));
+    record.add("actuator.timeouts", static_cast<double>(m_timeouts.load(std::memory_order_relaxed)));
+    record.add("actuator.stale_acks", static_cast<double>(m_staleAcks.load(std::memory_order_relaxed)));
+    record.add("actuator.round_trip_us", m_lastRoundTripNs.load(std::memory_order_relaxed) / 1000.0);
+    // 峰值只统计上次导出以来
+    record.add("actuator.max_round_trip_us", m_maxRoundTripNs.exchange(0, std::memory_order_relaxed) / 1000.0);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <mcp_mqtt/mcp_server.h>
+#include "ActuatorRing.h"
+
+class MetricsRecord;
+
+/**
+ * 执行器工具配置
+ *
+ * 通过环境变量 QUICKSTART_ACTUATOR 以逗号分隔的选项开启：
+ *   shm=NAME         共享内存段名称，默认 /quickstart-actuator
+ *   tools=PATH       工具定义文件（MCP 工具数组：name / description / inputSchema），
+ *                    不指定时使用内置的 gripper 与 joint_move 两个示例工具
+ *   slots=N          每个方向的槽位数，默认 64
+ *   timeout_ms=N     等待控制进程应答的超时，默认 100
+ *   spin_us=N        等待应答时先自旋的时间，默认 50，之后在 futex 上睡眠
+ * 例如：QUICKSTART_ACTUATOR=shm=/robot-arm,tools=/etc/quickstart/arm-tools.json
+ */
+struct ActuatorConfig {
+    bool enabled = false;
+    std::string shmName = "/quickstart-actuator";
+    std::string toolsPath;
+    int slots = 64;
+    int timeoutMs = 100;
+    int spinUs = 50;
+
+    static ActuatorConfig fromEnvironment();
+};
+
+/**
+ * 把 MCP 工具映射为共享内存命令环上的消息
+ *
+ * 按工具的 inputSchema 生成字段描述（number / integer / boolean / 带 enum 的 string / string，
+ * 最多 ActuatorMessage::kMaxFields 个），写进共享内存段头部，控制进程据此解析命令。
+ * 工具被调用时按字段顺序把参数编码进定长消息写入命令环，等待应答环上同一 id 的应答，
+ * 把状态、说明和往返耗时作为工具结果返回。超时后迟到的应答按 id 丢弃。
+ *
+ * 真实的执行器在独立的实时控制进程中，测试时可运行 tools/ActuatorControlStub。
+ * 工具调用彼此串行（命令环只有一个生产者），单次往返通常为数微秒到数十微秒。
+ */
+class ActuatorToolAdapter {
+public:
+    explicit ActuatorToolAdapter(const ActuatorConfig &config);
+    ~ActuatorToolAdapter();
+
+    ActuatorToolAdapter(const ActuatorToolAdapter &) = delete;
+    ActuatorToolAdapter &operator=(const ActuatorToolAdapter &) = delete;
+
+    /** 共享内存段是否已创建 */
+    bool isOpen() const { return m_ring != nullptr; }
+
+    /** 在 MCP 服务器上注册全部执行器工具 */
+    void registerTools(mcp_mqtt::McpServer &server);
+
+    /** 发送一条命令并等待应答，返回工具结果 */
+    mcp_mqtt::ToolCallResult call(int toolIndex, const nlohmann::json &args);
+
+    void exportMetrics(MetricsRecord &record);
+
+    /** 由 MCP 工具定义生成字段描述，不支持的参数类型返回 false */
+    static bool describe(const mcp_mqtt::Tool &tool, ActuatorToolDescriptor &descriptor, std::string &error);
+    /** 内置示例工具 */
+    static std::vector<mcp_mqtt::Tool> defaultTools();
+
+private:
+    bool loadTools(std::vector<mcp_mqtt::Tool> &tools);
+    bool encode(const ActuatorToolDescriptor &descriptor, const nlohmann::json &args,
+                ActuatorMessage &message, std::string &error) const;
+
+    const ActuatorConfig m_config;
+    std::vector<mcp_mqtt::Tool> m_tools;
+    std::vector<ActuatorToolDescriptor> m_descriptors;
+    std::unique_ptr<ActuatorRing> m_ring;
+
+    std::mutex m_callMutex;
+    uint64_t m_nextId = 0;
+
+    std::atomic<uint64_t> m_calls{0};
+    std::atomic<uint64_t> m_timeouts{0};
+    std::atomic<uint64_t> m_staleAcks{0};
+    std::atomic<uint64_t> m_lastRoundTripNs{0};
+    std::atomic<uint64_t> m_maxRoundTripNs{0};
+};
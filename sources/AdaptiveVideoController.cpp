@@ -0,0 +1,184 @@
+#include "AdaptiveVideoController.h"
+#include <QDateTime>
+#include <QDebug>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <sstream>
+
+AdaptiveVideoConfig AdaptiveVideoConfig::fromEnvironment() {
+    AdaptiveVideoConfig config;
+    // 竖屏 9:16，起始档位与原先固定的 360x640@15 一致
+    config.ladder = {
+        {180, 320, 10, 250, 80},
+        {270, 480, 15, 450, 150},
+        {360, 640, 15, 800, 250},
+        {540, 960, 20, 1300, 400},
+        {720, 1280, 25, 2200, 600},
+    };
+    config.startIndex = 2;
+
+    if (const char *ladder = std::getenv("QUICKSTART_VIDEO_LADDER")) {
+        std::vector<RtcVideoEncoderProfile> parsed;
+        std::stringstream ss(ladder);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            RtcVideoEncoderProfile profile;
+            int kbps = -1;
+            if (std::sscanf(item.c_str(), "%dx%d@%d:%d", &profile.width, &profile.height,
+                            &profile.frameRate, &kbps) >= 3) {
+                profile.maxBitrateKbps = kbps;
+                profile.minBitrateKbps = kbps > 0 ? kbps / 3 : 0;
+                parsed.push_back(profile);
+            } else {
+                qWarning() << "QUICKSTART_VIDEO_LADDER: invalid entry" << item.c_str();
+            }
+        }
+        if (!parsed.empty()) {
+            // 按像素率从低到高排序，起始档位取最接近原默认值的一档
+            std::sort(parsed.begin(), parsed.end(), [](const auto &a, const auto &b) {
+                return a.width * a.height * a.frameRate < b.width * b.height * b.frameRate;
+            });
+            config.ladder = parsed;
+            config.startIndex = 0;
+            for (size_t i = 0; i < parsed.size(); ++i) {
+                if (parsed[i].width * parsed[i].height <= 360 * 640) {
+                    config.startIndex = static_cast<int>(i);
+                }
+            }
+        }
+    }
+
+    if (const char *value = std::getenv("QUICKSTART_ADAPTIVE_VIDEO")) {
+        if (std::string(value) == "off") {
+            config.enabled = false;
+        }
+        std::stringstream ss(value);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            auto pos = item.find('=');
+            if (pos == std::string::npos) continue;
+            std::string key = item.substr(0, pos);
+            double number = std::atof(item.c_str() + pos + 1);
+
+            if (key == "start") config.startIndex = static_cast<int>(number);
+            else if (key == "interval_ms") config.intervalMs = static_cast<int>(number);
+            else if (key == "down") config.downSamples = static_cast<int>(number);
+            else if (key == "up") config.upSamples = static_cast<int>(number);
+            else if (key == "hold_ms") config.minHoldMs = static_cast<int>(number);
+            else if (key == "cpu_high") config.cpuHighPercent = number;
+            else if (key == "cpu_low") config.cpuLowPercent = number;
+            else if (key == "bad_tx") config.badTxQuality = static_cast<int>(number);
+            else if (key == "good_tx") config.goodTxQuality = static_cast<int>(number);
+            else if (key == "bad_loss") config.badLossRate = number;
+            else if (key == "good_loss") config.goodLossRate = number;
+            else qWarning() << "QUICKSTART_ADAPTIVE_VIDEO: unknown key" << key.c_str();
+        }
+    }
+
+    config.startIndex = std::clamp(config.startIndex, 0, static_cast<int>(config.ladder.size()) - 1);
+    config.intervalMs = std::max(100, config.intervalMs);
+    config.downSamples = std::max(1, config.downSamples);
+    config.upSamples = std::max(1, config.upSamples);
+    return config;
+}
+
+AdaptiveVideoController::AdaptiveVideoController(IRtcEngine *engine, const AdaptiveVideoConfig &config,
+                                                 QObject *parent)
+    : QObject(parent), m_engine(engine), m_config(config), m_index(config.startIndex) {
+    m_timer.setInterval(m_config.intervalMs);
+    connect(&m_timer, &QTimer::timeout, this, &AdaptiveVideoController::evaluate);
+}
+
+void AdaptiveVideoController::start() {
+    m_badCount = 0;
+    m_goodCount = 0;
+    m_upBackoff = 1;
+    applyProfile(m_config.startIndex, "initial");
+    m_cpuSampler.sample();
+    if (m_config.enabled && m_config.ladder.size() > 1) {
+        m_timer.start();
+    }
+}
+
+void AdaptiveVideoController::stop() {
+    m_timer.stop();
+}
+
+void AdaptiveVideoController::onNetworkQuality(const RtcNetworkQuality &quality) {
+    m_txQuality = quality.txQuality;
+    m_lossRate = quality.lossRate;
+}
+
+void AdaptiveVideoController::onLocalStreamStats(const RtcLocalStreamStats &stats) {
+    m_encoderOutputFps = stats.encoderOutputFrameRate;
+    m_sentKbps = stats.sentKbps;
+}
+
+const RtcVideoEncoderProfile &AdaptiveVideoController::currentProfile() const {
+    return m_config.ladder[m_index];
+}
+
+void AdaptiveVideoController::evaluate() {
+    const auto cpu = m_cpuSampler.sample();
+    const double cpuPercent = std::max(cpu.processPercent, cpu.systemPercent);
+    const int txQuality = m_txQuality;
+    const float lossRate = m_lossRate;
+    const float encoderFps = m_encoderOutputFps;
+    const int targetFps = currentProfile().frameRate;
+
+    // 质量评分为 0（未知）时不参与判断
+    const bool netBad = (txQuality >= m_config.badTxQuality) || lossRate > m_config.badLossRate;
+    const bool netGood = txQuality > 0 && txQuality <= m_config.goodTxQuality && lossRate < m_config.goodLossRate;
+    const bool cpuBad = cpuPercent > m_config.cpuHighPercent;
+    const bool cpuGood = cpuPercent < m_config.cpuLowPercent;
+    const bool encoderLagging = encoderFps >= 0.0f && encoderFps < targetFps * m_config.encoderLagRatio;
+
+    char reason[160];
+    std::snprintf(reason, sizeof(reason), "tx=%d loss=%.1f%% cpu=%.0f%% (proc %.0f%%) enc=%.1f/%dfps sent=%.0fkbps",
+                  txQuality, lossRate * 100.0f, cpuPercent, cpu.processPercent,
+                  encoderFps, targetFps, static_cast<float>(m_sentKbps));
+
+    if (netBad || cpuBad || encoderLagging) {
+        m_goodCount = 0;
+        ++m_badCount;
+    } else if (netGood && cpuGood && !encoderLagging) {
+        m_badCount = 0;
+        ++m_goodCount;
+    } else {
+        // 介于两者之间：保持当前档位，只让计数慢慢回落
+        m_badCount = std::max(0, m_badCount - 1);
+        m_goodCount = std::max(0, m_goodCount - 1);
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const bool holdExpired = now - m_lastChangeMs >= m_config.minHoldMs;
+
+    if (m_badCount >= m_config.downSamples && m_index > 0) {
+        m_upBackoff = std::min(m_upBackoff * 2, m_config.maxUpBackoff);
+        applyProfile(m_index - 1, reason);
+    } else if (m_goodCount >= m_config.upSamples * m_upBackoff && holdExpired
+               && m_index + 1 < static_cast<int>(m_config.ladder.size())) {
+        applyProfile(m_index + 1, reason);
+    } else if (holdExpired && m_goodCount > 0 && m_upBackoff > 1 && m_goodCount % m_config.upSamples == 0) {
+        // 长时间稳定后逐步恢复升档灵敏度
+        m_upBackoff = std::max(1, m_upBackoff / 2);
+    }
+}
+
+void AdaptiveVideoController::applyProfile(int index, const char *reason) {
+    const auto &from = m_config.ladder[m_index];
+    const auto &to = m_config.ladder[index];
+
+    qInfo().noquote() << QString("AdaptiveVideo: %1x%2@%3 %4kbps -> %5x%6@%7 %8kbps (%9)")
+            .arg(from.width).arg(from.height).arg(from.frameRate).arg(from.maxBitrateKbps)
+            .arg(to.width).arg(to.height).arg(to.frameRate).arg(to.maxBitrateKbps)
+            .arg(reason);
+
+    m_index = index;
+    m_badCount = 0;
+    m_goodCount = 0;
+    m_lastChangeMs = QDateTime::currentMSecsSinceEpoch();
+    m_encoderOutputFps = -1.0f;  // 等待新档位下的统计
+    m_engine->setVideoEncoderProfile(to);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "CpuUsage.h"
+#include "RtcBackend.h"
+
+/**
+ * 自适应视频编码参数的配置
+ *
+ * 档位（ladder）从低到高排列，可通过环境变量 QUICKSTART_VIDEO_LADDER 覆盖，
+ * 格式为 "宽x高@帧率:码率kbps"，以逗号分隔，例如：
+ *   QUICKSTART_VIDEO_LADDER="180x320@10:200,360x640@15:700,720x1280@25:2000"
+ * 其余阈值通过 QUICKSTART_ADAPTIVE_VIDEO 以 "key=value" 形式覆盖，
+ * 设置为 "off" 时关闭自适应，固定使用起始档位。
+ */
+struct AdaptiveVideoConfig {
+    std::vector<RtcVideoEncoderProfile> ladder;
+    int startIndex = 2;
+
+    bool enabled = true;
+    int intervalMs = 1000;       // 评估周期
+    int downSamples = 3;         // 连续多少个周期变差后降档
+    int upSamples = 10;          // 连续多少个周期良好后升档
+    int minHoldMs = 10000;       // 两次调整之间的最短间隔
+    int maxUpBackoff = 8;        // 降档后升档所需周期数的最大倍数
+
+    double cpuHighPercent = 85.0;    // 进程或整机 CPU 超过该值视为过载
+    double cpuLowPercent = 60.0;     // 低于该值才允许升档
+    int badTxQuality = 4;            // 上行质量评分 >= 该值视为网络差
+    int goodTxQuality = 2;           // 上行质量评分 <= 该值视为网络好
+    double badLossRate = 0.08;
+    double goodLossRate = 0.02;
+    double encoderLagRatio = 0.7;    // 编码输出帧率低于目标的该比例视为编码跟不上
+
+    static AdaptiveVideoConfig fromEnvironment();
+};
+
+/**
+ * 根据网络质量、本地流统计和 CPU 占用在档位间升降视频编码参数
+ *
+ * onNetworkQuality / onLocalStreamStats 可在 SDK 回调线程上调用，
+ * 评估和 setVideoEncoderProfile 在所属的 Qt 线程上按周期执行。
+ * 降档需连续 downSamples 个周期变差；升档需连续 upSamples 个周期良好，
+ * 且每次降档后升档所需周期翻倍（上限 maxUpBackoff 倍），避免来回振荡。
+ * 每次调整都会以 "AdaptiveVideo:" 前缀输出日志，便于调参。
+ */
+class AdaptiveVideoController : public QObject {
+    Q_OBJECT
+
+public:
+    AdaptiveVideoController(IRtcEngine *engine, const AdaptiveVideoConfig &config, QObject *parent = nullptr);
+
+    /** 应用起始档位并开始周期评估 */
+    void start();
+    void stop();
+
+    void onNetworkQuality(const RtcNetworkQuality &quality);
+    void onLocalStreamStats(const RtcLocalStreamStats &stats);
+
+    const RtcVideoEncoderProfile &currentProfile() const;
+
+private:
+    void evaluate();
+    void applyProfile(int index, const char *reason);
+
+    IRtcEngine *m_engine;
+    AdaptiveVideoConfig m_config;
+    QTimer m_timer;
+    CpuUsageSampler m_cpuSampler;
+
+    // 由 SDK 回调线程写入
+    std::atomic<int> m_txQuality{0};
+    std::atomic<float> m_lossRate{0.0f};
+    std::atomic<float> m_encoderOutputFps{-1.0f};
+    std::atomic<float> m_sentKbps{0.0f};
+
+    int m_index = 0;
+    int m_badCount = 0;
+    int m_goodCount = 0;
+    int m_upBackoff = 1;
+    qint64 m_lastChangeMs = 0;
+};
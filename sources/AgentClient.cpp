@@ -1,26 +1,149 @@
 #include "AgentClient.h"
-#include <QMetaObject>
+#include "EventLoopDrain.h"
+#include "MpscEventQueue.h"
+#include "MessageTracer.h"
+#include "SnapshotCache.h"
+#include "TelemetryStream.h"
+#include "ActuatorToolAdapter.h"
+#include "AllocTracker.h"
+#include "BrokerRace.h"
+#include "ThreadPolicy.h"
+#include "TopicAliasTable.h"
+#include "TypedTool.h"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstring>
+#include <iterator>
+#include <map>
 #include <mutex>
 
+// ── 回调事件 ──────────────────────────────────────────────────────
+// MQTT 线程交给界面线程的事件。消息只持有 Paho 已分配好的消息对象（复制共享指针），
+// 主题和内容在界面线程上再转换为 QString。协议消息逐条保留；灯状态只保留最新一次。
+struct AgentClient::MqttEvent {
+    enum class Type : uint8_t {
+        None,
+        Message,
+        ConnectionLost,
+        LightState,
+        FailoverFinished,
+    };
+
+    Type type = Type::None;
+    mqtt::const_message_ptr message;
+    bool lightOn = false;
+    char cause[256] = {};
+
+    static bool supersedes(const MqttEvent &newer, const MqttEvent &older) {
+        return newer.type == Type::LightState && older.type == Type::LightState;
+    }
+};
+
+namespace {
+
+// 智能体的增量文本可能在界面卡顿时密集到达，容量比 RTC 事件队列大
+const int kMqttEventQueueCapacity = 1024;
+
+// 智能体协议与 MCP 的 JSON-RPC id 各自编号，追踪时按主题分开；
+// 主题为空的是以别名发出的消息，只有智能体协议与遥测使用别名
+const char *traceChannel(const std::string &topic) {
+    return topic.empty() || topic.compare(0, 6, "$agent") == 0 ? "agent" : "mcp";
+}
+
+// CONNACK 中的 Topic Alias Maximum，服务器未给出时为 0（不接受别名）
+int topicAliasMaximum(const mqtt::token_ptr &token) {
+    const auto response = token->get_connect_response();
+    const auto &cProps = response.get_properties().c_struct();
+    for (int i = 0; i < cProps.count; ++i) {
+        if (cProps.array[i].identifier == MQTTPROPERTY_CODE_TOPIC_ALIAS_MAXIMUM) {
+            return cProps.array[i].value.integer2;
+        }
+    }
+    return 0;
+}
+
+// ── MCP 工具参数 ──────────────────────────────────────────────────
+
+enum class LightAction { On, Off };
+constexpr std::array<std::string_view, 2> kLightActions = {"on", "off"};
+
+struct LightArgs {
+    LightAction action = LightAction::Off;
+
+    static constexpr auto fields() {
+        return std::make_tuple(
+            TypedTool::enumeration("action", &LightArgs::action, kLightActions,
+                                   "Action to perform: 'on' to turn on, 'off' to turn off", TypedTool::Required));
+    }
+};
+
+enum class SnapshotSource { Local, Remote };
+constexpr std::array<std::string_view, 2> kSnapshotSources = {"local", "remote"};
+
+struct SnapshotArgs {
+    SnapshotSource source = SnapshotSource::Local;
+    std::string streamId;
+    int width = 0;
+    int height = 0;
+    int quality = 75;
+    std::string snapshotId;
+    int chunk = 0;
+
+    static constexpr auto fields() {
+        return std::make_tuple(
+            TypedTool::enumeration("source", &SnapshotArgs::source, kSnapshotSources,
+                                   "'local' for this device's camera, 'remote' for the other party's video"),
+            TypedTool::field("stream_id", &SnapshotArgs::streamId,
+                             "Remote stream to capture, defaults to the most recently active one"),
+            TypedTool::range("width", &SnapshotArgs::width, 0, 16384,
+                             "Maximum width in pixels, aspect ratio is preserved and frames are never upscaled"),
+            TypedTool::range("height", &SnapshotArgs::height, 0, 16384, "Maximum height in pixels"),
+            TypedTool::range("quality", &SnapshotArgs::quality, 1, 100, "JPEG quality 1-100, default 75"),
+            TypedTool::field("snapshot_id", &SnapshotArgs::snapshotId,
+                             "Fetch a chunk of an earlier snapshot instead of capturing a new one"),
+            TypedTool::range("chunk", &SnapshotArgs::chunk, 0, 1 << 20,
+                             "Chunk index to fetch together with snapshot_id"));
+    }
+};
+
+// 响应携带的 Correlation Data，即请求的 JSON-RPC id
+bool correlationData(const mqtt::message &msg, std::string &correlation) {
+    const auto &cProps = msg.get_properties().c_struct();
+    for (int i = 0; i < cProps.count; ++i) {
+        if (cProps.array[i].identifier == MQTTPROPERTY_CODE_CORRELATION_DATA) {
+            correlation.assign(cProps.array[i].value.data.data, cProps.array[i].value.data.len);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
 // ── IMqttClient 适配器 ─────────────────────────────────────────────
 // 将已有的 Paho mqtt::async_client 包装为 MCP SDK 所需的 IMqttClient 接口，
 // 使 McpServer 能复用同一条 MQTT 连接来订阅/发布 MCP 协议消息。
 class AgentClient::McpMqttAdapter : public mcp_mqtt::IMqttClient {
 public:
     explicit McpMqttAdapter(mqtt::async_client* client, const std::string& clientId,
-                            const std::string& brokerUrl)
-        : m_client(client), m_clientId(clientId), m_brokerUrl(brokerUrl) {}
+                            const std::string& brokerUrl, TopicAliasTable* topicAliases)
+        : m_client(client), m_clientId(clientId), m_brokerUrl(brokerUrl), m_topicAliases(topicAliases) {}
 
     bool isConnected() const override {
-        return m_client && m_client->is_connected();
+        mqtt::async_client* client = m_client.load();
+        return client && client->is_connected();
     }
 
     bool subscribe(const std::string& topic, int qos, bool noLocal) override {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_subscriptions[topic] = Subscription{qos, noLocal};
+        }
         try {
             mqtt::subscribe_options subOpts;
             subOpts.set_no_local(noLocal);
-            m_client->subscribe(topic, qos, subOpts);
+            m_client.load()->subscribe(topic, qos, subOpts);
             return true;
         } catch (const mqtt::exception& e) {
             qWarning() << "MCP subscribe error:" << e.what();
@@ -29,8 +152,12 @@ public:
     }
 
     bool unsubscribe(const std::string& topic) override {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_subscriptions.erase(topic);
+        }
         try {
-            m_client->unsubscribe(topic);
+            m_client.load()->unsubscribe(topic);
             return true;
         } catch (const mqtt::exception& e) {
             qWarning() << "MCP unsubscribe error:" << e.what();
@@ -41,14 +168,25 @@ public:
     bool publish(const std::string& topic, const std::string& payload,
                  int qos, bool retained,
                  const std::map<std::string, std::string>& userProps) override {
+        AllocScope allocScope(AllocSubsystem::McpAdapter);
+        if (retained) {
+            // 保留消息（如 presence）在切换 Broker 后重新发布，空内容表示清除
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (payload.empty()) {
+                m_retained.erase(topic);
+            } else {
+                m_retained[topic] = RetainedMessage{payload, qos, userProps};
+            }
+        }
         try {
+            MessageTracer::markPayload(TracePoint::Publish, "mcp", payload, topic.c_str());
             auto msg = mqtt::make_message(topic, payload, qos, retained);
             mqtt::properties props;
             for (const auto& [key, value] : userProps) {
                 props.add(mqtt::property(mqtt::property::USER_PROPERTY, key, value));
             }
             msg->set_properties(props);
-            m_client->publish(msg);
+            m_client.load()->publish(msg);
             return true;
         } catch (const mqtt::exception& e) {
             qWarning() << "MCP publish error:" << e.what();
@@ -84,13 +222,46 @@ public:
         m_willRetained = retained;
 
         // 若已连接则重连，以便应用 Will + Connect 属性
-        if (m_client && m_client->is_connected()) {
+        mqtt::async_client* client = m_client.load();
+        if (client && client->is_connected()) {
+            reconnect();
+        }
+    }
+
+    // 断线后切换到另一个 Broker 上已建立的连接：重新应用 Will 与 CONNECT 属性，
+    // 恢复 SDK 的订阅并重新发布保留消息；旧客户端由调用方保留到 stop()
+    void switchClient(mqtt::async_client* client, const std::string& brokerUrl) {
+        m_client.store(client);
+        m_brokerUrl = brokerUrl;
+        if (!m_willTopic.empty() || m_connectPropsSet) {
             reconnect();
         }
+
+        std::map<std::string, Subscription> subscriptions;
+        std::map<std::string, RetainedMessage> retained;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            subscriptions = m_subscriptions;
+            retained = m_retained;
+        }
+        for (const auto& [topic, subscription] : subscriptions) {
+            try {
+                mqtt::subscribe_options subOpts;
+                subOpts.set_no_local(subscription.noLocal);
+                client->subscribe(topic, subscription.qos, subOpts);
+            } catch (const mqtt::exception& e) {
+                qWarning() << "MCP resubscribe error:" << e.what();
+            }
+        }
+        for (const auto& [topic, message] : retained) {
+            publish(topic, message.payload, message.qos, true, message.userProps);
+        }
     }
 
     // 由 MqttCallbackBridge 调用，将收到的消息转发给 MCP SDK
     void forwardMessage(mqtt::const_message_ptr msg) {
+        // SDK 解析 MCP 消息与工具调用都在这里同步执行
+        AllocScope allocScope(AllocSubsystem::McpAdapter);
         mcp_mqtt::MqttMessageHandler handler;
         {
             std::lock_guard<std::mutex> lock(m_mutex);
@@ -117,13 +288,22 @@ public:
             }
         }
 
+        // 智能体协议的消息在界面线程排空时打点，这里只给 MCP 消息打点；
+        // 工具处理函数拿不到 JSON-RPC id，由 DispatchScope 交给 HandlerScope
+        if (std::strcmp(traceChannel(inMsg.topic), "mcp") != 0) {
+            handler(inMsg);
+            return;
+        }
+        MessageTracer::markPayload(TracePoint::Dispatch, "mcp", inMsg.payload);
+        MessageTracer::DispatchScope trace("mcp", inMsg.payload);
         handler(inMsg);
     }
 
 private:
     void reconnect() {
+        mqtt::async_client* client = m_client.load();
         try {
-            m_client->disconnect()->wait();
+            client->disconnect()->wait();
 
             auto builder = mqtt::connect_options_builder()
                 .mqtt_version(MQTTVERSION_5)
@@ -155,17 +335,35 @@ private:
                     .finalize());
             }
 
-            m_client->connect(builder.finalize())->wait();
+            auto token = client->connect(builder.finalize());
+            token->wait();
+            // 别名只在本次连接内有效，按新的 CONNACK 重新开始
+            m_topicAliases->reset(topicAliasMaximum(token));
         } catch (const mqtt::exception& e) {
             qWarning() << "MCP adapter reconnect error:" << e.what();
         }
     }
 
-    mqtt::async_client* m_client;
+    struct Subscription {
+        int qos = 0;
+        bool noLocal = false;
+    };
+    struct RetainedMessage {
+        std::string payload;
+        int qos = 0;
+        std::map<std::string, std::string> userProps;
+    };
+
+    // 切换 Broker 时在界面线程上替换，SDK 可能同时在其它线程上发布
+    std::atomic<mqtt::async_client*> m_client;
     std::string m_clientId;
     std::string m_brokerUrl;
+    TopicAliasTable* m_topicAliases;
     std::mutex m_mutex;
     mcp_mqtt::MqttMessageHandler m_handler;
+    // SDK 的订阅与保留消息，切换 Broker 后恢复
+    std::map<std::string, Subscription> m_subscriptions;
+    std::map<std::string, RetainedMessage> m_retained;
     // Will message (set by SDK via setWill())
     std::string m_willTopic;
     std::string m_willPayload;
@@ -178,8 +376,8 @@ private:
 };
 
 // ── 内部 MQTT 回调桥接类 ───────────────────────────────────────────
-// Paho 的回调运行在内部线程上，通过 QMetaObject::invokeMethod
-// 将消息安全地转发到 Qt 主线程处理；同时也转发给 MCP SDK。
+// Paho 的回调运行在内部线程上，消息写入无锁事件队列，
+// 由 Qt 主线程每轮事件循环排空处理；同时也转发给 MCP SDK。
 class AgentClient::MqttCallbackBridge : public mqtt::callback {
 public:
     explicit MqttCallbackBridge(AgentClient *owner) : m_owner(owner) {}
@@ -187,29 +385,42 @@ public:
     void setMcpAdapter(McpMqttAdapter* adapter) { m_mcpAdapter = adapter; }
 
     void message_arrived(mqtt::const_message_ptr msg) override {
+        ThreadPolicy::adoptCurrentThread(ThreadClass::Mqtt, "paho-callback");
+        if (MessageTracer::enabled()) {
+            MessageTracer::markPayload(TracePoint::Receive, traceChannel(msg->get_topic()),
+                                       msg->get_payload_str(), msg->get_topic().c_str());
+        }
+
         // 先转发给 MCP SDK（在 MQTT 线程上执行，SDK 内部处理线程安全）
         if (m_mcpAdapter) {
             m_mcpAdapter->forwardMessage(msg);
         }
 
-        // 再转发给智能体协议处理器（通过 Qt 事件队列发到主线程）
-        QString topic = QString::fromStdString(msg->get_topic());
-        QString payload = QString::fromStdString(msg->to_string());
-        QMetaObject::invokeMethod(m_owner, "handleMessage",
-            Qt::QueuedConnection,
-            Q_ARG(QString, topic),
-            Q_ARG(QString, payload));
+        // 再转发给智能体协议处理器（入队，由主线程排空）
+        MqttEvent event;
+        event.type = MqttEvent::Type::Message;
+        event.message = std::move(msg);
+        m_owner->postEvent(std::move(event));
     }
 
     void connection_lost(const std::string &cause) override {
-        QString reason = QString::fromStdString(cause);
-        QMetaObject::invokeMethod(m_owner, "handleConnectionLost",
-            Qt::QueuedConnection,
-            Q_ARG(QString, reason));
+        MqttEvent event;
+        event.type = MqttEvent::Type::ConnectionLost;
+        strncpy(event.cause, cause.c_str(), sizeof(event.cause) - 1);
+        m_owner->postEvent(std::move(event));
     }
 
     void connected(const std::string &) override {}
-    void delivery_complete(mqtt::delivery_token_ptr) override {}
+    void delivery_complete(mqtt::delivery_token_ptr token) override {
+        if (!MessageTracer::enabled() || !token) {
+            return;
+        }
+        auto msg = token->get_message();
+        if (msg) {
+            MessageTracer::markPayload(TracePoint::DeliveryComplete, traceChannel(msg->get_topic()),
+                                       msg->get_payload_str(), msg->get_topic().c_str());
+        }
+    }
 
 private:
     AgentClient *m_owner;
@@ -219,48 +430,131 @@ private:
 // ── AgentClient 实现 ──────────────────────────────────────────────
 
 AgentClient::AgentClient(QObject *parent)
-    : QObject(parent) {
+    : QObject(parent),
+      m_events(std::make_unique<MpscEventQueue<MqttEvent>>(kMqttEventQueueCapacity)),
+      m_eventDrain(std::make_unique<EventLoopDrain>([this] { drainEvents(); })) {
 }
 
 AgentClient::~AgentClient() {
     stop();
+    // stop() 之后 MQTT 线程不再回调，先断开排空再释放队列
+    m_eventDrain.reset();
+}
+
+void AgentClient::postEvent(MqttEvent &&event) {
+    // 消息、断线与灯的状态都不能丢：队列满时经溢出列表按顺序送达
+    m_events->pushReliable(std::move(event));
+    m_eventDrain->wake();
+}
+
+void AgentClient::beginShutdown() {
+    m_shuttingDown = true;
+}
+
+void AgentClient::drainEvents() {
+    m_events->drain([this](const MqttEvent &event) {
+        // 关闭过程中 stop() 在后台线程上修改会话状态，之后收到的事件直接丢弃；
+        // 处理本批事件时也可能触发挂断，因此逐个检查
+        if (m_shuttingDown) {
+            return;
+        }
+        switch (event.type) {
+            case MqttEvent::Type::Message: {
+                AllocScope allocScope(AllocSubsystem::AgentProtocol);
+                // MCP 消息已在 Paho 线程上交给 SDK 时打过点，这里不再重复
+                if (std::strcmp(traceChannel(event.message->get_topic()), "agent") != 0) {
+                    handleMessage(*event.message);
+                    break;
+                }
+                // 界面线程排空时打点，与 Paho 线程上的 receive 之差即为排队时间
+                MessageTracer::markPayload(TracePoint::Dispatch, "agent", event.message->get_payload_str());
+                MessageTracer::DispatchScope trace("agent", event.message->get_payload_str());
+                MessageTracer::HandlerScope handler("handleMessage");
+                handleMessage(*event.message);
+                break;
+            }
+            case MqttEvent::Type::ConnectionLost:
+                handleConnectionLost(QString::fromUtf8(event.cause));
+                break;
+            case MqttEvent::Type::LightState:
+                emit lightStateChanged(event.lightOn);
+                break;
+            case MqttEvent::Type::FailoverFinished:
+                finishFailover();
+                break;
+            case MqttEvent::Type::None:
+                break;
+        }
+    });
+
+    const uint64_t spilled = m_events->spilled();
+    if (spilled != m_reportedEventSpills) {
+        qWarning() << "MQTT event queue full," << spilled - m_reportedEventSpills << "events went through the overflow list";
+        m_reportedEventSpills = spilled;
+    }
+}
+
+std::unique_ptr<mqtt::async_client> AgentClient::createMqttClient(const std::string &brokerUrl,
+                                                                  const std::string &clientId) {
+    mqtt::create_options createOpts(MQTTVERSION_5);
+    return std::make_unique<mqtt::async_client>(brokerUrl, clientId, createOpts);
+}
+
+mqtt::connect_options AgentClient::connectOptions(const std::string &brokerUrl) {
+    auto connOptsBuilder = mqtt::connect_options_builder()
+        .mqtt_version(MQTTVERSION_5)
+        .clean_start(true)
+        .keep_alive_interval(std::chrono::seconds(60));
+
+    // 为 ssl:// 和 wss:// 连接配置 TLS 选项
+    if (brokerUrl.rfind("ssl://", 0) == 0 || brokerUrl.rfind("wss://", 0) == 0) {
+        auto sslOpts = mqtt::ssl_options_builder()
+            .enable_server_cert_auth(true)
+            .verify(true)
+            .finalize();
+        connOptsBuilder.ssl(std::move(sslOpts));
+    }
+
+    return connOptsBuilder.finalize();
 }
 
 void AgentClient::start(const QString &brokerUrl,
                          const QString &agentId,
-                         const QString &clientId) {
+                         const QString &clientId,
+                         std::unique_ptr<mqtt::async_client> connectedClient) {
     m_agentId = agentId.toStdString();
     m_clientId = clientId.toStdString();
-    m_brokerUrl = brokerUrl.toStdString();
+    m_brokers = BrokerRace::splitList(brokerUrl.toStdString());
+    m_brokerUrl.clear();
+    m_failoverCancelled = false;
+    m_failingOver = false;
+    m_voiceChatReady = false;
     m_nextRequestId = 1;
+    m_responseTopic = "$agent-client/" + m_clientId + "/rpc";
+    // 预热连接的 CONNACK 拿不到，在 setupMcpServer() 重连之前不使用别名
+    m_topicAliases.reset(0);
 
     try {
-        mqtt::create_options createOpts(MQTTVERSION_5);
-        m_mqttClient = std::make_unique<mqtt::async_client>(
-            brokerUrl.toStdString(), m_clientId, createOpts);
+        if (connectedClient && connectedClient->is_connected()) {
+            m_mqttClient = std::move(connectedClient);
+            m_brokerUrl = m_mqttClient->get_server_uri();
+            qDebug() << "MQTT using prewarmed connection to" << m_brokerUrl.c_str();
+        } else {
+            // 多个 Broker 时错开并行连接，不必等慢的那个超时
+            auto race = BrokerRace::connect(m_brokers, m_clientId, BrokerRaceConfig::fromEnvironment());
+            std::move(race.abandoned.begin(), race.abandoned.end(), std::back_inserter(m_abandonedClients));
+            if (!race.client) {
+                emit errorOccurred(QStringLiteral(u"连接 MQTT Broker 超时"));
+                return;
+            }
+            m_mqttClient = std::move(race.client);
+            m_brokerUrl = race.brokerUrl;
+            m_topicAliases.reset(topicAliasMaximum(race.token));
+        }
 
         m_callbackBridge = std::make_unique<MqttCallbackBridge>(this);
         m_mqttClient->set_callback(*m_callbackBridge);
 
-        auto connOptsBuilder = mqtt::connect_options_builder()
-            .mqtt_version(MQTTVERSION_5)
-            .clean_start(true)
-            .keep_alive_interval(std::chrono::seconds(60));
-
-        // 为 ssl:// 和 wss:// 连接配置 TLS 选项
-        std::string url = brokerUrl.toStdString();
-        if (url.rfind("ssl://", 0) == 0 || url.rfind("wss://", 0) == 0) {
-            auto sslOpts = mqtt::ssl_options_builder()
-                .enable_server_cert_auth(true)
-                .verify(true)
-                .finalize();
-            connOptsBuilder.ssl(std::move(sslOpts));
-        }
-
-        auto connOpts = connOptsBuilder.finalize();
-
-        m_mqttClient->connect(connOpts)->wait_for(std::chrono::seconds(10));
-
         if (!m_mqttClient->is_connected()) {
             emit errorOccurred(QStringLiteral(u"连接 MQTT Broker 超时"));
             return;
@@ -270,10 +564,7 @@ void AgentClient::start(const QString &brokerUrl,
         setupMcpServer();
 
         // 订阅智能体回复主题（必须在 setupMcpServer 之后，因为重连会清除订阅）
-        std::string subTopic = "$agent-client/" + m_clientId + "/#";
-        m_mqttClient->subscribe(subTopic, 1)->wait_for(std::chrono::seconds(5));
-
-        qDebug() << "MQTT connected, subscribed to:" << subTopic.c_str();
+        subscribeAndAttach();
 
         // 发送初始化会话
         sendInitializeSession();
@@ -285,7 +576,65 @@ void AgentClient::start(const QString &brokerUrl,
     }
 }
 
+void AgentClient::subscribeAndAttach() {
+    std::string subTopic = agentTopic();
+    m_mqttClient->subscribe(subTopic, 1)->wait_for(std::chrono::seconds(5));
+
+    qDebug() << "MQTT connected to" << m_brokerUrl.c_str() << ", subscribed to:" << subTopic.c_str()
+             << "topic alias maximum" << m_topicAliases.maximum();
+    attachTelemetry();
+}
+
+void AgentClient::attachTelemetry() {
+    // 遥测走独立主题，QoS 0 发出即返回，不与智能体协议消息排队
+    if (m_telemetry) {
+        mqtt::async_client *client = m_mqttClient.get();
+        TopicAliasTable *aliases = &m_topicAliases;
+        m_telemetryToken = m_telemetry->attach(m_agentId, m_clientId,
+            [client, aliases](const std::string &topic, const std::string &payload) {
+            try {
+                if (!client->is_connected()) return false;
+                client->publish(aliases->makeMessage(topic, payload, 0));
+                return true;
+            } catch (const mqtt::exception &) {
+                aliases->failed(topic);
+                return false;
+            }
+        });
+    }
+}
+
 void AgentClient::stop() {
+    // 进行中的 Broker 切换引用 MCP 适配器与回调桥，先取消并等待结束
+    m_failoverCancelled = true;
+    if (m_failoverThread.joinable()) {
+        m_failoverThread.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_failoverMutex);
+        if (m_failoverResult) {
+            if (m_failoverResult->client) {
+                m_abandonedClients.push_back(std::move(m_failoverResult->client));
+            }
+            std::move(m_failoverResult->abandoned.begin(), m_failoverResult->abandoned.end(),
+                      std::back_inserter(m_abandonedClients));
+            m_failoverResult.reset();
+        }
+    }
+    m_failingOver = false;
+    // 发布函数引用 MQTT 客户端，必须在释放客户端之前摘除
+    if (m_telemetry && m_telemetryToken) {
+        m_telemetry->detach(m_telemetryToken);
+        m_telemetryToken = 0;
+    }
+    if (m_topicAliases.aliasedMessages() > 0) {
+        qDebug() << "MQTT topic aliases:" << m_topicAliases.aliasedMessages() << "messages,"
+                 << m_topicAliases.savedBytes() << "topic bytes saved";
+    }
+    // 工具随 MCP 服务器一起停止，帧缓存不再拷贝帧
+    if (m_snapshotCache) {
+        m_snapshotCache->setToolRegistered(false);
+    }
     if (m_mqttClient && m_mqttClient->is_connected()) {
         try {
             // 先停止 MCP 服务器（清除 presence，取消 MCP 主题订阅）
@@ -297,6 +646,7 @@ void AgentClient::stop() {
             m_mqttClient->disconnect()->wait_for(std::chrono::seconds(2));
         } catch (...) {}
     }
+    BrokerRace::release(m_abandonedClients);
     if (m_callbackBridge) {
         m_callbackBridge->setMcpAdapter(nullptr);
     }
@@ -311,40 +661,42 @@ bool AgentClient::isConnected() const {
 
 // ── 消息处理 ──────────────────────────────────────────────────────
 
-void AgentClient::handleMessage(const QString &topic, const QString &payload) {
-    qDebug() << "MQTT message on" << topic << ":" << payload;
+void AgentClient::handleMessage(const mqtt::message &msg) {
+    const std::string &payload = msg.get_payload_str();
+    qDebug() << "MQTT message on" << msg.get_topic().c_str() << ":" << payload.c_str();
+
+    // 带 Correlation Data 的是对本端请求的响应，先按属性匹配待处理的请求，
+    // 匹配不到的（例如上一次会话的迟到响应）不必解析内容
+    std::string correlation;
+    if (correlationData(msg, correlation) && !isPendingRequest(correlation)) {
+        qDebug() << "Dropping response to unknown request" << correlation.c_str();
+        return;
+    }
 
     try {
-        auto json = nlohmann::json::parse(payload.toStdString());
+        // 常见消息走快速解码，不认识的形状退回 nlohmann 完整解析
+        AgentMessageDecoder::decode(payload, m_message);
+        const AgentMessage &message = m_message;
 
         // JSON-RPC 响应（带 id）
-        if (json.contains("id") && !json["id"].is_null()) {
-            // 提取 id（兼容字符串和数字类型）
-            std::string responseId;
-            if (json["id"].is_string()) {
-                responseId = json["id"].get<std::string>();
-            } else if (json["id"].is_number_integer()) {
-                responseId = std::to_string(json["id"].get<int64_t>());
-            }
+        if (message.kind == AgentMessage::Kind::Response) {
+            const std::string &responseId = correlation.empty() ? message.id : correlation;
 
             // 处理错误响应
-            if (json.contains("error")) {
-                auto error = json["error"];
-                QString errorMsg = QString::fromStdString(
-                    error.value("message", "Unknown error"));
-                emit errorOccurred(errorMsg);
+            if (message.hasError) {
+                emit errorOccurred(QString::fromStdString(message.errorMessage));
                 return;
             }
 
             // 处理成功响应
-            if (json.contains("result")) {
-                auto result = json["result"];
-
+            if (message.hasResult) {
                 if (responseId == m_initSessionId) {
                     qDebug() << "Session initialized, sending startVoiceChat";
                     sendStartVoiceChat();
                 }
                 else if (responseId == m_startVoiceChatId) {
+                    // 只有这条响应需要读取 result 的内容
+                    auto result = nlohmann::json::parse(message.result);
                     QString appId = QString::fromStdString(result.value("appId", ""));
                     QString roomId = QString::fromStdString(result.value("roomId", ""));
                     QString token = QString::fromStdString(result.value("token", ""));
@@ -356,6 +708,7 @@ void AgentClient::handleMessage(const QString &topic, const QString &payload) {
                              << "userId=" << userId
                              << "targetUserId=" << targetUserId;
 
+                    m_voiceChatReady = true;
                     emit voiceChatReady(appId, roomId, token, userId, targetUserId);
                 }
                 else if (responseId == m_stopVoiceChatId) {
@@ -364,8 +717,8 @@ void AgentClient::handleMessage(const QString &topic, const QString &payload) {
             }
         }
         // JSON-RPC 通知（无 id，有 method）
-        else if (json.contains("method")) {
-            std::string method = json["method"].get<std::string>();
+        else if (message.kind == AgentMessage::Kind::Notification) {
+            const std::string &method = message.method;
 
             if (method == "voiceChatStopped") {
                 qDebug() << "Received voiceChatStopped notification from agent";
@@ -376,8 +729,7 @@ void AgentClient::handleMessage(const QString &topic, const QString &payload) {
                 emit voiceChatStopped();
             }
             else if (method == "textTalkDelta") {
-                auto params = json.value("params", nlohmann::json::object());
-                QString delta = QString::fromStdString(params.value("textDelta", ""));
+                QString delta = QString::fromStdString(message.textDelta);
                 if (!delta.isEmpty()) {
                     qDebug() << "Received textTalkDelta:" << delta;
                     emit textDeltaReceived(delta);
@@ -395,15 +747,115 @@ void AgentClient::handleMessage(const QString &topic, const QString &payload) {
 }
 
 void AgentClient::handleConnectionLost(const QString &reason) {
+    // 切换 Broker 之前旧连接上排队的事件，当前连接仍然正常；切换进行中的重复断线同样忽略
+    if (m_failingOver || (m_mqttClient && m_mqttClient->is_connected())) {
+        return;
+    }
     qWarning() << "MQTT connection lost:" << reason;
+    if (beginFailover()) {
+        m_connectionLostReason = reason;
+        return;
+    }
     emit errorOccurred(QStringLiteral(u"MQTT 连接断开: ") + reason);
 }
 
+bool AgentClient::beginFailover() {
+    if (m_brokers.size() < 2 || !m_mqttClient || !m_mcpAdapter) {
+        return false;
+    }
+    BrokerRace::recordConnectionLost(m_brokerUrl);
+
+    // 遥测的发布函数引用旧客户端，切换期间摘除
+    if (m_telemetry && m_telemetryToken) {
+        m_telemetry->detach(m_telemetryToken);
+        m_telemetryToken = 0;
+    }
+
+    // 上一次切换的线程已在 finishFailover() 中结束
+    if (m_failoverThread.joinable()) {
+        m_failoverThread.join();
+    }
+    m_failingOver = true;
+    m_failoverThread = std::thread(&AgentClient::runFailover, this, m_brokers, m_clientId);
+    return true;
+}
+
+void AgentClient::runFailover(std::vector<std::string> brokers, std::string clientId) {
+    ThreadPolicy::registerCurrentThread(ThreadClass::Background, "mqtt-failover");
+
+    // 断开的 Broker 记为失败，排在最后；其余 Broker 照常竞速。竞速、重连与订阅都会等待网络往返
+    auto race = std::make_unique<BrokerRaceResult>(BrokerRace::connect(
+        brokers, clientId, BrokerRaceConfig::fromEnvironment(),
+        [this] { return m_failoverCancelled.load(); }));
+    if (race->client && !m_failoverCancelled) {
+        try {
+            race->client->set_callback(*m_callbackBridge);
+            // MCP 适配器换到新连接后重新应用 Will 与 CONNECT 属性，恢复 SDK 的订阅
+            m_mcpAdapter->switchClient(race->client.get(), race->brokerUrl);
+            race->client->subscribe(agentTopic(), 1)->wait_for(std::chrono::seconds(5));
+        } catch (const mqtt::exception &e) {
+            qWarning() << "MQTT failover error:" << e.what();
+            race->client->disable_callbacks();
+            race->abandoned.push_back(std::move(race->client));
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_failoverMutex);
+        m_failoverResult = std::move(race);
+    }
+
+    MqttEvent event;
+    event.type = MqttEvent::Type::FailoverFinished;
+    postEvent(std::move(event));
+}
+
+void AgentClient::finishFailover() {
+    // 线程投递完成事件后即退出
+    if (m_failoverThread.joinable()) {
+        m_failoverThread.join();
+    }
+    m_failingOver = false;
+    std::unique_ptr<BrokerRaceResult> race;
+    {
+        std::lock_guard<std::mutex> lock(m_failoverMutex);
+        race = std::move(m_failoverResult);
+    }
+    if (!race) {
+        return;
+    }
+    std::move(race->abandoned.begin(), race->abandoned.end(), std::back_inserter(m_abandonedClients));
+    if (!race->client) {
+        emit errorOccurred(QStringLiteral(u"MQTT 连接断开: ") + m_connectionLostReason);
+        return;
+    }
+
+    // 旧客户端可能仍被进行中的发布引用，留到 stop() 再释放
+    m_mqttClient->disable_callbacks();
+    m_abandonedClients.push_back(std::move(m_mqttClient));
+    m_mqttClient = std::move(race->client);
+    const std::string lostBroker = m_brokerUrl;
+    m_brokerUrl = race->brokerUrl;
+    m_topicAliases.reset(topicAliasMaximum(race->token));
+    attachTelemetry();
+    BrokerRace::recordFailover();
+    qWarning() << "MQTT failed over from" << lostBroker.c_str() << "to" << m_brokerUrl.c_str();
+    // 新连接在切换完成前断开时，它的断线事件已被忽略，在这里补上
+    if (!m_mqttClient->is_connected()) {
+        handleConnectionLost(QStringLiteral("lost during failover"));
+        return;
+    }
+
+    // 会话尚未建立时，进行中的请求可能随旧连接丢失，从 initializeSession 重新开始
+    if (!m_voiceChatReady) {
+        sendInitializeSession();
+    }
+}
+
 // ── MCP 服务器设置 ──────────────────────────────────────────────────
 
 void AgentClient::setupMcpServer() {
     // 创建适配器，将已有 MQTT 连接包装为 MCP SDK 接口
-    m_mcpAdapter = std::make_unique<McpMqttAdapter>(m_mqttClient.get(), m_clientId, m_brokerUrl);
+    m_mcpAdapter = std::make_unique<McpMqttAdapter>(m_mqttClient.get(), m_clientId, m_brokerUrl, &m_topicAliases);
     m_callbackBridge->setMcpAdapter(m_mcpAdapter.get());
 
     // 配置 MCP 服务器
@@ -415,38 +867,71 @@ void AgentClient::setupMcpServer() {
     caps.tools = true;
 
     m_mcpServer.configure(info, caps);
-    m_mcpServer.setServiceDescription("Physical AI demo with light control tool");
+    m_mcpServer.setServiceDescription("Physical AI demo with light control and camera snapshot tools");
 
     // 注册 "light" 工具
-    mcp_mqtt::Tool lightTool;
-    lightTool.name = "light";
-    lightTool.description = "Control the light - turn it on or off";
-    lightTool.inputSchema.properties = {
-        {"action", {
-            {"type", "string"},
-            {"description", "Action to perform: 'on' to turn on, 'off' to turn off"},
-            {"enum", nlohmann::json::array({"on", "off"})}
-        }}
-    };
-    lightTool.inputSchema.required = {"action"};
+    TypedTool::registerTool<LightArgs>(m_mcpServer, "light", "Control the light - turn it on or off",
+                                       [this](const LightArgs &args) -> mcp_mqtt::ToolCallResult {
+        bool on = (args.action == LightAction::On);
 
-    m_mcpServer.registerTool(lightTool, [this](const nlohmann::json& args) -> mcp_mqtt::ToolCallResult {
-        std::string action = args.value("action", "");
-        if (action != "on" && action != "off") {
-            return mcp_mqtt::ToolCallResult::error("Invalid action. Use 'on' or 'off'.");
-        }
-
-        bool on = (action == "on");
-
-        // 安全地将 UI 更新投递到 Qt 主线程
-        QMetaObject::invokeMethod(this, [this, on]() {
-            emit lightStateChanged(on);
-        }, Qt::QueuedConnection);
+        // 安全地将 UI 更新投递到 Qt 主线程，连续调用只应用最后一次
+        MqttEvent event;
+        event.type = MqttEvent::Type::LightState;
+        event.lightOn = on;
+        postEvent(std::move(event));
 
         return mcp_mqtt::ToolCallResult::success(
             on ? "Light turned on" : "Light turned off");
     });
 
+    // 注册 "camera_snapshot" 工具：首次调用返回第一块，再带 snapshot_id 和 chunk 取其余分块。
+    // 没有帧缓存（QUICKSTART_SNAPSHOT=off）时不注册，缓存只在工具注册后才拷贝帧
+    if (m_snapshotCache) {
+        TypedTool::registerTool<SnapshotArgs>(m_mcpServer, "camera_snapshot",
+            "Capture the latest camera frame as a base64 JPEG. Large images are split into "
+            "chunks: call again with snapshot_id and chunk to fetch the remaining chunks.",
+            [this](const SnapshotArgs &args) -> mcp_mqtt::ToolCallResult {
+            SnapshotChunk chunk;
+            std::string error;
+            if (!args.snapshotId.empty()) {
+                if (!m_snapshotCache->chunk(args.snapshotId, args.chunk, chunk, error)) {
+                    return mcp_mqtt::ToolCallResult::error(error);
+                }
+            } else {
+                SnapshotRequest request;
+                request.remote = (args.source == SnapshotSource::Remote);
+                request.streamId = args.streamId;
+                request.width = args.width;
+                request.height = args.height;
+                request.quality = args.quality;
+                if (!m_snapshotCache->capture(request, chunk, error)) {
+                    return mcp_mqtt::ToolCallResult::error(error);
+                }
+            }
+
+            nlohmann::json result = {
+                {"snapshot_id", chunk.snapshotId},
+                {"stream_id", chunk.streamId},
+                {"width", chunk.width},
+                {"height", chunk.height},
+                {"bytes", chunk.bytes},
+                {"chunk", chunk.chunk},
+                {"chunks", chunk.chunks},
+                {"age_ms", chunk.ageMs},
+                {"mime_type", "image/jpeg"},
+                {"encoding", "base64"},
+                {"data", std::move(chunk.data)}
+            };
+            return mcp_mqtt::ToolCallResult::success(result.dump());
+        });
+        m_snapshotCache->setToolRegistered(true);
+    }
+
+    // 执行器工具由工具定义生成，调用转发给控制进程
+    if (m_actuators && m_actuators->isOpen()) {
+        m_actuators->registerTools(m_mcpServer);
+    }
+
     // 启动 MCP 服务器
     mcp_mqtt::McpServerConfig mcpConfig;
     mcpConfig.serverId = m_clientId;
@@ -469,7 +954,7 @@ void AgentClient::sendInitializeSession() {
     req.method = "initializeSession";
     req.params = nlohmann::json::object();
 
-    publishToAgent(req.toJson());
+    publishToAgent(req.toJson(), m_initSessionId);
 }
 
 void AgentClient::sendStartVoiceChat() {
@@ -480,7 +965,7 @@ void AgentClient::sendStartVoiceChat() {
     req.method = "startVoiceChat";
     req.params = nlohmann::json::object();
 
-    publishToAgent(req.toJson());
+    publishToAgent(req.toJson(), m_startVoiceChatId);
 }
 
 void AgentClient::sendStopVoiceChat() {
@@ -491,7 +976,7 @@ void AgentClient::sendStopVoiceChat() {
     req.method = "stopVoiceChat";
     req.params = nlohmann::json::object();
 
-    publishToAgent(req.toJson());
+    publishToAgent(req.toJson(), m_stopVoiceChatId);
 }
 
 void AgentClient::sendDestroySession() {
@@ -517,7 +1002,12 @@ void AgentClient::sendTextTalk(const QString &text) {
     publishToAgent(notif.toJson());
 }
 
-void AgentClient::publishToAgent(const nlohmann::json &message) {
+bool AgentClient::isPendingRequest(const std::string &id) const {
+    return id == m_initSessionId || id == m_startVoiceChatId || id == m_stopVoiceChatId;
+}
+
+void AgentClient::publishToAgent(const nlohmann::json &message, const std::string &requestId) {
+    AllocScope allocScope(AllocSubsystem::AgentProtocol);
     if (!m_mqttClient || !m_mqttClient->is_connected()) {
         emit errorOccurred(QStringLiteral(u"MQTT 未连接"));
         return;
@@ -529,8 +1019,16 @@ void AgentClient::publishToAgent(const nlohmann::json &message) {
     qDebug() << "Publishing to" << topic.c_str() << ":" << payload.c_str();
 
     try {
-        m_mqttClient->publish(topic, payload, 1, false);
+        MessageTracer::markPayload(TracePoint::Publish, "agent", payload, topic.c_str());
+        // 请求带上响应主题与 Correlation Data，响应无需解析内容即可匹配到请求
+        mqtt::properties props;
+        if (!requestId.empty()) {
+            props.add(mqtt::property(mqtt::property::RESPONSE_TOPIC, m_responseTopic));
+            props.add(mqtt::property(mqtt::property::CORRELATION_DATA, requestId));
+        }
+        m_mqttClient->publish(m_topicAliases.makeMessage(topic, payload, 1, std::move(props)));
     } catch (const mqtt::exception &e) {
+        m_topicAliases.failed(topic);
         emit errorOccurred(QString("发送消息失败: %1").arg(e.what()));
     }
 }
@@ -3,25 +3,38 @@
 #include <QObject>
 #include <QString>
 #include <QDebug>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <mqtt/async_client.h>
 #include <mcp_mqtt/json_rpc.h>
 #include <mcp_mqtt/mcp_server.h>
 #include <mcp_mqtt/mqtt_interface.h>
+#include "AgentMessageDecoder.h"
+#include "TopicAliasTable.h"
+
+class EventLoopDrain;
+class SnapshotCache;
+class TelemetryStream;
+class ActuatorToolAdapter;
+template <typename T> class MpscEventQueue;
+struct BrokerRaceResult;
 
 /**
  * MQTT 智能体客户端
  *
  * 封装与智能体的 MQTT 通信协议，实现以下流程：
- * 1. 连接 MQTT Broker
+ * 1. 连接 MQTT Broker（可配置多个，竞速连接、断线时切换，见 BrokerRace）
  * 2. 订阅智能体回复主题 $agent-client/{clientId}/#
  * 3. 发送 initializeSession 初始化会话
  * 4. 发送 startVoiceChat 发起语音会话
  * 5. 从应答中提取 RTC 加入房间所需参数
  *
- * 同时作为 MCP 服务器，注册工具供智能体调用（如灯控制工具）。
+ * 同时作为 MCP 服务器，注册工具供智能体调用（灯控制、摄像头快照）。
  *
  * 参考协议文档：specs/client_agent_message_protocol.md
  */
@@ -35,16 +48,31 @@ public:
     /**
      * 启动完整流程：连接 Broker → initializeSession → startVoiceChat
      * 最终通过 voiceChatReady 信号返回 RTC 房间参数
+     *
+     * brokerUrl 可以是以逗号、分号或空白分隔的多个地址，按偏好排列：
+     * 错开启动并行连接，用最先完成 CONNECT 的一个；连接断开时切换到其余 Broker 中最先连上的一个
+     *
+     * connectedClient 为登录页预热好的连接（见 ConnectionPrewarmer），
+     * 仍处于连接状态时直接接管，跳过 DNS 解析与 TCP/TLS 握手
      */
     void start(const QString &brokerUrl,
                const QString &agentId,
-               const QString &clientId);
+               const QString &clientId,
+               std::unique_ptr<mqtt::async_client> connectedClient = nullptr);
 
     /**
      * 停止：发送 stopVoiceChat + destroySession，断开 MQTT
+     *
+     * 会等待网络往返，调用 beginShutdown() 之后可以在后台线程上调用。
      */
     void stop();
 
+    /**
+     * 在界面线程上调用，之后不再处理收到的消息、不再发出信号，
+     * 由调用方在后台线程上 stop()，完成后再释放对象
+     */
+    void beginShutdown();
+
     /**
      * 向智能体发送文本消息（textTalk 通知）
      */
@@ -52,6 +80,19 @@ public:
 
     bool isConnected() const;
 
+    /** camera_snapshot 工具使用的帧缓存，在 start() 之前设置，为空时工具返回错误 */
+    void setSnapshotCache(SnapshotCache *cache) { m_snapshotCache = cache; }
+    /** 连接后把遥测发布到独立主题，stop() 时摘除；在 start() 之前设置 */
+    void setTelemetryStream(TelemetryStream *telemetry) { m_telemetry = telemetry; }
+    /** 共享内存命令环上的执行器工具，与 light 等工具一起注册；在 start() 之前设置 */
+    void setActuatorTools(ActuatorToolAdapter *actuators) { m_actuators = actuators; }
+
+    /** 创建与 start() 相同配置（MQTT 5）的客户端，供预热连接使用 */
+    static std::unique_ptr<mqtt::async_client> createMqttClient(const std::string &brokerUrl,
+                                                                const std::string &clientId);
+    /** ssl:// 和 wss:// 地址会带上 TLS 选项 */
+    static mqtt::connect_options connectOptions(const std::string &brokerUrl);
+
 signals:
     void voiceChatReady(const QString &appId, const QString &roomId,
                         const QString &token, const QString &userId,
@@ -62,33 +103,75 @@ signals:
     void textDeltaReceived(const QString &delta);
     void textFinished();
 
-private slots:
-    void handleMessage(const QString &topic, const QString &payload);
-    void handleConnectionLost(const QString &reason);
-
 private:
     class MqttCallbackBridge;
     class McpMqttAdapter;
+    struct MqttEvent;
+
+    void handleMessage(const mqtt::message &msg);
+    void handleConnectionLost(const QString &reason);
+    /**
+     * 断线后在 mqtt-failover 线程上重新竞速其余 Broker，在新连接上恢复 MCP 服务与订阅，
+     * 完成后经事件队列回到界面线程由 finishFailover() 换上新连接；无法切换时返回 false
+     */
+    bool beginFailover();
+    void runFailover(std::vector<std::string> brokers, std::string clientId);
+    void finishFailover();
+    /** 订阅智能体回复主题并挂上遥测，连接且 MCP 服务就绪后调用 */
+    void subscribeAndAttach();
+    void attachTelemetry();
+    std::string agentTopic() const { return "$agent-client/" + m_clientId + "/#"; }
+    /** MQTT 线程与 MCP 工具回调入队，不阻塞；队列满时转入溢出列表，不丢弃 */
+    void postEvent(MqttEvent &&event);
+    void drainEvents();
 
     void sendInitializeSession();
     void sendStartVoiceChat();
     void sendStopVoiceChat();
     void sendDestroySession();
-    void publishToAgent(const nlohmann::json &message);
+    /** requestId 非空时为请求，附带响应主题与 Correlation Data */
+    void publishToAgent(const nlohmann::json &message, const std::string &requestId = std::string());
+    bool isPendingRequest(const std::string &id) const;
     void setupMcpServer();
 
     std::unique_ptr<mqtt::async_client> m_mqttClient;
     std::unique_ptr<MqttCallbackBridge> m_callbackBridge;
     std::unique_ptr<McpMqttAdapter> m_mcpAdapter;
     mcp_mqtt::McpServer m_mcpServer;
+    SnapshotCache *m_snapshotCache = nullptr;
+    TelemetryStream *m_telemetry = nullptr;
+    uint64_t m_telemetryToken = 0;
+    ActuatorToolAdapter *m_actuators = nullptr;
+    // 出站主题别名，MCP 适配器重连后按新的 CONNACK 重置
+    TopicAliasTable m_topicAliases;
 
     std::string m_agentId;
     std::string m_clientId;
-    std::string m_brokerUrl;
+    std::string m_brokerUrl;            // 当前连接的 Broker
+    std::vector<std::string> m_brokers; // 配置的全部 Broker
+    // 竞速落败和断开后换下的客户端，stop() 时在后台线程上释放
+    std::vector<std::unique_ptr<mqtt::async_client>> m_abandonedClients;
+    // 切换 Broker 在后台线程上进行，结果由 finishFailover() 取走；stop() 取消并等待
+    std::thread m_failoverThread;
+    std::atomic<bool> m_failoverCancelled{false};
+    std::mutex m_failoverMutex;
+    std::unique_ptr<BrokerRaceResult> m_failoverResult;
+    bool m_failingOver = false;
+    QString m_connectionLostReason;
+    bool m_voiceChatReady = false;
+    std::string m_responseTopic;
     int64_t m_nextRequestId = 1;
 
     std::string m_initSessionId;
     std::string m_startVoiceChatId;
     std::string m_stopVoiceChatId;
     int64_t m_nextTaskId = 1;
+    // 解码结果跨消息复用，textTalkDelta 的文本缓冲不必每条重新分配
+    AgentMessage m_message;
+
+    // 界面线程每轮事件循环排空一次
+    std::unique_ptr<MpscEventQueue<MqttEvent>> m_events;
+    std::unique_ptr<EventLoopDrain> m_eventDrain;
+    uint64_t m_reportedEventSpills = 0;
+    bool m_shuttingDown = false;
 };
@@ -0,0 +1,546 @@
+#include "AgentMessageDecoder.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <nlohmann/json.hpp>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define AGENT_DECODER_NEON 1
+#endif
+
+void AgentMessage::clear() {
+    kind = Kind::Other;
+    id.clear();
+    hasError = false;
+    errorMessage.clear();
+    hasResult = false;
+    result.clear();
+    method.clear();
+    textDelta.clear();
+}
+
+namespace AgentMessageDecoder {
+
+namespace {
+
+// 8 字节一组查找引号或反斜杠：逐字节异或后用 “减 1 借位” 判断是否有 0 字节，
+// 借位只会影响第一个命中之后的字节，所以最低的命中位是准确的
+const char *findQuoteOrBackslashSwar(const char *p, const char *end) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    constexpr uint64_t kOnes = 0x0101010101010101ull;
+    constexpr uint64_t kHighs = 0x8080808080808080ull;
+    while (end - p >= 8) {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        const uint64_t q = v ^ (kOnes * '"');
+        const uint64_t b = v ^ (kOnes * '\\');
+        const uint64_t hit = (((q - kOnes) & ~q) | ((b - kOnes) & ~b)) & kHighs;
+        if (hit) {
+            return p + (__builtin_ctzll(hit) >> 3);
+        }
+        p += 8;
+    }
+#endif
+    while (p < end && *p != '"' && *p != '\\') {
+        ++p;
+    }
+    return p;
+}
+
+const char *findQuoteOrBackslash(const char *p, const char *end) {
+#ifdef AGENT_DECODER_NEON
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    while (end - p >= 16) {
+        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+        const uint8x16_t match = vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash));
+        // 每个字节压成 4 位，第一个命中的位置 = 最低置位 / 4
+        const uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(match), 4)), 0);
+        if (bits) {
+            return p + (__builtin_ctzll(bits) >> 2);
+        }
+        p += 16;
+    }
+#endif
+    return findQuoteOrBackslashSwar(p, end);
+}
+
+void appendUtf8(uint32_t cp, std::string &out) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+bool parseHex4(std::string_view raw, size_t at, uint32_t &value) {
+    if (at + 4 > raw.size()) return false;
+    value = 0;
+    for (size_t i = at; i < at + 4; ++i) {
+        const char c = raw[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9') value |= static_cast<uint32_t>(c - '0');
+        else if (c >= 'a' && c <= 'f') value |= static_cast<uint32_t>(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') value |= static_cast<uint32_t>(c - 'A' + 10);
+        else return false;
+    }
+    return true;
+}
+
+// 去掉 JSON 字符串的转义写入 out；非法转义和落单的代理项返回 false，交给 nlohmann 报错
+bool unescape(std::string_view raw, bool escaped, std::string &out) {
+    out.clear();
+    if (!escaped) {
+        out.assign(raw.data(), raw.size());
+        return true;
+    }
+    out.reserve(raw.size());
+    size_t i = 0;
+    for (;;) {
+        const size_t slash = raw.find('\\', i);
+        out.append(raw.data() + i, (slash == std::string_view::npos ? raw.size() : slash) - i);
+        if (slash == std::string_view::npos) return true;
+        if (slash + 1 >= raw.size()) return false;
+        i = slash + 2;
+        switch (raw[slash + 1]) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                uint32_t cp = 0;
+                if (!parseHex4(raw, i, cp)) return false;
+                i += 4;
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    uint32_t low = 0;
+                    if (i + 2 > raw.size() || raw[i] != '\\' || raw[i + 1] != 'u'
+                        || !parseHex4(raw, i + 2, low) || low < 0xDC00 || low > 0xDFFF) {
+                        return false;
+                    }
+                    i += 6;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                    return false;
+                }
+                appendUtf8(cp, out);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+}
+
+// 按 JSON 与 RFC 3629 检查字符串内容，判定与 nlohmann 一致：不允许未转义的控制字符，
+// 转义只能是 \" \\ \/ \b \f \n \r \t 与成对代理项的 \uXXXX，非 ASCII 字节必须是合法的 UTF-8
+// （不接受过长编码、代理项区间与超出 U+10FFFF 的码点）
+bool validString(std::string_view raw) {
+    constexpr uint64_t kOnes = 0x0101010101010101ull;
+    constexpr uint64_t kHighs = 0x8080808080808080ull;
+    const size_t n = raw.size();
+    size_t i = 0;
+    while (i < n) {
+        // 8 字节一组跳过普通 ASCII：无最高位、无小于 0x20 的字节、无反斜杠
+        while (n - i >= 8) {
+            uint64_t v;
+            std::memcpy(&v, raw.data() + i, 8);
+            const uint64_t b = v ^ (kOnes * '\\');
+            if ((v | ((v - kOnes * 0x20) & ~v) | ((b - kOnes) & ~b)) & kHighs) break;
+            i += 8;
+        }
+        if (i >= n) break;
+        const auto c = static_cast<uint8_t>(raw[i]);
+        if (c < 0x20) return false;
+        if (c == '\\') {
+            if (i + 1 >= n) return false;
+            const char e = raw[i + 1];
+            if (e != 'u') {
+                if (std::memchr("\"\\/bfnrt", e, 8) == nullptr) return false;
+                i += 2;
+                continue;
+            }
+            uint32_t cp = 0;
+            if (!parseHex4(raw, i + 2, cp) || (cp >= 0xDC00 && cp <= 0xDFFF)) return false;
+            i += 6;
+            if (cp >= 0xD800 && cp <= 0xDBFF) {
+                uint32_t low = 0;
+                if (i + 2 > n || raw[i] != '\\' || raw[i + 1] != 'u'
+                    || !parseHex4(raw, i + 2, low) || low < 0xDC00 || low > 0xDFFF) {
+                    return false;
+                }
+                i += 6;
+            }
+            continue;
+        }
+        if (c < 0x80) {
+            ++i;
+            continue;
+        }
+        // 首字节决定长度，第二字节的范围排除过长编码、代理项与超出 U+10FFFF 的码点
+        size_t length = 0;
+        uint8_t low = 0x80;
+        uint8_t high = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF) {
+            length = 2;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            length = 3;
+            if (c == 0xE0) low = 0xA0;
+            else if (c == 0xED) high = 0x9F;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            length = 4;
+            if (c == 0xF0) low = 0x90;
+            else if (c == 0xF4) high = 0x8F;
+        } else {
+            return false;
+        }
+        if (n - i < length) return false;
+        const auto second = static_cast<uint8_t>(raw[i + 1]);
+        if (second < low || second > high) return false;
+        for (size_t k = 2; k < length; ++k) {
+            if ((static_cast<uint8_t>(raw[i + k]) & 0xC0) != 0x80) return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+/**
+ * 单遍扫描器：字符串用 findQuoteOrBackslash 成段跳过后再校验内容，
+ * 嵌套的对象与数组按 JSON 语法完整校验但不建树；任何 nlohmann 会拒绝的输入都返回 false
+ */
+struct Scanner {
+    // 嵌套超过这个深度时返回 false，交给 nlohmann 处理，避免递归过深
+    static constexpr int kMaxDepth = 128;
+
+    const char *p;
+    const char *end;
+
+    explicit Scanner(std::string_view text) : p(text.data()), end(text.data() + text.size()) {}
+
+    void skipSpace() {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) {
+            ++p;
+        }
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (p < end && *p == c) {
+            ++p;
+            return true;
+        }
+        return false;
+    }
+
+    // p 指向起始引号；raw 为引号内的原始文本，escaped 表示其中有反斜杠
+    bool scanString(std::string_view &raw, bool &escaped) {
+        if (p >= end || *p != '"') return false;
+        const char *begin = ++p;
+        escaped = false;
+        for (;;) {
+            p = findQuoteOrBackslash(p, end);
+            if (p >= end) return false;
+            if (*p == '"') {
+                raw = std::string_view(begin, static_cast<size_t>(p - begin));
+                ++p;
+                return validString(raw);
+            }
+            // 跳过反斜杠和被转义的字符，\uXXXX 的十六进制位按普通字符处理
+            escaped = true;
+            p += 2;
+        }
+    }
+
+    bool skipLiteral(const char *literal, size_t length) {
+        if (static_cast<size_t>(end - p) < length || std::memcmp(p, literal, length) != 0) return false;
+        p += length;
+        return true;
+    }
+
+    // 至少一位数字
+    bool skipDigits() {
+        const char *begin = p;
+        while (p < end && *p >= '0' && *p <= '9') {
+            ++p;
+        }
+        return p != begin;
+    }
+
+    // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?，其后的字符由调用方检查。
+    // nlohmann 把超出 double 范围的数字当作错误：这里按最高位非零数字的十进制数量级判断，
+    // 数量级达到 308（DBL_MAX 约 1.8e308）的临界值一律交给 nlohmann
+    bool skipNumber() {
+        if (p < end && *p == '-') ++p;
+        if (p >= end) return false;
+        const char *integer = p;
+        if (*p == '0') {
+            ++p;
+        } else if (*p < '1' || *p > '9' || !skipDigits()) {
+            return false;
+        }
+        bool zero = *integer == '0';
+        long magnitude = zero ? 0 : static_cast<long>(p - integer) - 1;
+        if (p < end && *p == '.') {
+            const char *fraction = ++p;
+            if (!skipDigits()) return false;
+            if (zero) {
+                const char *digit = fraction;
+                while (digit < p && *digit == '0') ++digit;
+                zero = digit == p;
+                magnitude = -static_cast<long>(digit - fraction) - 1;
+            }
+        }
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            ++p;
+            bool negative = false;
+            if (p < end && (*p == '+' || *p == '-')) negative = *p++ == '-';
+            const char *digits = p;
+            if (!skipDigits()) return false;
+            long exponent = 0;
+            for (const char *digit = digits; digit < p && exponent < 100000; ++digit) {
+                exponent = exponent * 10 + (*digit - '0');
+            }
+            magnitude += negative ? -exponent : exponent;
+        }
+        return zero || magnitude < 308;
+    }
+
+    bool skipObject(int depth) {
+        if (depth > kMaxDepth) return false;
+        ++p;
+        if (consume('}')) return true;
+        for (;;) {
+            skipSpace();
+            std::string_view key;
+            bool escaped;
+            if (!scanString(key, escaped) || !consume(':') || !skipValue(depth)) return false;
+            if (consume(',')) continue;
+            return consume('}');
+        }
+    }
+
+    bool skipArray(int depth) {
+        if (depth > kMaxDepth) return false;
+        ++p;
+        if (consume(']')) return true;
+        for (;;) {
+            if (!skipValue(depth)) return false;
+            if (consume(',')) continue;
+            return consume(']');
+        }
+    }
+
+    bool skipValue(int depth = 0) {
+        skipSpace();
+        if (p >= end) return false;
+        switch (*p) {
+            case '"': {
+                std::string_view raw;
+                bool escaped;
+                return scanString(raw, escaped);
+            }
+            case '{':
+                return skipObject(depth + 1);
+            case '[':
+                return skipArray(depth + 1);
+            case 't':
+                return skipLiteral("true", 4);
+            case 'f':
+                return skipLiteral("false", 5);
+            case 'n':
+                return skipLiteral("null", 4);
+            default:
+                return skipNumber();
+        }
+    }
+};
+
+/**
+ * 遍历对象的成员，对每个成员调用 fn(key, scanner)，fn 负责消费值并返回是否成功；
+ * 键中含转义时返回 false（协议中的键都是普通 ASCII）
+ */
+template <typename Fn>
+bool forEachMember(Scanner &s, Fn fn) {
+    if (!s.consume('{')) return false;
+    if (s.consume('}')) return true;
+    for (;;) {
+        s.skipSpace();
+        std::string_view key;
+        bool escaped;
+        if (!s.scanString(key, escaped) || escaped) return false;
+        if (!s.consume(':')) return false;
+        s.skipSpace();
+        if (!fn(key, s)) return false;
+        if (s.consume(',')) continue;
+        return s.consume('}');
+    }
+}
+
+// 取对象中某个字符串成员：不存在时 found = false；存在但不是字符串返回 false
+bool findStringMember(std::string_view object, std::string_view name, std::string &value, bool &found) {
+    found = false;
+    Scanner s(object);
+    bool typeOk = true;
+    const bool ok = forEachMember(s, [&](std::string_view key, Scanner &scanner) {
+        if (key != name) return scanner.skipValue();
+        std::string_view raw;
+        bool escaped;
+        if (scanner.p >= scanner.end || *scanner.p != '"') {
+            typeOk = false;
+            return scanner.skipValue();
+        }
+        if (!scanner.scanString(raw, escaped)) return false;
+        // 重复的键以最后一个为准，与 nlohmann 一致
+        found = unescape(raw, escaped, value);
+        typeOk = found;
+        return true;
+    });
+    return ok && typeOk;
+}
+
+} // namespace
+
+bool decodeFast(std::string_view payload, AgentMessage &message) {
+    message.clear();
+
+    enum class IdType { Absent, Null, String, Number, Other };
+    IdType idType = IdType::Absent;
+    std::string_view idRaw;
+    bool idEscaped = false;
+    std::string_view methodRaw;
+    bool methodEscaped = false;
+    bool hasMethod = false;
+    std::string_view params;
+    std::string_view result;
+    std::string_view error;
+
+    Scanner s(payload);
+    const bool ok = forEachMember(s, [&](std::string_view key, Scanner &scanner) {
+        const char *valueBegin = scanner.p;
+        if (key == "id") {
+            if (scanner.p < scanner.end && *scanner.p == '"') {
+                idType = IdType::String;
+                return scanner.scanString(idRaw, idEscaped);
+            }
+            if (!scanner.skipValue()) return false;
+            idRaw = std::string_view(valueBegin, static_cast<size_t>(scanner.p - valueBegin));
+            if (idRaw == "null") idType = IdType::Null;
+            else if (idRaw[0] == '-' || (idRaw[0] >= '0' && idRaw[0] <= '9')) idType = IdType::Number;
+            else idType = IdType::Other;
+            return true;
+        }
+        if (key == "method") {
+            if (scanner.p >= scanner.end || *scanner.p != '"') return false;
+            hasMethod = true;
+            return scanner.scanString(methodRaw, methodEscaped);
+        }
+        if (!scanner.skipValue()) return false;
+        const std::string_view value(valueBegin, static_cast<size_t>(scanner.p - valueBegin));
+        if (key == "params") params = value;
+        else if (key == "result") result = value;
+        else if (key == "error") error = value;
+        return true;
+    });
+    if (!ok) return false;
+    s.skipSpace();
+    if (s.p != s.end) return false;
+
+    if (idType != IdType::Absent && idType != IdType::Null) {
+        message.kind = AgentMessage::Kind::Response;
+        if (idType == IdType::String) {
+            if (!unescape(idRaw, idEscaped, message.id)) return false;
+        } else if (idType == IdType::Number
+                   && idRaw.find_first_of(".eE") == std::string_view::npos) {
+            // 整数 id 规范化为十进制文本；超出 int64 的交给 nlohmann 按原逻辑处理
+            const std::string text(idRaw);
+            errno = 0;
+            char *parsedEnd = nullptr;
+            const long long value = std::strtoll(text.c_str(), &parsedEnd, 10);
+            if (errno != 0 || parsedEnd != text.c_str() + text.size()) return false;
+            message.id = std::to_string(value);
+        }
+
+        if (!error.empty()) {
+            message.hasError = true;
+            bool found = false;
+            if (!findStringMember(error, "message", message.errorMessage, found)) return false;
+            if (!found) message.errorMessage = "Unknown error";
+        } else if (!result.empty()) {
+            message.hasResult = true;
+            message.result.assign(result.data(), result.size());
+        }
+        return true;
+    }
+
+    if (hasMethod) {
+        message.kind = AgentMessage::Kind::Notification;
+        if (!unescape(methodRaw, methodEscaped, message.method)) return false;
+        if (message.method == "textTalkDelta" && !params.empty()) {
+            bool found = false;
+            if (!findStringMember(params, "textDelta", message.textDelta, found)) return false;
+        }
+    }
+    return true;
+}
+
+void decodeJson(std::string_view payload, AgentMessage &message) {
+    message.clear();
+    auto json = nlohmann::json::parse(payload.begin(), payload.end());
+
+    if (json.contains("id") && !json["id"].is_null()) {
+        message.kind = AgentMessage::Kind::Response;
+        // 提取 id（兼容字符串和数字类型）
+        if (json["id"].is_string()) {
+            message.id = json["id"].get<std::string>();
+        } else if (json["id"].is_number_integer()) {
+            message.id = std::to_string(json["id"].get<int64_t>());
+        }
+
+        if (json.contains("error")) {
+            message.hasError = true;
+            message.errorMessage = json["error"].value("message", "Unknown error");
+        } else if (json.contains("result")) {
+            message.hasResult = true;
+            message.result = json["result"].dump();
+        }
+    } else if (json.contains("method")) {
+        message.kind = AgentMessage::Kind::Notification;
+        message.method = json["method"].get<std::string>();
+        if (message.method == "textTalkDelta") {
+            auto params = json.value("params", nlohmann::json::object());
+            message.textDelta = params.value("textDelta", "");
+        }
+    }
+}
+
+void decode(std::string_view payload, AgentMessage &message) {
+    if (!decodeFast(payload, message)) {
+        decodeJson(payload, message);
+    }
+}
+
+bool hasSimd() {
+#ifdef AGENT_DECODER_NEON
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace AgentMessageDecoder
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+/**
+ * 智能体下行消息解码结果
+ *
+ * 只保留 AgentClient::handleMessage 用到的字段：响应的 id / error.message / result，
+ * 通知的 method 与 textTalkDelta 的 params.textDelta。
+ */
+struct AgentMessage {
+    enum class Kind {
+        Other,          // 既不是响应也不是通知，忽略
+        Response,       // id 不为 null
+        Notification,   // 无 id，有 method
+    };
+
+    Kind kind = Kind::Other;
+    std::string id;             // 字符串 id 原样保留，整数 id 转为十进制文本，其他类型为空
+    bool hasError = false;
+    std::string errorMessage;   // error.message，缺省为 "Unknown error"
+    bool hasResult = false;
+    std::string result;         // result 的原始 JSON 文本，startVoiceChat 等少数响应再按需解析
+    std::string method;
+    std::string textDelta;      // textTalkDelta 的 params.textDelta
+
+    void clear();
+};
+
+/**
+ * 智能体消息解码
+ *
+ * textTalkDelta 在一次回答中每秒到达数十条，逐条建 nlohmann DOM 再做多次查找的开销远大于消息本身。
+ * 快速路径按 JSON-RPC 信封的固定结构单遍扫描：只识别顶层的 id / method / params / result / error，
+ * 其余成员和嵌套值只跳过不建树，但数字、字面量、字符串（控制字符、转义、UTF-8）与嵌套结构都按
+ * JSON 语法校验；字符串按 16 字节（NEON）或 8 字节（SWAR）一组查找引号与反斜杠，无转义时直接拷贝。
+ * 除输出字符串外不分配内存。
+ *
+ * 输入非法，或遇到快速路径不认识的形状（顶层不是对象、字段类型与协议不符、整数超出 int64 等）时
+ * 返回 false，由 decode() 退回 nlohmann 完整解析，两条路径的结果一致（result 为原始文本，
+ * 解析后与 nlohmann 的 dump() 相同），由 tests/AgentMessageDecoderTest.cpp 对照检查。
+ */
+namespace AgentMessageDecoder {
+
+/** 先走快速路径，失败时用 nlohmann 解析；JSON 非法时抛出 nlohmann::json::exception */
+void decode(std::string_view payload, AgentMessage &message);
+
+/** 只走快速路径，返回 false 表示需要退回完整解析（message 内容未定义） */
+bool decodeFast(std::string_view payload, AgentMessage &message);
+
+/** 只用 nlohmann 完整解析，供回退与基准对比 */
+void decodeJson(std::string_view payload, AgentMessage &message);
+
+/** 当前构建的字符串扫描是否使用了 NEON */
+bool hasSimd();
+
+} // namespace AgentMessageDecoder
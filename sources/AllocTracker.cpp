@@ -0,0 +1,298 @@
+#include "AllocTracker.h"
+#include "MetricsExporter.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#ifdef QUICKSTART_ALLOC_TRACKING
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <malloc.h>
+#include <unistd.h>
+#endif
+
+const char *allocSubsystemName(AllocSubsystem subsystem) {
+    switch (subsystem) {
+        case AllocSubsystem::Other: return "other";
+        case AllocSubsystem::AgentProtocol: return "agent";
+        case AllocSubsystem::McpAdapter: return "mcp";
+        case AllocSubsystem::UiTranscript: return "transcript";
+        case AllocSubsystem::RtcGlue: return "rtc";
+    }
+    return "other";
+}
+
+#ifndef QUICKSTART_ALLOC_TRACKING
+
+AllocSubsystem AllocTracker::enter(AllocSubsystem) {
+    return AllocSubsystem::Other;
+}
+
+void AllocTracker::leave(AllocSubsystem) {
+}
+
+void AllocTracker::snapshot(Totals (&totals)[kAllocSubsystemCount]) {
+    for (Totals &total : totals) {
+        total = Totals();
+    }
+}
+
+void AllocTracker::exportMetrics(MetricsRecord &) {
+}
+
+#else
+
+namespace {
+
+// 每块分配前的头，16 字节以保持 new 的默认对齐
+struct alignas(16) BlockHeader {
+    uint64_t size;
+    uint32_t offset;      // 头之后的用户指针距 malloc 返回地址的字节数，对齐分配时大于 16
+    uint8_t subsystem;
+    uint8_t reserved[3];
+};
+static_assert(sizeof(BlockHeader) == 16, "block header layout");
+
+// 一个线程的计数。自己的槽只有本线程写，用普通的读 + 写；共享槽用原子加
+struct alignas(64) ThreadCounters {
+    std::atomic<uint64_t> allocations[kAllocSubsystemCount];
+    std::atomic<uint64_t> frees[kAllocSubsystemCount];
+    std::atomic<uint64_t> allocatedBytes[kAllocSubsystemCount];
+    std::atomic<uint64_t> freedBytes[kAllocSubsystemCount];
+    bool inUse;
+};
+
+constexpr int kMaxThreads = 256;
+
+// 全部为零初始化，不依赖静态构造顺序：进程启动时的第一次 new 可能早于任何构造函数
+ThreadCounters g_slots[kMaxThreads];
+// 槽用尽以及线程退出之后（析构 thread_local 时仍可能释放内存）使用
+ThreadCounters g_shared;
+// 已退出线程的累计计数
+AllocTracker::Totals g_retired[kAllocSubsystemCount];
+std::mutex g_slotMutex;
+
+thread_local AllocSubsystem t_subsystem = AllocSubsystem::Other;
+thread_local ThreadCounters *t_counters = nullptr;
+thread_local bool t_exited = false;
+
+void bump(ThreadCounters *counters, std::atomic<uint64_t> *field, uint64_t value) {
+    if (counters == &g_shared) {
+        field->fetch_add(value, std::memory_order_relaxed);
+    } else {
+        field->store(field->load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+}
+
+ThreadCounters *claimSlot();
+
+/** 线程退出时把计数并入 g_retired 并归还槽 */
+struct SlotOwner {
+    ~SlotOwner() {
+        ThreadCounters *counters = t_counters;
+        t_exited = true;
+        t_counters = nullptr;
+        if (!counters || counters == &g_shared) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(g_slotMutex);
+        for (int i = 0; i < kAllocSubsystemCount; ++i) {
+            g_retired[i].allocations += counters->allocations[i].load(std::memory_order_relaxed);
+            g_retired[i].frees += counters->frees[i].load(std::memory_order_relaxed);
+            g_retired[i].allocatedBytes += counters->allocatedBytes[i].load(std::memory_order_relaxed);
+            g_retired[i].freedBytes += counters->freedBytes[i].load(std::memory_order_relaxed);
+        }
+        counters->inUse = false;
+    }
+};
+
+thread_local SlotOwner t_owner;
+
+ThreadCounters *claimSlot() {
+    if (t_exited) {
+        return &g_shared;
+    }
+    ThreadCounters *claimed = &g_shared;
+    {
+        std::lock_guard<std::mutex> lock(g_slotMutex);
+        for (ThreadCounters &slot : g_slots) {
+            if (!slot.inUse) {
+                for (int i = 0; i < kAllocSubsystemCount; ++i) {
+                    slot.allocations[i].store(0, std::memory_order_relaxed);
+                    slot.frees[i].store(0, std::memory_order_relaxed);
+                    slot.allocatedBytes[i].store(0, std::memory_order_relaxed);
+                    slot.freedBytes[i].store(0, std::memory_order_relaxed);
+                }
+                slot.inUse = true;
+                claimed = &slot;
+                break;
+            }
+        }
+    }
+    t_counters = claimed;
+    // 第一次访问时登记析构（glibc 用 calloc 记录，不会回到这里）
+    (void)&t_owner;
+    return claimed;
+}
+
+inline ThreadCounters *counters() {
+    ThreadCounters *counters = t_counters;
+    return counters ? counters : claimSlot();
+}
+
+void *trackedAlloc(size_t size, size_t alignment) {
+    const size_t offset = std::max(alignment, sizeof(BlockHeader));
+    void *raw = alignment > alignof(std::max_align_t)
+            ? std::aligned_alloc(alignment, ((offset + size + alignment - 1) / alignment) * alignment)
+            : std::malloc(offset + size);
+    if (!raw) {
+        return nullptr;
+    }
+    auto *user = static_cast<uint8_t *>(raw) + offset;
+    auto *header = reinterpret_cast<BlockHeader *>(user) - 1;
+    header->size = size;
+    header->offset = static_cast<uint32_t>(offset);
+    header->subsystem = static_cast<uint8_t>(t_subsystem);
+
+    ThreadCounters *c = counters();
+    const int index = header->subsystem;
+    bump(c, &c->allocations[index], 1);
+    bump(c, &c->allocatedBytes[index], size);
+    return user;
+}
+
+void trackedFree(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    auto *header = static_cast<BlockHeader *>(ptr) - 1;
+    ThreadCounters *c = counters();
+    const int index = header->subsystem;
+    bump(c, &c->frees[index], 1);
+    bump(c, &c->freedBytes[index], header->size);
+    std::free(static_cast<uint8_t *>(ptr) - header->offset);
+}
+
+void *allocOrThrow(size_t size, size_t alignment) {
+    for (;;) {
+        if (void *ptr = trackedAlloc(size, alignment)) {
+            return ptr;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+// 采样峰值与上次导出的计数，只在导出线程上访问
+int64_t g_peak[kAllocSubsystemCount];
+AllocTracker::Totals g_lastExport[kAllocSubsystemCount];
+std::chrono::steady_clock::time_point g_lastExportTime;
+
+} // namespace
+
+// ── 全局 operator new / delete ──────────────────────────────────
+
+void *operator new(size_t size) { return allocOrThrow(size, 0); }
+void *operator new[](size_t size) { return allocOrThrow(size, 0); }
+void *operator new(size_t size, std::align_val_t alignment) { return allocOrThrow(size, static_cast<size_t>(alignment)); }
+void *operator new[](size_t size, std::align_val_t alignment) { return allocOrThrow(size, static_cast<size_t>(alignment)); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return trackedAlloc(size, 0); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return trackedAlloc(size, 0); }
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return trackedAlloc(size, static_cast<size_t>(alignment));
+}
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return trackedAlloc(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void *ptr) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr) noexcept { trackedFree(ptr); }
+void operator delete(void *ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, size_t, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { trackedFree(ptr); }
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept { trackedFree(ptr); }
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept { trackedFree(ptr); }
+
+// ── 统计 ─────────────────────────────────────────────────────────
+
+AllocSubsystem AllocTracker::enter(AllocSubsystem subsystem) {
+    const AllocSubsystem previous = t_subsystem;
+    t_subsystem = subsystem;
+    return previous;
+}
+
+void AllocTracker::leave(AllocSubsystem previous) {
+    t_subsystem = previous;
+}
+
+void AllocTracker::snapshot(Totals (&totals)[kAllocSubsystemCount]) {
+    auto add = [&totals](const ThreadCounters &counters) {
+        for (int i = 0; i < kAllocSubsystemCount; ++i) {
+            totals[i].allocations += counters.allocations[i].load(std::memory_order_relaxed);
+            totals[i].frees += counters.frees[i].load(std::memory_order_relaxed);
+            totals[i].allocatedBytes += counters.allocatedBytes[i].load(std::memory_order_relaxed);
+            totals[i].freedBytes += counters.freedBytes[i].load(std::memory_order_relaxed);
+        }
+    };
+
+    std::lock_guard<std::mutex> lock(g_slotMutex);
+    for (int i = 0; i < kAllocSubsystemCount; ++i) {
+        totals[i] = g_retired[i];
+    }
+    for (const ThreadCounters &slot : g_slots) {
+        if (slot.inUse) {
+            add(slot);
+        }
+    }
+    add(g_shared);
+}
+
+void AllocTracker::exportMetrics(MetricsRecord &record) {
+    Totals totals[kAllocSubsystemCount];
+    snapshot(totals);
+
+    const auto now = std::chrono::steady_clock::now();
+    const double seconds = g_lastExportTime.time_since_epoch().count() == 0
+            ? 0.0 : std::chrono::duration<double>(now - g_lastExportTime).count();
+    for (int i = 0; i < kAllocSubsystemCount; ++i) {
+        const std::string prefix = std::string("alloc.") + allocSubsystemName(static_cast<AllocSubsystem>(i)) + ".";
+        const int64_t live = totals[i].liveBytes();
+        g_peak[i] = std::max(g_peak[i], live);
+        record.add(prefix + "live_bytes", static_cast<double>(live));
+        record.add(prefix + "peak_bytes", static_cast<double>(g_peak[i]));
+        if (seconds > 0.0) {
+            record.add(prefix + "allocs_per_s", (totals[i].allocations - g_lastExport[i].allocations) / seconds);
+            record.add(prefix + "bytes_per_s", (totals[i].allocatedBytes - g_lastExport[i].allocatedBytes) / seconds);
+        }
+        g_lastExport[i] = totals[i];
+    }
+    g_lastExportTime = now;
+
+    // 包括 malloc 直接分配的部分，与各子系统之和的差即为未归类的 C 分配（Paho C、SDK、Qt 字符串）
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 info = mallinfo2();
+    record.add("alloc.heap_in_use_bytes", static_cast<double>(info.uordblks + info.hblkhd));
+#endif
+    if (FILE *file = std::fopen("/proc/self/statm", "r")) {
+        unsigned long size = 0;
+        unsigned long resident = 0;
+        if (std::fscanf(file, "%lu %lu", &size, &resident) == 2) {
+            record.add("alloc.rss_bytes", static_cast<double>(resident) * sysconf(_SC_PAGESIZE));
+        }
+        std::fclose(file);
+    }
+}
+
+#endif
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+
+class MetricsRecord;
+
+/** 堆分配按子系统归类 */
+enum class AllocSubsystem : uint8_t {
+    Other,           // 不在任何作用域内的分配，包括 SDK、Paho 与 Qt 自己的线程
+    AgentProtocol,   // 智能体协议：消息解码、请求发布、会话状态
+    McpAdapter,      // MCP 适配器：SDK 收到的 MCP 消息、工具调用与发布
+    UiTranscript,    // 界面对话记录（QTextDocument）
+    RtcGlue,         // RTC 回调与事件处理、进房与挂断
+};
+
+constexpr int kAllocSubsystemCount = 5;
+
+/** 子系统在指标中的名称：other / agent / mcp / transcript / rtc */
+const char *allocSubsystemName(AllocSubsystem subsystem);
+
+/**
+ * 按子系统的堆分配统计
+ *
+ * 只在以 -DQUICKSTART_ALLOC_TRACKING=ON 编译时生效：替换全局 operator new / delete，
+ * 每块分配前加 16 字节的头记录大小与所属子系统，释放时（可能在另一个线程上）按头中的子系统记账。
+ * 计数器按线程分开，每个线程只写自己的槽，不用原子读改写、不加锁；导出时汇总所有槽，
+ * 线程退出时把计数并入公共部分。未开启时 AllocScope 为空对象，没有任何开销。
+ *
+ * 只统计 C++ 的 new / delete：Paho C、SDK 内部与 Qt 的字符串数据直接调用 malloc，
+ * 它们的占用体现在 alloc.heap_in_use_bytes（glibc 的 mallinfo2）与各子系统之和的差里。
+ * 峰值为导出时采样到的最大值。
+ */
+class AllocTracker {
+public:
+    static constexpr bool enabled() {
+#ifdef QUICKSTART_ALLOC_TRACKING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    struct Totals {
+        uint64_t allocations = 0;
+        uint64_t frees = 0;
+        uint64_t allocatedBytes = 0;
+        uint64_t freedBytes = 0;
+
+        int64_t liveBytes() const { return static_cast<int64_t>(allocatedBytes - freedBytes); }
+    };
+
+    /** 当前线程进入子系统，返回之前的子系统，供 leave() 恢复 */
+    static AllocSubsystem enter(AllocSubsystem subsystem);
+    static void leave(AllocSubsystem previous);
+
+    /** 汇总所有线程的计数 */
+    static void snapshot(Totals (&totals)[kAllocSubsystemCount]);
+
+    /**
+     * 指标：alloc.<子系统>.live_bytes / peak_bytes / allocs_per_s / bytes_per_s，
+     * 以及 alloc.heap_in_use_bytes 与 alloc.rss_bytes；未开启时不输出
+     */
+    static void exportMetrics(MetricsRecord &record);
+};
+
+/**
+ * 分配归类作用域：其间当前线程上的 new 计入该子系统，可以嵌套，内层优先
+ *
+ *   AllocScope scope(AllocSubsystem::AgentProtocol);
+ */
+class AllocScope {
+public:
+#ifdef QUICKSTART_ALLOC_TRACKING
+    explicit AllocScope(AllocSubsystem subsystem) : m_previous(AllocTracker::enter(subsystem)) {}
+    ~AllocScope() { AllocTracker::leave(m_previous); }
+#else
+    explicit AllocScope(AllocSubsystem) {}
+#endif
+
+    AllocScope(const AllocScope &) = delete;
+    AllocScope &operator=(const AllocScope &) = delete;
+
+#ifdef QUICKSTART_ALLOC_TRACKING
+private:
+    AllocSubsystem m_previous;
+#endif
+};
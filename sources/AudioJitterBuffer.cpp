@@ -0,0 +1,75 @@
+#include "AudioJitterBuffer.h"
+#include <algorithm>
+#include <cstring>
+
+AudioJitterBuffer::AudioJitterBuffer(const AudioJitterConfig &config, int sampleRate, int channels)
+    : m_config(config),
+      m_samplesPerMs(std::max(1, sampleRate * channels / 1000)),
+      m_ring(size_t(m_samplesPerMs) * std::max(config.maxMs, config.minMs) * 2) {
+    m_config.minMs = std::max(0, m_config.minMs);
+    m_config.maxMs = std::max(m_config.minMs, m_config.maxMs);
+    m_config.stepMs = std::max(1, m_config.stepMs);
+    m_targetSamples.store(size_t(m_samplesPerMs) * m_config.minMs, std::memory_order_relaxed);
+}
+
+void AudioJitterBuffer::write(const int16_t *samples, size_t count) {
+    m_ring.write(samples, count);
+}
+
+void AudioJitterBuffer::read(int16_t *samples, size_t count) {
+    const size_t target = m_targetSamples.load(std::memory_order_relaxed);
+    const size_t step = size_t(m_samplesPerMs) * m_config.stepMs;
+    size_t available = m_ring.available();
+
+    if (m_refilling) {
+        if (available < target + count) {
+            std::memset(samples, 0, count * sizeof(int16_t));
+            return;
+        }
+        m_refilling = false;
+    }
+
+    if (available < count) {
+        m_ring.read(samples, available);
+        std::memset(samples + available, 0, (count - available) * sizeof(int16_t));
+        m_underruns.fetch_add(1, std::memory_order_relaxed);
+        m_targetSamples.store(std::min(target + step, size_t(m_samplesPerMs) * m_config.maxMs),
+                              std::memory_order_relaxed);
+        m_refilling = true;
+        m_stableWindows = 0;
+        m_windowMin = SIZE_MAX;
+        m_windowConsumed = 0;
+        return;
+    }
+
+    m_ring.read(samples, count);
+    available -= count;
+    m_windowMin = std::min(m_windowMin, available);
+    m_windowConsumed += count;
+
+    if (m_windowConsumed >= size_t(m_samplesPerMs) * m_config.windowMs) {
+        size_t newTarget = target;
+        if (++m_stableWindows >= m_config.stableWindows) {
+            m_stableWindows = 0;
+            newTarget = std::max(target > step ? target - step : 0, size_t(m_samplesPerMs) * m_config.minMs);
+            m_targetSamples.store(newTarget, std::memory_order_relaxed);
+        }
+        if (m_windowMin > newTarget + step) {
+            m_trimmedSamples.fetch_add(m_ring.skip(m_windowMin - newTarget), std::memory_order_relaxed);
+        }
+        m_windowMin = SIZE_MAX;
+        m_windowConsumed = 0;
+    }
+}
+
+double AudioJitterBuffer::bufferedMs() const {
+    return double(m_ring.available()) / m_samplesPerMs;
+}
+
+double AudioJitterBuffer::targetMs() const {
+    return double(m_targetSamples.load(std::memory_order_relaxed)) / m_samplesPerMs;
+}
+
+uint64_t AudioJitterBuffer::droppedSamples() const {
+    return m_ring.overruns() + m_trimmedSamples.load(std::memory_order_relaxed);
+}
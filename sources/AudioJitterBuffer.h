@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "PcmRingBuffer.h"
+
+/**
+ * 播放端自适应抖动缓冲
+ *
+ * 引擎拉流线程按固定 10 ms 节拍写入，声卡回调按设备节奏成批读取，两者的时钟并不一致。
+ * 目标水位 targetMs 表示读取前至少应缓存的音频：
+ * - 欠载时用静音补齐，目标水位增加 stepMs（不超过 maxMs），并重新预缓冲到目标水位
+ * - 连续若干个统计窗口没有欠载时，目标水位减少 stepMs（不低于 minMs）
+ * - 窗口内的最低水位仍高出目标一个 step 以上时，丢弃多余部分以降低延迟
+ */
+struct AudioJitterConfig {
+    int minMs = 20;
+    int maxMs = 200;
+    int stepMs = 10;
+    int windowMs = 2000;
+    int stableWindows = 3;    // 连续多少个无欠载窗口后降低目标水位
+};
+
+class AudioJitterBuffer {
+public:
+    AudioJitterBuffer(const AudioJitterConfig &config, int sampleRate, int channels);
+
+    /** 生产者调用，缓冲已满时丢弃多出的采样 */
+    void write(const int16_t *samples, size_t count);
+
+    /** 消费者调用，总是填满 count 个采样，数据不足的部分为静音 */
+    void read(int16_t *samples, size_t count);
+
+    double bufferedMs() const;
+    double targetMs() const;
+    uint64_t underruns() const { return m_underruns.load(std::memory_order_relaxed); }
+    uint64_t droppedSamples() const;
+
+private:
+    AudioJitterConfig m_config;
+    int m_samplesPerMs = 0;
+    PcmRingBuffer m_ring;
+    std::atomic<size_t> m_targetSamples{0};
+    std::atomic<uint64_t> m_underruns{0};
+    std::atomic<uint64_t> m_trimmedSamples{0};
+
+    // 以下只在消费者线程访问
+    bool m_refilling = true;
+    size_t m_windowMin = SIZE_MAX;
+    size_t m_windowConsumed = 0;
+    int m_stableWindows = 0;
+};
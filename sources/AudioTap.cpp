@@ -0,0 +1,269 @@
+#include "AudioTap.h"
+#include "ThreadPolicy.h"
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+// 环形缓冲按最大格式（48 kHz 立体声）分配，格式变化时不需要重新分配
+constexpr int kMaxSampleRate = 48000;
+constexpr int kMaxChannels = 2;
+constexpr int kChunkMs = 10;
+
+int64_t threadCpuNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+int64_t steadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+AudioTapConfig AudioTapConfig::fromEnvironment() {
+    AudioTapConfig config;
+    const char *value = std::getenv("QUICKSTART_AUDIO_TAP");
+    if (!value) {
+        return config;
+    }
+
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item == "record") { config.tapRecord = true; continue; }
+        if (item == "playback") { config.tapPlayback = true; continue; }
+        if (item == "vad") { config.vadEnabled = true; config.tapRecord = true; continue; }
+
+        auto pos = item.find('=');
+        if (pos == std::string::npos) {
+            if (!item.empty()) qWarning() << "QUICKSTART_AUDIO_TAP: unknown option" << item.c_str();
+            continue;
+        }
+        std::string key = item.substr(0, pos);
+        double number = std::atof(item.c_str() + pos + 1);
+
+        if (key == "ring_ms") config.ringMs = int(number);
+        else if (key == "report_ms") config.reportIntervalMs = int(number);
+        else if (key == "vad_threshold_db") config.vad.thresholdDb = number;
+        else if (key == "vad_margin_db") config.vad.marginDb = number;
+        else if (key == "vad_attack_ms") config.vad.attackMs = int(number);
+        else if (key == "vad_hangover_ms") config.vad.hangoverMs = int(number);
+        else qWarning() << "QUICKSTART_AUDIO_TAP: unknown key" << key.c_str();
+    }
+
+    config.ringMs = std::max(config.ringMs, 4 * kChunkMs);
+    return config;
+}
+
+// ── 单个方向的音频流 ──────────────────────────────────────────────
+
+struct AudioTap::Stream {
+    explicit Stream(int ringMs)
+        : ring(size_t(kMaxSampleRate) * kMaxChannels * ringMs / 1000),
+          chunk(size_t(kMaxSampleRate) * kMaxChannels * kChunkMs / 1000) {}
+
+    PcmRingBuffer ring;
+
+    // 回调线程写入
+    std::atomic<int> sampleRate{0};
+    std::atomic<int> channels{0};
+    std::atomic<int64_t> callbackNs{0};
+    std::atomic<uint64_t> callbackCount{0};
+
+    // 以下只在处理线程访问
+    int activeSampleRate = 0;
+    int activeChannels = 0;
+    std::vector<int16_t> chunk;
+    uint64_t frames = 0;
+    int64_t cpuNs = 0;
+    int64_t maxCpuNs = 0;
+};
+
+// ── AudioTap ──────────────────────────────────────────────────────
+
+AudioTap::AudioTap(const AudioTapConfig &config, IAudioTapConsumer *consumer)
+    : m_config(config), m_consumer(consumer), m_vad(config.vad) {
+    if (m_config.tapRecord) {
+        m_record = std::make_unique<Stream>(m_config.ringMs);
+    }
+    if (m_config.tapPlayback) {
+        m_playback = std::make_unique<Stream>(m_config.ringMs);
+    }
+}
+
+AudioTap::~AudioTap() {
+    stop();
+}
+
+void AudioTap::setVoiceActivityCallback(std::function<void(bool)> callback) {
+    m_voiceActivityCallback = std::move(callback);
+}
+
+void AudioTap::start() {
+    if (m_running.exchange(true)) return;
+    m_vad.reset();
+    m_thread = std::thread(&AudioTap::processLoop, this);
+    qDebug() << "AudioTap started, record" << m_config.tapRecord << "playback" << m_config.tapPlayback
+             << "vad" << m_config.vadEnabled;
+}
+
+void AudioTap::stop() {
+    if (!m_running.exchange(false)) return;
+    wakeProcessor();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void AudioTap::onRecordAudioFrame(const RtcAudioFrame &frame) {
+    ThreadPolicy::adoptCurrentThread(ThreadClass::Audio, "rtc-audio");
+    if (m_record && m_running.load(std::memory_order_relaxed)) {
+        pushFrame(*m_record, frame);
+    }
+}
+
+void AudioTap::onPlaybackAudioFrame(const RtcAudioFrame &frame) {
+    ThreadPolicy::adoptCurrentThread(ThreadClass::Audio, "rtc-audio");
+    if (m_playback && m_running.load(std::memory_order_relaxed)) {
+        pushFrame(*m_playback, frame);
+    }
+}
+
+void AudioTap::pushFrame(Stream &stream, const RtcAudioFrame &frame) {
+    if (!frame.data || frame.samplesPerChannel <= 0
+        || frame.sampleRate > kMaxSampleRate || frame.channels > kMaxChannels) {
+        return;
+    }
+
+    int64_t begin = steadyNs();
+    stream.sampleRate.store(frame.sampleRate, std::memory_order_relaxed);
+    stream.channels.store(frame.channels, std::memory_order_relaxed);
+    stream.ring.write(frame.data, size_t(frame.samplesPerChannel) * frame.channels, size_t(frame.channels));
+    wakeProcessor();
+    stream.callbackNs.fetch_add(steadyNs() - begin, std::memory_order_relaxed);
+    stream.callbackCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AudioTap::wakeProcessor() {
+    m_wakeSeq.fetch_add(1);
+    if (m_processorWaiting.load()) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_wakeSeq), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    }
+}
+
+void AudioTap::processLoop() {
+    ThreadPolicy::registerCurrentThread(ThreadClass::Audio, "audio-tap");
+    auto lastReport = std::chrono::steady_clock::now();
+
+    while (m_running.load(std::memory_order_acquire)) {
+        uint32_t seq = m_wakeSeq.load();
+        bool processed = false;
+        if (m_record) processed |= processStream(*m_record, AudioTapSource::Record);
+        if (m_playback) processed |= processStream(*m_playback, AudioTapSource::Playback);
+
+        if (m_config.reportIntervalMs > 0) {
+            auto now = std::chrono::steady_clock::now();
+            double elapsed = std::chrono::duration<double>(now - lastReport).count();
+            if (elapsed * 1000 >= m_config.reportIntervalMs) {
+                report(elapsed);
+                lastReport = now;
+            }
+        }
+
+        if (!processed) {
+            // 与 VideoFrameTap 相同：先登记等待再比较序号，不会错过唤醒
+            m_processorWaiting.store(1);
+            struct timespec ts = {0, 100 * 1000 * 1000};
+            syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_wakeSeq), FUTEX_WAIT_PRIVATE, seq, &ts, nullptr, 0);
+            m_processorWaiting.store(0);
+        }
+    }
+}
+
+bool AudioTap::processStream(Stream &stream, AudioTapSource source) {
+    int sampleRate = stream.sampleRate.load(std::memory_order_relaxed);
+    int channels = stream.channels.load(std::memory_order_relaxed);
+    if (sampleRate <= 0 || channels <= 0) {
+        return false;
+    }
+    if (sampleRate != stream.activeSampleRate || channels != stream.activeChannels) {
+        // 格式变化：丢弃旧格式的残留采样
+        if (stream.activeSampleRate != 0) {
+            qDebug() << "AudioTap: format changed to" << sampleRate << "Hz," << channels << "channel(s)";
+            stream.ring.clear();
+        }
+        stream.activeSampleRate = sampleRate;
+        stream.activeChannels = channels;
+    }
+
+    const int samplesPerChannel = sampleRate * kChunkMs / 1000;
+    const size_t count = size_t(samplesPerChannel) * channels;
+    bool processed = false;
+
+    while (stream.ring.read(stream.chunk.data(), count)) {
+        int64_t begin = threadCpuNs();
+
+        if (source == AudioTapSource::Record && m_config.vadEnabled) {
+            bool wasActive = m_vad.isActive();
+            bool active = m_vad.process(stream.chunk.data(), int(count), kChunkMs);
+            if (active) {
+                m_vadActiveFrames++;
+            }
+            if (active != wasActive) {
+                m_vadToggles++;
+                if (m_voiceActivityCallback) {
+                    m_voiceActivityCallback(active);
+                }
+            }
+        }
+        if (m_consumer) {
+            m_consumer->onTappedAudio(source, stream.chunk.data(), samplesPerChannel, channels, sampleRate);
+        }
+
+        int64_t cost = threadCpuNs() - begin;
+        stream.frames++;
+        stream.cpuNs += cost;
+        stream.maxCpuNs = std::max(stream.maxCpuNs, cost);
+        processed = true;
+    }
+    return processed;
+}
+
+void AudioTap::report(double elapsedSeconds) {
+    auto reportStream = [&](Stream *stream, const char *name) {
+        if (!stream) return;
+        uint64_t callbacks = stream->callbackCount.exchange(0, std::memory_order_relaxed);
+        int64_t callbackNs = stream->callbackNs.exchange(0, std::memory_order_relaxed);
+        double avgUs = stream->frames ? stream->cpuNs / 1000.0 / stream->frames : 0;
+        double callbackUs = callbacks ? callbackNs / 1000.0 / callbacks : 0;
+        qInfo() << "AudioTap:" << name << stream->frames << "frames in" << elapsedSeconds << "s,"
+                << "cpu per 10ms frame avg" << avgUs << "us max" << stream->maxCpuNs / 1000.0 << "us,"
+                << "callback copy" << callbackUs << "us, overruns" << stream->ring.overruns();
+        stream->frames = 0;
+        stream->cpuNs = 0;
+        stream->maxCpuNs = 0;
+    };
+
+    uint64_t recordFrames = m_record ? m_record->frames : 0;
+    reportStream(m_record.get(), "record");
+    reportStream(m_playback.get(), "playback");
+
+    if (m_config.vadEnabled) {
+        qInfo() << "AudioTap: vad active" << (recordFrames ? 100.0 * m_vadActiveFrames / recordFrames : 0) << "%,"
+                << "toggles" << m_vadToggles << ", noise floor" << m_vad.noiseFloorDb() << "dBFS";
+        m_vadActiveFrames = 0;
+        m_vadToggles = 0;
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include "PcmRingBuffer.h"
+#include "RtcBackend.h"
+#include "VoiceActivityDetector.h"
+
+/**
+ * PCM 音频抽取配置
+ *
+ * 通过环境变量 QUICKSTART_AUDIO_TAP 开启，逗号分隔：
+ *   record / playback      抽取麦克风采集和/或播放的音频
+ *   vad                    对麦克风音频做语音检测，并据此开关音频上行（隐含 record）
+ *   ring_ms=N              每个方向环形缓冲的时长，默认 200
+ *   vad_threshold_db=N     语音的最低电平（dBFS），默认 -50
+ *   vad_margin_db=N        语音需高出底噪的幅度，默认 12
+ *   vad_attack_ms=N        连续语音多久后打开上行，默认 30
+ *   vad_hangover_ms=N      最后一个语音帧后多久关闭上行，默认 600
+ *   report_ms=N            统计输出间隔，默认 10000，0 表示不输出
+ * 例如：QUICKSTART_AUDIO_TAP=vad,playback,vad_hangover_ms=800
+ */
+struct AudioTapConfig {
+    bool tapRecord = false;
+    bool tapPlayback = false;
+    bool vadEnabled = false;
+    int ringMs = 200;
+    int reportIntervalMs = 10000;
+    VoiceActivityConfig vad;
+
+    bool enabled() const { return tapRecord || tapPlayback; }
+
+    static AudioTapConfig fromEnvironment();
+};
+
+enum class AudioTapSource {
+    Record,
+    Playback,
+};
+
+/** 音频消费者，在 AudioTap 的处理线程上以 10 ms 为单位调用 */
+class IAudioTapConsumer {
+public:
+    virtual ~IAudioTapConsumer() = default;
+
+    virtual void onTappedAudio(AudioTapSource source, const int16_t *samples,
+                               int samplesPerChannel, int channels, int sampleRate) = 0;
+};
+
+/**
+ * PCM 音频抽取
+ *
+ * 作为 IRtcAudioFrameObserver 注册到引擎，音频回调线程上只把采样拷贝进无锁环形缓冲；
+ * 处理线程按 10 ms 一帧取出，先做语音检测（如开启），再交给 IAudioTapConsumer。
+ * 语音检测状态变化时调用 setVoiceActivityCallback 设置的回调（在处理线程上）。
+ *
+ * 定期输出每个 10 ms 帧的平均/最大处理 CPU 时间、回调线程上的拷贝耗时、溢出采样数，
+ * 以及语音检测打开的时间比例和切换次数。
+ *
+ * 生命周期：start() → addAudioFrameObserver → ... → removeAudioFrameObserver → stop()。
+ */
+class AudioTap : public IRtcAudioFrameObserver {
+public:
+    explicit AudioTap(const AudioTapConfig &config, IAudioTapConsumer *consumer = nullptr);
+    ~AudioTap() override;
+
+    void setVoiceActivityCallback(std::function<void(bool active)> callback);
+
+    void start();
+    void stop();
+
+    void onRecordAudioFrame(const RtcAudioFrame &frame) override;
+    void onPlaybackAudioFrame(const RtcAudioFrame &frame) override;
+
+private:
+    struct Stream;
+
+    void pushFrame(Stream &stream, const RtcAudioFrame &frame);
+    void processLoop();
+    bool processStream(Stream &stream, AudioTapSource source);
+    void report(double elapsedSeconds);
+    void wakeProcessor();
+
+    AudioTapConfig m_config;
+    IAudioTapConsumer *m_consumer = nullptr;
+    std::function<void(bool)> m_voiceActivityCallback;
+    std::unique_ptr<Stream> m_record;
+    std::unique_ptr<Stream> m_playback;
+    VoiceActivityDetector m_vad;
+    uint64_t m_vadActiveFrames = 0;
+    uint64_t m_vadToggles = 0;
+    std::atomic<bool> m_running{false};
+    std::atomic<uint32_t> m_wakeSeq{0};
+    std::atomic<uint32_t> m_processorWaiting{0};
+    std::thread m_thread;
+};
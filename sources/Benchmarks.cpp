@@ -0,0 +1,601 @@
+#include "Benchmarks.h"
+#include "ActuatorToolAdapter.h"
+#include "AgentMessageDecoder.h"
+#include "AllocTracker.h"
+#include "ColorConvert.h"
+#include "FakeRtcBackend.h"
+#include "ImageScale.h"
+#include "JpegEncoder.h"
+#include "PulseAudioDevice.h"
+#include "StartupProbe.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+extern char **environ;
+
+namespace Benchmarks {
+
+namespace {
+
+struct Benchmark {
+    const char *name;
+    const char *description;
+    int (*run)(int argc, char *argv[]);
+};
+
+// 在固定时长内重复调用 fn，返回每次调用的平均耗时（毫秒）
+template <typename Fn>
+double measureMs(Fn fn, double minSeconds) {
+    using Clock = std::chrono::steady_clock;
+    fn();  // 预热
+    int iterations = 0;
+    auto begin = Clock::now();
+    double elapsed = 0;
+    do {
+        fn();
+        ++iterations;
+        elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+    } while (elapsed < minSeconds);
+    return elapsed * 1000.0 / iterations;
+}
+
+// ── color-convert ─────────────────────────────────────────────────
+
+int colorConvert(int argc, char *argv[]) {
+    const double seconds = argc > 0 ? std::max(0.05, std::atof(argv[0])) : 0.5;
+    const struct { int width, height; } sizes[] = {
+        {320, 180}, {640, 360}, {1280, 720}, {1920, 1080},
+    };
+    const struct { const char *name; ColorConvert::RgbLayout layout; } layouts[] = {
+        {"bgr24", ColorConvert::RgbLayout::Bgr24},
+        {"bgra32", ColorConvert::RgbLayout::Bgra32},
+    };
+
+    std::printf("I420 -> RGB, simd %s, %.2fs per case\n", ColorConvert::hasSimd() ? "neon" : "none", seconds);
+    std::printf("%-10s %-7s %12s %12s %12s %12s %8s\n",
+                "size", "layout", "scalar ms", "simd ms", "scalar Mpx/s", "simd Mpx/s", "speedup");
+
+    int mismatches = 0;
+    for (const auto &size : sizes) {
+        const int w = size.width;
+        const int h = size.height;
+        const int cw = (w + 1) / 2;
+        const int ch = (h + 1) / 2;
+        std::vector<uint8_t> y(w * h), u(cw * ch), v(cw * ch);
+        uint32_t seed = 12345;
+        auto next = [&seed]() { seed = seed * 1664525u + 1013904223u; return uint8_t(seed >> 24); };
+        for (auto &p : y) p = next();
+        for (auto &p : u) p = next();
+        for (auto &p : v) p = next();
+
+        for (const auto &layout : layouts) {
+            const int stride = w * ColorConvert::bytesPerPixel(layout.layout);
+            std::vector<uint8_t> scalarOut(stride * h), simdOut(stride * h);
+
+            double scalarMs = measureMs([&]() {
+                ColorConvert::i420ToRgbScalar(y.data(), w, u.data(), cw, v.data(), cw,
+                                              scalarOut.data(), stride, w, h, layout.layout);
+            }, seconds);
+            double simdMs = measureMs([&]() {
+                ColorConvert::i420ToRgb(y.data(), w, u.data(), cw, v.data(), cw,
+                                        simdOut.data(), stride, w, h, layout.layout);
+            }, seconds);
+
+            if (scalarOut != simdOut) {
+                ++mismatches;
+            }
+            const double mpix = double(w) * h / 1e6;
+            char label[32];
+            std::snprintf(label, sizeof(label), "%dx%d", w, h);
+            std::printf("%-10s %-7s %12.3f %12.3f %12.1f %12.1f %7.2fx\n",
+                        label, layout.name, scalarMs, simdMs,
+                        mpix / (scalarMs / 1000.0), mpix / (simdMs / 1000.0), scalarMs / simdMs);
+        }
+    }
+
+    if (mismatches > 0) {
+        std::printf("ERROR: %d case(s) where SIMD output differs from scalar\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
+
+// ── snapshot ──────────────────────────────────────────────────────
+
+// camera_snapshot 工具的处理耗时：1080p 缩放到各输出尺寸（SIMD 与标量对比）再编码 JPEG
+int snapshot(int argc, char *argv[]) {
+    const double seconds = argc > 0 ? std::max(0.05, std::atof(argv[0])) : 0.5;
+    const int quality = argc > 1 ? std::max(1, std::min(100, std::atoi(argv[1]))) : 75;
+    const int srcWidth = 1920;
+    const int srcHeight = 1080;
+    const struct { int width, height; } sizes[] = {
+        {1280, 720}, {960, 540}, {640, 360}, {320, 180},
+    };
+
+    // 平滑渐变加噪声，接近摄像头画面的压缩率
+    std::vector<uint8_t> src(srcWidth * srcHeight * 3 / 2);
+    uint32_t seed = 12345;
+    auto next = [&seed]() { seed = seed * 1664525u + 1013904223u; return int(seed >> 28); };
+    for (int row = 0; row < srcHeight; ++row) {
+        for (int col = 0; col < srcWidth; ++col) {
+            src[row * srcWidth + col] = uint8_t((col * 200 / srcWidth + row * 40 / srcHeight + next()) & 0xff);
+        }
+    }
+    std::fill(src.begin() + srcWidth * srcHeight, src.end(), uint8_t(128));
+    ImageScale::I420Image image;
+    image.planes[0] = src.data();
+    image.planes[1] = src.data() + srcWidth * srcHeight;
+    image.planes[2] = image.planes[1] + (srcWidth / 2) * (srcHeight / 2);
+    image.strides[0] = srcWidth;
+    image.strides[1] = srcWidth / 2;
+    image.strides[2] = srcWidth / 2;
+    image.width = srcWidth;
+    image.height = srcHeight;
+
+    std::printf("%dx%d I420 -> JPEG q%d, scale simd %s, jpeg %s, %.2fs per case\n", srcWidth, srcHeight, quality,
+                ImageScale::hasSimd() ? "neon" : "none", JpegEncoder::backendName(), seconds);
+    std::printf("%-10s %12s %12s %8s %12s %10s\n", "output", "scalar ms", "simd ms", "speedup", "encode ms", "bytes");
+
+    JpegEncoder encoder;
+    std::vector<uint8_t> scratch, scalarOut, simdOut, jpeg;
+    int mismatches = 0;
+    for (const auto &size : sizes) {
+        double scalarMs = measureMs([&]() {
+            ImageScale::scaleI420Scalar(image, size.width, size.height, scalarOut, scratch);
+        }, seconds);
+        double simdMs = measureMs([&]() {
+            ImageScale::scaleI420(image, size.width, size.height, simdOut, scratch);
+        }, seconds);
+        if (scalarOut != simdOut) {
+            ++mismatches;
+        }
+
+        ImageScale::I420Image scaled;
+        scaled.planes[0] = simdOut.data();
+        scaled.planes[1] = simdOut.data() + size.width * size.height;
+        scaled.planes[2] = scaled.planes[1] + (size.width / 2) * (size.height / 2);
+        scaled.strides[0] = size.width;
+        scaled.strides[1] = size.width / 2;
+        scaled.strides[2] = size.width / 2;
+        scaled.width = size.width;
+        scaled.height = size.height;
+        bool encoded = true;
+        double encodeMs = measureMs([&]() {
+            encoded = encoder.encode(scaled, quality, jpeg) && encoded;
+        }, seconds);
+        if (!encoded) {
+            std::printf("ERROR: JPEG encoding failed\n");
+            return 1;
+        }
+
+        char label[32];
+        std::snprintf(label, sizeof(label), "%dx%d", size.width, size.height);
+        std::printf("%-10s %12.3f %12.3f %7.2fx %12.3f %10zu\n",
+                    label, scalarMs, simdMs, scalarMs / simdMs, encodeMs, jpeg.size());
+    }
+
+    if (mismatches > 0) {
+        std::printf("ERROR: %d case(s) where SIMD output differs from scalar\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
+
+// ── agent-decode ──────────────────────────────────────────────────
+
+bool sameMessage(const AgentMessage &a, const AgentMessage &b) {
+    if (a.kind != b.kind || a.id != b.id || a.hasError != b.hasError || a.errorMessage != b.errorMessage
+        || a.hasResult != b.hasResult || a.method != b.method || a.textDelta != b.textDelta) {
+        return false;
+    }
+    // 快速路径保留 result 的原始文本，按内容比较
+    return !a.hasResult || nlohmann::json::parse(a.result) == nlohmann::json::parse(b.result);
+}
+
+// 典型的智能体下行消息逐条解码，快速路径与 nlohmann 完整解析对比
+int agentDecode(int argc, char *argv[]) {
+    const double seconds = argc > 0 ? std::max(0.05, std::atof(argv[0])) : 0.3;
+    const struct { const char *name; std::string payload; } messages[] = {
+        {"textTalkDelta",
+         R"({"jsonrpc":"2.0","method":"textTalkDelta","params":{"taskId":"task-1024","textDelta":"好的，我已经把客厅的灯打开了，还需要调节亮度吗？"}})"},
+        {"textTalkDelta (escaped)",
+         R"({"jsonrpc":"2.0","method":"textTalkDelta","params":{"taskId":"task-1024","textDelta":"好的，\"灯\"已打开\n"}})"},
+        {"textTalkFinished",
+         R"({"jsonrpc":"2.0","method":"textTalkFinished","params":{"taskId":"task-1024"}})"},
+        {"rpc result",
+         R"({"jsonrpc":"2.0","id":"17","result":{}})"},
+        {"rpc error",
+         R"({"jsonrpc":"2.0","id":18,"error":{"code":-32000,"message":"session not found"}})"},
+        {"startVoiceChat result",
+         R"({"jsonrpc":"2.0","id":"2","result":{"appId":"6588e3c7a0d1b2001e2f3a4b","roomId":"room-8c1f","token":"001abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ","userId":"user-1","targetUserId":"agent-1"}})"},
+    };
+
+    std::printf("agent message decode, simd %s, %.2fs per case\n", AgentMessageDecoder::hasSimd() ? "neon" : "swar", seconds);
+    std::printf("%-24s %6s %12s %12s %8s\n", "message", "bytes", "json ns", "fast ns", "speedup");
+
+    int mismatches = 0;
+    for (const auto &entry : messages) {
+        AgentMessage fast;
+        AgentMessage reference;
+        const bool handled = AgentMessageDecoder::decodeFast(entry.payload, fast);
+        AgentMessageDecoder::decodeJson(entry.payload, reference);
+        if (!handled || !sameMessage(fast, reference)) {
+            std::printf("%-24s %s\n", entry.name, handled ? "MISMATCH" : "not handled by fast path");
+            ++mismatches;
+            continue;
+        }
+
+        // 每次解码一批，避免计时开销占比过大
+        constexpr int kBatch = 100;
+        AgentMessage message;
+        const double jsonMs = measureMs([&] {
+            for (int i = 0; i < kBatch; ++i) AgentMessageDecoder::decodeJson(entry.payload, message);
+        }, seconds);
+        const double fastMs = measureMs([&] {
+            for (int i = 0; i < kBatch; ++i) AgentMessageDecoder::decodeFast(entry.payload, message);
+        }, seconds);
+        std::printf("%-24s %6zu %12.0f %12.0f %7.1fx\n", entry.name, entry.payload.size(),
+                    jsonMs * 1e6 / kBatch, fastMs * 1e6 / kBatch, jsonMs / fastMs);
+    }
+
+    if (mismatches > 0) {
+        std::printf("ERROR: %d message(s) where the fast path differs from nlohmann\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
+
+// ── actuator ──────────────────────────────────────────────────────
+
+// 进程内起一个应答线程充当控制进程，测量 MCP 工具调用经共享内存命令环的往返耗时
+int actuator(int argc, char *argv[]) {
+    const int calls = argc > 0 ? std::max(1, std::atoi(argv[0])) : 20000;
+
+    ActuatorConfig config;
+    config.shmName = "/quickstart-actuator-bench";
+    config.spinUs = argc > 1 ? std::max(0, std::atoi(argv[1])) : config.spinUs;
+    ActuatorToolAdapter adapter(config);
+    if (!adapter.isOpen()) {
+        std::printf("cannot create shared memory ring %s\n", config.shmName.c_str());
+        return 1;
+    }
+
+    std::string error;
+    auto ring = ActuatorRing::attach(config.shmName, error);
+    if (!ring) {
+        std::printf("cannot attach %s: %s\n", config.shmName.c_str(), error.c_str());
+        return 1;
+    }
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> acked{0};
+    std::thread responder([&] {
+        ActuatorMessage command{};
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (!ring->pop(ActuatorRing::Direction::Command, command)) {
+                ring->wait(ActuatorRing::Direction::Command, 10000, config.spinUs);
+                continue;
+            }
+            ActuatorMessage ack{};
+            ack.id = command.id;
+            ack.tool = command.tool;
+            ack.receivedNs = ActuatorRing::nowNs();
+            ack.ackNs = ack.receivedNs;
+            acked.fetch_add(1, std::memory_order_relaxed);
+            ring->push(ActuatorRing::Direction::Ack, ack);
+        }
+    });
+
+    const nlohmann::json args = {{"action", "close"}, {"force", 3.5}};
+    std::vector<double> roundTrips;
+    roundTrips.reserve(calls);
+    int failures = 0;
+    for (int i = 0; i < calls; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t before = acked.load(std::memory_order_relaxed);
+        adapter.call(0, args);
+        const auto end = std::chrono::steady_clock::now();
+        // 应答线程没有处理这条命令，说明调用在命令环满或超时时失败
+        if (acked.load(std::memory_order_relaxed) == before) {
+            ++failures;
+            continue;
+        }
+        roundTrips.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+    stop.store(true, std::memory_order_relaxed);
+    responder.join();
+
+    if (roundTrips.empty()) {
+        std::printf("no successful calls\n");
+        return 1;
+    }
+    std::sort(roundTrips.begin(), roundTrips.end());
+    auto percentile = [&](double p) {
+        return roundTrips[std::min(roundTrips.size() - 1, static_cast<size_t>(p * roundTrips.size()))];
+    };
+    std::printf("%d calls, spin %d us, %d failed\n", calls, config.spinUs, failures);
+    std::printf("tool call round trip (encode + command + ack + result JSON): p50 %.1f us, p99 %.1f us, max %.1f us\n",
+                percentile(0.5), percentile(0.99), roundTrips.back());
+    return failures > 0 ? 1 : 0;
+}
+
+// ── audio-device ──────────────────────────────────────────────────
+
+// 用模拟引擎驱动 PulseAudio 外部音频设备，默认在 null sink 上运行，无需声卡
+int audioDevice(int argc, char *argv[]) {
+    const int seconds = argc > 0 ? std::max(1, std::atoi(argv[0])) : 10;
+
+    PulseAudioDeviceConfig config = PulseAudioDeviceConfig::fromEnvironment();
+    if (config.source.empty() && config.sink.empty()) {
+        config.nullSink = true;
+    }
+    config.reportIntervalMs = 0;
+
+    FakeRtcConfig fakeConfig;
+    fakeConfig.remoteUsers = 1;
+    fakeConfig.joinDelayMs = 0;
+    fakeConfig.audioSampleRate = config.sampleRate;
+    fakeConfig.audioChannels = config.channels;
+    FakeRtcEngine engine(fakeConfig);
+    IRtcEventHandler handler;
+    engine.create("bench", &handler);
+    IRtcRoom *room = engine.createRoom("bench");
+    room->joinRoom("", "bench", RtcRoomConfig());
+
+    PulseAudioDevice device(config);
+    if (!device.start(&engine)) {
+        std::printf("failed to start PulseAudio device\n");
+        engine.destroyRoom(room);
+        engine.destroy();
+        return 1;
+    }
+
+    std::printf("PulseAudio %d Hz x %d, fragment %d ms, playback %d ms, %s\n",
+                config.sampleRate, config.channels, config.fragmentMs, config.playbackMs,
+                config.nullSink ? "null sink" : "configured devices");
+    std::printf("%4s %10s %10s %10s %10s %10s %9s %8s\n",
+                "t(s)", "capture", "jitter", "target", "playback", "local", "underrun", "dropped");
+
+    double sumLocal = 0;
+    double maxLocal = 0;
+    PulseAudioLatency last;
+    for (int t = 1; t <= seconds; ++t) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        last = device.latency();
+        sumLocal += last.localPathMs();
+        maxLocal = std::max(maxLocal, last.localPathMs());
+        std::printf("%4d %10.1f %10.1f %10.1f %10.1f %10.1f %9llu %8llu\n", t,
+                    last.captureMs, last.jitterBufferMs, last.jitterTargetMs, last.playbackMs, last.localPathMs(),
+                    (unsigned long long) last.underruns, (unsigned long long) last.droppedSamples);
+    }
+
+    device.stop();
+    engine.destroyRoom(room);
+    engine.destroy();
+    std::printf("local path latency: avg %.1f ms, max %.1f ms, underruns %llu\n",
+                sumLocal / seconds, maxLocal, (unsigned long long) last.underruns);
+    return 0;
+}
+
+// ── startup ───────────────────────────────────────────────────────
+
+struct StartupSample {
+    double firstPaintMs = -1;
+    double sdkReadyMs = -1;
+};
+
+// 以探针模式启动一次自身，返回从 spawn 到首帧绘制/SDK 就绪的耗时
+bool runStartupOnce(const char *exe, bool eager, StartupSample &sample) {
+    setenv("QUICKSTART_STARTUP_PROBE", "1", 1);
+    setenv("QUICKSTART_EAGER_SDK_LOAD", eager ? "1" : "0", 1);
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addclose(&actions, fds[0]);
+
+    char *args[] = {const_cast<char *>(exe), nullptr};
+    const int64_t spawnNs = StartupProbe::monotonicNs();
+    pid_t pid = 0;
+    int ret = posix_spawn(&pid, exe, &actions, nullptr, args, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[1]);
+    if (ret != 0) {
+        close(fds[0]);
+        return false;
+    }
+
+    FILE *out = fdopen(fds[0], "r");
+    char line[256];
+    long long ns = 0;
+    while (out && fgets(line, sizeof(line), out)) {
+        if (std::sscanf(line, "first_paint_ns=%lld", &ns) == 1) {
+            sample.firstPaintMs = (ns - spawnNs) / 1e6;
+        } else if (std::sscanf(line, "sdk_ready_ns=%lld", &ns) == 1) {
+            sample.sdkReadyMs = (ns - spawnNs) / 1e6;
+        }
+    }
+    if (out) {
+        fclose(out);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return sample.firstPaintMs >= 0;
+}
+
+int startup(int argc, char *argv[]) {
+    const int runs = argc > 0 ? std::max(1, std::atoi(argv[0])) : 5;
+
+    char exe[4096];
+    ssize_t length = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    if (length <= 0) {
+        std::printf("cannot resolve executable path\n");
+        return 1;
+    }
+    exe[length] = '\0';
+    // 没有显示服务时用 offscreen 平台，绘制路径相同
+    if (!std::getenv("DISPLAY") && !std::getenv("WAYLAND_DISPLAY")) {
+        setenv("QT_QPA_PLATFORM", "offscreen", 0);
+    }
+
+    std::printf("time from spawn to first paint, %d runs per mode (eager = SDK loaded before the window, as with link-time loading)\n", runs);
+    std::printf("%-6s %14s %14s %14s %14s\n", "mode", "paint min ms", "paint med ms", "sdk min ms", "sdk med ms");
+
+    auto median = [](std::vector<double> values) {
+        if (values.empty()) return -1.0;
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    };
+    for (bool eager : {true, false}) {
+        std::vector<double> paint;
+        std::vector<double> sdk;
+        for (int i = 0; i < runs; ++i) {
+            StartupSample sample;
+            if (!runStartupOnce(exe, eager, sample)) {
+                std::printf("run %d (%s) did not report a first paint\n", i, eager ? "eager" : "lazy");
+                continue;
+            }
+            paint.push_back(sample.firstPaintMs);
+            if (sample.sdkReadyMs >= 0) {
+                sdk.push_back(sample.sdkReadyMs);
+            }
+        }
+        std::printf("%-6s %14.1f %14.1f %14.1f %14.1f\n", eager ? "eager" : "lazy",
+                    paint.empty() ? -1.0 : *std::min_element(paint.begin(), paint.end()), median(paint),
+                    sdk.empty() ? -1.0 : *std::min_element(sdk.begin(), sdk.end()), median(sdk));
+    }
+    return 0;
+}
+
+// ── alloc ─────────────────────────────────────────────────────────
+
+// 分配结果写入 volatile，避免编译器把成对的 malloc / free 整个删掉
+volatile uintptr_t g_allocSink = 0;
+
+// 在 AllocScope 内 new / delete 一批，返回每次分配加释放的纳秒数，包括作用域本身的开销
+double newDeleteNs(size_t size, double seconds) {
+    constexpr int kBatch = 64;
+    void *blocks[kBatch];
+    const double ms = measureMs([&] {
+        AllocScope scope(AllocSubsystem::AgentProtocol);
+        for (void *&block : blocks) {
+            block = ::operator new(size);
+            static_cast<char *>(block)[0] = 1;
+        }
+        for (void *block : blocks) {
+            g_allocSink = g_allocSink + reinterpret_cast<uintptr_t>(block);
+            ::operator delete(block);
+        }
+    }, seconds);
+    return ms * 1e6 / kBatch;
+}
+
+// 以 QUICKSTART_ALLOC_TRACKING 开启与否各编译一次对比；同一次运行中 malloc 一列不经过统计，可作基线
+int allocation(int argc, char *argv[]) {
+    const double seconds = argc > 0 ? std::max(0.05, std::atof(argv[0])) : 0.3;
+    const int threads = argc > 1 ? std::max(1, std::atoi(argv[1])) : 4;
+    constexpr int kBatch = 64;
+
+    std::printf("allocation tracking %s, %.2fs per case\n",
+                AllocTracker::enabled() ? "compiled in" : "off (build with -DQUICKSTART_ALLOC_TRACKING=ON to compare)", seconds);
+    std::printf("%-30s %12s %12s %10s\n", "case", "malloc ns", "new ns", "overhead");
+    for (size_t size : {16, 64, 256, 4096}) {
+        void *blocks[kBatch];
+        const double mallocMs = measureMs([&] {
+            for (void *&block : blocks) {
+                block = std::malloc(size);
+                static_cast<char *>(block)[0] = 1;
+            }
+            for (void *block : blocks) {
+                g_allocSink = g_allocSink + reinterpret_cast<uintptr_t>(block);
+                std::free(block);
+            }
+        }, seconds);
+        const double mallocNs = mallocMs * 1e6 / kBatch;
+        const double newNs = newDeleteNs(size, seconds);
+        char name[64];
+        std::snprintf(name, sizeof(name), "alloc + free %zu B", size);
+        std::printf("%-30s %12.1f %12.1f %9.1f%%\n", name, mallocNs, newNs, (newNs / mallocNs - 1.0) * 100.0);
+    }
+
+    // 分配密集的实际负载：解析一条 startVoiceChat 响应
+    const std::string payload =
+        R"({"jsonrpc":"2.0","id":"2","result":{"appId":"6588e3c7a0d1b2001e2f3a4b","roomId":"room-8c1f","token":"001abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ","userId":"user-1","targetUserId":"agent-1"}})";
+    const double parseMs = measureMs([&] {
+        AllocScope scope(AllocSubsystem::AgentProtocol);
+        auto json = nlohmann::json::parse(payload);
+        g_allocSink = g_allocSink + json.size();
+    }, seconds);
+    std::printf("%-30s %12s %12.1f\n", "nlohmann parse (agent msg)", "-", parseMs * 1e6);
+
+    // 多线程同时分配：每个线程只写自己的计数槽，耗时不应随线程数上升
+    std::vector<double> perThread(threads);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back([&perThread, i, seconds] { perThread[i] = newDeleteNs(64, seconds); });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    double sum = 0;
+    for (double ns : perThread) {
+        sum += ns;
+    }
+    char name[64];
+    std::snprintf(name, sizeof(name), "alloc + free 64 B x%d threads", threads);
+    std::printf("%-30s %12s %12.1f\n", name, "-", sum / threads);
+
+    if (AllocTracker::enabled()) {
+        AllocTracker::Totals totals[kAllocSubsystemCount];
+        AllocTracker::snapshot(totals);
+        const auto &agent = totals[static_cast<int>(AllocSubsystem::AgentProtocol)];
+        std::printf("counted under 'agent': %llu allocations, %llu frees, %lld live bytes\n",
+                    static_cast<unsigned long long>(agent.allocations), static_cast<unsigned long long>(agent.frees),
+                    static_cast<long long>(agent.liveBytes()));
+    }
+    return 0;
+}
+
+const Benchmark kBenchmarks[] = {
+    {"color-convert", "I420 -> RGB conversion throughput per resolution, SIMD vs scalar [seconds]", colorConvert},
+    {"snapshot", "camera_snapshot downscale (SIMD vs scalar) and JPEG encode time from 1080p [seconds] [quality]", snapshot},
+    {"agent-decode", "agent message decode time per message, fast path vs nlohmann [seconds]", agentDecode},
+    {"actuator", "MCP tool round trip through the shared-memory actuator ring [calls] [spin_us]", actuator},
+    {"audio-device", "PulseAudio external device latency, null sink unless source/sink set [seconds]", audioDevice},
+    {"startup", "time to first paint with eager vs background SDK loading [runs]", startup},
+    {"alloc", "new/delete cost with per-subsystem allocation tracking vs malloc [seconds] [threads]", allocation},
+};
+
+} // namespace
+
+int run(int argc, char *argv[]) {
+    if (argc > 0) {
+        for (const auto &benchmark : kBenchmarks) {
+            if (std::strcmp(argv[0], benchmark.name) == 0) {
+                return benchmark.run(argc - 1, argv + 1);
+            }
+        }
+        std::printf("unknown benchmark: %s\n", argv[0]);
+    }
+
+    std::printf("usage: --bench <name> [args...]\n");
+    for (const auto &benchmark : kBenchmarks) {
+        std::printf("  %-16s %s\n", benchmark.name, benchmark.description);
+    }
+    return argc > 0 ? 1 : 0;
+}
+
+} // namespace Benchmarks
@@ -0,0 +1,14 @@
+#pragma once
+
+/**
+ * 命令行基准测试
+ *
+ * 通过 QuickStart --bench <name> [args...] 运行，不创建界面，结果输出到标准输出。
+ * 不带名字的 --bench 列出全部可用的基准。
+ */
+namespace Benchmarks {
+
+/** 运行指定基准，返回进程退出码 */
+int run(int argc, char *argv[]);
+
+} // namespace Benchmarks
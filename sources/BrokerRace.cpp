@@ -0,0 +1,398 @@
+#include "BrokerRace.h"
+#include "AgentClient.h"
+#include "ConnectionPrewarmer.h"
+#include "MetricsExporter.h"
+#include "ThreadPolicy.h"
+#include <QDebug>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <netdb.h>
+#include <sys/socket.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 连接耗时的指数平均权重，新样本占 30%
+constexpr double kLatencyWeight = 0.3;
+
+int elapsedMs(Clock::time_point since, Clock::time_point now) {
+    return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(now - since).count());
+}
+
+struct BrokerStats {
+    double connectMs = 0.0;     // 成功连接耗时的指数平均，0 表示从未成功
+    int consecutiveFailures = 0;
+    uint64_t failures = 0;
+    uint64_t wins = 0;
+};
+
+/** 进程内的连接耗时记忆，可选保存到 latency_file */
+struct LatencyMemory {
+    std::mutex mutex;
+    std::map<std::string, BrokerStats> brokers;
+    std::string file;
+    bool loaded = false;
+    uint64_t races = 0;
+    uint64_t failovers = 0;
+
+    static LatencyMemory &instance() {
+        static LatencyMemory memory;
+        return memory;
+    }
+
+    // 调用方持有 mutex
+    void load(const std::string &path) {
+        if (loaded || path.empty()) {
+            return;
+        }
+        loaded = true;
+        file = path;
+        std::ifstream in(path);
+        double connectMs = 0.0;
+        int consecutiveFailures = 0;
+        std::string url;
+        // 每行：平均耗时 连续失败次数 地址
+        while (in >> connectMs >> consecutiveFailures >> url) {
+            BrokerStats &stats = brokers[url];
+            stats.connectMs = connectMs;
+            stats.consecutiveFailures = consecutiveFailures;
+        }
+    }
+
+    // 调用方持有 mutex
+    void save() {
+        if (file.empty()) {
+            return;
+        }
+        std::ofstream out(file, std::ios::trunc);
+        for (const auto &[url, stats] : brokers) {
+            out << stats.connectMs << ' ' << stats.consecutiveFailures << ' ' << url << '\n';
+        }
+        if (!out) {
+            qWarning() << "BrokerRace: cannot write" << file.c_str();
+            file.clear();
+        }
+    }
+};
+
+/** 后台解析的结果；竞速提前结束时解析线程仍持有它，独自运行到 getaddrinfo 返回 */
+struct Resolution {
+    enum State { Running, Resolved, Failed };
+    std::atomic<int> state{Running};
+    std::string error;          // state 变为 Failed 之前写入
+};
+
+std::shared_ptr<Resolution> resolveInBackground(const std::string &brokerUrl) {
+    auto resolution = std::make_shared<Resolution>();
+    std::string host;
+    std::string port;
+    if (!ConnectionPrewarmer::parseBrokerUrl(brokerUrl, host, port)) {
+        // 认不出主机的地址交给 Paho 自己处理
+        resolution->state.store(Resolution::Resolved, std::memory_order_release);
+        return resolution;
+    }
+    // getaddrinfo 无法取消，线程不等待，结果只通过共享的 Resolution 交回
+    std::thread([resolution, host, port] {
+        ThreadPolicy::registerCurrentThread(ThreadClass::Background, "broker-dns");
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo *result = nullptr;
+        const int rc = getaddrinfo(host.c_str(), port.c_str(), &hints, &result);
+        if (rc == 0) {
+            freeaddrinfo(result);
+            resolution->state.store(Resolution::Resolved, std::memory_order_release);
+        } else {
+            resolution->error = std::string("cannot resolve ") + host + ": " + gai_strerror(rc);
+            resolution->state.store(Resolution::Failed, std::memory_order_release);
+        }
+    }).detach();
+    return resolution;
+}
+
+struct Attempt {
+    enum class State { Waiting, Resolving, Connecting, Failed, Won };
+
+    std::string brokerUrl;
+    State state = State::Waiting;
+    Clock::time_point started;
+    std::shared_ptr<Resolution> resolution;
+    std::unique_ptr<mqtt::async_client> client;
+    mqtt::token_ptr token;
+
+    bool active() const { return state == State::Resolving || state == State::Connecting; }
+};
+
+/** 指标名中只保留主机与端口，其余字符换成下划线 */
+std::string metricName(const std::string &brokerUrl) {
+    std::string host;
+    std::string port;
+    std::string name = ConnectionPrewarmer::parseBrokerUrl(brokerUrl, host, port) ? host + "_" + port : brokerUrl;
+    for (char &c : name) {
+        const bool keep = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-';
+        if (!keep) c = '_';
+    }
+    return name;
+}
+
+} // namespace
+
+BrokerRaceConfig BrokerRaceConfig::fromEnvironment() {
+    BrokerRaceConfig config;
+    const char *value = std::getenv("QUICKSTART_BROKERS");
+    if (!value) {
+        return config;
+    }
+
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.compare(0, 11, "stagger_ms=") == 0) config.staggerMs = std::atoi(item.c_str() + 11);
+        else if (item.compare(0, 19, "connect_timeout_ms=") == 0) config.connectTimeoutMs = std::atoi(item.c_str() + 19);
+        else if (item.compare(0, 13, "latency_file=") == 0) config.latencyFile = item.substr(13);
+        else if (!item.empty()) qWarning() << "QUICKSTART_BROKERS: unknown option" << item.c_str();
+    }
+
+    config.staggerMs = std::max(0, config.staggerMs);
+    config.connectTimeoutMs = std::max(1000, config.connectTimeoutMs);
+    return config;
+}
+
+std::vector<std::string> BrokerRace::splitList(const std::string &list) {
+    std::vector<std::string> brokers;
+    size_t pos = 0;
+    while (pos < list.size()) {
+        const size_t end = std::min(list.find_first_of(",; \t\r\n", pos), list.size());
+        std::string url = list.substr(pos, end - pos);
+        if (!url.empty() && std::find(brokers.begin(), brokers.end(), url) == brokers.end()) {
+            brokers.push_back(std::move(url));
+        }
+        pos = end + 1;
+    }
+    return brokers;
+}
+
+std::vector<std::string> BrokerRace::order(const std::vector<std::string> &brokers) {
+    LatencyMemory &memory = LatencyMemory::instance();
+    std::lock_guard<std::mutex> lock(memory.mutex);
+
+    // 分组：0 成功过且最近没有失败，1 没有记录，2 最近失败
+    auto rank = [&memory](const std::string &url, int &group, double &key) {
+        auto it = memory.brokers.find(url);
+        if (it == memory.brokers.end() || (it->second.connectMs <= 0.0 && it->second.consecutiveFailures == 0)) {
+            group = 1;
+            key = 0.0;
+        } else if (it->second.consecutiveFailures == 0) {
+            group = 0;
+            key = it->second.connectMs;
+        } else {
+            group = 2;
+            key = it->second.consecutiveFailures;
+        }
+    };
+
+    std::vector<std::string> ordered = brokers;
+    std::stable_sort(ordered.begin(), ordered.end(), [&rank](const std::string &a, const std::string &b) {
+        int groupA = 0;
+        int groupB = 0;
+        double keyA = 0.0;
+        double keyB = 0.0;
+        rank(a, groupA, keyA);
+        rank(b, groupB, keyB);
+        return groupA != groupB ? groupA < groupB : keyA < keyB;
+    });
+    return ordered;
+}
+
+BrokerRaceResult BrokerRace::connect(const std::vector<std::string> &brokers, const std::string &clientId,
+                                     const BrokerRaceConfig &config,
+                                     const std::function<bool()> &cancelled) {
+    LatencyMemory &memory = LatencyMemory::instance();
+    {
+        std::lock_guard<std::mutex> lock(memory.mutex);
+        memory.load(config.latencyFile);
+        ++memory.races;
+    }
+
+    std::vector<Attempt> attempts;
+    for (const std::string &url : order(brokers)) {
+        Attempt attempt;
+        attempt.brokerUrl = url;
+        attempts.push_back(std::move(attempt));
+    }
+
+    BrokerRaceResult result;
+    std::vector<std::string> failedUrls;
+    auto fail = [&failedUrls](Attempt &attempt, const std::string &reason) {
+        qWarning() << "BrokerRace:" << attempt.brokerUrl.c_str() << reason.c_str();
+        attempt.state = Attempt::State::Failed;
+        failedUrls.push_back(attempt.brokerUrl);
+    };
+
+    const auto stagger = std::chrono::milliseconds(config.staggerMs);
+    size_t launched = 0;
+    Clock::time_point nextLaunch = Clock::now();
+    Attempt *winner = nullptr;
+    bool wasCancelled = false;
+
+    while (!winner) {
+        const auto now = Clock::now();
+        const bool anyActive = std::any_of(attempts.begin(), attempts.end(),
+                                           [](const Attempt &attempt) { return attempt.active(); });
+        // 到了错开的时间，或者进行中的都已失败，就开始下一个
+        if (launched < attempts.size() && (now >= nextLaunch || !anyActive)) {
+            Attempt &attempt = attempts[launched++];
+            attempt.started = now;
+            attempt.state = Attempt::State::Resolving;
+            attempt.resolution = resolveInBackground(attempt.brokerUrl);
+            nextLaunch = now + stagger;
+        }
+
+        for (Attempt &attempt : attempts) {
+            if (attempt.state == Attempt::State::Resolving) {
+                const int state = attempt.resolution->state.load(std::memory_order_acquire);
+                if (state == Resolution::Failed) {
+                    fail(attempt, attempt.resolution->error);
+                    continue;
+                }
+                if (state == Resolution::Resolved) {
+                    try {
+                        attempt.client = AgentClient::createMqttClient(attempt.brokerUrl, clientId);
+                        auto options = AgentClient::connectOptions(attempt.brokerUrl);
+                        const int remainingMs = std::max(1000, config.connectTimeoutMs - elapsedMs(attempt.started, now));
+                        options.set_connect_timeout(std::chrono::milliseconds(remainingMs));
+                        attempt.token = attempt.client->connect(options);
+                        attempt.state = Attempt::State::Connecting;
+                    } catch (const mqtt::exception &e) {
+                        fail(attempt, std::string("connect failed: ") + e.what());
+                        continue;
+                    }
+                }
+            }
+            if (attempt.state == Attempt::State::Connecting) {
+                try {
+                    if (attempt.token->wait_for(std::chrono::milliseconds(0))) {
+                        attempt.state = Attempt::State::Won;
+                        winner = &attempt;
+                        break;
+                    }
+                } catch (const mqtt::exception &e) {
+                    fail(attempt, std::string("connect failed: ") + e.what());
+                    continue;
+                }
+            }
+            if (attempt.active() && elapsedMs(attempt.started, now) > config.connectTimeoutMs) {
+                fail(attempt, "timed out");
+            }
+        }
+
+        if (winner) {
+            break;
+        }
+        const bool finished = launched == attempts.size() &&
+                std::none_of(attempts.begin(), attempts.end(), [](const Attempt &attempt) { return attempt.active(); });
+        if (finished) {
+            break;
+        }
+        if (cancelled && cancelled()) {
+            wasCancelled = true;
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    // 落败的连接可能随后也完成 CONNECT，客户端 ID 相同，在互通的集群上会把胜出的连接挤掉，立即断开
+    for (Attempt &attempt : attempts) {
+        if (&attempt == winner || !attempt.client) {
+            continue;
+        }
+        try {
+            attempt.client->disconnect();
+        } catch (const mqtt::exception &) {
+            // 尚未开始连接或已失败的客户端没有可断开的连接
+        }
+        result.abandoned.push_back(std::move(attempt.client));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(memory.mutex);
+        for (const std::string &url : failedUrls) {
+            BrokerStats &stats = memory.brokers[url];
+            ++stats.failures;
+            ++stats.consecutiveFailures;
+        }
+        if (winner) {
+            BrokerStats &stats = memory.brokers[winner->brokerUrl];
+            const double sample = elapsedMs(winner->started, Clock::now());
+            stats.connectMs = stats.connectMs > 0.0 ? stats.connectMs + kLatencyWeight * (sample - stats.connectMs) : sample;
+            stats.consecutiveFailures = 0;
+            ++stats.wins;
+        }
+        memory.save();
+    }
+
+    if (!winner) {
+        if (!wasCancelled) {
+            qWarning() << "BrokerRace: no broker reachable out of" << attempts.size();
+        }
+        return result;
+    }
+
+    result.connectMs = elapsedMs(winner->started, Clock::now());
+    result.brokerUrl = winner->brokerUrl;
+    result.client = std::move(winner->client);
+    result.token = winner->token;
+    qInfo() << "BrokerRace: connected to" << result.brokerUrl.c_str() << "in" << result.connectMs << "ms,"
+            << launched << "of" << attempts.size() << "brokers tried";
+    return result;
+}
+
+void BrokerRace::recordConnectionLost(const std::string &brokerUrl) {
+    LatencyMemory &memory = LatencyMemory::instance();
+    std::lock_guard<std::mutex> lock(memory.mutex);
+    BrokerStats &stats = memory.brokers[brokerUrl];
+    ++stats.failures;
+    ++stats.consecutiveFailures;
+    memory.save();
+}
+
+void BrokerRace::recordFailover() {
+    LatencyMemory &memory = LatencyMemory::instance();
+    std::lock_guard<std::mutex> lock(memory.mutex);
+    ++memory.failovers;
+}
+
+void BrokerRace::release(std::vector<std::unique_ptr<mqtt::async_client>> &clients) {
+    for (auto &client : clients) {
+        try {
+            if (client->is_connected()) {
+                client->disconnect()->wait_for(std::chrono::seconds(1));
+            }
+        } catch (const mqtt::exception &e) {
+            qWarning() << "BrokerRace: disconnect failed:" << e.what();
+        }
+        client.reset();
+    }
+    clients.clear();
+}
+
+void BrokerRace::exportMetrics(MetricsRecord &record) {
+    LatencyMemory &memory = LatencyMemory::instance();
+    std::lock_guard<std::mutex> lock(memory.mutex);
+    record.add("brokers.races", static_cast<double>(memory.races));
+    record.add("brokers.failovers", static_cast<double>(memory.failovers));
+    for (const auto &[url, stats] : memory.brokers) {
+        const std::string prefix = "brokers." + metricName(url) + ".";
+        record.add(prefix + "connect_ms", stats.connectMs);
+        record.add(prefix + "failures", static_cast<double>(stats.failures));
+        record.add(prefix + "wins", static_cast<double>(stats.wins));
+    }
+}
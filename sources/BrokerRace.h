@@ -0,0 +1,75 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mqtt/async_client.h>
+
+class MetricsRecord;
+
+/**
+ * 多 Broker 连接配置
+ *
+ * 连接配置中的 Broker 地址可以写多个，以逗号、分号或空白分隔，按偏好排列，例如
+ * "ssl://cn-north.example.com:8883, ssl://ap-southeast.example.com:8883"。
+ * 通过环境变量 QUICKSTART_BROKERS 以逗号分隔的选项覆盖：
+ *   stagger_ms=N          相邻两个 Broker 开始连接的间隔，默认 250；前一个失败时立即开始下一个
+ *   connect_timeout_ms=N  单个 Broker 的连接超时（含 DNS 解析），默认 10000
+ *   latency_file=PATH     把每个 Broker 的连接耗时保存到文件，重启后仍按上次的结果排序
+ */
+struct BrokerRaceConfig {
+    int staggerMs = 250;
+    int connectTimeoutMs = 10000;
+    std::string latencyFile;
+
+    static BrokerRaceConfig fromEnvironment();
+};
+
+/** 一次竞速的结果，client 为空表示全部失败或被取消 */
+struct BrokerRaceResult {
+    std::unique_ptr<mqtt::async_client> client;
+    mqtt::token_ptr token;          // 胜出连接的 CONNECT token，用于读取 CONNACK 属性
+    std::string brokerUrl;
+    int connectMs = 0;
+    // 落败与失败的客户端，已发出断开；可能阻塞，由调用方在合适的线程上 release()
+    std::vector<std::unique_ptr<mqtt::async_client>> abandoned;
+};
+
+/**
+ * 多 Broker 连接竞速（happy eyeballs）
+ *
+ * 按记忆的连接耗时排序后依次错开 stagger_ms 开始连接：每个 Broker 先在独立线程上解析地址
+ * （Paho 的所有客户端共用一个发送线程，在其中解析会让一个慢 DNS 拖住其它 Broker），
+ * 解析完成后再由 Paho 建立连接。最先完成 CONNECT 的胜出，其余的立即断开。
+ *
+ * 每个 Broker 的连接耗时（从开始解析到 CONNACK）按指数平均记在进程内，失败与断线计入连续失败次数：
+ * 成功过的 Broker 按平均耗时排在前面，之后是没连过的（保持配置顺序），最后是最近失败的。
+ * 各 Broker 的记录在所有连接（预热、通话、断线切换）之间共享。
+ *
+ * connect() 在调用线程上等待结果，cancelled 返回 true 时提前结束；其余接口线程安全。
+ */
+class BrokerRace {
+public:
+    /** 拆分 Broker 列表，去掉空项与重复项 */
+    static std::vector<std::string> splitList(const std::string &list);
+
+    static BrokerRaceResult connect(const std::vector<std::string> &brokers, const std::string &clientId,
+                                    const BrokerRaceConfig &config,
+                                    const std::function<bool()> &cancelled = nullptr);
+
+    /** 按记忆的连接耗时排列，见类说明 */
+    static std::vector<std::string> order(const std::vector<std::string> &brokers);
+
+    /** 已建立的连接断开：计为一次失败，下次排序时靠后 */
+    static void recordConnectionLost(const std::string &brokerUrl);
+    /** 断线后切换到了另一个 Broker */
+    static void recordFailover();
+
+    /** 断开并释放客户端，每个最多等待 1 秒 */
+    static void release(std::vector<std::unique_ptr<mqtt::async_client>> &clients);
+
+    /** 指标：brokers.races / failovers，brokers.<主机_端口>.connect_ms / failures / wins */
+    static void exportMetrics(MetricsRecord &record);
+};
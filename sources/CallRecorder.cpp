@@ -0,0 +1,931 @@
+#include "CallRecorder.h"
+#include "JpegEncoder.h"
+#include "MetricsExporter.h"
+#include "ThreadPolicy.h"
+#include <QDebug>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+
+// IORING_OP_* 是枚举，以同一内核版本（5.6）引入的 IORING_FEAT_RW_CUR_POS 判断头文件是否带 IORING_OP_WRITE
+#if defined(__NR_io_uring_setup) && defined(IORING_FEAT_RW_CUR_POS)
+#define QUICKSTART_RECORDER_URING 1
+#endif
+
+using namespace RecordingFormat;
+
+namespace {
+
+const char *const kTrackNames[kRecordTypeCount] = {"padding", "mic", "playback", "video", "text"};
+
+uint8_t *allocateAligned(size_t size) {
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, kAlignment, size) != 0) {
+        return nullptr;
+    }
+    std::memset(ptr, 0, size);
+    return static_cast<uint8_t *>(ptr);
+}
+
+int64_t steadyUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t hashStream(const char *streamId) {
+    uint64_t hash = 1469598103934665603ull;
+    for (const char *p = streamId ? streamId : ""; *p; ++p) {
+        hash = (hash ^ static_cast<uint8_t>(*p)) * 1099511628211ull;
+    }
+    return hash | 1;   // 0 表示空槽位
+}
+
+std::string sanitizeFileName(const std::string &text) {
+    std::string out;
+    for (char c : text) {
+        out += (std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_') ? c : '_';
+    }
+    return out.substr(0, 48);
+}
+
+#ifdef QUICKSTART_RECORDER_URING
+/**
+ * 最小的 io_uring 封装：只提交写请求（预注册缓冲用 WRITE_FIXED），由写盘线程独占使用。
+ * 不依赖 liburing，内核不支持或被禁用时 init() 返回 false。
+ */
+class UringQueue {
+public:
+    ~UringQueue() { close(); }
+
+    bool init(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        m_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (m_fd < 0) {
+            return false;
+        }
+        m_entries = params.sq_entries;
+        m_sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        m_cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMmap) {
+            m_sqSize = m_cqSize = std::max(m_sqSize, m_cqSize);
+        }
+        m_sq = mmap(nullptr, m_sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+        if (m_sq == MAP_FAILED) {
+            m_sq = nullptr;
+            close();
+            return false;
+        }
+        if (singleMmap) {
+            m_cq = m_sq;
+        } else {
+            m_cq = mmap(nullptr, m_cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+            if (m_cq == MAP_FAILED) {
+                m_cq = nullptr;
+                close();
+                return false;
+            }
+        }
+        m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void *sqes = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            close();
+            return false;
+        }
+        m_sqes = static_cast<io_uring_sqe *>(sqes);
+
+        auto *sq = static_cast<uint8_t *>(m_sq);
+        auto *cq = static_cast<uint8_t *>(m_cq);
+        m_sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+        m_sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        m_sqMask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        m_sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        m_cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        m_cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        m_cqMask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    /** 注册固定缓冲，失败（如 RLIMIT_MEMLOCK 不足）时改用普通 WRITE */
+    bool registerBuffers(const iovec *buffers, unsigned count) {
+        m_fixed = syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_BUFFERS, buffers, count) == 0;
+        return m_fixed;
+    }
+
+    bool submitWrite(int fd, int bufferIndex, const void *data, unsigned size, uint64_t offset, uint64_t userData) {
+        const unsigned tail = *m_sqTail;
+        const unsigned head = __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+        if (tail - head >= m_entries) {
+            return false;
+        }
+        const unsigned index = tail & *m_sqMask;
+        io_uring_sqe *sqe = &m_sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+#ifdef IORING_OP_WRITE
+        sqe->opcode = m_fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+#else
+        if (!m_fixed) return false;
+        sqe->opcode = IORING_OP_WRITE_FIXED;
+#endif
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(data);
+        sqe->len = size;
+        sqe->off = offset;
+        sqe->buf_index = m_fixed ? static_cast<uint16_t>(bufferIndex) : 0;
+        sqe->user_data = userData;
+        m_sqArray[index] = index;
+        __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+
+        for (;;) {
+            const long submitted = syscall(__NR_io_uring_enter, m_fd, 1, 0, 0, nullptr, 0);
+            if (submitted >= 0) return submitted == 1;
+            if (errno != EINTR) return false;
+        }
+    }
+
+    /** 阻塞直到取到一个完成事件 */
+    bool waitCompletion(uint64_t &userData, int &result) {
+        for (;;) {
+            const unsigned head = *m_cqHead;
+            const unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+            if (head != tail) {
+                const io_uring_cqe &cqe = m_cqes[head & *m_cqMask];
+                userData = cqe.user_data;
+                result = cqe.res;
+                __atomic_store_n(m_cqHead, head + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+            if (syscall(__NR_io_uring_enter, m_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR) {
+                return false;
+            }
+        }
+    }
+
+private:
+    void close() {
+        if (m_sqes) munmap(m_sqes, m_sqesSize);
+        if (m_cq && m_cq != m_sq) munmap(m_cq, m_cqSize);
+        if (m_sq) munmap(m_sq, m_sqSize);
+        if (m_fd >= 0) ::close(m_fd);
+        m_sqes = nullptr;
+        m_cq = m_sq = nullptr;
+        m_fd = -1;
+    }
+
+    int m_fd = -1;
+    unsigned m_entries = 0;
+    bool m_fixed = false;
+    void *m_sq = nullptr;
+    void *m_cq = nullptr;
+    size_t m_sqSize = 0;
+    size_t m_cqSize = 0;
+    size_t m_sqesSize = 0;
+    io_uring_sqe *m_sqes = nullptr;
+    unsigned *m_sqHead = nullptr;
+    unsigned *m_sqTail = nullptr;
+    unsigned *m_sqMask = nullptr;
+    unsigned *m_sqArray = nullptr;
+    unsigned *m_cqHead = nullptr;
+    unsigned *m_cqTail = nullptr;
+    unsigned *m_cqMask = nullptr;
+    io_uring_cqe *m_cqes = nullptr;
+};
+#endif
+
+} // namespace
+
+RecorderConfig RecorderConfig::fromEnvironment() {
+    RecorderConfig config;
+    const char *value = std::getenv("QUICKSTART_RECORD");
+    if (!value) {
+        return config;
+    }
+
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.compare(0, 4, "dir=") == 0) config.directory = item.substr(4);
+        else if (item.compare(0, 7, "tracks=") == 0) {
+            const std::string tracks = "+" + item.substr(7) + "+";
+            config.mic = tracks.find("+mic+") != std::string::npos;
+            config.playback = tracks.find("+playback+") != std::string::npos;
+            config.video = tracks.find("+video+") != std::string::npos;
+            config.text = tracks.find("+text+") != std::string::npos;
+        }
+        else if (item == "video=all") config.localVideo = config.remoteVideo = true;
+        else if (item == "video=local") { config.localVideo = true; config.remoteVideo = false; }
+        else if (item == "video=remote") { config.localVideo = false; config.remoteVideo = true; }
+        else if (item.compare(0, 10, "video_fps=") == 0) config.videoFps = std::atoi(item.c_str() + 10);
+        else if (item == "video_codec=jpeg") config.videoJpeg = true;
+        else if (item == "video_codec=raw") config.videoJpeg = false;
+        else if (item.compare(0, 8, "quality=") == 0) config.jpegQuality = std::atoi(item.c_str() + 8);
+        else if (item.compare(0, 7, "blocks=") == 0) config.blocks = std::atoi(item.c_str() + 7);
+        else if (item.compare(0, 9, "block_kb=") == 0) config.blockKb = std::atoi(item.c_str() + 9);
+        else if (item.compare(0, 9, "write_kb=") == 0) config.writeKb = std::atoi(item.c_str() + 9);
+        else if (item.compare(0, 9, "flush_ms=") == 0) config.flushMs = std::atoi(item.c_str() + 9);
+        else if (item == "direct") config.direct = true;
+        else if (item == "no_uring") config.uring = false;
+        else if (!item.empty()) qWarning() << "QUICKSTART_RECORD: unknown option" << item.c_str();
+    }
+
+    config.videoFps = std::max(1, std::min(config.videoFps, 60));
+    config.jpegQuality = std::max(1, std::min(config.jpegQuality, 100));
+    config.blocks = std::max(4, std::min(config.blocks, 1024));
+    config.blockKb = std::max(64, std::min(config.blockKb, 64 * 1024));
+    config.writeKb = std::max(64, std::min(config.writeKb, 16 * 1024)) / 4 * 4;
+    config.flushMs = std::max(10, config.flushMs);
+    return config;
+}
+
+// ── 写盘线程 ─────────────────────────────────────────────────────
+
+struct CallRecorder::Writer {
+    static constexpr int kBuffers = 2;
+
+    explicit Writer(const RecorderConfig &config)
+            : unitSize(static_cast<size_t>(config.writeKb) * 1024),
+              jpegQuality(config.jpegQuality),
+              encodeJpeg(config.videoJpeg) {
+        for (int i = 0; i < kBuffers; ++i) {
+            buffers[i] = allocateAligned(unitSize);
+        }
+#ifdef QUICKSTART_RECORDER_URING
+        if (config.uring && ring.init(4)) {
+            iovec iov[kBuffers];
+            for (int i = 0; i < kBuffers; ++i) {
+                iov[i].iov_base = buffers[i];
+                iov[i].iov_len = unitSize;
+            }
+            ring.registerBuffers(iov, kBuffers);
+            useUring = true;
+        }
+#endif
+    }
+
+    ~Writer() {
+        for (uint8_t *buffer : buffers) {
+            std::free(buffer);
+        }
+    }
+
+    bool valid() const { return buffers[0] && buffers[1]; }
+
+    void open(int file, const RecordingFileHeader &header) {
+        fd = file;
+        current = 0;
+        fill = 0;
+        fileOffset = 0;
+        failed = false;
+        unitIndexed = false;
+        index.clear();
+        std::memset(buffers[0], 0, kHeaderSize);
+        std::memcpy(buffers[0], &header, sizeof(header));
+        fill = kHeaderSize;
+        if (fill == unitSize) {
+            flushBuffer(fill);
+        }
+    }
+
+    /** 一条记录的开始，当前写盘块还没有索引项时登记 */
+    void beginRecord(int64_t timestampUs) {
+        if (!unitIndexed) {
+            index.push_back({timestampUs, fileOffset + fill});
+            unitIndexed = true;
+        }
+    }
+
+    void append(const void *data, size_t size) {
+        auto *src = static_cast<const uint8_t *>(data);
+        while (size > 0) {
+            const size_t n = std::min(size, unitSize - fill);
+            if (src) {
+                std::memcpy(buffers[current] + fill, src, n);
+                src += n;
+            } else {
+                std::memset(buffers[current] + fill, 0, n);
+            }
+            fill += n;
+            size -= n;
+            if (fill == unitSize) {
+                flushBuffer(fill);
+            }
+        }
+    }
+
+    void appendRecord(RecordType type, int64_t timestampUs, const void *payload, size_t size) {
+        RecordHeader header{};
+        header.size = static_cast<uint32_t>(size);
+        header.type = type;
+        header.timestampUs = timestampUs;
+        beginRecord(timestampUs);
+        append(&header, sizeof(header));
+        append(payload, size);
+        append(nullptr, alignRecord(size) - size);
+    }
+
+    /** 把当前缓冲的前 size 字节（4 KiB 的倍数）写到 fileOffset，然后切换到另一块 */
+    void flushBuffer(size_t size) {
+        if (size == 0) return;
+        if (!failed) {
+            bool submitted = false;
+#ifdef QUICKSTART_RECORDER_URING
+            if (useUring) {
+                pending[current] = {fileOffset, size, steadyUs()};
+                submitted = ring.submitWrite(fd, current, buffers[current], static_cast<unsigned>(size),
+                                             fileOffset, static_cast<uint64_t>(current));
+                inFlight[current] = submitted;
+            }
+#endif
+            if (!submitted) {
+                const int64_t begin = steadyUs();
+                writeSync(buffers[current], size, fileOffset);
+                noteLatency(steadyUs() - begin);
+            }
+        }
+        fileOffset += size;
+        current ^= 1;
+        fill = 0;
+        unitIndexed = false;
+        reap(current);
+    }
+
+    /** 等待 buffer 上的异步写完成，之后才能复用 */
+    void reap(int buffer) {
+#ifdef QUICKSTART_RECORDER_URING
+        while (inFlight[buffer]) {
+            uint64_t userData = 0;
+            int result = 0;
+            if (!ring.waitCompletion(userData, result)) {
+                // 取不到完成事件时不能确定数据是否写出，两块都按同步方式重写
+                useUring = false;
+                for (int i = 0; i < kBuffers; ++i) {
+                    if (inFlight[i]) {
+                        inFlight[i] = false;
+                        writeSync(buffers[i], pending[i].size, pending[i].offset);
+                    }
+                }
+                return;
+            }
+            const int done = static_cast<int>(userData);
+            if (done < 0 || done >= kBuffers || !inFlight[done]) continue;
+            inFlight[done] = false;
+            const Pending &write = pending[done];
+            if (result < 0) {
+                // 内核不支持该写操作（旧内核）等：本块改为同步写，之后不再使用 io_uring
+                if (result == -EINVAL || result == -EOPNOTSUPP) {
+                    useUring = false;
+                    writeSync(buffers[done], write.size, write.offset);
+                } else {
+                    fail(-result);
+                }
+            } else if (static_cast<size_t>(result) < write.size) {
+                bytesWritten += static_cast<uint64_t>(result);
+                writeSync(buffers[done] + result, write.size - result, write.offset + result);
+            } else {
+                bytesWritten += write.size;
+            }
+            noteLatency(steadyUs() - write.submittedUs);
+        }
+#else
+        (void)buffer;
+#endif
+    }
+
+    void writeSync(const uint8_t *data, size_t size, uint64_t offset) {
+        while (size > 0 && !failed) {
+            const ssize_t n = pwrite(fd, data, size, static_cast<off_t>(offset));
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                fail(errno);
+                return;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+            offset += static_cast<uint64_t>(n);
+            bytesWritten += static_cast<uint64_t>(n);
+        }
+    }
+
+    void fail(int error) {
+        if (!failed) {
+            qWarning() << "CallRecorder: write failed:" << strerror(error);
+        }
+        failed = true;
+        ++writeErrors;
+    }
+
+    void noteLatency(int64_t us) {
+        maxWriteUs = std::max(maxWriteUs, us);
+    }
+
+    /** 数据区补齐到 4 KiB，写出索引与文件尾，等待全部写完 */
+    void finish() {
+        const uint64_t position = fileOffset + fill;
+        uint64_t dataEnd = alignBlock(position);
+        if (dataEnd != position && dataEnd - position < sizeof(RecordHeader)) {
+            dataEnd += kAlignment;
+        }
+        if (dataEnd != position) {
+            RecordHeader padding{};
+            padding.type = RecordType::Padding;
+            padding.size = static_cast<uint32_t>(dataEnd - position - sizeof(RecordHeader));
+            append(&padding, sizeof(padding));
+            append(nullptr, padding.size);
+        }
+
+        const size_t indexBytes = index.size() * sizeof(RecordingIndexEntry);
+        const size_t tailBytes = alignBlock(indexBytes + sizeof(RecordingFileFooter));
+        append(index.data(), indexBytes);
+        append(nullptr, tailBytes - indexBytes - sizeof(RecordingFileFooter));
+        RecordingFileFooter footer{};
+        std::memcpy(footer.magic, kFooterMagic, sizeof(footer.magic));
+        footer.indexOffset = dataEnd;
+        footer.indexCount = index.size();
+        footer.dataEnd = dataEnd;
+        append(&footer, sizeof(footer));
+
+        flushBuffer(fill);
+        for (int i = 0; i < kBuffers; ++i) {
+            reap(i);
+        }
+        if (!failed) {
+            fdatasync(fd);
+        }
+    }
+
+    struct Pending {
+        uint64_t offset = 0;
+        size_t size = 0;
+        int64_t submittedUs = 0;
+    };
+
+    const size_t unitSize;
+    const int jpegQuality;
+    const bool encodeJpeg;
+    uint8_t *buffers[kBuffers] = {nullptr, nullptr};
+    bool inFlight[kBuffers] = {false, false};
+    Pending pending[kBuffers];
+    int current = 0;
+    size_t fill = 0;
+    uint64_t fileOffset = 0;
+    bool unitIndexed = false;
+    bool failed = false;
+    int fd = -1;
+    bool useUring = false;
+#ifdef QUICKSTART_RECORDER_URING
+    UringQueue ring;
+#endif
+    std::vector<RecordingIndexEntry> index;
+    JpegEncoder jpeg;
+    std::vector<uint8_t> encoded;
+    std::vector<uint8_t> videoPayload;
+
+    // 写盘线程上累计，由 writerLoop 转存到 CallRecorder 的原子计数
+    uint64_t bytesWritten = 0;
+    uint64_t writeErrors = 0;
+    int64_t maxWriteUs = 0;
+};
+
+// ── 录制 ─────────────────────────────────────────────────────────
+
+CallRecorder::CallRecorder(const RecorderConfig &config)
+        : m_config(config),
+          m_blockSize(static_cast<size_t>(config.blockKb) * 1024),
+          m_blocks(new Block[config.blocks]),
+          m_next(new std::atomic<uint32_t>[config.blocks]),
+          m_filled(config.blocks),
+          // 留 10% 余量，源帧率恰为 video_fps 时不会因抖动隔帧丢弃
+          m_videoIntervalUs(900000 / config.videoFps),
+          m_writer(new Writer(config)) {
+    for (int i = 0; i < config.blocks; ++i) {
+        m_blocks[i].data = allocateAligned(m_blockSize);
+        if (m_blocks[i].data) {
+            pushFree(static_cast<uint32_t>(i));
+        }
+    }
+    m_minFree.store(m_freeCount.load());
+    qInfo() << "CallRecorder:" << m_freeCount.load() << "x" << config.blockKb << "KiB blocks,"
+            << (m_writer->useUring ? "io_uring" : "pwrite") << "writer";
+}
+
+CallRecorder::~CallRecorder() {
+    stop();
+    for (int i = 0; i < m_config.blocks; ++i) {
+        std::free(m_blocks[i].data);
+    }
+}
+
+std::string CallRecorder::filePath() const {
+    std::lock_guard<std::mutex> lock(m_pathMutex);
+    return m_filePath;
+}
+
+bool CallRecorder::start(const std::string &roomId) {
+    if (m_recording.load() || m_thread.joinable() || !m_writer->valid()) {
+        return false;
+    }
+
+    const std::time_t now = std::time(nullptr);
+    std::tm local{};
+    localtime_r(&now, &local);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &local);
+    const std::string path = m_config.directory + "/call-" + stamp + "-" + sanitizeFileName(roomId) + ".qsrec";
+
+    mkdir(m_config.directory.c_str(), 0755);
+    int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    int fd = -1;
+    if (m_config.direct) {
+        // tmpfs 等不支持 O_DIRECT 的文件系统上退回普通写入
+        fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+    }
+    if (fd < 0) {
+        fd = ::open(path.c_str(), flags, 0644);
+    }
+    if (fd < 0) {
+        qWarning() << "CallRecorder: cannot open" << path.c_str() << strerror(errno);
+        return false;
+    }
+
+    RecordingFileHeader header{};
+    std::memcpy(header.magic, kFileMagic, sizeof(header.magic));
+    header.version = 1;
+    header.headerSize = kHeaderSize;
+    header.startUnixMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    std::snprintf(header.roomId, sizeof(header.roomId), "%s", roomId.c_str());
+    m_writer->open(fd, header);
+
+    m_micLane = Lane();
+    m_playbackLane = Lane();
+    m_textLane = Lane();
+    for (VideoStream &stream : m_videoStreams) {
+        stream.key.store(0, std::memory_order_relaxed);
+        stream.lastUs.store(0, std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_pathMutex);
+        m_filePath = path;
+    }
+
+    m_startTime = std::chrono::steady_clock::now();
+    m_stopping.store(false);
+    m_thread = std::thread(&CallRecorder::writerLoop, this);
+    m_recording.store(true, std::memory_order_release);
+    qInfo() << "CallRecorder: recording to" << path.c_str();
+    return true;
+}
+
+void CallRecorder::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_textMutex);
+        if (!m_recording.exchange(false)) {
+            return;
+        }
+        flushLane(m_textLane);
+    }
+    // 观察者已移除，音频回调不会再访问各自的当前块
+    flushLane(m_micLane);
+    flushLane(m_playbackLane);
+
+    m_stopping.store(true);
+    wakeWriter();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    ::close(m_writer->fd);
+    m_writer->fd = -1;
+    qInfo() << "CallRecorder: finished" << filePath().c_str();
+}
+
+int64_t CallRecorder::nowUs() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_startTime).count();
+}
+
+// ── 空闲块栈与提交 ───────────────────────────────────────────────
+
+uint32_t CallRecorder::popFree() {
+    uint64_t head = m_freeHead.load(std::memory_order_acquire);
+    for (;;) {
+        const uint32_t top = static_cast<uint32_t>(head);
+        if (top == 0) {
+            return kNoBlock;
+        }
+        const uint32_t next = m_next[top - 1].load(std::memory_order_relaxed);
+        const uint64_t replacement = (((head >> 32) + 1) << 32) | next;
+        if (m_freeHead.compare_exchange_weak(head, replacement, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            const int remaining = m_freeCount.fetch_sub(1, std::memory_order_relaxed) - 1;
+            int low = m_minFree.load(std::memory_order_relaxed);
+            while (remaining < low && !m_minFree.compare_exchange_weak(low, remaining, std::memory_order_relaxed)) {
+            }
+            m_blocks[top - 1].used = 0;
+            return top - 1;
+        }
+    }
+}
+
+void CallRecorder::pushFree(uint32_t index) {
+    uint64_t head = m_freeHead.load(std::memory_order_relaxed);
+    uint64_t replacement;
+    do {
+        m_next[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        replacement = (((head >> 32) + 1) << 32) | (index + 1);
+    } while (!m_freeHead.compare_exchange_weak(head, replacement, std::memory_order_release, std::memory_order_relaxed));
+    m_freeCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CallRecorder::submit(uint32_t index) {
+    // 队列容量不小于块数，不会满
+    m_filled.push(std::move(index));
+    wakeWriter();
+}
+
+void CallRecorder::wakeWriter() {
+    m_wakeSeq.fetch_add(1);
+    if (m_writerWaiting.load()) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_wakeSeq), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    }
+}
+
+uint8_t *CallRecorder::reserve(Lane &lane, RecordType type, int64_t timestampUs, size_t payloadSize) {
+    const size_t total = alignRecord(sizeof(RecordHeader) + payloadSize);
+    if (total > m_blockSize) {
+        m_tooLarge.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    if (lane.block != kNoBlock) {
+        const Block &block = m_blocks[lane.block];
+        if (block.used + total > m_blockSize || timestampUs - lane.openedUs >= m_config.flushMs * 1000LL) {
+            flushLane(lane);
+        }
+    }
+    if (lane.block == kNoBlock) {
+        lane.block = popFree();
+        if (lane.block == kNoBlock) {
+            m_dropped[static_cast<int>(type)].fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        lane.openedUs = timestampUs;
+    }
+
+    Block &block = m_blocks[lane.block];
+    RecordHeader header{};
+    header.size = static_cast<uint32_t>(payloadSize);
+    header.type = type;
+    header.timestampUs = timestampUs;
+    std::memcpy(block.data + block.used, &header, sizeof(header));
+    uint8_t *payload = block.data + block.used + sizeof(header);
+    block.used += total;
+    m_records[static_cast<int>(type)].fetch_add(1, std::memory_order_relaxed);
+    return payload;
+}
+
+void CallRecorder::flushLane(Lane &lane) {
+    if (lane.block != kNoBlock) {
+        submit(lane.block);
+        lane.block = kNoBlock;
+    }
+}
+
+// ── 回调 ─────────────────────────────────────────────────────────
+
+void CallRecorder::onRecordAudioFrame(const RtcAudioFrame &frame) {
+    if (m_config.mic && m_recording.load(std::memory_order_acquire)) {
+        recordAudio(m_micLane, RecordType::MicAudio, frame);
+    }
+}
+
+void CallRecorder::onPlaybackAudioFrame(const RtcAudioFrame &frame) {
+    if (m_config.playback && m_recording.load(std::memory_order_acquire)) {
+        recordAudio(m_playbackLane, RecordType::PlaybackAudio, frame);
+    }
+}
+
+void CallRecorder::recordAudio(Lane &lane, RecordType type, const RtcAudioFrame &frame) {
+    if (!frame.data || frame.samplesPerChannel <= 0 || frame.channels <= 0) {
+        return;
+    }
+    const size_t pcmBytes = static_cast<size_t>(frame.samplesPerChannel) * frame.channels * sizeof(int16_t);
+    uint8_t *payload = reserve(lane, type, nowUs(), sizeof(AudioHeader) + pcmBytes);
+    if (!payload) {
+        return;
+    }
+    AudioHeader header{};
+    header.sampleRate = static_cast<uint32_t>(frame.sampleRate);
+    header.channels = static_cast<uint16_t>(frame.channels);
+    std::memcpy(payload, &header, sizeof(header));
+    std::memcpy(payload + sizeof(header), frame.data, pcmBytes);
+}
+
+void CallRecorder::onLocalVideoFrame(const RtcVideoFrame &frame) {
+    if (m_config.video && m_config.localVideo && m_recording.load(std::memory_order_acquire)) {
+        recordVideo("", false, frame);
+    }
+}
+
+void CallRecorder::onRemoteVideoFrame(const char *streamId, const char *, const RtcVideoFrame &frame) {
+    if (m_config.video && m_config.remoteVideo && m_recording.load(std::memory_order_acquire)) {
+        recordVideo(streamId ? streamId : "", true, frame);
+    }
+}
+
+bool CallRecorder::admitVideo(const char *streamId, int64_t timestampUs) {
+    const uint64_t key = hashStream(streamId);
+    for (VideoStream &stream : m_videoStreams) {
+        uint64_t current = stream.key.load(std::memory_order_acquire);
+        if (current == 0 && stream.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+            current = key;
+        }
+        if (current != key) continue;
+        const int64_t last = stream.lastUs.load(std::memory_order_relaxed);
+        if (last != 0 && timestampUs - last < m_videoIntervalUs) {
+            return false;
+        }
+        stream.lastUs.store(timestampUs, std::memory_order_relaxed);
+        return true;
+    }
+    return true;   // 流超过上限时不限帧率
+}
+
+void CallRecorder::recordVideo(const char *streamId, bool remote, const RtcVideoFrame &frame) {
+    if (frame.format != RtcPixelFormat::I420 || frame.width <= 0 || frame.height <= 0) {
+        return;
+    }
+    const int64_t timestampUs = nowUs();
+    if (!admitVideo(streamId, timestampUs)) {
+        return;
+    }
+
+    const size_t streamIdSize = std::min<size_t>(std::strlen(streamId), UINT16_MAX);
+    const int chromaWidth = (frame.width + 1) / 2;
+    const int chromaHeight = (frame.height + 1) / 2;
+    const size_t frameBytes = static_cast<size_t>(frame.width) * frame.height
+                            + static_cast<size_t>(chromaWidth) * chromaHeight * 2;
+
+    // 每帧独占一块，可能有多个 SDK 线程同时回调
+    Lane lane;
+    uint8_t *payload = reserve(lane, RecordType::Video, timestampUs, sizeof(VideoHeader) + streamIdSize + frameBytes);
+    if (!payload) {
+        return;
+    }
+    VideoHeader header{};
+    header.width = static_cast<uint32_t>(frame.width);
+    header.height = static_cast<uint32_t>(frame.height);
+    header.codec = VideoCodec::I420;
+    header.streamIdSize = static_cast<uint16_t>(streamIdSize);
+    header.remote = remote ? 1 : 0;
+    std::memcpy(payload, &header, sizeof(header));
+    std::memcpy(payload + sizeof(header), streamId, streamIdSize);
+
+    uint8_t *dst = payload + sizeof(header) + streamIdSize;
+    const int widths[3] = {frame.width, chromaWidth, chromaWidth};
+    const int heights[3] = {frame.height, chromaHeight, chromaHeight};
+    for (int plane = 0; plane < 3; ++plane) {
+        const uint8_t *src = frame.planes[plane];
+        for (int row = 0; row < heights[plane]; ++row) {
+            std::memcpy(dst, src + static_cast<size_t>(row) * frame.strides[plane], widths[plane]);
+            dst += widths[plane];
+        }
+    }
+    flushLane(lane);
+}
+
+void CallRecorder::recordText(TextKind kind, const std::string &text) {
+    if (!m_config.text) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_textMutex);
+    if (!m_recording.load(std::memory_order_acquire)) {
+        return;
+    }
+    uint8_t *payload = reserve(m_textLane, RecordType::Text, nowUs(), sizeof(TextHeader) + text.size());
+    if (!payload) {
+        return;
+    }
+    TextHeader header{kind};
+    std::memcpy(payload, &header, sizeof(header));
+    std::memcpy(payload + sizeof(header), text.data(), text.size());
+}
+
+// ── 写盘线程 ─────────────────────────────────────────────────────
+
+void CallRecorder::writerLoop() {
+    ThreadPolicy::registerCurrentThread(ThreadClass::Background, "recorder");
+    Writer &writer = *m_writer;
+    uint64_t reportedBytes = 0;
+    uint64_t reportedErrors = 0;
+
+    auto processBlock = [&](uint32_t index) {
+        const Block &block = m_blocks[index];
+        size_t offset = 0;
+        while (offset + sizeof(RecordHeader) <= block.used) {
+            RecordHeader header;
+            std::memcpy(&header, block.data + offset, sizeof(header));
+            const uint8_t *payload = block.data + offset + sizeof(header);
+            offset += alignRecord(sizeof(header) + header.size);
+
+            if (writer.failed) {
+                m_dropped[static_cast<int>(header.type)].fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            if (header.type == RecordType::Video && writer.encodeJpeg) {
+                VideoHeader video;
+                std::memcpy(&video, payload, sizeof(video));
+                const uint8_t *streamId = payload + sizeof(video);
+                const uint8_t *planes = streamId + video.streamIdSize;
+                const int width = static_cast<int>(video.width);
+                const int height = static_cast<int>(video.height);
+                ImageScale::I420Image image;
+                image.width = width;
+                image.height = height;
+                image.planes[0] = planes;
+                image.planes[1] = planes + static_cast<size_t>(width) * height;
+                image.planes[2] = image.planes[1] + static_cast<size_t>(width / 2) * (height / 2);
+                image.strides[0] = width;
+                image.strides[1] = image.strides[2] = width / 2;
+                // 奇数宽高的帧保留原始数据
+                if (width % 2 == 0 && height % 2 == 0 && writer.jpeg.encode(image, writer.jpegQuality, writer.encoded)) {
+                    video.codec = VideoCodec::Jpeg;
+                    writer.videoPayload.resize(sizeof(video) + video.streamIdSize + writer.encoded.size());
+                    std::memcpy(writer.videoPayload.data(), &video, sizeof(video));
+                    std::memcpy(writer.videoPayload.data() + sizeof(video), streamId, video.streamIdSize);
+                    std::memcpy(writer.videoPayload.data() + sizeof(video) + video.streamIdSize,
+                                writer.encoded.data(), writer.encoded.size());
+                    writer.appendRecord(RecordType::Video, header.timestampUs,
+                                        writer.videoPayload.data(), writer.videoPayload.size());
+                    continue;
+                }
+            }
+            writer.appendRecord(header.type, header.timestampUs, payload, header.size);
+        }
+    };
+
+    for (;;) {
+        const uint32_t seq = m_wakeSeq.load();
+        const int consumed = m_filled.consume([&](uint32_t index) {
+            processBlock(index);
+            pushFree(index);
+        }, m_config.blocks);
+
+        m_bytesWritten.fetch_add(writer.bytesWritten - reportedBytes, std::memory_order_relaxed);
+        m_writeErrors.fetch_add(writer.writeErrors - reportedErrors, std::memory_order_relaxed);
+        reportedBytes = writer.bytesWritten;
+        reportedErrors = writer.writeErrors;
+        int64_t maxUs = m_maxWriteUs.load(std::memory_order_relaxed);
+        while (writer.maxWriteUs > maxUs
+               && !m_maxWriteUs.compare_exchange_weak(maxUs, writer.maxWriteUs, std::memory_order_relaxed)) {
+        }
+        writer.maxWriteUs = 0;
+
+        if (consumed > 0) continue;
+        if (m_stopping.load() && m_filled.size() == 0) break;
+
+        // 与 AudioTap 相同：先登记等待再比较序号，不会错过唤醒
+        m_writerWaiting.store(1);
+        struct timespec ts = {0, 100 * 1000 * 1000};
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_wakeSeq), FUTEX_WAIT_PRIVATE, seq, &ts, nullptr, 0);
+        m_writerWaiting.store(0);
+    }
+
+    writer.finish();
+    m_bytesWritten.fetch_add(writer.bytesWritten - reportedBytes, std::memory_order_relaxed);
+    m_writeErrors.fetch_add(writer.writeErrors - reportedErrors, std::memory_order_relaxed);
+    writer.bytesWritten = 0;
+    writer.writeErrors = 0;
+}
+
+void CallRecorder::exportMetrics(MetricsRecord &record) {
+    record.add("recorder.recording", recording() ? 1.0 : 0.0);
+    record.add("recorder.bytes_written", static_cast<double>(m_bytesWritten.load(std::memory_order_relaxed)));
+    for (int type = 1; type < kRecordTypeCount; ++type) {
+        const std::string track = kTrackNames[type];
+        record.add("recorder.records." + track, static_cast<double>(m_records[type].load(std::memory_order_relaxed)));
+        record.add("recorder.dropped." + track, static_cast<double>(m_dropped[type].load(std::memory_order_relaxed)));
+    }
+    record.add("recorder.too_large", static_cast<double>(m_tooLarge.load(std::memory_order_relaxed)));
+    record.add("recorder.write_errors", static_cast<double>(m_writeErrors.load(std::memory_order_relaxed)));
+
+    // 块占用取当前值与上次导出以来的峰值，峰值接近 blocks 说明磁盘跟不上
+    const int freeBlocks = m_freeCount.load(std::memory_order_relaxed);
+    const int minFree = m_minFree.exchange(freeBlocks, std::memory_order_relaxed);
+    record.add("recorder.blocks_in_use", m_config.blocks - freeBlocks);
+    record.add("recorder.max_blocks_in_use", m_config.blocks - std::min(minFree, freeBlocks));
+    record.add("recorder.max_write_ms", m_maxWriteUs.exchange(0, std::memory_order_relaxed) / 1000.0);
+}
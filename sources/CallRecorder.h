@@ -0,0 +1,171 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MpscEventQueue.h"
+#include "RecordingFormat.h"
+#include "RtcBackend.h"
+
+class MetricsRecord;
+
+/**
+ * 通话录制配置
+ *
+ * 通过环境变量 QUICKSTART_RECORD 以逗号分隔的选项开启：
+ *   dir=PATH          录制文件目录，每次通话一个 call-<时间>-<房间>.qsrec，不指定则不录制
+ *   tracks=LIST       录制的轨道，以 + 分隔：mic、playback、video、text，默认全部
+ *   video=SOURCE      录制的画面：all（默认）、local、remote
+ *   video_fps=N       每路画面的最大录制帧率，默认 5
+ *   video_codec=C     jpeg（默认，在写盘线程上编码）或 raw（原始 I420）
+ *   quality=N         JPEG 质量，默认 70
+ *   blocks=N          预分配的缓冲块数，默认 32
+ *   block_kb=N        缓冲块大小，默认 2048，超过的单帧画面被丢弃
+ *   write_kb=N        每次写盘的大小（4 KiB 的倍数），默认 1024
+ *   flush_ms=N        音频与文本块最长攒多久交给写盘线程，默认 200
+ *   direct            以 O_DIRECT 打开文件，不经过页缓存
+ *   no_uring          不使用 io_uring，写盘线程直接 pwrite
+ * 例如：QUICKSTART_RECORD=dir=/data/calls,tracks=mic+playback+text
+ */
+struct RecorderConfig {
+    std::string directory;
+    bool mic = true;
+    bool playback = true;
+    bool video = true;
+    bool text = true;
+    bool localVideo = true;
+    bool remoteVideo = true;
+    int videoFps = 5;
+    bool videoJpeg = true;
+    int jpegQuality = 70;
+    int blocks = 32;
+    int blockKb = 2048;
+    int writeKb = 1024;
+    int flushMs = 200;
+    bool direct = false;
+    bool uring = true;
+
+    bool enabled() const { return !directory.empty(); }
+
+    static RecorderConfig fromEnvironment();
+};
+
+/**
+ * 通话录制
+ *
+ * 作为音视频帧观察者注册到引擎，并由界面线程送入对话文本，把麦克风与播放 PCM、视频帧和文本
+ * 以共同的时间轴写入一个可按时间定位的录制文件（格式见 RecordingFormat.h）。
+ *
+ * 回调路径只做一次拷贝：记录直接序列化进构造时预分配的缓冲块，不加锁、不分配内存、不做 I/O。
+ * 麦克风、播放与文本各有一个当前块，攒满或超过 flush_ms 后交给写盘线程；每帧画面独占一块
+ * （可能来自多个 SDK 线程）。空闲块放在无锁栈上，拿不到空闲块（磁盘跟不上）或单帧超过 block_kb 时
+ * 丢弃该记录并按轨道计数，不阻塞回调。
+ *
+ * 唯一的写盘线程把记录拷入两块 4 KiB 对齐的写盘缓冲，凑满 write_kb 后整块写出：
+ * 内核支持时通过 io_uring 以预注册缓冲异步写入，写一块的同时填另一块；否则退回 pwrite。
+ * 视频按配置在写盘线程上编码为 JPEG。结束时补写索引与文件尾。
+ *
+ * 生命周期：start() → 注册观察者 → ... → 移除观察者 → stop()；
+ * recordText() 可在任意时刻调用，未在录制时直接返回。对象可跨通话复用，计数累计。
+ */
+class CallRecorder : public IRtcVideoFrameObserver, public IRtcAudioFrameObserver {
+public:
+    explicit CallRecorder(const RecorderConfig &config);
+    ~CallRecorder() override;
+
+    CallRecorder(const CallRecorder &) = delete;
+    CallRecorder &operator=(const CallRecorder &) = delete;
+
+    const RecorderConfig &config() const { return m_config; }
+
+    /** 在配置的目录下新建录制文件并启动写盘线程，失败时返回 false */
+    bool start(const std::string &roomId);
+    /** 交出各轨道未满的块，等待写盘线程写完并补写索引 */
+    void stop();
+    bool recording() const { return m_recording.load(std::memory_order_acquire); }
+    /** 最近一次 start() 的文件路径 */
+    std::string filePath() const;
+
+    void onLocalVideoFrame(const RtcVideoFrame &frame) override;
+    void onRemoteVideoFrame(const char *streamId, const char *userId, const RtcVideoFrame &frame) override;
+    void onRecordAudioFrame(const RtcAudioFrame &frame) override;
+    void onPlaybackAudioFrame(const RtcAudioFrame &frame) override;
+
+    void recordText(RecordingFormat::TextKind kind, const std::string &text);
+
+    /** 指标：recorder.bytes_written / records.* / dropped.* / blocks_in_use / max_write_ms 等 */
+    void exportMetrics(MetricsRecord &record);
+
+private:
+    static constexpr uint32_t kNoBlock = UINT32_MAX;
+    static constexpr int kMaxVideoStreams = 16;
+
+    struct Block {
+        uint8_t *data = nullptr;
+        size_t used = 0;
+    };
+
+    /** 单生产者的当前块 */
+    struct Lane {
+        uint32_t block = kNoBlock;
+        int64_t openedUs = 0;
+    };
+
+    struct VideoStream {
+        std::atomic<uint64_t> key{0};
+        std::atomic<int64_t> lastUs{0};
+    };
+
+    struct Writer;
+
+    int64_t nowUs() const;
+    uint32_t popFree();
+    void pushFree(uint32_t index);
+    void submit(uint32_t index);
+    void wakeWriter();
+    uint8_t *reserve(Lane &lane, RecordingFormat::RecordType type, int64_t timestampUs, size_t payloadSize);
+    void flushLane(Lane &lane);
+    void recordAudio(Lane &lane, RecordingFormat::RecordType type, const RtcAudioFrame &frame);
+    void recordVideo(const char *streamId, bool remote, const RtcVideoFrame &frame);
+    bool admitVideo(const char *streamId, int64_t timestampUs);
+    void writerLoop();
+
+    const RecorderConfig m_config;
+    const size_t m_blockSize;
+
+    std::unique_ptr<Block[]> m_blocks;
+    std::unique_ptr<std::atomic<uint32_t>[]> m_next;   // 空闲栈中下一块的序号 + 1
+    std::atomic<uint64_t> m_freeHead{0};                // 高 32 位为防 ABA 的版本号，低 32 位为栈顶序号 + 1
+    std::atomic<int> m_freeCount{0};
+    MpscEventQueue<uint32_t> m_filled;
+
+    Lane m_micLane;        // 只在音频采集回调线程上访问
+    Lane m_playbackLane;   // 只在音频播放回调线程上访问
+    std::mutex m_textMutex;
+    Lane m_textLane;
+    VideoStream m_videoStreams[kMaxVideoStreams];
+    int64_t m_videoIntervalUs;
+
+    std::atomic<bool> m_recording{false};
+    std::chrono::steady_clock::time_point m_startTime;
+    std::atomic<bool> m_stopping{false};
+    std::atomic<uint32_t> m_wakeSeq{0};
+    std::atomic<uint32_t> m_writerWaiting{0};
+    std::unique_ptr<Writer> m_writer;
+    std::thread m_thread;
+    mutable std::mutex m_pathMutex;
+    std::string m_filePath;
+
+    std::atomic<uint64_t> m_records[RecordingFormat::kRecordTypeCount] = {};
+    std::atomic<uint64_t> m_dropped[RecordingFormat::kRecordTypeCount] = {};
+    std::atomic<uint64_t> m_tooLarge{0};
+    std::atomic<uint64_t> m_bytesWritten{0};
+    std::atomic<uint64_t> m_writeErrors{0};
+    std::atomic<int64_t> m_maxWriteUs{0};
+    std::atomic<int> m_minFree{0};
+};
@@ -0,0 +1,182 @@
+#include "ColorConvert.h"
+#include <algorithm>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define COLOR_CONVERT_NEON 1
+#endif
+
+namespace ColorConvert {
+
+// 6 位定点系数：1.164 → 74，1.596 → 102，0.391 → 25，0.813 → 52，2.018 → 129
+// NEON 与标量实现使用相同的公式和舍入 ((x + 32) >> 6)，输出逐字节一致
+namespace {
+
+constexpr int kY = 74;
+constexpr int kRV = 102;
+constexpr int kGU = 25;
+constexpr int kGV = 52;
+constexpr int kBU = 129;
+
+inline uint8_t clampToByte(int value) {
+    return static_cast<uint8_t>(std::min(255, std::max(0, value)));
+}
+
+inline void storePixel(uint8_t *dst, int r, int g, int b, RgbLayout layout) {
+    switch (layout) {
+    case RgbLayout::Rgb24:
+        dst[0] = clampToByte(r); dst[1] = clampToByte(g); dst[2] = clampToByte(b);
+        break;
+    case RgbLayout::Bgr24:
+        dst[0] = clampToByte(b); dst[1] = clampToByte(g); dst[2] = clampToByte(r);
+        break;
+    case RgbLayout::Bgra32:
+        dst[0] = clampToByte(b); dst[1] = clampToByte(g); dst[2] = clampToByte(r); dst[3] = 255;
+        break;
+    case RgbLayout::Rgba32:
+        dst[0] = clampToByte(r); dst[1] = clampToByte(g); dst[2] = clampToByte(b); dst[3] = 255;
+        break;
+    }
+}
+
+// 转换一行中 [x0, width) 的像素
+void convertRowScalar(const uint8_t *rowY, const uint8_t *rowU, const uint8_t *rowV,
+                      uint8_t *dst, int x0, int width, RgbLayout layout) {
+    const int bpp = bytesPerPixel(layout);
+    for (int x = x0; x < width; ++x) {
+        const int y = kY * (rowY[x] - 16);
+        const int u = rowU[x >> 1] - 128;
+        const int v = rowV[x >> 1] - 128;
+        const int r = (y + kRV * v + 32) >> 6;
+        const int g = (y - kGU * u - kGV * v + 32) >> 6;
+        const int b = (y + kBU * u + 32) >> 6;
+        storePixel(dst + x * bpp, r, g, b, layout);
+    }
+}
+
+#ifdef COLOR_CONVERT_NEON
+
+inline void storeNeon(uint8_t *dst, uint8x16_t r, uint8x16_t g, uint8x16_t b, RgbLayout layout) {
+    switch (layout) {
+    case RgbLayout::Rgb24: {
+        uint8x16x3_t px = {{r, g, b}};
+        vst3q_u8(dst, px);
+        break;
+    }
+    case RgbLayout::Bgr24: {
+        uint8x16x3_t px = {{b, g, r}};
+        vst3q_u8(dst, px);
+        break;
+    }
+    case RgbLayout::Bgra32: {
+        uint8x16x4_t px = {{b, g, r, vdupq_n_u8(255)}};
+        vst4q_u8(dst, px);
+        break;
+    }
+    case RgbLayout::Rgba32: {
+        uint8x16x4_t px = {{r, g, b, vdupq_n_u8(255)}};
+        vst4q_u8(dst, px);
+        break;
+    }
+    }
+}
+
+// 16 个亮度值与已展开的色度项合成 RGB；B 分量可能超出 int16，使用饱和加法
+inline void convertLumaNeon(uint8x16_t luma, int16x8x2_t rC, int16x8x2_t gC, int16x8x2_t bC,
+                            uint8_t *dst, RgbLayout layout) {
+    const uint8x8_t k16 = vdup_n_u8(16);
+    int16x8_t yLo = vmulq_n_s16(vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(luma), k16)), kY);
+    int16x8_t yHi = vmulq_n_s16(vreinterpretq_s16_u16(vsubl_u8(vget_high_u8(luma), k16)), kY);
+
+    uint8x16_t r = vcombine_u8(vqrshrun_n_s16(vqaddq_s16(yLo, rC.val[0]), 6),
+                               vqrshrun_n_s16(vqaddq_s16(yHi, rC.val[1]), 6));
+    uint8x16_t g = vcombine_u8(vqrshrun_n_s16(vqsubq_s16(yLo, gC.val[0]), 6),
+                               vqrshrun_n_s16(vqsubq_s16(yHi, gC.val[1]), 6));
+    uint8x16_t b = vcombine_u8(vqrshrun_n_s16(vqaddq_s16(yLo, bC.val[0]), 6),
+                               vqrshrun_n_s16(vqaddq_s16(yHi, bC.val[1]), 6));
+    storeNeon(dst, r, g, b, layout);
+}
+
+// 同时转换共享色度的两行，返回已处理的列数（16 的倍数）
+int convertRowPairNeon(const uint8_t *rowY0, const uint8_t *rowY1,
+                       const uint8_t *rowU, const uint8_t *rowV,
+                       uint8_t *dst0, uint8_t *dst1, int width, RgbLayout layout) {
+    const int bpp = bytesPerPixel(layout);
+    const uint8x8_t k128 = vdup_n_u8(128);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        int16x8_t u = vreinterpretq_s16_u16(vsubl_u8(vld1_u8(rowU + x / 2), k128));
+        int16x8_t v = vreinterpretq_s16_u16(vsubl_u8(vld1_u8(rowV + x / 2), k128));
+
+        int16x8_t r = vmulq_n_s16(v, kRV);
+        int16x8_t g = vmlaq_n_s16(vmulq_n_s16(u, kGU), v, kGV);
+        int16x8_t b = vmulq_n_s16(u, kBU);
+
+        // 每个色度样本对应水平相邻的两个像素
+        int16x8x2_t rC = vzipq_s16(r, r);
+        int16x8x2_t gC = vzipq_s16(g, g);
+        int16x8x2_t bC = vzipq_s16(b, b);
+
+        convertLumaNeon(vld1q_u8(rowY0 + x), rC, gC, bC, dst0 + x * bpp, layout);
+        if (rowY1) {
+            convertLumaNeon(vld1q_u8(rowY1 + x), rC, gC, bC, dst1 + x * bpp, layout);
+        }
+    }
+    return x;
+}
+
+#endif // COLOR_CONVERT_NEON
+
+} // namespace
+
+int bytesPerPixel(RgbLayout layout) {
+    return (layout == RgbLayout::Rgb24 || layout == RgbLayout::Bgr24) ? 3 : 4;
+}
+
+bool hasSimd() {
+#ifdef COLOR_CONVERT_NEON
+    return true;
+#else
+    return false;
+#endif
+}
+
+void i420ToRgbScalar(const uint8_t *srcY, int strideY,
+                     const uint8_t *srcU, int strideU,
+                     const uint8_t *srcV, int strideV,
+                     uint8_t *dst, int dstStride,
+                     int width, int height, RgbLayout layout) {
+    for (int row = 0; row < height; ++row) {
+        convertRowScalar(srcY + row * strideY, srcU + (row / 2) * strideU, srcV + (row / 2) * strideV,
+                         dst + row * dstStride, 0, width, layout);
+    }
+}
+
+void i420ToRgb(const uint8_t *srcY, int strideY,
+               const uint8_t *srcU, int strideU,
+               const uint8_t *srcV, int strideV,
+               uint8_t *dst, int dstStride,
+               int width, int height, RgbLayout layout) {
+#ifdef COLOR_CONVERT_NEON
+    for (int row = 0; row < height; row += 2) {
+        const uint8_t *rowY0 = srcY + row * strideY;
+        const uint8_t *rowY1 = row + 1 < height ? rowY0 + strideY : nullptr;
+        const uint8_t *rowU = srcU + (row / 2) * strideU;
+        const uint8_t *rowV = srcV + (row / 2) * strideV;
+        uint8_t *dst0 = dst + row * dstStride;
+        uint8_t *dst1 = dst0 + dstStride;
+
+        int done = convertRowPairNeon(rowY0, rowY1, rowU, rowV, dst0, dst1, width, layout);
+        if (done < width) {
+            convertRowScalar(rowY0, rowU, rowV, dst0, done, width, layout);
+            if (rowY1) {
+                convertRowScalar(rowY1, rowU, rowV, dst1, done, width, layout);
+            }
+        }
+    }
+#else
+    i420ToRgbScalar(srcY, strideY, srcU, strideU, srcV, strideV, dst, dstStride, width, height, layout);
+#endif
+}
+
+} // namespace ColorConvert
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * I420 → RGB 颜色转换（BT.601 limited range）
+ *
+ * ARM64 上使用 NEON 一次处理两行 16 个像素（两行共享一组色度），
+ * 其他平台使用结果完全一致的标量实现。
+ */
+namespace ColorConvert {
+
+enum class RgbLayout {
+    Rgb24,   // R G B
+    Bgr24,   // B G R（OpenCV 默认顺序）
+    Bgra32,  // B G R A，与小端机器上的 QImage::Format_RGB32 / ARGB32 内存布局一致
+    Rgba32,  // R G B A
+};
+
+int bytesPerPixel(RgbLayout layout);
+
+void i420ToRgb(const uint8_t *srcY, int strideY,
+               const uint8_t *srcU, int strideU,
+               const uint8_t *srcV, int strideV,
+               uint8_t *dst, int dstStride,
+               int width, int height, RgbLayout layout);
+
+/** 强制使用标量实现，用于基准对比和校验 */
+void i420ToRgbScalar(const uint8_t *srcY, int strideY,
+                     const uint8_t *srcU, int strideU,
+                     const uint8_t *srcV, int strideV,
+                     uint8_t *dst, int dstStride,
+                     int width, int height, RgbLayout layout);
+
+/** 当前构建是否使用了 SIMD 实现 */
+bool hasSimd();
+
+} // namespace ColorConvert
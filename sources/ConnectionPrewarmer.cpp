@@ -0,0 +1,280 @@
+#include "ConnectionPrewarmer.h"
+#include "BrokerRace.h"
+#include "ThreadPolicy.h"
+#include "AgentClient.h"
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <netdb.h>
+#include <sys/socket.h>
+
+namespace {
+
+int elapsedMsSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count());
+}
+
+} // namespace
+
+PrewarmConfig PrewarmConfig::fromEnvironment() {
+    PrewarmConfig config;
+    const char *value = std::getenv("QUICKSTART_PREWARM");
+    if (!value) {
+        return config;
+    }
+
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.compare(0, 4, "dns=") == 0) config.dns = std::atoi(item.c_str() + 4) != 0;
+        else if (item.compare(0, 5, "mqtt=") == 0) config.mqtt = std::atoi(item.c_str() + 5) != 0;
+        else if (item.compare(0, 4, "rtc=") == 0) config.rtc = std::atoi(item.c_str() + 4) != 0;
+        else if (item.compare(0, 16, "idle_timeout_ms=") == 0) config.idleTimeoutMs = std::atoi(item.c_str() + 16);
+        else if (item.compare(0, 19, "connect_timeout_ms=") == 0) config.connectTimeoutMs = std::atoi(item.c_str() + 19);
+        else if (!item.empty()) qWarning() << "QUICKSTART_PREWARM: unknown option" << item.c_str();
+    }
+
+    config.idleTimeoutMs = std::max(0, config.idleTimeoutMs);
+    config.connectTimeoutMs = std::max(1000, config.connectTimeoutMs);
+    return config;
+}
+
+ConnectionPrewarmer::ConnectionPrewarmer(const PrewarmConfig &config)
+        : m_config(config) {
+    m_thread = std::thread(&ConnectionPrewarmer::run, this);
+}
+
+ConnectionPrewarmer::~ConnectionPrewarmer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cond.notify_all();
+    m_doneCond.notify_all();
+    m_thread.join();
+}
+
+bool ConnectionPrewarmer::parseBrokerUrl(const std::string &url, std::string &host, std::string &port) {
+    size_t schemeEnd = url.find("://");
+    if (schemeEnd == std::string::npos) {
+        return false;
+    }
+    const std::string scheme = url.substr(0, schemeEnd);
+    size_t hostStart = schemeEnd + 3;
+    size_t hostEnd = url.find_first_of(":/", hostStart);
+    // IPv6 字面量写在方括号里，冒号属于地址本身
+    if (hostStart < url.size() && url[hostStart] == '[') {
+        size_t bracket = url.find(']', hostStart);
+        if (bracket == std::string::npos) {
+            return false;
+        }
+        host = url.substr(hostStart + 1, bracket - hostStart - 1);
+        hostEnd = bracket + 1;
+    } else {
+        host = url.substr(hostStart, hostEnd == std::string::npos ? std::string::npos : hostEnd - hostStart);
+    }
+    if (host.empty()) {
+        return false;
+    }
+
+    if (hostEnd != std::string::npos && hostEnd < url.size() && url[hostEnd] == ':') {
+        size_t portEnd = url.find('/', hostEnd + 1);
+        port = url.substr(hostEnd + 1, portEnd == std::string::npos ? std::string::npos : portEnd - hostEnd - 1);
+    } else if (scheme == "ssl" || scheme == "mqtts") {
+        port = "8883";
+    } else if (scheme == "ws") {
+        port = "80";
+    } else if (scheme == "wss") {
+        port = "443";
+    } else {
+        port = "1883";
+    }
+    return !port.empty();
+}
+
+void ConnectionPrewarmer::prewarm(const std::string &brokerUrl, const std::string &clientId) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_brokerUrl == brokerUrl && m_clientId == clientId) {
+            return;
+        }
+        m_brokerUrl = brokerUrl;
+        m_clientId = clientId;
+        ++m_generation;
+    }
+    m_cond.notify_all();
+}
+
+void ConnectionPrewarmer::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_brokerUrl.empty()) {
+            return;
+        }
+        m_brokerUrl.clear();
+        m_clientId.clear();
+        ++m_generation;
+    }
+    m_cond.notify_all();
+}
+
+std::unique_ptr<mqtt::async_client> ConnectionPrewarmer::take(const std::string &brokerUrl,
+                                                              const std::string &clientId) {
+    std::unique_ptr<mqtt::async_client> client;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_connecting && m_brokerUrl == brokerUrl && m_clientId == clientId) {
+            // 已经在握手的连接比重新连接更快完成，等它结束
+            m_doneCond.wait_for(lock, std::chrono::milliseconds(m_config.connectTimeoutMs),
+                                [this] { return !m_connecting || m_stopping; });
+        }
+        if (m_ready && m_readyBrokerUrl == brokerUrl && m_readyClientId == clientId && m_ready->is_connected()) {
+            client = std::move(m_ready);
+        }
+        // 无论是否取到，预热都到此结束；剩下不匹配或已断开的连接由后台线程释放
+        m_brokerUrl.clear();
+        m_clientId.clear();
+        ++m_generation;
+    }
+    m_cond.notify_all();
+    return client;
+}
+
+bool ConnectionPrewarmer::cancelled(uint64_t generation) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stopping || m_generation != generation;
+}
+
+bool ConnectionPrewarmer::stopping() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stopping;
+}
+
+void ConnectionPrewarmer::run() {
+    ThreadPolicy::registerCurrentThread(ThreadClass::Background, "prewarm");
+    std::unique_lock<std::mutex> lock(m_mutex);
+    uint64_t handled = 0;
+    auto readySince = std::chrono::steady_clock::now();
+    for (;;) {
+        auto changed = [this, &handled] { return m_stopping || m_generation != handled; };
+        if (m_ready && m_config.idleTimeoutMs > 0) {
+            auto deadline = readySince + std::chrono::milliseconds(m_config.idleTimeoutMs);
+            if (!m_cond.wait_until(lock, deadline, changed)) {
+                qDebug() << "Prewarm: connection idle for" << m_config.idleTimeoutMs << "ms, closing";
+                auto idle = std::move(m_ready);
+                lock.unlock();
+                release(std::move(idle));
+                lock.lock();
+                continue;
+            }
+        } else {
+            m_cond.wait(lock, changed);
+        }
+        if (m_stopping) {
+            break;
+        }
+
+        handled = m_generation;
+        const std::string brokerUrl = m_brokerUrl;
+        const std::string clientId = m_clientId;
+
+        const bool readyMatches = m_ready && m_readyBrokerUrl == brokerUrl && m_readyClientId == clientId;
+        if (m_ready && !(readyMatches && m_ready->is_connected())) {
+            auto stale = std::move(m_ready);
+            lock.unlock();
+            release(std::move(stale));
+            lock.lock();
+        }
+        if (brokerUrl.empty() || m_ready || (!m_config.mqtt && !m_config.dns)) {
+            continue;
+        }
+
+        m_connecting = true;
+        lock.unlock();
+        auto client = connect(brokerUrl, clientId, handled);
+        lock.lock();
+        m_connecting = false;
+        if (client && !m_stopping && m_generation == handled) {
+            m_ready = std::move(client);
+            m_readyBrokerUrl = brokerUrl;
+            m_readyClientId = clientId;
+            readySince = std::chrono::steady_clock::now();
+        } else if (client) {
+            lock.unlock();
+            release(std::move(client));
+            lock.lock();
+        }
+        m_doneCond.notify_all();
+    }
+
+    auto remaining = std::move(m_ready);
+    lock.unlock();
+    release(std::move(remaining));
+}
+
+std::unique_ptr<mqtt::async_client> ConnectionPrewarmer::connect(const std::string &brokerUrl,
+                                                                 const std::string &clientId,
+                                                                 uint64_t generation) {
+    auto start = std::chrono::steady_clock::now();
+    const auto brokers = BrokerRace::splitList(brokerUrl);
+
+    if (!m_config.mqtt) {
+        // 只预解析：Paho 连接时会再解析一次，这里先把结果带进系统的解析缓存，解析失败也能提前发现
+        for (const std::string &url : brokers) {
+            std::string host;
+            std::string port;
+            if (cancelled(generation) || !parseBrokerUrl(url, host, port)) {
+                continue;
+            }
+            addrinfo hints = {};
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            addrinfo *result = nullptr;
+            int rc = getaddrinfo(host.c_str(), port.c_str(), &hints, &result);
+            if (rc != 0) {
+                qWarning() << "Prewarm: cannot resolve" << host.c_str() << ":" << gai_strerror(rc);
+                continue;
+            }
+            freeaddrinfo(result);
+            qDebug() << "Prewarm: resolved" << host.c_str() << "in" << elapsedMsSince(start) << "ms";
+        }
+        return nullptr;
+    }
+
+    // 多个 Broker 时错开竞速，取消或退出时不必等握手结束；解析在竞速中进行
+    auto raceConfig = BrokerRaceConfig::fromEnvironment();
+    raceConfig.connectTimeoutMs = m_config.connectTimeoutMs;
+    auto race = BrokerRace::connect(brokers, clientId, raceConfig, [this, generation] { return cancelled(generation); });
+    BrokerRace::release(race.abandoned);
+    if (!race.client) {
+        if (cancelled(generation)) {
+            qDebug() << "Prewarm: connect to" << brokerUrl.c_str() << "cancelled";
+        } else {
+            qWarning() << "Prewarm: connect to" << brokerUrl.c_str() << "failed";
+        }
+        return nullptr;
+    }
+
+    if (cancelled(generation)) {
+        qDebug() << "Prewarm: connection to" << race.brokerUrl.c_str() << "no longer needed";
+    } else {
+        qInfo() << "Prewarm: connected to" << race.brokerUrl.c_str() << "in" << elapsedMsSince(start) << "ms";
+    }
+    return std::move(race.client);
+}
+
+void ConnectionPrewarmer::release(std::unique_ptr<mqtt::async_client> client) {
+    if (!client) {
+        return;
+    }
+    try {
+        if (client->is_connected()) {
+            client->disconnect()->wait_for(std::chrono::seconds(2));
+        }
+    } catch (const mqtt::exception &e) {
+        qWarning() << "Prewarm: disconnect failed:" << e.what();
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace mqtt {
+class async_client;
+}
+
+/**
+ * 登录页预热配置
+ *
+ * 通过环境变量 QUICKSTART_PREWARM 以 "key=value" 形式覆盖：
+ *   dns=0|1               预先解析 Broker 地址，默认 1
+ *   mqtt=0|1              预先建立到 Broker 的 TCP/TLS 连接并完成 CONNECT，默认 1
+ *   rtc=0|1               配置记录过 RTC AppId 时预先创建 RTC 引擎，默认 1
+ *   idle_timeout_ms=N     预热好的连接在登录页闲置超过该时间后断开，默认 120000，0 表示不限
+ *   connect_timeout_ms=N  预热连接的超时，默认 10000
+ */
+struct PrewarmConfig {
+    bool dns = true;
+    bool mqtt = true;
+    bool rtc = true;
+    int idleTimeoutMs = 120000;
+    int connectTimeoutMs = 10000;
+
+    static PrewarmConfig fromEnvironment();
+};
+
+/**
+ * 登录页的 MQTT 连接预热
+ *
+ * 选中已保存的连接配置后，在后台线程上解析 Broker 地址并建立 MQTT 连接，
+ * 用户点击开始时由 take() 交给 AgentClient 直接使用。配置了多个 Broker 时
+ * 由 BrokerRace 竞速，取走的是最先完成 CONNECT 的那个；目标仍以整个列表比较。
+ *
+ * 取消：
+ * - prewarm() 换了目标或调用 cancel() 后，进行中的解析/连接结束时直接丢弃，
+ *   已建立的连接在后台线程上断开，不阻塞界面线程
+ * - 闲置超过 idleTimeoutMs 未被取走的连接同样断开，避免长期占用 Broker 上的会话
+ * - 析构时断开未取走的连接并等待后台线程退出
+ *
+ * 除析构外所有方法只在界面线程上调用。
+ */
+class ConnectionPrewarmer {
+public:
+    explicit ConnectionPrewarmer(const PrewarmConfig &config);
+    ~ConnectionPrewarmer();
+
+    ConnectionPrewarmer(const ConnectionPrewarmer &) = delete;
+    ConnectionPrewarmer &operator=(const ConnectionPrewarmer &) = delete;
+
+    /** 开始预热，目标与当前相同时不重复建立 */
+    void prewarm(const std::string &brokerUrl, const std::string &clientId);
+    void cancel();
+
+    /**
+     * 取走与参数匹配且仍在连接状态的预热连接，没有则返回 nullptr。
+     * 同一目标正在连接时等它完成（不超过 connectTimeoutMs）；目标不同则取消预热。
+     */
+    std::unique_ptr<mqtt::async_client> take(const std::string &brokerUrl, const std::string &clientId);
+
+    /** 把 scheme://host:port/path 拆出主机和端口，未写端口时按 scheme 取默认值 */
+    static bool parseBrokerUrl(const std::string &url, std::string &host, std::string &port);
+
+private:
+    void run();
+    /** 按当前目标解析并连接，返回的连接可能已因取消而作废，由调用方检查 generation */
+    std::unique_ptr<mqtt::async_client> connect(const std::string &brokerUrl, const std::string &clientId,
+                                                uint64_t generation);
+    void release(std::unique_ptr<mqtt::async_client> client);
+    bool cancelled(uint64_t generation);
+    bool stopping();
+
+    const PrewarmConfig m_config;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::condition_variable m_doneCond;
+    // 目标每变化一次 generation 加一；目标为空表示取消
+    uint64_t m_generation = 0;
+    std::string m_brokerUrl;
+    std::string m_clientId;
+    bool m_connecting = false;
+    bool m_stopping = false;
+    // 已连接、等待取走的连接及其目标
+    std::unique_ptr<mqtt::async_client> m_ready;
+    std::string m_readyBrokerUrl;
+    std::string m_readyClientId;
+    std::thread m_thread;
+};
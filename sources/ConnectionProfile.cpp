@@ -0,0 +1,127 @@
+#include "ConnectionProfile.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+QString ConnectionProfileStore::configPath() {
+    QString path = QString::fromLocal8Bit(qgetenv("QUICKSTART_CONFIG"));
+    if (!path.isEmpty()) {
+        return path;
+    }
+
+#ifdef QUICKSTART_CONFIG_FILE
+    // 开发时直接使用源码目录下的配置；打包后该目录不存在
+    path = QStringLiteral(QUICKSTART_CONFIG_FILE);
+    if (QFileInfo(path).dir().exists()) {
+        return path;
+    }
+#endif
+
+    return QDir(QCoreApplication::applicationDirPath()).filePath(QStringLiteral("config.json"));
+}
+
+bool ConnectionProfileStore::load() {
+    m_profiles.clear();
+    m_lastProfile.clear();
+
+    const QString path = configPath();
+    QFile file(path);
+    if (!file.exists()) {
+        return true;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "ConnectionProfileStore: cannot open" << path << ":" << file.errorString();
+        return false;
+    }
+
+    QJsonParseError error;
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError || !document.isObject()) {
+        qWarning() << "ConnectionProfileStore: invalid" << path << ":" << error.errorString();
+        return false;
+    }
+
+    QJsonObject root = document.object();
+    for (const QJsonValue &value : root.value(QStringLiteral("profiles")).toArray()) {
+        QJsonObject object = value.toObject();
+        ConnectionProfile profile;
+        profile.name = object.value(QStringLiteral("name")).toString();
+        profile.brokerUrl = object.value(QStringLiteral("brokerUrl")).toString();
+        profile.agentId = object.value(QStringLiteral("agentId")).toString();
+        profile.clientId = object.value(QStringLiteral("clientId")).toString();
+        profile.rtcAppId = object.value(QStringLiteral("rtcAppId")).toString();
+        if (profile.name.isEmpty() || find(profile.name)) {
+            qWarning() << "ConnectionProfileStore: skipping unnamed or duplicate profile" << profile.name;
+            continue;
+        }
+        m_profiles.append(profile);
+    }
+    m_lastProfile = root.value(QStringLiteral("lastProfile")).toString();
+    return true;
+}
+
+bool ConnectionProfileStore::save() const {
+    QJsonArray profiles;
+    for (const ConnectionProfile &profile : m_profiles) {
+        QJsonObject object;
+        object.insert(QStringLiteral("name"), profile.name);
+        object.insert(QStringLiteral("brokerUrl"), profile.brokerUrl);
+        object.insert(QStringLiteral("agentId"), profile.agentId);
+        object.insert(QStringLiteral("clientId"), profile.clientId);
+        if (!profile.rtcAppId.isEmpty()) {
+            object.insert(QStringLiteral("rtcAppId"), profile.rtcAppId);
+        }
+        profiles.append(object);
+    }
+    QJsonObject root;
+    root.insert(QStringLiteral("lastProfile"), m_lastProfile);
+    root.insert(QStringLiteral("profiles"), profiles);
+
+    // 先写临时文件再替换，写到一半退出不会留下损坏的配置
+    const QString path = configPath();
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(QJsonDocument(root).toJson(QJsonDocument::Indented)) < 0
+        || !file.commit()) {
+        qWarning() << "ConnectionProfileStore: cannot write" << path << ":" << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+const ConnectionProfile *ConnectionProfileStore::find(const QString &name) const {
+    for (const ConnectionProfile &profile : m_profiles) {
+        if (profile.name == name) {
+            return &profile;
+        }
+    }
+    return nullptr;
+}
+
+void ConnectionProfileStore::upsert(const ConnectionProfile &profile) {
+    for (ConnectionProfile &existing : m_profiles) {
+        if (existing.name == profile.name) {
+            existing = profile;
+            return;
+        }
+    }
+    m_profiles.append(profile);
+}
+
+void ConnectionProfileStore::remove(const QString &name) {
+    for (int i = 0; i < m_profiles.size(); ++i) {
+        if (m_profiles[i].name == name) {
+            m_profiles.remove(i);
+            break;
+        }
+    }
+    if (m_lastProfile == name) {
+        m_lastProfile.clear();
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+/**
+ * 登录页保存的连接配置
+ *
+ * rtcAppId 不需要用户填写：智能体在 startVoiceChat 应答中返回，通话建立后记录下来，
+ * 下次选中该配置时用于提前创建 RTC 引擎。
+ */
+struct ConnectionProfile {
+    QString name;
+    QString brokerUrl;
+    QString agentId;
+    QString clientId;
+    QString rtcAppId;
+};
+
+/**
+ * 连接配置文件（config.json）的读写
+ *
+ * 文件路径按以下顺序确定：
+ * 1. 环境变量 QUICKSTART_CONFIG
+ * 2. 编译时 CMake 的 CONFIG_FILE（源码目录下的 config.json），所在目录存在时使用
+ * 3. 可执行文件所在目录下的 config.json（打包后的运行环境）
+ *
+ * 文件格式：
+ * {
+ *   "lastProfile": "demo",
+ *   "profiles": [
+ *     { "name": "demo", "brokerUrl": "ssl://...", "agentId": "...", "clientId": "...", "rtcAppId": "..." }
+ *   ]
+ * }
+ */
+class ConnectionProfileStore {
+public:
+    static QString configPath();
+
+    /** 文件不存在时返回 true 且配置为空，格式错误时输出警告并返回 false */
+    bool load();
+    bool save() const;
+
+    const QVector<ConnectionProfile> &profiles() const { return m_profiles; }
+    /** 未找到时返回 nullptr */
+    const ConnectionProfile *find(const QString &name) const;
+    /** 按名称新增或替换 */
+    void upsert(const ConnectionProfile &profile);
+    void remove(const QString &name);
+
+    QString lastProfile() const { return m_lastProfile; }
+    void setLastProfile(const QString &name) { m_lastProfile = name; }
+
+private:
+    QVector<ConnectionProfile> m_profiles;
+    QString m_lastProfile;
+};
@@ -0,0 +1,81 @@
+#include "CpuUsage.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+CpuUsageSampler::CpuUsageSampler()
+    : m_ticksPerSecond(sysconf(_SC_CLK_TCK)) {
+}
+
+int CpuUsageSampler::cpuCount() {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? static_cast<int>(n) : 1;
+}
+
+bool CpuUsageSampler::readProcessTicks(uint64_t &ticks) {
+    FILE *fp = std::fopen("/proc/self/stat", "r");
+    if (!fp) return false;
+
+    char buf[1024];
+    size_t len = std::fread(buf, 1, sizeof(buf) - 1, fp);
+    std::fclose(fp);
+    buf[len] = '\0';
+
+    // comm 字段可能包含空格，从最后一个 ')' 之后开始解析
+    const char *p = std::strrchr(buf, ')');
+    if (!p) return false;
+
+    unsigned long long utime = 0, stime = 0;
+    // 跳过 state(3) 到 cstime 之前的字段，utime/stime 为第 14/15 个字段
+    int matched = std::sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu",
+                              &utime, &stime);
+    if (matched != 2) return false;
+    ticks = utime + stime;
+    return true;
+}
+
+bool CpuUsageSampler::readSystemTicks(uint64_t &busy, uint64_t &total) {
+    FILE *fp = std::fopen("/proc/stat", "r");
+    if (!fp) return false;
+
+    unsigned long long user = 0, nice = 0, system = 0, idle = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
+    int matched = std::fscanf(fp, "cpu %llu %llu %llu %llu %llu %llu %llu %llu",
+                              &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal);
+    std::fclose(fp);
+    if (matched < 4) return false;
+
+    busy = user + nice + system + irq + softirq + steal;
+    total = busy + idle + iowait;
+    return true;
+}
+
+CpuUsageSampler::Sample CpuUsageSampler::sample() {
+    Sample result;
+    uint64_t processTicks = 0, systemBusy = 0, systemTotal = 0;
+    bool hasProcess = readProcessTicks(processTicks);
+    bool hasSystem = readSystemTicks(systemBusy, systemTotal);
+    auto now = std::chrono::steady_clock::now();
+
+    if (m_hasBaseline) {
+        double seconds = std::chrono::duration<double>(now - m_lastTime).count();
+        if (hasProcess && seconds > 0.0 && m_ticksPerSecond > 0) {
+            double cpuSeconds = static_cast<double>(processTicks - m_lastProcessTicks) / m_ticksPerSecond;
+            result.processPercent = 100.0 * cpuSeconds / (seconds * cpuCount());
+        }
+        if (hasSystem && systemTotal > m_lastSystemTotal) {
+            result.systemPercent = 100.0 * static_cast<double>(systemBusy - m_lastSystemBusy)
+                                   / static_cast<double>(systemTotal - m_lastSystemTotal);
+        }
+    }
+
+    m_hasBaseline = true;
+    m_lastProcessTicks = processTicks;
+    m_lastSystemBusy = systemBusy;
+    m_lastSystemTotal = systemTotal;
+    m_lastTime = now;
+
+    result.processPercent = std::min(100.0, std::max(0.0, result.processPercent));
+    result.systemPercent = std::min(100.0, std::max(0.0, result.systemPercent));
+    return result;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+/**
+ * 进程与整机 CPU 占用采样
+ *
+ * 读取 /proc/self/stat 和 /proc/stat，两次 sample() 之间的占用率以百分比返回，
+ * 均按全部核心归一化（100 表示所有核心满载）。首次调用只建立基线，返回 0。
+ * 非线程安全，每个使用方持有自己的实例。
+ */
+class CpuUsageSampler {
+public:
+    struct Sample {
+        double processPercent = 0.0;
+        double systemPercent = 0.0;
+    };
+
+    CpuUsageSampler();
+
+    Sample sample();
+
+    static int cpuCount();
+
+private:
+    static bool readProcessTicks(uint64_t &ticks);
+    static bool readSystemTicks(uint64_t &busy, uint64_t &total);
+
+    bool m_hasBaseline = false;
+    uint64_t m_lastProcessTicks = 0;
+    uint64_t m_lastSystemBusy = 0;
+    uint64_t m_lastSystemTotal = 0;
+    std::chrono::steady_clock::time_point m_lastTime;
+    long m_ticksPerSecond;
+};
@@ -0,0 +1,42 @@
+#include "EventLoopDrain.h"
+#include <QAbstractEventDispatcher>
+#include <QDebug>
+#include <QObject>
+#include <QThread>
+
+EventLoopDrain::EventLoopDrain(std::function<void()> drain)
+        : m_drain(std::move(drain)),
+          m_dispatcher(QAbstractEventDispatcher::instance(QThread::currentThread())) {
+    if (!m_dispatcher) {
+        qWarning() << "EventLoopDrain: no event dispatcher on this thread";
+        return;
+    }
+    m_connection = QObject::connect(m_dispatcher, &QAbstractEventDispatcher::aboutToBlock,
+                                    [this] { onAboutToBlock(); });
+}
+
+EventLoopDrain::~EventLoopDrain() {
+    QObject::disconnect(m_connection);
+}
+
+void EventLoopDrain::wake() {
+    if (!m_wakePending.exchange(true, std::memory_order_acq_rel) && m_dispatcher) {
+        m_dispatcher->wakeUp();
+    }
+}
+
+void EventLoopDrain::onAboutToBlock() {
+    if (m_draining) {
+        return;
+    }
+    m_draining = true;
+    // 先清标志再排空：排空期间入队的事件会重新唤醒下一轮
+    m_wakePending.store(false, std::memory_order_release);
+    m_drain();
+    m_draining = false;
+
+    // 排空期间的唤醒可能被嵌套事件循环消耗掉，补一次，避免事件滞留到下一次无关的唤醒
+    if (m_wakePending.load(std::memory_order_acquire)) {
+        m_dispatcher->wakeUp();
+    }
+}
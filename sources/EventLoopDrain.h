@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QMetaObject>
+#include <atomic>
+#include <functional>
+
+class QAbstractEventDispatcher;
+
+/**
+ * 在界面线程每轮事件循环进入等待前调用一次排空函数
+ *
+ * 与 MpscEventQueue 配合使用：回调线程入队后调用 wake()，
+ * 只有第一次 wake() 会唤醒事件循环（一次系统调用，不分配内存），
+ * 之后同一轮内的 wake() 都只是读一次原子标志。
+ * 排空函数在 QAbstractEventDispatcher::aboutToBlock 时执行，
+ * 处理函数中若打开嵌套事件循环（如模态对话框），嵌套循环内不会重入排空。
+ *
+ * 必须在界面线程上构造和析构。
+ */
+class EventLoopDrain {
+public:
+    explicit EventLoopDrain(std::function<void()> drain);
+    ~EventLoopDrain();
+
+    EventLoopDrain(const EventLoopDrain &) = delete;
+    EventLoopDrain &operator=(const EventLoopDrain &) = delete;
+
+    /** 任意线程调用 */
+    void wake();
+
+private:
+    void onAboutToBlock();
+
+    std::function<void()> m_drain;
+    QAbstractEventDispatcher *m_dispatcher = nullptr;
+    QMetaObject::Connection m_connection;
+    std::atomic<bool> m_wakePending{false};
+    bool m_draining = false;
+};
@@ -0,0 +1,648 @@
+#include "ExternalVideoSource.h"
+#include "ThreadPolicy.h"
+#include "VideoFramePool.h"
+#include <QDebug>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <linux/videodev2.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+int64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void fillPlanes(RtcExternalVideoFrame &frame, uint8_t *base, int width, int height, int stride) {
+    frame.width = width;
+    frame.height = height;
+    frame.planes[0] = base;
+    frame.strides[0] = stride;
+    if (frame.format == RtcPixelFormat::NV12) {
+        frame.planes[1] = base + stride * height;
+        frame.strides[1] = stride;
+        frame.planes[2] = nullptr;
+        frame.strides[2] = 0;
+    } else {
+        frame.planes[1] = base + stride * height;
+        frame.strides[1] = stride / 2;
+        frame.planes[2] = frame.planes[1] + (stride / 2) * (height / 2);
+        frame.strides[2] = stride / 2;
+    }
+}
+
+} // namespace
+
+ExternalVideoSourceConfig ExternalVideoSourceConfig::fromEnvironment() {
+    ExternalVideoSourceConfig config;
+    const char *value = std::getenv("QUICKSTART_VIDEO_SOURCE");
+    if (!value || !*value || std::strcmp(value, "camera") == 0) {
+        return config;
+    }
+
+    std::string spec(value);
+    auto first = spec.find(':');
+    if (first == std::string::npos) {
+        qWarning() << "QUICKSTART_VIDEO_SOURCE: invalid value" << value;
+        return config;
+    }
+    std::string type = spec.substr(0, first);
+    std::string rest = spec.substr(first + 1);
+
+    // 可选的 ":宽x高@帧率" 后缀
+    auto last = rest.rfind(':');
+    if (last != std::string::npos) {
+        int w = 0, h = 0, fps = 0;
+        if (std::sscanf(rest.c_str() + last + 1, "%dx%d@%d", &w, &h, &fps) >= 2) {
+            config.width = w & ~1;
+            config.height = h & ~1;
+            if (fps > 0) config.fps = fps;
+            rest = rest.substr(0, last);
+        }
+    }
+    config.path = rest;
+
+    if (type == "v4l2") config.type = Type::V4l2;
+    else if (type == "yuv") config.type = Type::YuvFile;
+    else if (type == "shm") config.type = Type::SharedMemory;
+    else qWarning() << "QUICKSTART_VIDEO_SOURCE: unknown type" << type.c_str();
+    return config;
+}
+
+// ── 采集后端 ──────────────────────────────────────────────────────
+
+class ExternalVideoSource::Capture {
+public:
+    virtual ~Capture() = default;
+
+    virtual bool open(const ExternalVideoSourceConfig &config) = 0;
+    /** 等待下一帧，超时或丢帧时返回 false */
+    virtual bool readFrame(RtcExternalVideoFrame &frame, int timeoutMs) = 0;
+    /** 停止采集并在引擎归还全部帧后释放映射 */
+    virtual void close() = 0;
+
+protected:
+    // 引擎可能仍持有帧，映射必须等这些帧归还后才能释放
+    bool waitOutstanding(const char *name) {
+        for (int i = 0; i < 200 && m_outstanding.load() > 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        if (m_outstanding.load() > 0) {
+            qWarning() << name << ": engine still holds" << m_outstanding.load() << "frames, leaking mapping";
+            return false;
+        }
+        return true;
+    }
+
+    std::atomic<int> m_outstanding{0};
+};
+
+// V4L2 设备：mmap 采集缓冲直接交给引擎，引擎释放时重新入队
+class V4l2Capture : public ExternalVideoSource::Capture {
+public:
+    ~V4l2Capture() override { close(); }
+
+    bool open(const ExternalVideoSourceConfig &config) override {
+        m_fd = ::open(config.path.c_str(), O_RDWR | O_NONBLOCK);
+        if (m_fd < 0) {
+            qWarning() << "V4L2: cannot open" << config.path.c_str() << std::strerror(errno);
+            return false;
+        }
+
+        v4l2_capability cap{};
+        if (xioctl(VIDIOC_QUERYCAP, &cap) < 0
+            || !(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE)
+            || !(cap.capabilities & V4L2_CAP_STREAMING)) {
+            qWarning() << "V4L2:" << config.path.c_str() << "is not a streaming capture device";
+            return false;
+        }
+
+        // 按引擎可直接使用的格式优先协商，YUYV 需要转换一次
+        const uint32_t candidates[] = {V4L2_PIX_FMT_NV12, V4L2_PIX_FMT_YUV420, V4L2_PIX_FMT_YUYV};
+        v4l2_format fmt{};
+        bool negotiated = false;
+        for (uint32_t pixfmt : candidates) {
+            fmt = v4l2_format{};
+            fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            fmt.fmt.pix.width = config.width;
+            fmt.fmt.pix.height = config.height;
+            fmt.fmt.pix.pixelformat = pixfmt;
+            fmt.fmt.pix.field = V4L2_FIELD_ANY;
+            if (xioctl(VIDIOC_S_FMT, &fmt) == 0 && fmt.fmt.pix.pixelformat == pixfmt) {
+                negotiated = true;
+                break;
+            }
+        }
+        if (!negotiated) {
+            qWarning() << "V4L2: no supported pixel format (NV12/YUV420/YUYV)";
+            return false;
+        }
+        m_pixfmt = fmt.fmt.pix.pixelformat;
+        m_width = fmt.fmt.pix.width & ~1u;
+        m_height = fmt.fmt.pix.height & ~1u;
+        m_bytesPerLine = fmt.fmt.pix.bytesperline;
+        const int minBytesPerLine = m_pixfmt == V4L2_PIX_FMT_YUYV ? m_width * 2 : m_width;
+        if (m_bytesPerLine < minBytesPerLine) {
+            m_bytesPerLine = minBytesPerLine;
+        }
+        // 一帧至少应有的字节数：平面格式的色度共占亮度的一半，YUYV 每行 bytesPerLine
+        m_frameBytes = m_pixfmt == V4L2_PIX_FMT_YUYV
+                ? static_cast<size_t>(m_bytesPerLine) * m_height
+                : static_cast<size_t>(m_bytesPerLine) * m_height * 3 / 2;
+
+        v4l2_streamparm parm{};
+        parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        parm.parm.capture.timeperframe.numerator = 1;
+        parm.parm.capture.timeperframe.denominator = config.fps;
+        xioctl(VIDIOC_S_PARM, &parm);
+
+        v4l2_requestbuffers req{};
+        req.count = 4;
+        req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        req.memory = V4L2_MEMORY_MMAP;
+        if (xioctl(VIDIOC_REQBUFS, &req) < 0 || req.count < 2) {
+            qWarning() << "V4L2: REQBUFS failed" << std::strerror(errno);
+            return false;
+        }
+
+        for (uint32_t i = 0; i < req.count; ++i) {
+            v4l2_buffer buf{};
+            buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = V4L2_MEMORY_MMAP;
+            buf.index = i;
+            if (xioctl(VIDIOC_QUERYBUF, &buf) < 0) {
+                return false;
+            }
+            if (buf.length < m_frameBytes) {
+                qWarning() << "V4L2: buffer" << i << "has" << buf.length << "bytes, frame needs" << m_frameBytes;
+                return false;
+            }
+            void *start = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, buf.m.offset);
+            if (start == MAP_FAILED) {
+                qWarning() << "V4L2: mmap failed" << std::strerror(errno);
+                return false;
+            }
+            m_buffers.push_back({static_cast<uint8_t *>(start), buf.length});
+        }
+
+        if (m_pixfmt == V4L2_PIX_FMT_YUYV) {
+            m_pool = std::make_unique<VideoFramePool>(
+                    static_cast<int>(m_buffers.size()), static_cast<size_t>(m_width) * m_height * 3 / 2);
+        }
+
+        for (uint32_t i = 0; i < m_buffers.size(); ++i) {
+            requeue(static_cast<int>(i));
+        }
+        int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        if (xioctl(VIDIOC_STREAMON, &type) < 0) {
+            qWarning() << "V4L2: STREAMON failed" << std::strerror(errno);
+            return false;
+        }
+        m_streaming = true;
+
+        char fourcc[5] = {char(m_pixfmt & 0xff), char((m_pixfmt >> 8) & 0xff),
+                          char((m_pixfmt >> 16) & 0xff), char((m_pixfmt >> 24) & 0xff), 0};
+        qDebug() << "V4L2:" << config.path.c_str() << m_width << "x" << m_height << fourcc
+                 << m_buffers.size() << "mmap buffers" << (m_pool ? "(converted)" : "(zero-copy)");
+        return true;
+    }
+
+    bool readFrame(RtcExternalVideoFrame &frame, int timeoutMs) override {
+        pollfd pfd{m_fd, POLLIN, 0};
+        if (poll(&pfd, 1, timeoutMs) <= 0) {
+            return false;
+        }
+
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        if (xioctl(VIDIOC_DQBUF, &buf) < 0) {
+            return false;
+        }
+        if (buf.index >= m_buffers.size()) {
+            return false;
+        }
+        // 出错或不完整的帧（设备断开、传输中断）不交给引擎，缓冲直接重新入队
+        if (buf.bytesused < m_frameBytes || (buf.flags & V4L2_BUF_FLAG_ERROR)) {
+            if (m_shortFrames++ == 0) {
+                qWarning() << "V4L2: dropping incomplete frame," << buf.bytesused << "of" << m_frameBytes << "bytes";
+            }
+            requeue(static_cast<int>(buf.index));
+            return false;
+        }
+
+        uint8_t *base = m_buffers[buf.index].start;
+        frame.timestampUs = nowUs();
+
+        if (!m_pool) {
+            frame.format = m_pixfmt == V4L2_PIX_FMT_NV12 ? RtcPixelFormat::NV12 : RtcPixelFormat::I420;
+            fillPlanes(frame, base, m_width, m_height, m_bytesPerLine);
+            frame.release = &V4l2Capture::releaseBuffer;
+            frame.opaque = this;
+            frame.bufferIndex = static_cast<int>(buf.index);
+            ++m_outstanding;
+            return true;
+        }
+
+        int index = m_pool->acquire();
+        if (index < 0) {
+            // 引擎还没归还缓冲，丢弃这一帧
+            requeue(static_cast<int>(buf.index));
+            return false;
+        }
+        frame.format = RtcPixelFormat::I420;
+        fillPlanes(frame, m_pool->data(index), m_width, m_height, m_width);
+        convertYuyvToI420(base, frame);
+        requeue(static_cast<int>(buf.index));
+
+        frame.release = &V4l2Capture::releasePooled;
+        frame.opaque = this;
+        frame.bufferIndex = index;
+        ++m_outstanding;
+        return true;
+    }
+
+    void close() override {
+        if (m_fd < 0) return;
+
+        if (m_streaming.exchange(false)) {
+            int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            xioctl(VIDIOC_STREAMOFF, &type);
+        }
+        if (waitOutstanding("V4L2")) {
+            for (const auto &buffer : m_buffers) {
+                munmap(buffer.start, buffer.length);
+            }
+            m_pool.reset();
+        } else {
+            m_pool.release();
+        }
+        m_buffers.clear();
+        ::close(m_fd);
+        m_fd = -1;
+    }
+
+private:
+    struct Buffer {
+        uint8_t *start;
+        size_t length;
+    };
+
+    int xioctl(unsigned long request, void *arg) {
+        int ret;
+        do {
+            ret = ioctl(m_fd, request, arg);
+        } while (ret < 0 && errno == EINTR);
+        return ret;
+    }
+
+    void requeue(int index) {
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = static_cast<uint32_t>(index);
+        xioctl(VIDIOC_QBUF, &buf);
+    }
+
+    void convertYuyvToI420(const uint8_t *src, const RtcExternalVideoFrame &frame) {
+        for (int y = 0; y < m_height; ++y) {
+            const uint8_t *line = src + y * m_bytesPerLine;
+            uint8_t *dstY = frame.planes[0] + y * frame.strides[0];
+            for (int x = 0; x < m_width; ++x) {
+                dstY[x] = line[x * 2];
+            }
+            if ((y & 1) == 0) {
+                uint8_t *dstU = frame.planes[1] + (y / 2) * frame.strides[1];
+                uint8_t *dstV = frame.planes[2] + (y / 2) * frame.strides[2];
+                for (int x = 0; x < m_width / 2; ++x) {
+                    dstU[x] = line[x * 4 + 1];
+                    dstV[x] = line[x * 4 + 3];
+                }
+            }
+        }
+    }
+
+    static void releaseBuffer(void *opaque, int bufferIndex) {
+        auto *self = static_cast<V4l2Capture *>(opaque);
+        if (self->m_streaming) {
+            self->requeue(bufferIndex);
+        }
+        --self->m_outstanding;
+    }
+
+    static void releasePooled(void *opaque, int bufferIndex) {
+        auto *self = static_cast<V4l2Capture *>(opaque);
+        self->m_pool->release(bufferIndex);
+        --self->m_outstanding;
+    }
+
+    int m_fd = -1;
+    uint32_t m_pixfmt = 0;
+    int m_width = 0;
+    int m_height = 0;
+    int m_bytesPerLine = 0;
+    size_t m_frameBytes = 0;
+    uint64_t m_shortFrames = 0;   // 只在采集线程上访问
+    std::vector<Buffer> m_buffers;
+    std::unique_ptr<VideoFramePool> m_pool;
+    std::atomic<bool> m_streaming{false};
+};
+
+// I420 裸文件：整个文件 mmap（私有映射，不会写回），帧直接指向映射区
+class YuvFileCapture : public ExternalVideoSource::Capture {
+public:
+    ~YuvFileCapture() override { close(); }
+
+    bool open(const ExternalVideoSourceConfig &config) override {
+        int fd = ::open(config.path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            qWarning() << "YUV file: cannot open" << config.path.c_str() << std::strerror(errno);
+            return false;
+        }
+        struct stat st{};
+        fstat(fd, &st);
+        m_width = config.width;
+        m_height = config.height;
+        m_frameSize = static_cast<size_t>(m_width) * m_height * 3 / 2;
+        m_frameCount = m_frameSize > 0 ? static_cast<size_t>(st.st_size) / m_frameSize : 0;
+        if (m_frameCount == 0) {
+            qWarning() << "YUV file: smaller than one" << m_width << "x" << m_height << "frame";
+            ::close(fd);
+            return false;
+        }
+
+        m_mapSize = m_frameCount * m_frameSize;
+        void *base = mmap(nullptr, m_mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            qWarning() << "YUV file: mmap failed" << std::strerror(errno);
+            return false;
+        }
+        madvise(base, m_mapSize, MADV_SEQUENTIAL | MADV_WILLNEED);
+        m_base = static_cast<uint8_t *>(base);
+        m_interval = std::chrono::microseconds(1000000 / std::max(1, config.fps));
+        m_next = std::chrono::steady_clock::now();
+
+        qDebug() << "YUV file:" << config.path.c_str() << m_frameCount << "frames of"
+                 << m_width << "x" << m_height << "@" << config.fps << "fps";
+        return true;
+    }
+
+    bool readFrame(RtcExternalVideoFrame &frame, int timeoutMs) override {
+        auto now = std::chrono::steady_clock::now();
+        if (m_next > now + std::chrono::milliseconds(timeoutMs)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+            return false;
+        }
+        std::this_thread::sleep_until(m_next);
+        m_next += m_interval;
+        if (std::chrono::steady_clock::now() > m_next + m_interval) {
+            m_next = std::chrono::steady_clock::now();
+        }
+
+        frame.format = RtcPixelFormat::I420;
+        fillPlanes(frame, m_base + m_current * m_frameSize, m_width, m_height, m_width);
+        frame.timestampUs = nowUs();
+        frame.release = &YuvFileCapture::releaseFrame;
+        frame.opaque = this;
+        frame.bufferIndex = static_cast<int>(m_current);
+        ++m_outstanding;
+
+        m_current = (m_current + 1) % m_frameCount;
+        return true;
+    }
+
+    void close() override {
+        if (!m_base) return;
+        if (waitOutstanding("YUV file")) {
+            munmap(m_base, m_mapSize);
+        }
+        m_base = nullptr;
+    }
+
+private:
+    static void releaseFrame(void *opaque, int) {
+        --static_cast<YuvFileCapture *>(opaque)->m_outstanding;
+    }
+
+    uint8_t *m_base = nullptr;
+    size_t m_mapSize = 0;
+    size_t m_frameSize = 0;
+    size_t m_frameCount = 0;
+    size_t m_current = 0;
+    int m_width = 0;
+    int m_height = 0;
+    std::chrono::microseconds m_interval{66666};
+    std::chrono::steady_clock::time_point m_next;
+};
+
+// 共享内存生产者：帧在对方进程写入的槽中，引擎用完后槽置回空闲
+class ShmCapture : public ExternalVideoSource::Capture {
+public:
+    ~ShmCapture() override { close(); }
+
+    bool open(const ExternalVideoSourceConfig &config) override {
+        int fd = shm_open(config.path.c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            qWarning() << "SHM video: cannot open" << config.path.c_str() << std::strerror(errno);
+            return false;
+        }
+        struct stat st{};
+        if (fstat(fd, &st) < 0) {
+            st.st_size = 0;
+        }
+        m_mapSize = static_cast<size_t>(st.st_size);
+        void *base = m_mapSize >= sizeof(ShmVideoHeader)
+                ? mmap(nullptr, m_mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            qWarning() << "SHM video: mmap failed";
+            return false;
+        }
+        m_base = static_cast<uint8_t *>(base);
+        m_header = reinterpret_cast<ShmVideoHeader *>(m_base);
+
+        // 段由外部进程写入，几何参数只在这里读取一次并校验，之后只用校验过的副本
+        const auto *h = m_header;
+        const uint32_t width = h->width;
+        const uint32_t height = h->height;
+        const uint32_t slotCount = h->slotCount;
+        const uint32_t slotSize = h->slotSize;
+        const uint32_t dataOffset = h->dataOffset;
+        const uint64_t frameBytes = uint64_t(width) * height * 3 / 2;
+        if (h->magic != ShmVideoHeader::kMagic || h->version != ShmVideoHeader::kVersion
+            || width == 0 || height == 0 || (width & 1) || (height & 1)
+            || width > kMaxShmDimension || height > kMaxShmDimension
+            || slotCount == 0 || slotCount > ShmVideoHeader::kMaxSlots
+            || dataOffset < sizeof(ShmVideoHeader)
+            || uint64_t(dataOffset) + uint64_t(slotCount) * slotSize > m_mapSize
+            || frameBytes > slotSize) {
+            qWarning() << "SHM video: invalid header in" << config.path.c_str();
+            munmap(m_base, m_mapSize);
+            m_base = nullptr;
+            m_header = nullptr;
+            return false;
+        }
+        m_width = static_cast<int>(width);
+        m_height = static_cast<int>(height);
+        m_format = h->format == 1 ? RtcPixelFormat::NV12 : RtcPixelFormat::I420;
+        m_slotCount = slotCount;
+        m_slotSize = slotSize;
+        m_dataOffset = dataOffset;
+        m_lastSeq = h->frameSeq.load(std::memory_order_acquire);
+
+        qDebug() << "SHM video:" << config.path.c_str() << m_width << "x" << m_height
+                 << (m_format == RtcPixelFormat::NV12 ? "NV12" : "I420") << m_slotCount << "slots";
+        return true;
+    }
+
+    bool readFrame(RtcExternalVideoFrame &frame, int timeoutMs) override {
+        auto *seqWord = reinterpret_cast<uint32_t *>(&m_header->frameSeq);
+        if (m_header->frameSeq.load(std::memory_order_acquire) == m_lastSeq) {
+            timespec ts{timeoutMs / 1000, (timeoutMs % 1000) * 1000000L};
+            syscall(SYS_futex, seqWord, FUTEX_WAIT, m_lastSeq, &ts, nullptr, 0);
+        }
+        m_lastSeq = m_header->frameSeq.load(std::memory_order_acquire);
+
+        // 取最新的就绪槽，较旧的就绪槽留给生产者回收
+        for (;;) {
+            int best = -1;
+            uint32_t bestSeq = 0;
+            for (uint32_t i = 0; i < m_slotCount; ++i) {
+                auto &slot = m_header->slots[i];
+                if (slot.state.load(std::memory_order_acquire) != ShmVideoHeader::kSlotReady) continue;
+                const uint32_t seq = slot.seq.load(std::memory_order_acquire);
+                if (best < 0 || static_cast<int32_t>(seq - bestSeq) > 0) {
+                    best = static_cast<int>(i);
+                    bestSeq = seq;
+                }
+            }
+            if (best < 0) {
+                return false;
+            }
+            uint32_t expected = ShmVideoHeader::kSlotReady;
+            if (m_header->slots[best].state.compare_exchange_strong(expected, ShmVideoHeader::kSlotInUse,
+                                                                   std::memory_order_acq_rel)) {
+                auto &slot = m_header->slots[best];
+                frame.format = m_format;
+                fillPlanes(frame, m_base + m_dataOffset + static_cast<size_t>(best) * m_slotSize,
+                           m_width, m_height, m_width);
+                frame.timestampUs = slot.timestampUs ? slot.timestampUs : nowUs();
+                frame.release = &ShmCapture::releaseSlot;
+                frame.opaque = this;
+                frame.bufferIndex = best;
+                ++m_outstanding;
+                return true;
+            }
+        }
+    }
+
+    void close() override {
+        if (!m_base) return;
+        if (waitOutstanding("SHM video")) {
+            munmap(m_base, m_mapSize);
+        }
+        m_base = nullptr;
+        m_header = nullptr;
+    }
+
+private:
+    static void releaseSlot(void *opaque, int bufferIndex) {
+        auto *self = static_cast<ShmCapture *>(opaque);
+        self->m_header->slots[bufferIndex].state.store(ShmVideoHeader::kSlotFree, std::memory_order_release);
+        --self->m_outstanding;
+    }
+
+    // 宽高上限，保证 fillPlanes 中的 int 运算不溢出
+    static constexpr uint32_t kMaxShmDimension = 16384;
+
+    uint8_t *m_base = nullptr;
+    size_t m_mapSize = 0;
+    ShmVideoHeader *m_header = nullptr;
+    uint32_t m_lastSeq = 0;
+    int m_width = 0;
+    int m_height = 0;
+    RtcPixelFormat m_format = RtcPixelFormat::I420;
+    uint32_t m_slotCount = 0;
+    size_t m_slotSize = 0;
+    size_t m_dataOffset = 0;
+};
+
+// ── ExternalVideoSource 实现 ──────────────────────────────────────
+
+ExternalVideoSource::ExternalVideoSource(const ExternalVideoSourceConfig &config)
+    : m_config(config) {
+}
+
+ExternalVideoSource::~ExternalVideoSource() {
+    stop();
+    if (m_capture) {
+        m_capture->close();
+    }
+}
+
+bool ExternalVideoSource::start(IRtcEngine *engine) {
+    if (m_running) return true;
+
+    if (!m_capture) {
+        switch (m_config.type) {
+        case ExternalVideoSourceConfig::Type::V4l2:
+            m_capture = std::make_unique<V4l2Capture>();
+            break;
+        case ExternalVideoSourceConfig::Type::YuvFile:
+            m_capture = std::make_unique<YuvFileCapture>();
+            break;
+        case ExternalVideoSourceConfig::Type::SharedMemory:
+            m_capture = std::make_unique<ShmCapture>();
+            break;
+        case ExternalVideoSourceConfig::Type::None:
+            return false;
+        }
+        if (!m_capture->open(m_config)) {
+            m_capture.reset();
+            return false;
+        }
+    }
+
+    m_engine = engine;
+    m_running = true;
+    m_thread = std::thread(&ExternalVideoSource::captureLoop, this);
+    return true;
+}
+
+void ExternalVideoSource::stop() {
+    if (!m_running.exchange(false)) return;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    qDebug() << "External video source stopped: pushed" << m_pushedFrames << "frames,"
+             << m_failedPushes << "rejected";
+}
+
+void ExternalVideoSource::captureLoop() {
+    ThreadPolicy::registerCurrentThread(ThreadClass::Video, "video-capture");
+    while (m_running) {
+        RtcExternalVideoFrame frame;
+        if (!m_capture->readFrame(frame, 100)) {
+            continue;
+        }
+        // 推送失败时引擎会同步调用 release，缓冲不会泄漏
+        if (m_engine->pushExternalVideoFrame(frame) == 0) {
+            ++m_pushedFrames;
+        } else {
+            ++m_failedPushes;
+        }
+    }
+}
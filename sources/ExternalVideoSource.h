@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include "RtcBackend.h"
+
+/**
+ * 外部视频源配置
+ *
+ * 通过环境变量 QUICKSTART_VIDEO_SOURCE 选择，未设置时使用 SDK 内置摄像头采集：
+ *   v4l2:/dev/video0[:640x480@30]     V4L2 设备（优先 NV12/YUV420，mmap 缓冲直接交给引擎）
+ *   yuv:/path/to/file.yuv:640x360@15  I420 裸文件（mmap 后循环播放）
+ *   shm:/quickstart-video             共享内存生产者（布局见 ShmVideoHeader）
+ */
+struct ExternalVideoSourceConfig {
+    enum class Type {
+        None,
+        V4l2,
+        YuvFile,
+        SharedMemory,
+    };
+
+    Type type = Type::None;
+    std::string path;
+    int width = 640;
+    int height = 480;
+    int fps = 30;
+
+    static ExternalVideoSourceConfig fromEnvironment();
+};
+
+/**
+ * 共享内存视频帧环的布局（版本 1），外部进程按此格式写入：
+ *
+ * - 段起始处为 ShmVideoHeader，帧数据从 dataOffset 开始，每个槽 slotSize 字节
+ * - 生产者将空闲槽（kSlotFree）CAS 为 kSlotWriting，写入整帧后填 seq/timestampUs，
+ *   再以 release 语义置为 kSlotReady，然后递增 frameSeq 并对其执行 FUTEX_WAKE
+ * - 本进程只在 open 时读取并校验宽高、槽数与偏移，之后不再信任段内的这些字段
+ * - 没有空闲槽时，生产者可以把最旧的 kSlotReady 槽 CAS 回 kSlotWriting 复用
+ * - 本进程取 seq 最大的就绪槽（CAS 为 kSlotInUse），引擎用完后置回 kSlotFree
+ */
+struct ShmVideoHeader {
+    static constexpr uint32_t kMagic = 0x46565351;  // "QSVF"
+    static constexpr uint32_t kVersion = 1;
+    static constexpr int kMaxSlots = 8;
+
+    enum SlotState : uint32_t {
+        kSlotFree = 0,
+        kSlotWriting = 1,
+        kSlotReady = 2,
+        kSlotInUse = 3,
+    };
+
+    struct Slot {
+        std::atomic<uint32_t> state;
+        std::atomic<uint32_t> seq;   // 就绪槽可能随时被生产者回收改写，须原子读取
+        int64_t timestampUs;
+    };
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;      // 0 = I420, 1 = NV12
+    uint32_t slotCount;
+    uint32_t slotSize;
+    uint32_t dataOffset;
+    std::atomic<uint32_t> frameSeq;
+    uint32_t reserved;
+    Slot slots[kMaxSlots];
+};
+
+static_assert(sizeof(ShmVideoHeader::Slot) == 16, "shm video slot layout");
+static_assert(sizeof(ShmVideoHeader) == 40 + ShmVideoHeader::kMaxSlots * 16, "shm video header layout");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared atomics must be lock free");
+
+/**
+ * 外部视频源
+ *
+ * 在独立线程上从采集后端读取帧，并通过 IRtcEngine::pushExternalVideoFrame 推送给引擎。
+ * 帧内存直接来自 V4L2 的 mmap 缓冲、mmap 的文件或共享内存槽，
+ * 引擎用完后经释放回调归还，采集与引擎之间不发生拷贝；
+ * 只有设备仅支持 YUYV 时才转换一次到预分配的 VideoFramePool 缓冲中。
+ *
+ * 生命周期：start() → stop()（停止采集线程）→ 销毁引擎 → 析构（等待引擎归还全部帧后释放映射）。
+ */
+class ExternalVideoSource {
+public:
+    class Capture;
+
+    explicit ExternalVideoSource(const ExternalVideoSourceConfig &config);
+    ~ExternalVideoSource();
+
+    bool start(IRtcEngine *engine);
+    void stop();
+
+    bool isRunning() const { return m_running; }
+
+private:
+    void captureLoop();
+
+    ExternalVideoSourceConfig m_config;
+    std::unique_ptr<Capture> m_capture;
+    IRtcEngine *m_engine = nullptr;
+    std::atomic<bool> m_running{false};
+    std::thread m_thread;
+    uint64_t m_pushedFrames = 0;
+    uint64_t m_failedPushes = 0;
+};
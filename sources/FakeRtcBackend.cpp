@@ -0,0 +1,752 @@
+#include "FakeRtcBackend.h"
+#include "ThreadPolicy.h"
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace {
+
+int64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+FakeRtcConfig FakeRtcConfig::fromEnvironment() {
+    FakeRtcConfig config;
+    const char *value = std::getenv("QUICKSTART_FAKE_RTC");
+    if (!value) {
+        return config;
+    }
+
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        auto pos = item.find('=');
+        if (pos == std::string::npos) continue;
+        std::string key = item.substr(0, pos);
+        int number = std::atoi(item.c_str() + pos + 1);
+
+        if (key == "width") config.videoWidth = number;
+        else if (key == "height") config.videoHeight = number;
+        else if (key == "fps") config.videoFps = number;
+        else if (key == "sample_rate") config.audioSampleRate = number;
+        else if (key == "channels") config.audioChannels = number;
+        else if (key == "frame_ms") config.audioFrameMs = number;
+        else if (key == "talk_ms") config.talkMs = number;
+        else if (key == "pause_ms") config.pauseMs = number;
+        else if (key == "users") config.remoteUsers = number;
+        else if (key == "join_delay_ms") config.joinDelayMs = number;
+        else if (key == "churn_ms") config.userChurnMs = number;
+        else if (key == "stats_ms") config.statsIntervalMs = number;
+        else if (key == "tx_quality") config.txQuality = number;
+        else if (key == "loss") config.lossPercent = number;
+        else qWarning() << "QUICKSTART_FAKE_RTC: unknown key" << key.c_str();
+    }
+
+    // I420 要求偶数宽高
+    config.videoWidth = std::max(2, config.videoWidth & ~1);
+    config.videoHeight = std::max(2, config.videoHeight & ~1);
+    config.videoFps = std::max(1, config.videoFps);
+    config.audioFrameMs = std::max(1, config.audioFrameMs);
+    config.audioChannels = std::max(1, config.audioChannels);
+    config.remoteUsers = std::max(0, config.remoteUsers);
+    return config;
+}
+
+// ── 房间 ──────────────────────────────────────────────────────────
+
+class FakeRtcEngine::Room : public IRtcRoom {
+public:
+    Room(FakeRtcEngine *engine, const std::string &roomId)
+        : m_engine(engine), m_roomId(roomId) {}
+
+    int joinRoom(const std::string &token, const std::string &userId, const RtcRoomConfig &config) override {
+        m_engine->joinRoom(m_roomId, userId, config.autoSubscribeVideo);
+        return 0;
+    }
+
+    int leaveRoom() override {
+        m_engine->leaveRoom();
+        return 0;
+    }
+
+    int publishStreamAudio(bool publish) override {
+        m_publishAudio = publish;
+        return 0;
+    }
+
+    int subscribeStreamVideo(const std::string &streamId, bool subscribe) override {
+        return m_engine->subscribeStreamVideo(streamId, subscribe);
+    }
+
+    int setRemoteVideoConfig(const std::string &streamId, const RtcRemoteVideoConfig &config) override {
+        return m_engine->setRemoteVideoConfig(streamId, config);
+    }
+
+private:
+    FakeRtcEngine *m_engine;
+    std::string m_roomId;
+    std::atomic<bool> m_publishAudio{true};
+};
+
+// ── FakeRtcEngine 实现 ────────────────────────────────────────────
+
+FakeRtcEngine::FakeRtcEngine(const FakeRtcConfig &config)
+    : m_config(config) {
+    qDebug() << "FakeRtcEngine: video" << m_config.videoWidth << "x" << m_config.videoHeight
+             << "@" << m_config.videoFps << "fps, audio" << m_config.audioSampleRate << "Hz /"
+             << m_config.audioFrameMs << "ms, remote users" << m_config.remoteUsers;
+}
+
+FakeRtcEngine::~FakeRtcEngine() {
+    destroy();
+}
+
+std::string FakeRtcEngine::sdkVersion() const {
+    return "FakeRTC";
+}
+
+bool FakeRtcEngine::create(const std::string &appId, IRtcEventHandler *handler) {
+    if (m_running) {
+        qWarning() << "FakeRtcEngine already created";
+        return false;
+    }
+    m_handler = handler;
+
+    const size_t frameSize = static_cast<size_t>(m_config.videoWidth) * m_config.videoHeight * 3 / 2;
+    m_localFrame.assign(frameSize, 0);
+    m_firstLocalFrameSent = false;
+
+    m_running = true;
+    m_videoThread = std::thread(&FakeRtcEngine::videoLoop, this);
+    m_audioThread = std::thread(&FakeRtcEngine::audioLoop, this);
+    m_eventThread = std::thread(&FakeRtcEngine::eventLoop, this);
+    return true;
+}
+
+void FakeRtcEngine::destroy() {
+    if (!m_running) {
+        return;
+    }
+    m_room.reset();
+    leaveRoom();
+
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_running = false;
+    }
+    m_stateCond.notify_all();
+    m_videoThread.join();
+    m_audioThread.join();
+    m_eventThread.join();
+
+    m_videoCapturing = false;
+    m_audioCapturing = false;
+    m_handler = nullptr;
+}
+
+int FakeRtcEngine::setVideoEncoderProfile(const RtcVideoEncoderProfile &profile) {
+    qDebug() << "FakeRtcEngine: encoder profile" << profile.width << "x" << profile.height
+             << "@" << profile.frameRate << "fps";
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    m_encoderProfile = profile;
+    return 0;
+}
+
+int FakeRtcEngine::setLocalVideoCanvas(void *view) {
+    return 0;
+}
+
+int FakeRtcEngine::setRemoteVideoCanvas(const std::string &streamId, void *view) {
+    return 0;
+}
+
+int FakeRtcEngine::startVideoCapture() {
+    m_videoCapturing = true;
+    return 0;
+}
+
+int FakeRtcEngine::stopVideoCapture() {
+    m_videoCapturing = false;
+    return 0;
+}
+
+int FakeRtcEngine::startAudioCapture() {
+    m_audioCapturing = true;
+    return 0;
+}
+
+int FakeRtcEngine::stopAudioCapture() {
+    m_audioCapturing = false;
+    return 0;
+}
+
+int FakeRtcEngine::setExternalVideoSource(bool enable) {
+    m_externalVideoSource = enable;
+    return 0;
+}
+
+int FakeRtcEngine::pushExternalVideoFrame(const RtcExternalVideoFrame &frame) {
+    if (!m_running || !m_externalVideoSource) {
+        if (frame.release) frame.release(frame.opaque, frame.bufferIndex);
+        return -1;
+    }
+
+    // 本地观察者只接收 I420，NV12 帧只模拟编码消耗
+    if (frame.format == RtcPixelFormat::I420) {
+        RtcVideoFrame view;
+        view.width = frame.width;
+        view.height = frame.height;
+        for (int i = 0; i < 3; ++i) {
+            view.planes[i] = frame.planes[i];
+            view.strides[i] = frame.strides[i];
+        }
+        view.timestampUs = frame.timestampUs;
+        m_videoObservers.forEach([&](IRtcVideoFrameObserver *observer) {
+            observer->onLocalVideoFrame(view);
+        });
+    }
+
+    bool firstFrame = false;
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        firstFrame = !m_firstLocalFrameSent;
+        m_firstLocalFrameSent = true;
+    }
+    if (firstFrame && m_handler) m_handler->onFirstLocalVideoFrameCaptured();
+
+    if (frame.release) frame.release(frame.opaque, frame.bufferIndex);
+    return 0;
+}
+
+int FakeRtcEngine::setExternalAudioDevice(bool enable) {
+    m_externalAudioDevice = enable;
+    return 0;
+}
+
+int FakeRtcEngine::pushExternalAudioFrame(const RtcAudioFrame &frame) {
+    if (!m_running || !m_externalAudioDevice) return -1;
+    m_audioObservers.forEach([&](IRtcAudioFrameObserver *observer) {
+        observer->onRecordAudioFrame(frame);
+    });
+    return 0;
+}
+
+int FakeRtcEngine::pullExternalAudioFrame(int16_t *data, int samplesPerChannel, int channels, int sampleRate) {
+    const size_t count = size_t(samplesPerChannel) * channels;
+    if (!m_running || !m_externalAudioDevice || sampleRate <= 0) {
+        std::fill(data, data + count, int16_t(0));
+        return -1;
+    }
+
+    bool inRoom;
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        inRoom = m_inRoom;
+    }
+    if (!inRoom) {
+        std::fill(data, data + count, int16_t(0));
+        return 0;
+    }
+
+    // 与内部播放相同的 220 Hz 远端信号
+    const double twoPi = 6.283185307179586;
+    for (int i = 0; i < samplesPerChannel; ++i) {
+        auto sample = static_cast<int16_t>(6000.0 * std::sin(m_pullPhase));
+        m_pullPhase += twoPi * 220.0 / sampleRate;
+        for (int ch = 0; ch < channels; ++ch) {
+            data[i * channels + ch] = sample;
+        }
+    }
+    m_pullPhase = std::fmod(m_pullPhase, twoPi);
+
+    RtcAudioFrame frame;
+    frame.data = data;
+    frame.samplesPerChannel = samplesPerChannel;
+    frame.channels = channels;
+    frame.sampleRate = sampleRate;
+    frame.timestampUs = nowUs();
+    m_audioObservers.forEach([&](IRtcAudioFrameObserver *observer) {
+        observer->onPlaybackAudioFrame(frame);
+    });
+    return 0;
+}
+
+IRtcRoom *FakeRtcEngine::createRoom(const std::string &roomId) {
+    if (!m_running || m_room) {
+        return nullptr;
+    }
+    m_room = std::make_unique<Room>(this, roomId);
+    return m_room.get();
+}
+
+void FakeRtcEngine::destroyRoom(IRtcRoom *room) {
+    if (!room || room != m_room.get()) {
+        return;
+    }
+    leaveRoom();
+    m_room.reset();
+}
+
+void FakeRtcEngine::addVideoFrameObserver(IRtcVideoFrameObserver *observer) {
+    m_videoObservers.add(observer);
+}
+
+void FakeRtcEngine::removeVideoFrameObserver(IRtcVideoFrameObserver *observer) {
+    m_videoObservers.remove(observer);
+}
+
+void FakeRtcEngine::addAudioFrameObserver(IRtcAudioFrameObserver *observer) {
+    m_audioObservers.add(observer);
+}
+
+void FakeRtcEngine::removeAudioFrameObserver(IRtcAudioFrameObserver *observer) {
+    m_audioObservers.remove(observer);
+}
+
+void FakeRtcEngine::joinRoom(const std::string &roomId, const std::string &userId, bool autoSubscribeVideo) {
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_roomId = roomId;
+        m_localUserId = userId;
+        m_autoSubscribeVideo = autoSubscribeVideo;
+        m_remoteUsers.clear();
+        m_remoteUsers.resize(m_config.remoteUsers);
+        for (int i = 0; i < m_config.remoteUsers; ++i) {
+            m_remoteUsers[i].userId = "fake_user_" + std::to_string(i + 1);
+            m_remoteUsers[i].streamId = "fake_stream_" + std::to_string(i + 1);
+        }
+        m_joinPending = true;
+        m_joinAt = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_config.joinDelayMs);
+    }
+    m_stateCond.notify_all();
+}
+
+int FakeRtcEngine::subscribeStreamVideo(const std::string &streamId, bool subscribe) {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    for (auto &user : m_remoteUsers) {
+        if (user.streamId != streamId) continue;
+        if (!user.present) return -1;
+        if (user.subscribed != subscribe) {
+            user.subscribed = subscribe;
+            user.firstFrameSent = false;
+            qDebug() << "FakeRtcEngine:" << (subscribe ? "subscribe" : "unsubscribe") << streamId.c_str();
+        }
+        return 0;
+    }
+    return -1;
+}
+
+int FakeRtcEngine::setRemoteVideoConfig(const std::string &streamId, const RtcRemoteVideoConfig &config) {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    for (auto &user : m_remoteUsers) {
+        if (user.streamId != streamId) continue;
+        // 模拟发布端的三层 simulcast（原始、1/2、1/4），选不小于请求分辨率的最小一层
+        int layer = 0;
+        if (config.width > 0 && config.height > 0) {
+            while (layer < 2 && (m_config.videoWidth >> (layer + 1)) >= config.width
+                   && (m_config.videoHeight >> (layer + 1)) >= config.height) {
+                ++layer;
+            }
+        }
+        user.layer = layer;
+        user.frameDivider = config.frameRate > 0 ? std::max(1, m_config.videoFps / config.frameRate) : 1;
+        qDebug() << "FakeRtcEngine:" << streamId.c_str() << "layer"
+                 << ((m_config.videoWidth >> layer) & ~1) << "x" << ((m_config.videoHeight >> layer) & ~1)
+                 << "@" << m_config.videoFps / user.frameDivider << "fps";
+        return 0;
+    }
+    return -1;
+}
+
+void FakeRtcEngine::leaveRoom() {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    m_inRoom = false;
+    m_joinPending = false;
+    m_remoteUsers.clear();
+}
+
+// ── 合成数据生成 ──────────────────────────────────────────────────
+
+void FakeRtcEngine::renderSyntheticFrame(std::vector<uint8_t> &buffer, int width, int height, int seed,
+                                         int64_t frameIndex, RtcVideoFrame &frame) const {
+    uint8_t *y = buffer.data();
+    uint8_t *u = y + width * height;
+    uint8_t *v = u + (width / 2) * (height / 2);
+
+    // 斜向移动的亮度渐变，保证每帧内容都不同
+    const int offset = static_cast<int>(frameIndex * 4);
+    for (int row = 0; row < height; ++row) {
+        uint8_t *line = y + row * width;
+        for (int col = 0; col < width; ++col) {
+            line[col] = static_cast<uint8_t>(col + row + offset);
+        }
+    }
+    std::memset(u, 64 + seed * 40, (width / 2) * (height / 2));
+    std::memset(v, 192 - seed * 40, (width / 2) * (height / 2));
+
+    frame.format = RtcPixelFormat::I420;
+    frame.width = width;
+    frame.height = height;
+    frame.planes[0] = y;
+    frame.planes[1] = u;
+    frame.planes[2] = v;
+    frame.strides[0] = width;
+    frame.strides[1] = width / 2;
+    frame.strides[2] = width / 2;
+    frame.timestampUs = nowUs();
+}
+
+void FakeRtcEngine::videoLoop() {
+    ThreadPolicy::registerCurrentThread(ThreadClass::Video, "fake-video");
+    const auto interval = std::chrono::microseconds(1000000 / m_config.videoFps);
+    const size_t frameSize = static_cast<size_t>(m_config.videoWidth) * m_config.videoHeight * 3 / 2;
+    auto next = std::chrono::steady_clock::now();
+    int64_t frameIndex = 0;
+
+    // 本轮要生成的远端帧，在 m_stateMutex 内取出，字符串容量跨轮复用
+    struct RemoteFrame {
+        size_t index = 0;
+        std::string streamId;
+        std::string userId;
+        int width = 0;
+        int height = 0;
+        bool first = false;
+    };
+    std::vector<RemoteFrame> remoteFrames;
+    // 按远端用户序号预分配的 I420 缓冲，只在视频线程上访问
+    std::vector<std::vector<uint8_t>> remoteBuffers;
+
+    while (m_running) {
+        next += interval;
+        {
+            std::unique_lock<std::mutex> lock(m_stateMutex);
+            if (m_stateCond.wait_until(lock, next, [this] { return !m_running; })) {
+                break;
+            }
+        }
+
+        std::lock_guard<std::mutex> dispatch(m_dispatchMutex);
+        bool renderLocal = false;
+        bool firstLocal = false;
+        size_t remoteCount = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_stateMutex);
+            renderLocal = m_videoCapturing && !m_externalVideoSource;
+            if (renderLocal && !m_firstLocalFrameSent) {
+                m_firstLocalFrameSent = true;
+                firstLocal = true;
+            }
+
+            if (m_inRoom) {
+                for (size_t i = 0; i < m_remoteUsers.size(); ++i) {
+                    auto &user = m_remoteUsers[i];
+                    if (!user.present || !user.subscribed) continue;
+                    if (frameIndex % user.frameDivider != 0) continue;
+
+                    if (remoteFrames.size() <= remoteCount) {
+                        remoteFrames.emplace_back();
+                    }
+                    RemoteFrame &remote = remoteFrames[remoteCount++];
+                    remote.index = i;
+                    remote.streamId = user.streamId;
+                    remote.userId = user.userId;
+                    remote.width = std::max(2, (m_config.videoWidth >> user.layer) & ~1);
+                    remote.height = std::max(2, (m_config.videoHeight >> user.layer) & ~1);
+                    remote.first = !user.firstFrameSent;
+                    user.firstFrameSent = true;
+                }
+            }
+        }
+
+        RtcVideoFrame frame;
+        if (renderLocal) {
+            renderSyntheticFrame(m_localFrame, m_config.videoWidth, m_config.videoHeight, 0, frameIndex, frame);
+            m_videoObservers.forEach([&](IRtcVideoFrameObserver *observer) {
+                observer->onLocalVideoFrame(frame);
+            });
+            if (firstLocal && m_handler) m_handler->onFirstLocalVideoFrameCaptured();
+        }
+
+        for (size_t n = 0; n < remoteCount; ++n) {
+            const RemoteFrame &remote = remoteFrames[n];
+            // 缓冲按原始分辨率分配，较低的层直接复用
+            if (remoteBuffers.size() <= remote.index) {
+                remoteBuffers.resize(remote.index + 1);
+            }
+            auto &buffer = remoteBuffers[remote.index];
+            if (buffer.size() < frameSize) {
+                buffer.assign(frameSize, 0);
+            }
+            renderSyntheticFrame(buffer, remote.width, remote.height, static_cast<int>(remote.index % 4) + 1,
+                                 frameIndex, frame);
+            m_videoObservers.forEach([&](IRtcVideoFrameObserver *observer) {
+                observer->onRemoteVideoFrame(remote.streamId.c_str(), remote.userId.c_str(), frame);
+            });
+            if (remote.first && m_handler) {
+                m_handler->onFirstRemoteVideoFrameDecoded(remote.streamId.c_str(), remote.userId.c_str());
+            }
+        }
+        ++frameIndex;
+
+        // 处理不过来时不追帧，直接从当前时间重新计时
+        auto now = std::chrono::steady_clock::now();
+        if (now > next + interval) {
+            next = now;
+        }
+    }
+}
+
+void FakeRtcEngine::audioLoop() {
+    ThreadPolicy::registerCurrentThread(ThreadClass::Audio, "fake-audio");
+    const auto interval = std::chrono::milliseconds(m_config.audioFrameMs);
+    const int samplesPerChannel = m_config.audioSampleRate * m_config.audioFrameMs / 1000;
+    std::vector<int16_t> record(static_cast<size_t>(samplesPerChannel) * m_config.audioChannels);
+    std::vector<int16_t> playback(record.size());
+    const double twoPi = 6.283185307179586;
+    double recordPhase = 0.0;
+    double playbackPhase = 0.0;
+    const int talkCycleMs = m_config.talkMs > 0 ? m_config.talkMs + std::max(0, m_config.pauseMs) : 0;
+    int64_t recordElapsedMs = 0;
+    auto next = std::chrono::steady_clock::now();
+
+    while (m_running) {
+        next += interval;
+        std::this_thread::sleep_until(next);
+
+        bool inRoom;
+        {
+            std::lock_guard<std::mutex> lock(m_stateMutex);
+            inRoom = m_inRoom;
+        }
+
+        RtcAudioFrame frame;
+        frame.samplesPerChannel = samplesPerChannel;
+        frame.channels = m_config.audioChannels;
+        frame.sampleRate = m_config.audioSampleRate;
+        frame.timestampUs = nowUs();
+
+        // 外部音频设备模式下采集和播放由 push/pullExternalAudioFrame 驱动
+        if (m_audioCapturing && !m_externalAudioDevice) {
+            // 停顿期间只保留很低的底噪
+            bool talking = talkCycleMs == 0 || recordElapsedMs % talkCycleMs < m_config.talkMs;
+            const double amplitude = talking ? 8000.0 : 20.0;
+            recordElapsedMs += m_config.audioFrameMs;
+            for (int i = 0; i < samplesPerChannel; ++i) {
+                auto sample = static_cast<int16_t>(amplitude * std::sin(recordPhase));
+                recordPhase += twoPi * 440.0 / m_config.audioSampleRate;
+                for (int ch = 0; ch < m_config.audioChannels; ++ch) {
+                    record[i * m_config.audioChannels + ch] = sample;
+                }
+            }
+            recordPhase = std::fmod(recordPhase, twoPi);
+            frame.data = record.data();
+            m_audioObservers.forEach([&](IRtcAudioFrameObserver *observer) {
+                observer->onRecordAudioFrame(frame);
+            });
+        }
+
+        if (inRoom && !m_externalAudioDevice) {
+            for (int i = 0; i < samplesPerChannel; ++i) {
+                auto sample = static_cast<int16_t>(6000.0 * std::sin(playbackPhase));
+                playbackPhase += twoPi * 220.0 / m_config.audioSampleRate;
+                for (int ch = 0; ch < m_config.audioChannels; ++ch) {
+                    playback[i * m_config.audioChannels + ch] = sample;
+                }
+            }
+            playbackPhase = std::fmod(playbackPhase, twoPi);
+            frame.data = playback.data();
+            m_audioObservers.forEach([&](IRtcAudioFrameObserver *observer) {
+                observer->onPlaybackAudioFrame(frame);
+            });
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now > next + interval) {
+            next = now;
+        }
+    }
+}
+
+// 调用时持有 m_stateMutex
+void FakeRtcEngine::collectStats(std::vector<HandlerEvent> &events) {
+    if (!m_handler) return;
+
+    RtcNetworkQuality quality;
+    quality.txQuality = m_config.txQuality;
+    quality.rxQuality = m_config.txQuality;
+    quality.lossRate = m_config.lossPercent / 100.0f;
+    quality.rttMs = 40;
+    events.emplace_back();
+    events.back().type = HandlerEvent::Type::NetworkQuality;
+    events.back().quality = quality;
+
+    // 未设置码率上限时按每像素 0.1 bit 粗略估算
+    const auto &profile = m_encoderProfile;
+    RtcLocalStreamStats stats;
+    stats.sentKbps = profile.maxBitrateKbps > 0
+            ? static_cast<float>(profile.maxBitrateKbps)
+            : profile.width * profile.height * profile.frameRate * 0.1f / 1000.0f;
+    stats.inputFrameRate = m_videoCapturing ? static_cast<float>(m_config.videoFps) : 0.0f;
+    stats.encoderOutputFrameRate = std::min(stats.inputFrameRate, static_cast<float>(profile.frameRate));
+    stats.encodedWidth = profile.width;
+    stats.encodedHeight = profile.height;
+    stats.lossRate = quality.lossRate;
+    stats.rttMs = quality.rttMs;
+    events.emplace_back();
+    events.back().type = HandlerEvent::Type::LocalStreamStats;
+    events.back().localStats = stats;
+
+    // 远端统计按当前订阅的 simulcast 层估算，解码耗时按每百万像素 2 ms 计
+    for (size_t i = 0; i < m_remoteUsers.size(); ++i) {
+        const auto &user = m_remoteUsers[i];
+        if (!user.present || !user.subscribed) continue;
+
+        RtcRemoteStreamStats remote;
+        remote.width = std::max(2, (m_config.videoWidth >> user.layer) & ~1);
+        remote.height = std::max(2, (m_config.videoHeight >> user.layer) & ~1);
+        remote.decoderOutputFrameRate = static_cast<float>(m_config.videoFps) / user.frameDivider;
+        remote.renderFrameRate = remote.decoderOutputFrameRate;
+        remote.receivedKbps = remote.width * remote.height * remote.decoderOutputFrameRate * 0.1f / 1000.0f;
+        remote.lossRate = quality.lossRate;
+        remote.rttMs = quality.rttMs;
+        remote.jitterBufferDelayMs = 40 + static_cast<int>(i * 7 % 20) + m_config.lossPercent * 5;
+        remote.e2eDelayMs = remote.rttMs / 2 + remote.jitterBufferDelayMs + 20;
+        remote.decodeTimeMs = remote.width * remote.height * 2.0f / 1e6f;
+        events.emplace_back();
+        events.back().type = HandlerEvent::Type::RemoteStreamStats;
+        events.back().id = user.streamId;
+        events.back().userId = user.userId;
+        events.back().remoteStats = remote;
+    }
+}
+
+// 调用时持有 m_stateMutex
+void FakeRtcEngine::publishRemoteUser(RemoteUser &user, bool present, std::vector<HandlerEvent> &events) {
+    user.present = present;
+    user.subscribed = present && m_autoSubscribeVideo;
+    user.firstFrameSent = false;
+    user.layer = 0;
+    user.frameDivider = 1;
+    if (!m_handler) return;
+    events.emplace_back();
+    events.back().type = present ? HandlerEvent::Type::UserPublished : HandlerEvent::Type::UserUnpublished;
+    events.back().id = user.streamId;
+    events.back().userId = user.userId;
+}
+
+// 调用时持有 m_dispatchMutex、不持有 m_stateMutex
+void FakeRtcEngine::dispatchEvents(std::vector<HandlerEvent> &events) {
+    for (const HandlerEvent &event : events) {
+        switch (event.type) {
+        case HandlerEvent::Type::RoomJoined:
+            m_handler->onRoomStateChanged(event.id.c_str(), event.userId.c_str(), 0, "{}");
+            break;
+        case HandlerEvent::Type::UserPublished:
+            m_handler->onUserJoined(event.userId.c_str());
+            m_handler->onUserPublishStreamVideo(event.id.c_str(), event.userId.c_str(), true);
+            break;
+        case HandlerEvent::Type::UserUnpublished:
+            m_handler->onUserPublishStreamVideo(event.id.c_str(), event.userId.c_str(), false);
+            m_handler->onUserLeave(event.userId.c_str(), 0);
+            break;
+        case HandlerEvent::Type::NetworkQuality:
+            m_handler->onNetworkQuality(event.quality);
+            break;
+        case HandlerEvent::Type::LocalStreamStats:
+            m_handler->onLocalStreamStats(event.localStats);
+            break;
+        case HandlerEvent::Type::RemoteStreamStats:
+            m_handler->onRemoteStreamStats(event.id.c_str(), event.userId.c_str(), event.remoteStats);
+            break;
+        }
+    }
+    events.clear();
+}
+
+void FakeRtcEngine::eventLoop() {
+    ThreadPolicy::registerCurrentThread(ThreadClass::Background, "fake-events");
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point nextChurn = Clock::time_point::max();
+    Clock::time_point nextStats = Clock::time_point::max();
+    size_t churnIndex = 0;
+    std::vector<HandlerEvent> events;
+
+    std::unique_lock<std::mutex> lock(m_stateMutex);
+    while (m_running) {
+        Clock::time_point deadline = std::min(nextChurn, nextStats);
+        if (m_joinPending) {
+            deadline = std::min(deadline, m_joinAt);
+        }
+        if (deadline == Clock::time_point::max()) {
+            m_stateCond.wait(lock);
+        } else {
+            m_stateCond.wait_until(lock, deadline);
+        }
+        if (!m_running) break;
+
+        // 按 m_dispatchMutex → m_stateMutex 的顺序重新加锁，用户的加入、离开与视频线程的帧回调
+        // 保持先后；状态在锁内更新，回调放开 m_stateMutex 之后进行
+        lock.unlock();
+        std::lock_guard<std::mutex> dispatch(m_dispatchMutex);
+        lock.lock();
+        if (!m_running) break;
+
+        const auto now = Clock::now();
+        if (m_joinPending && now >= m_joinAt) {
+            m_joinPending = false;
+            m_inRoom = true;
+            if (m_handler) {
+                events.emplace_back();
+                events.back().type = HandlerEvent::Type::RoomJoined;
+                events.back().id = m_roomId;
+                events.back().userId = m_localUserId;
+            }
+            for (auto &user : m_remoteUsers) {
+                publishRemoteUser(user, true, events);
+            }
+            churnIndex = 0;
+            nextStats = m_config.statsIntervalMs > 0
+                    ? now + std::chrono::milliseconds(m_config.statsIntervalMs)
+                    : Clock::time_point::max();
+            nextChurn = m_config.userChurnMs > 0 && !m_remoteUsers.empty()
+                    ? now + std::chrono::milliseconds(m_config.userChurnMs)
+                    : Clock::time_point::max();
+        }
+
+        if (!m_inRoom) {
+            nextChurn = Clock::time_point::max();
+            nextStats = Clock::time_point::max();
+        } else {
+            if (now >= nextStats) {
+                collectStats(events);
+                nextStats = now + std::chrono::milliseconds(m_config.statsIntervalMs);
+            }
+
+            if (m_remoteUsers.empty()) {
+                nextChurn = Clock::time_point::max();
+            } else if (now >= nextChurn) {
+                // 轮流让用户离开，下一次再让同一用户重新加入
+                auto &user = m_remoteUsers[churnIndex % m_remoteUsers.size()];
+                if (user.present) {
+                    publishRemoteUser(user, false, events);
+                } else {
+                    publishRemoteUser(user, true, events);
+                    ++churnIndex;
+                }
+                nextChurn = now + std::chrono::milliseconds(m_config.userChurnMs);
+            }
+        }
+
+        if (!events.empty()) {
+            lock.unlock();
+            dispatchEvents(events);
+            lock.lock();
+        }
+    }
+}
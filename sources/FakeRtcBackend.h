@@ -0,0 +1,165 @@
+#pragma once
+
+#include "RtcBackend.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * 模拟 RTC 后端的参数
+ *
+ * 通过环境变量 QUICKSTART_FAKE_RTC 以 "key=value,key=value" 形式覆盖，例如：
+ *   QUICKSTART_FAKE_RTC="width=1280,height=720,fps=30,users=3,churn_ms=5000"
+ */
+struct FakeRtcConfig {
+    int videoWidth = 640;
+    int videoHeight = 360;
+    int videoFps = 15;
+    int audioSampleRate = 16000;
+    int audioChannels = 1;
+    int audioFrameMs = 10;
+    int talkMs = 0;           // >0 时麦克风信号按 talkMs 发声、pauseMs 静音交替，用于测试语音检测
+    int pauseMs = 0;
+    int remoteUsers = 1;      // 加入房间后出现的远端用户数
+    int joinDelayMs = 200;    // joinRoom 到房间状态回调的延迟
+    int userChurnMs = 0;      // >0 时每隔该时间让一个远端用户离开或重新加入
+    int statsIntervalMs = 2000;  // 网络质量与流统计回调间隔
+    int txQuality = 1;        // 上报的上行网络质量评分
+    int lossPercent = 0;      // 上报的丢包率（百分比）
+
+    static FakeRtcConfig fromEnvironment();
+};
+
+/**
+ * 进程内模拟 RTC 引擎
+ *
+ * 不依赖 SDK 和任何音视频设备：
+ * - 视频线程按 videoFps 为本地采集和每个远端用户生成 I420 合成帧
+ * - 音频线程按 audioFrameMs 生成采集（正弦波）和播放音频帧
+ * - 事件线程按配置产生房间状态、用户加入/离开和首帧事件
+ * 渲染画布只做记录，不实际绘制。
+ * 关闭自动订阅视频时只为已订阅的远端流生成帧，并按 setRemoteVideoConfig 在三层 simulcast 中选择分辨率。
+ * 启用外部视频源后，推送的帧代替合成帧交给本地视频观察者，随后立即归还。
+ *
+ * 观察者和事件处理者的回调都不持有 m_stateMutex：在锁内取出要回调的内容，放开锁再回调，
+ * 界面线程的订阅、加入/离开房间不会等待帧的生成和分发。视频线程与事件线程的回调由
+ * m_dispatchMutex 串行，某条流的离开事件之后不会再有它的帧。
+ */
+class FakeRtcEngine : public IRtcEngine {
+public:
+    explicit FakeRtcEngine(const FakeRtcConfig &config);
+    ~FakeRtcEngine() override;
+
+    RtcBackendType type() const override { return RtcBackendType::Fake; }
+    std::string sdkVersion() const override;
+
+    bool create(const std::string &appId, IRtcEventHandler *handler) override;
+    void destroy() override;
+
+    int setVideoEncoderProfile(const RtcVideoEncoderProfile &profile) override;
+    int setLocalVideoCanvas(void *view) override;
+    int setRemoteVideoCanvas(const std::string &streamId, void *view) override;
+
+    int startVideoCapture() override;
+    int stopVideoCapture() override;
+    int startAudioCapture() override;
+    int stopAudioCapture() override;
+
+    int setExternalVideoSource(bool enable) override;
+    int pushExternalVideoFrame(const RtcExternalVideoFrame &frame) override;
+    int setExternalAudioDevice(bool enable) override;
+    int pushExternalAudioFrame(const RtcAudioFrame &frame) override;
+    int pullExternalAudioFrame(int16_t *data, int samplesPerChannel, int channels, int sampleRate) override;
+
+    IRtcRoom *createRoom(const std::string &roomId) override;
+    void destroyRoom(IRtcRoom *room) override;
+
+    void addVideoFrameObserver(IRtcVideoFrameObserver *observer) override;
+    void removeVideoFrameObserver(IRtcVideoFrameObserver *observer) override;
+    void addAudioFrameObserver(IRtcAudioFrameObserver *observer) override;
+    void removeAudioFrameObserver(IRtcAudioFrameObserver *observer) override;
+
+private:
+    class Room;
+    friend class Room;
+
+    struct RemoteUser {
+        std::string userId;
+        std::string streamId;
+        bool present = false;
+        bool subscribed = false;
+        bool firstFrameSent = false;
+        int layer = 0;               // simulcast 层：0 原始，1 为 1/2，2 为 1/4 分辨率
+        int frameDivider = 1;        // 每 frameDivider 帧发送一帧
+    };
+
+    /** 事件线程在 m_stateMutex 内生成、放开锁后交给事件处理者的回调 */
+    struct HandlerEvent {
+        enum class Type {
+            RoomJoined,
+            UserPublished,
+            UserUnpublished,
+            NetworkQuality,
+            LocalStreamStats,
+            RemoteStreamStats,
+        };
+        Type type = Type::RoomJoined;
+        std::string id;              // RoomJoined 为房间号，其余为流编号
+        std::string userId;
+        RtcNetworkQuality quality;
+        RtcLocalStreamStats localStats;
+        RtcRemoteStreamStats remoteStats;
+    };
+
+    void joinRoom(const std::string &roomId, const std::string &userId, bool autoSubscribeVideo);
+    void leaveRoom();
+    int subscribeStreamVideo(const std::string &streamId, bool subscribe);
+    int setRemoteVideoConfig(const std::string &streamId, const RtcRemoteVideoConfig &config);
+    void publishRemoteUser(RemoteUser &user, bool present, std::vector<HandlerEvent> &events);
+
+    void videoLoop();
+    void audioLoop();
+    void eventLoop();
+    void collectStats(std::vector<HandlerEvent> &events);
+    void dispatchEvents(std::vector<HandlerEvent> &events);
+    void renderSyntheticFrame(std::vector<uint8_t> &buffer, int width, int height, int seed,
+                              int64_t frameIndex, RtcVideoFrame &frame) const;
+
+    const FakeRtcConfig m_config;
+    IRtcEventHandler *m_handler = nullptr;
+    std::unique_ptr<Room> m_room;
+
+    RtcObserverList<IRtcVideoFrameObserver> m_videoObservers;
+    RtcObserverList<IRtcAudioFrameObserver> m_audioObservers;
+
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_videoCapturing{false};
+    std::atomic<bool> m_audioCapturing{false};
+    std::atomic<bool> m_externalVideoSource{false};
+    std::atomic<bool> m_externalAudioDevice{false};
+    double m_pullPhase = 0.0;   // 只在调用 pullExternalAudioFrame 的线程上访问
+    std::thread m_videoThread;
+    std::thread m_audioThread;
+    std::thread m_eventThread;
+
+    // 视频线程与事件线程回调时持有，先于 m_stateMutex 加锁
+    std::mutex m_dispatchMutex;
+
+    // 房间状态，由 m_stateMutex 保护
+    std::mutex m_stateMutex;
+    std::condition_variable m_stateCond;
+    std::string m_roomId;
+    std::string m_localUserId;
+    bool m_autoSubscribeVideo = true;
+    bool m_inRoom = false;
+    bool m_joinPending = false;
+    std::chrono::steady_clock::time_point m_joinAt;
+    std::vector<RemoteUser> m_remoteUsers;
+    bool m_firstLocalFrameSent = false;
+    std::vector<uint8_t> m_localFrame;   // 只在视频线程上访问
+    RtcVideoEncoderProfile m_encoderProfile;
+};
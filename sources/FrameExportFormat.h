@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 解码帧导出（QUICKSTART_FRAME_EXPORT）的共享内存布局与控制消息，FrameExporter 写入，
+ * tools/FrameExportClient 与其它语言的消费者读取。所有整数为小端，原子字段为对齐的 64 位整数。
+ *
+ * 控制通道：Unix 域 SOCK_SEQPACKET 套接字，每条消息为一个 ControlMessage，文件描述符通过 SCM_RIGHTS 附带：
+ *   Hello         连接后第一条，附带该订阅者专用的 eventfd
+ *   Stream        一路流的帧环（首次出现或分辨率变大后重建），附带只读映射的 memfd
+ *   StreamClosed  该路流结束（通话结束），之前的帧环不再更新
+ * 订阅者不需要发送任何内容，断开连接即退订。
+ *
+ * 帧环（每路流一个 memfd）：
+ *
+ *   [RingHeader][SlotHeader x slotCount] ... 补齐到 kDataOffset ... [slot 0 数据][slot 1 数据] ...
+ *
+ * 帧序号从 1 开始，序号 seq 的帧写在 (seq - 1) % slotCount 号槽。生产者依次覆盖各槽，从不等待消费者。
+ * 每写完一帧递增 RingHeader::latestSeq 并向每个订阅者的 eventfd 写 1（计数可能合并多帧）。
+ * 消费者读 eventfd 后取各路流的 latestSeq，只处理最新的一帧，序号不连续即为跳过的帧。
+ *
+ * 每个槽是一个 seqlock：生产者写数据前把 SlotHeader::version 加 1（变为奇数），写完再加 1。
+ * 消费者先读 version（acquire），为奇数或 SlotHeader::seq 不是要取的序号则该帧已被覆盖；
+ * 就地处理数据后再读一次 version，与之前不同说明处理期间槽被新帧覆盖，结果应丢弃。
+ * 槽数为 slotCount 时，消费者有约 slotCount - 1 个帧间隔处理一帧而不被覆盖。
+ */
+namespace FrameExportFormat {
+
+constexpr uint32_t kRingMagic = 0x58465351;  // "QSFX"
+constexpr uint32_t kVersion = 1;
+constexpr int kMaxSlots = 16;
+constexpr size_t kDataOffset = 4096;
+constexpr size_t kAlignment = 4096;         // 每个槽的数据起始与长度对齐到页
+constexpr size_t kStrideAlignment = 64;     // 行跨度对齐
+
+enum class PixelFormat : uint32_t {
+    I420 = 0,     // 三个平面：Y、U、V
+    Rgb24 = 1,
+    Bgr24 = 2,
+    Bgra32 = 3,
+    Rgba32 = 4,
+};
+
+struct RingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotHeaderSize;      // sizeof(SlotHeader)
+    uint64_t dataOffset;          // 第一个槽的数据偏移，即 kDataOffset
+    uint64_t slotSize;            // 每个槽的数据字节数
+    PixelFormat format;
+    uint32_t reserved;
+    std::atomic<uint32_t> closed; // 1：已被新的帧环取代或流已结束
+    uint32_t reserved2;
+    alignas(64) std::atomic<uint64_t> latestSeq;   // 最新写完的帧序号，0 表示还没有帧
+};
+
+struct alignas(64) SlotHeader {
+    std::atomic<uint64_t> version;  // seqlock，奇数表示正在写
+    uint64_t seq;
+    int64_t timestampUs;
+    uint32_t width;
+    uint32_t height;
+    uint32_t planeOffsets[3];       // 相对槽数据起始，RGB 格式只有第一个平面
+    uint32_t strides[3];
+    uint32_t dataSize;
+    uint32_t reserved;
+};
+
+enum class MessageType : uint32_t {
+    Hello = 1,
+    Stream = 2,
+    StreamClosed = 3,
+};
+
+struct ControlMessage {
+    MessageType type;
+    uint32_t version;             // kVersion
+    uint32_t stream;              // 流的编号（0 .. maxStreams - 1），编号在流结束后可被复用
+    uint32_t generation;          // 同一编号下每次新建帧环递增
+    uint64_t mapSize;             // Stream：memfd 的大小，整段映射
+    uint32_t maxStreams;          // Hello
+    uint32_t local;               // Stream：1 为本地采集画面
+    char streamId[128];
+    char userId[128];
+};
+
+static_assert(sizeof(RingHeader) == 128, "ring header layout");
+static_assert(sizeof(SlotHeader) == 64, "slot header layout");
+static_assert(sizeof(RingHeader) + kMaxSlots * sizeof(SlotHeader) <= kDataOffset, "slot headers fit before data");
+static_assert(sizeof(ControlMessage) == 288, "control message layout");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared atomics must be lock free");
+
+inline SlotHeader *slotHeaders(void *base) {
+    return reinterpret_cast<SlotHeader *>(static_cast<uint8_t *>(base) + sizeof(RingHeader));
+}
+
+inline uint8_t *slotData(void *base, const RingHeader &header, uint32_t slot) {
+    return static_cast<uint8_t *>(base) + header.dataOffset + static_cast<size_t>(slot) * header.slotSize;
+}
+
+constexpr size_t alignUp(size_t size, size_t alignment) {
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace FrameExportFormat
@@ -0,0 +1,665 @@
+#include "FrameExporter.h"
+#include "ColorConvert.h"
+#include "MetricsExporter.h"
+#include "ThreadPolicy.h"
+#include <QDebug>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace FrameExportFormat;
+
+FrameExportConfig FrameExportConfig::fromEnvironment() {
+    FrameExportConfig config;
+    const char *value = std::getenv("QUICKSTART_FRAME_EXPORT");
+    if (!value) {
+        return config;
+    }
+
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item == "remote") config.exportRemote = true;
+        else if (item == "local") config.exportLocal = true;
+        else if (item == "i420") config.format = PixelFormat::I420;
+        else if (item == "rgb") config.format = PixelFormat::Rgb24;
+        else if (item == "bgr") config.format = PixelFormat::Bgr24;
+        else if (item == "bgra") config.format = PixelFormat::Bgra32;
+        else if (item == "rgba") config.format = PixelFormat::Rgba32;
+        else if (item.compare(0, 6, "slots=") == 0) config.slots = std::atoi(item.c_str() + 6);
+        else if (item.compare(0, 7, "socket=") == 0) config.socketPath = item.substr(7);
+        else if (!item.empty()) qWarning() << "QUICKSTART_FRAME_EXPORT: unknown option" << item.c_str();
+    }
+
+    config.slots = std::max(2, std::min(config.slots, kMaxSlots));
+    if (config.socketPath.empty()) {
+        const char *runtimeDir = std::getenv("XDG_RUNTIME_DIR");
+        config.socketPath = runtimeDir && *runtimeDir
+                ? std::string(runtimeDir) + "/quickstart-frames.sock"
+                : "/tmp/quickstart-frames-" + std::to_string(getuid()) + ".sock";
+    }
+    return config;
+}
+
+namespace {
+
+ColorConvert::RgbLayout rgbLayout(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::Rgb24: return ColorConvert::RgbLayout::Rgb24;
+        case PixelFormat::Bgra32: return ColorConvert::RgbLayout::Bgra32;
+        case PixelFormat::Rgba32: return ColorConvert::RgbLayout::Rgba32;
+        default: return ColorConvert::RgbLayout::Bgr24;
+    }
+}
+
+/** 帧在槽内的排列，返回占用的字节数 */
+size_t frameLayout(PixelFormat format, int width, int height, uint32_t (&offsets)[3], uint32_t (&strides)[3]) {
+    if (format == PixelFormat::I420) {
+        const size_t chromaHeight = (height + 1) / 2;
+        strides[0] = static_cast<uint32_t>(alignUp(width, kStrideAlignment));
+        strides[1] = strides[2] = static_cast<uint32_t>(alignUp((width + 1) / 2, kStrideAlignment));
+        offsets[0] = 0;
+        offsets[1] = strides[0] * height;
+        offsets[2] = static_cast<uint32_t>(offsets[1] + strides[1] * chromaHeight);
+        return offsets[2] + strides[2] * chromaHeight;
+    }
+    strides[0] = static_cast<uint32_t>(alignUp(static_cast<size_t>(width) * ColorConvert::bytesPerPixel(rgbLayout(format)),
+                                               kStrideAlignment));
+    strides[1] = strides[2] = 0;
+    offsets[0] = offsets[1] = offsets[2] = 0;
+    return static_cast<size_t>(strides[0]) * height;
+}
+
+/** 计数溢出（约 2^64 次未读）之前不会失败，EAGAIN 可以忽略 */
+void signalEventFd(int fd) {
+    uint64_t one = 1;
+    ssize_t n = write(fd, &one, sizeof(one));
+    (void)n;
+}
+
+void copyPlane(const uint8_t *src, int srcStride, uint8_t *dst, int dstStride, int width, int height) {
+    for (int y = 0; y < height; ++y) {
+        std::memcpy(dst + static_cast<size_t>(y) * dstStride, src + static_cast<size_t>(y) * srcStride, width);
+    }
+}
+
+} // namespace
+
+// ── 帧环、流与订阅者 ────────────────────────────────────────────────
+
+struct FrameExporter::Ring {
+    int fd = -1;
+    void *base = nullptr;
+    size_t mapSize = 0;
+    RingHeader *header = nullptr;
+
+    ~Ring() {
+        if (header) {
+            header->closed.store(1, std::memory_order_release);
+        }
+        if (base) {
+            munmap(base, mapSize);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    static std::unique_ptr<Ring> create(size_t slotSize, int slots, PixelFormat format) {
+        auto ring = std::make_unique<Ring>();
+        ring->mapSize = kDataOffset + slotSize * slots;
+        ring->fd = memfd_create("quickstart-frames", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (ring->fd < 0 || ftruncate(ring->fd, static_cast<off_t>(ring->mapSize)) != 0) {
+            qWarning() << "FrameExporter: cannot create memfd:" << std::strerror(errno);
+            return nullptr;
+        }
+        ring->base = mmap(nullptr, ring->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, 0);
+        if (ring->base == MAP_FAILED) {
+            ring->base = nullptr;
+            qWarning() << "FrameExporter: cannot map memfd:" << std::strerror(errno);
+            return nullptr;
+        }
+
+        // 大小固定，消费者无法截断（否则生产者写入时 SIGBUS）；已有的映射之外不再允许写，消费者只能只读映射
+        int seals = F_SEAL_SHRINK | F_SEAL_GROW;
+#ifdef F_SEAL_FUTURE_WRITE
+        seals |= F_SEAL_FUTURE_WRITE;
+#endif
+        if (fcntl(ring->fd, F_ADD_SEALS, seals | F_SEAL_SEAL) != 0) {
+            fcntl(ring->fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+        }
+
+        // memfd 初始为 0，magic 最后写入
+        ring->header = static_cast<RingHeader *>(ring->base);
+        ring->header->version = kVersion;
+        ring->header->slotCount = static_cast<uint32_t>(slots);
+        ring->header->slotHeaderSize = sizeof(SlotHeader);
+        ring->header->dataOffset = kDataOffset;
+        ring->header->slotSize = slotSize;
+        ring->header->format = format;
+        std::atomic_thread_fence(std::memory_order_release);
+        ring->header->magic = kRingMagic;
+        return ring;
+    }
+};
+
+struct FrameExporter::Stream {
+    enum State : int {
+        kFree = 0,
+        kClaiming = 1,
+        kActive = 2,
+        kReleasing = 3,    // 流已结束，等回调线程不再使用后由服务线程回收
+    };
+
+    std::atomic<int> state{kFree};
+    // 正在写这路流的回调数；先加一再检查状态，服务线程看到 0 时才能释放帧环
+    std::atomic<int> busy{0};
+    char streamId[128] = {};
+    char userId[128] = {};
+    bool isLocal = false;
+
+    // 只在回调线程访问
+    uint64_t seq = 0;
+
+    // 回调线程在 m_mutex 下替换，服务线程在 m_mutex 下读取
+    std::unique_ptr<Ring> ring;
+    uint32_t generation = 0;
+};
+
+struct FrameExporter::Subscriber {
+    int socketFd = -1;
+    int eventFd = -1;
+    pid_t pid = 0;
+    uint32_t announced[kMaxStreams] = {};   // 已发送的帧环 generation，0 为没有
+
+    ~Subscriber() {
+        if (socketFd >= 0) {
+            close(socketFd);
+        }
+        if (eventFd >= 0) {
+            close(eventFd);
+        }
+    }
+};
+
+// ── FrameExporter ─────────────────────────────────────────────────
+
+FrameExporter::FrameExporter(const FrameExportConfig &config)
+    : m_config(config) {
+    for (auto &stream : m_streams) {
+        stream = std::make_unique<Stream>();
+    }
+}
+
+FrameExporter::~FrameExporter() {
+    stop();
+}
+
+bool FrameExporter::start() {
+    if (m_running.load()) return true;
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (m_config.socketPath.size() >= sizeof(address.sun_path)) {
+        qWarning() << "FrameExporter: socket path too long:" << m_config.socketPath.c_str();
+        return false;
+    }
+    std::memcpy(address.sun_path, m_config.socketPath.c_str(), m_config.socketPath.size());
+
+    m_listenFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (m_listenFd < 0) {
+        qWarning() << "FrameExporter: cannot create socket:" << std::strerror(errno);
+        return false;
+    }
+    // 能连上说明另一个进程正在导出；连不上的是上次异常退出留下的文件
+    int probe = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (probe >= 0 && ::connect(probe, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0) {
+        close(probe);
+        qWarning() << "FrameExporter:" << m_config.socketPath.c_str() << "is in use by another process";
+        close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+    if (probe >= 0) {
+        close(probe);
+    }
+    unlink(m_config.socketPath.c_str());
+
+    if (bind(m_listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0
+        || chmod(m_config.socketPath.c_str(), S_IRUSR | S_IWUSR) != 0
+        || listen(m_listenFd, 8) != 0) {
+        qWarning() << "FrameExporter: cannot listen on" << m_config.socketPath.c_str() << ":" << std::strerror(errno);
+        close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+
+    m_wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_wakeFd < 0) {
+        qWarning() << "FrameExporter: cannot create eventfd:" << std::strerror(errno);
+        close(m_listenFd);
+        m_listenFd = -1;
+        unlink(m_config.socketPath.c_str());
+        return false;
+    }
+
+    m_running.store(true);
+    m_thread = std::thread(&FrameExporter::serverLoop, this);
+    qInfo() << "FrameExporter: listening on" << m_config.socketPath.c_str()
+            << "format" << static_cast<int>(m_config.format) << "slots" << m_config.slots;
+    return true;
+}
+
+void FrameExporter::stop() {
+    if (!m_running.exchange(false)) return;
+    signalEventFd(m_wakeFd);
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    for (int i = 0; i < kMaxSubscribers; ++i) {
+        if (m_subscribers[i]) {
+            dropSubscriber(i);
+        }
+    }
+    close(m_listenFd);
+    m_listenFd = -1;
+    unlink(m_config.socketPath.c_str());
+    close(m_wakeFd);
+    m_wakeFd = -1;
+    qDebug() << "FrameExporter stopped, frames" << m_frames.load() << "dropped" << m_dropped.load();
+}
+
+void FrameExporter::endCall() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &stream : m_streams) {
+            stream->ring.reset();
+            stream->generation = 0;
+            stream->seq = 0;
+            stream->state.store(Stream::kFree, std::memory_order_release);
+        }
+    }
+    if (m_running.load()) {
+        wakeServer();
+    }
+}
+
+void FrameExporter::onLocalVideoFrame(const RtcVideoFrame &frame) {
+    ThreadPolicy::adoptCurrentThread(ThreadClass::Video, "rtc-video");
+    if (!m_config.exportLocal || m_subscriberCount.load(std::memory_order_relaxed) == 0) return;
+    if (Stream *stream = streamFor("local", "", true)) {
+        produce(stream, frame);
+        finishFrame(stream);
+    }
+}
+
+void FrameExporter::onRemoteVideoFrame(const char *streamId, const char *userId, const RtcVideoFrame &frame) {
+    ThreadPolicy::adoptCurrentThread(ThreadClass::Video, "rtc-video");
+    if (!m_config.exportRemote || m_subscriberCount.load(std::memory_order_relaxed) == 0) return;
+    if (Stream *stream = streamFor(streamId ? streamId : "", userId ? userId : "", false)) {
+        produce(stream, frame);
+        finishFrame(stream);
+    }
+}
+
+void FrameExporter::releaseStream(const std::string &streamId) {
+    bool released = false;
+    for (auto &stream : m_streams) {
+        if (stream->state.load(std::memory_order_acquire) != Stream::kActive) continue;
+        // 与 streamFor() 相同，计数期间标识稳定
+        stream->busy.fetch_add(1);
+        int expected = Stream::kActive;
+        if (stream->state.load() == Stream::kActive
+            && !stream->isLocal && std::strcmp(stream->streamId, streamId.c_str()) == 0
+            && stream->state.compare_exchange_strong(expected, Stream::kReleasing)) {
+            qDebug() << "FrameExporter: released stream" << streamId.c_str();
+            released = true;
+        }
+        stream->busy.fetch_sub(1);
+    }
+    if (released && m_running.load()) {
+        wakeServer();
+    }
+}
+
+void FrameExporter::finishFrame(Stream *stream) {
+    stream->busy.fetch_sub(1);
+    // 写帧期间流被释放，服务线程可能因为 busy 跳过了回收
+    if (stream->state.load(std::memory_order_acquire) == Stream::kReleasing) {
+        wakeServer();
+    }
+}
+
+FrameExporter::Stream *FrameExporter::streamFor(const char *streamId, const char *userId, bool isLocal) {
+    for (auto &stream : m_streams) {
+        if (stream->state.load(std::memory_order_acquire) != Stream::kActive) continue;
+        // 先计数再比较标识，与 reclaimStreams() 配对：计数之后仍为 kActive，
+        // 服务线程就不会释放帧环，标识也不会被新的流改写
+        stream->busy.fetch_add(1);
+        if (stream->state.load() == Stream::kActive
+            && stream->isLocal == isLocal && std::strcmp(stream->streamId, streamId) == 0) {
+            return stream.get();
+        }
+        finishFrame(stream.get());
+    }
+
+    // 首次出现的流：占用一个空闲编号，写好标识后再对服务线程可见
+    for (auto &stream : m_streams) {
+        int expected = Stream::kFree;
+        if (stream->state.compare_exchange_strong(expected, Stream::kClaiming, std::memory_order_acq_rel)) {
+            std::snprintf(stream->streamId, sizeof(stream->streamId), "%s", streamId);
+            std::snprintf(stream->userId, sizeof(stream->userId), "%s", userId);
+            stream->isLocal = isLocal;
+            stream->busy.fetch_add(1);
+            stream->state.store(Stream::kActive, std::memory_order_release);
+            qDebug() << "FrameExporter: exporting stream" << streamId << "user" << userId;
+            return stream.get();
+        }
+    }
+
+    if (m_dropped.fetch_add(1, std::memory_order_relaxed) == 0) {
+        qWarning() << "FrameExporter: too many streams, ignoring" << streamId;
+    }
+    return nullptr;
+}
+
+bool FrameExporter::ensureRing(Stream *stream, int width, int height) {
+    uint32_t offsets[3];
+    uint32_t strides[3];
+    const size_t needed = frameLayout(m_config.format, width, height, offsets, strides);
+    if (stream->ring && needed <= stream->ring->header->slotSize) {
+        return true;
+    }
+
+    auto ring = Ring::create(alignUp(needed, kAlignment), m_config.slots, m_config.format);
+    if (!ring) {
+        return false;
+    }
+    std::unique_ptr<Ring> previous;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        previous = std::move(stream->ring);
+        stream->ring = std::move(ring);
+        stream->generation = m_nextGeneration++;
+        stream->seq = 0;
+    }
+    m_ringsCreated.fetch_add(1, std::memory_order_relaxed);
+    qDebug() << "FrameExporter: ring for" << stream->streamId << width << "x" << height
+             << "slot" << needed << "bytes";
+    // 旧帧环标记为关闭，订阅者各自的映射仍然有效
+    previous.reset();
+    return true;
+}
+
+void FrameExporter::produce(Stream *stream, const RtcVideoFrame &frame) {
+    if (frame.format != RtcPixelFormat::I420 || frame.width <= 0 || frame.height <= 0) {
+        if (m_dropped.fetch_add(1, std::memory_order_relaxed) == 0) {
+            qWarning() << "FrameExporter: only I420 frames are supported";
+        }
+        return;
+    }
+    if (!ensureRing(stream, frame.width, frame.height)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Ring *ring = stream->ring.get();
+    RingHeader &header = *ring->header;
+    const uint64_t seq = ++stream->seq;
+    const uint32_t index = static_cast<uint32_t>((seq - 1) % header.slotCount);
+    SlotHeader &slot = slotHeaders(ring->base)[index];
+    uint8_t *data = slotData(ring->base, header, index);
+
+    // seqlock：先置为奇数，正在读这个槽的消费者据此发现帧已被覆盖
+    const uint64_t version = slot.version.load(std::memory_order_relaxed);
+    slot.version.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    uint32_t offsets[3];
+    uint32_t strides[3];
+    const size_t size = frameLayout(m_config.format, frame.width, frame.height, offsets, strides);
+    if (m_config.format == PixelFormat::I420) {
+        const int chromaWidth = (frame.width + 1) / 2;
+        const int chromaHeight = (frame.height + 1) / 2;
+        copyPlane(frame.planes[0], frame.strides[0], data + offsets[0], strides[0], frame.width, frame.height);
+        copyPlane(frame.planes[1], frame.strides[1], data + offsets[1], strides[1], chromaWidth, chromaHeight);
+        copyPlane(frame.planes[2], frame.strides[2], data + offsets[2], strides[2], chromaWidth, chromaHeight);
+    } else {
+        ColorConvert::i420ToRgb(frame.planes[0], frame.strides[0],
+                                frame.planes[1], frame.strides[1],
+                                frame.planes[2], frame.strides[2],
+                                data, static_cast<int>(strides[0]), frame.width, frame.height,
+                                rgbLayout(m_config.format));
+    }
+    slot.seq = seq;
+    slot.timestampUs = frame.timestampUs;
+    slot.width = static_cast<uint32_t>(frame.width);
+    slot.height = static_cast<uint32_t>(frame.height);
+    std::memcpy(slot.planeOffsets, offsets, sizeof(offsets));
+    std::memcpy(slot.strides, strides, sizeof(strides));
+    slot.dataSize = static_cast<uint32_t>(size);
+
+    slot.version.store(version + 2, std::memory_order_release);
+    header.latestSeq.store(seq, std::memory_order_release);
+    m_frames.fetch_add(1, std::memory_order_relaxed);
+    wakeServer();
+}
+
+void FrameExporter::wakeServer() {
+    // 服务线程处理之前的多次唤醒合并为一次写入
+    if (!m_wakePending.exchange(true, std::memory_order_acq_rel)) {
+        signalEventFd(m_wakeFd);
+    }
+}
+
+// ── 服务线程 ───────────────────────────────────────────────────────
+
+void FrameExporter::serverLoop() {
+    ThreadPolicy::registerCurrentThread(ThreadClass::Video, "frame-export");
+    std::vector<pollfd> fds;
+    std::vector<int> owners;
+    uint64_t notified = m_frames.load();
+
+    while (m_running.load(std::memory_order_acquire)) {
+        fds.clear();
+        owners.clear();
+        fds.push_back({m_listenFd, POLLIN, 0});
+        fds.push_back({m_wakeFd, POLLIN, 0});
+        for (int i = 0; i < kMaxSubscribers; ++i) {
+            if (m_subscribers[i]) {
+                fds.push_back({m_subscribers[i]->socketFd, POLLIN, 0});
+                owners.push_back(i);
+            }
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            qWarning() << "FrameExporter: poll failed:" << std::strerror(errno);
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            // 先清标志再读：之后的唤醒会再次写入，不会丢失
+            m_wakePending.store(false, std::memory_order_release);
+            uint64_t count = 0;
+            ssize_t n = read(m_wakeFd, &count, sizeof(count));
+            (void)n;
+        }
+        if (!m_running.load(std::memory_order_acquire)) {
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            acceptSubscriber();
+        }
+
+        // 订阅者不发送内容，可读即为断开（或协议错误）
+        for (size_t i = 0; i < owners.size(); ++i) {
+            if (!fds[i + 2].revents) continue;
+            char buffer[sizeof(ControlMessage)];
+            ssize_t n = recv(fds[i + 2].fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (n < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+            dropSubscriber(owners[i]);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            reclaimStreams();
+            for (auto &subscriber : m_subscribers) {
+                if (subscriber) {
+                    syncStreams(*subscriber);
+                }
+            }
+        }
+        for (int i = 0; i < kMaxSubscribers; ++i) {
+            if (m_subscribers[i] && m_subscribers[i]->socketFd < 0) {
+                dropSubscriber(i);
+            }
+        }
+
+        const uint64_t frames = m_frames.load(std::memory_order_relaxed);
+        if (frames != notified) {
+            notified = frames;
+            // 消费者一直不读也只是计数增长
+            for (auto &subscriber : m_subscribers) {
+                if (subscriber) {
+                    signalEventFd(subscriber->eventFd);
+                }
+            }
+        }
+    }
+}
+
+void FrameExporter::acceptSubscriber() {
+    int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+    if (fd < 0) {
+        return;
+    }
+    int slot = -1;
+    for (int i = 0; i < kMaxSubscribers; ++i) {
+        if (!m_subscribers[i]) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        qWarning() << "FrameExporter: too many subscribers, refusing connection";
+        close(fd);
+        return;
+    }
+
+    auto subscriber = std::make_unique<Subscriber>();
+    subscriber->socketFd = fd;
+    subscriber->eventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    ucred credentials = {};
+    socklen_t length = sizeof(credentials);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) == 0) {
+        subscriber->pid = credentials.pid;
+    }
+
+    ControlMessage hello = {};
+    hello.type = MessageType::Hello;
+    hello.version = kVersion;
+    hello.maxStreams = kMaxStreams;
+    if (subscriber->eventFd < 0 || !sendMessage(*subscriber, hello, subscriber->eventFd)) {
+        qWarning() << "FrameExporter: cannot set up subscriber:" << std::strerror(errno);
+        return;
+    }
+
+    qInfo() << "FrameExporter: subscriber connected, pid" << subscriber->pid;
+    m_subscribers[slot] = std::move(subscriber);
+    // 第一个订阅者出现后回调才开始写帧
+    m_subscriberCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FrameExporter::reclaimStreams() {
+    for (auto &stream : m_streams) {
+        if (stream->state.load() == Stream::kReleasing && stream->busy.load() == 0) {
+            // 订阅者随后收到 StreamClosed，各自的映射仍然有效
+            stream->ring.reset();
+            stream->generation = 0;
+            stream->seq = 0;
+            stream->state.store(Stream::kFree, std::memory_order_release);
+        }
+    }
+}
+
+void FrameExporter::syncStreams(Subscriber &subscriber) {
+    for (int i = 0; i < kMaxStreams && subscriber.socketFd >= 0; ++i) {
+        const Stream &stream = *m_streams[i];
+        const bool active = stream.state.load(std::memory_order_acquire) == Stream::kActive && stream.ring;
+        const uint32_t generation = active ? stream.generation : 0;
+        if (subscriber.announced[i] == generation) continue;
+
+        ControlMessage message = {};
+        message.version = kVersion;
+        message.stream = static_cast<uint32_t>(i);
+        message.generation = generation;
+        if (active) {
+            message.type = MessageType::Stream;
+            message.mapSize = stream.ring->mapSize;
+            message.local = stream.isLocal ? 1 : 0;
+            std::snprintf(message.streamId, sizeof(message.streamId), "%s", stream.streamId);
+            std::snprintf(message.userId, sizeof(message.userId), "%s", stream.userId);
+        } else {
+            message.type = MessageType::StreamClosed;
+        }
+        // 控制消息很少，发送缓冲区满说明订阅者已经不再读取，断开它
+        if (!sendMessage(subscriber, message, active ? stream.ring->fd : -1)) {
+            qWarning() << "FrameExporter: subscriber" << subscriber.pid << "not reading, disconnecting";
+            close(subscriber.socketFd);
+            subscriber.socketFd = -1;
+            return;
+        }
+        subscriber.announced[i] = generation;
+    }
+}
+
+bool FrameExporter::sendMessage(Subscriber &subscriber, const ControlMessage &message, int fd) {
+    iovec iov = {const_cast<ControlMessage *>(&message), sizeof(message)};
+    msghdr header = {};
+    header.msg_iov = &iov;
+    header.msg_iovlen = 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    if (fd >= 0) {
+        header.msg_control = control;
+        header.msg_controllen = sizeof(control);
+        cmsghdr *cmsg = CMSG_FIRSTHDR(&header);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+    return sendmsg(subscriber.socketFd, &header, MSG_DONTWAIT | MSG_NOSIGNAL) == static_cast<ssize_t>(sizeof(message));
+}
+
+void FrameExporter::dropSubscriber(int index) {
+    qInfo() << "FrameExporter: subscriber disconnected, pid" << m_subscribers[index]->pid;
+    m_subscribers[index].reset();
+    m_subscriberCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void FrameExporter::exportMetrics(MetricsRecord &record) {
+    int streams = 0;
+    for (const auto &stream : m_streams) {
+        if (stream->state.load(std::memory_order_acquire) == Stream::kActive) {
+            ++streams;
+        }
+    }
+    record.add("frame_export.subscribers", m_subscriberCount.load(std::memory_order_relaxed));
+    record.add("frame_export.streams", streams);
+    record.add("frame_export.frames", static_cast<double>(m_frames.load(std::memory_order_relaxed)));
+    record.add("frame_export.dropped", static_cast<double>(m_dropped.load(std::memory_order_relaxed)));
+    record.add("frame_export.rings_created", static_cast<double>(m_ringsCreated.load(std::memory_order_relaxed)));
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "FrameExportFormat.h"
+#include "RtcBackend.h"
+
+class MetricsRecord;
+
+/**
+ * 解码帧导出配置
+ *
+ * 通过环境变量 QUICKSTART_FRAME_EXPORT 开启，逗号分隔：
+ *   remote / local   导出远端和/或本地帧（至少指定一个）
+ *   i420 / rgb / bgr / bgra / rgba  导出的像素格式，默认 i420（不做转换，只拷贝平面）
+ *   slots=N          每路流帧环的槽数，默认 4（2 ~ 16），越多慢消费者处理一帧的时间越长
+ *   socket=PATH      控制套接字，默认 $XDG_RUNTIME_DIR/quickstart-frames.sock
+ *                    （没有 XDG_RUNTIME_DIR 时为 /tmp/quickstart-frames-<uid>.sock）
+ * 例如：QUICKSTART_FRAME_EXPORT=remote,local,bgr,slots=6
+ */
+struct FrameExportConfig {
+    bool exportRemote = false;
+    bool exportLocal = false;
+    FrameExportFormat::PixelFormat format = FrameExportFormat::PixelFormat::I420;
+    int slots = 4;
+    std::string socketPath;
+
+    bool enabled() const { return exportRemote || exportLocal; }
+
+    static FrameExportConfig fromEnvironment();
+};
+
+/**
+ * 解码帧导出到其它进程
+ *
+ * 作为 IRtcVideoFrameObserver 注册到引擎，在引擎回调线程上把每帧写入该流 memfd 帧环的下一个槽
+ * （I420 只拷贝平面，RGB 格式直接转换到槽中），然后通知订阅者。帧格式见 FrameExportFormat.h。
+ * 订阅者通过 Unix 域套接字连接，收到帧环的 memfd 后整段映射，直接读取共享内存中的帧，不再拷贝；
+ * 生产者依次覆盖各槽、从不等待消费者，慢的消费者只会跳帧，不会拖慢通话或其它消费者。
+ *
+ * 回调路径上不加锁、不分配内存：帧环在某路流第一帧或分辨率变大时才（重新）创建，
+ * 通知时只唤醒一次服务线程（frame-export，未处理的唤醒合并），由它向各订阅者的 eventfd 写入。
+ * 没有订阅者时回调直接返回，不拷贝帧。
+ *
+ * 导出器在多次通话之间保留，订阅者不必重连：每次通话加入时 addVideoFrameObserver，
+ * 挂断时 removeVideoFrameObserver 之后调用 endCall()，各路流收到 StreamClosed。
+ * 通话中远端流结束（用户离开或取消发布）时调用 releaseStream()，服务线程等回调线程写完当前帧后
+ * 回收该流的编号与帧环，订阅者收到 StreamClosed，编号留给之后的流。
+ */
+class FrameExporter : public IRtcVideoFrameObserver {
+public:
+    static constexpr int kMaxStreams = 16;
+    static constexpr int kMaxSubscribers = 32;
+
+    explicit FrameExporter(const FrameExportConfig &config);
+    ~FrameExporter() override;
+
+    /** 创建控制套接字并启动服务线程，失败时返回 false（导出不生效，不影响通话） */
+    bool start();
+    void stop();
+
+    /** 通话结束：关闭所有流，编号留给下一次通话。调用时不能再有帧回调 */
+    void endCall();
+    /** 远端流结束，关闭该流并归还编号；任意线程可调用 */
+    void releaseStream(const std::string &streamId);
+
+    void onLocalVideoFrame(const RtcVideoFrame &frame) override;
+    void onRemoteVideoFrame(const char *streamId, const char *userId, const RtcVideoFrame &frame) override;
+
+    /** 指标：frame_export.subscribers / streams / frames / dropped / rings_created */
+    void exportMetrics(MetricsRecord &record);
+
+private:
+    struct Ring;
+    struct Stream;
+    struct Subscriber;
+
+    /** 返回的流已标记为正在写入，写完后调用 finishFrame() */
+    Stream *streamFor(const char *streamId, const char *userId, bool isLocal);
+    void produce(Stream *stream, const RtcVideoFrame &frame);
+    void finishFrame(Stream *stream);
+    bool ensureRing(Stream *stream, int width, int height);
+    void wakeServer();
+
+    void serverLoop();
+    void acceptSubscriber();
+    /** 在 m_mutex 下调用：释放已结束且不再写入的流 */
+    void reclaimStreams();
+    void syncStreams(Subscriber &subscriber);
+    bool sendMessage(Subscriber &subscriber, const FrameExportFormat::ControlMessage &message, int fd);
+    void dropSubscriber(int index);
+
+    FrameExportConfig m_config;
+    std::unique_ptr<Stream> m_streams[kMaxStreams];
+    std::unique_ptr<Subscriber> m_subscribers[kMaxSubscribers];
+    std::mutex m_mutex;             // 帧环的替换（回调线程）与发送给订阅者（服务线程）
+    uint32_t m_nextGeneration = 1;
+
+    int m_listenFd = -1;
+    int m_wakeFd = -1;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_wakePending{false};
+    std::atomic<int> m_subscriberCount{0};
+    std::thread m_thread;
+
+    std::atomic<uint64_t> m_frames{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_ringsCreated{0};
+};
@@ -0,0 +1,163 @@
+#include "ImageScale.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define IMAGE_SCALE_NEON 1
+#endif
+
+namespace ImageScale {
+
+namespace {
+
+typedef void (*HalveFn)(const uint8_t *, int, uint8_t *, int, int, int);
+
+void halveRowScalar(const uint8_t *row0, const uint8_t *row1, uint8_t *dst, int x0, int dstWidth) {
+    for (int x = x0; x < dstWidth; ++x) {
+        dst[x] = static_cast<uint8_t>((row0[2 * x] + row0[2 * x + 1] + row1[2 * x] + row1[2 * x + 1] + 2) >> 2);
+    }
+}
+
+#ifdef IMAGE_SCALE_NEON
+
+// 两行各读 32 个像素，水平两两相加后再上下相加，带舍入右移 2 位，返回已处理的输出列数
+int halveRowNeon(const uint8_t *row0, const uint8_t *row1, uint8_t *dst, int dstWidth) {
+    int x = 0;
+    for (; x + 16 <= dstWidth; x += 16) {
+        uint16x8_t lo = vaddq_u16(vpaddlq_u8(vld1q_u8(row0 + 2 * x)), vpaddlq_u8(vld1q_u8(row1 + 2 * x)));
+        uint16x8_t hi = vaddq_u16(vpaddlq_u8(vld1q_u8(row0 + 2 * x + 16)), vpaddlq_u8(vld1q_u8(row1 + 2 * x + 16)));
+        vst1q_u8(dst + x, vcombine_u8(vrshrn_n_u16(lo, 2), vrshrn_n_u16(hi, 2)));
+    }
+    return x;
+}
+
+#endif // IMAGE_SCALE_NEON
+
+// 单个平面：逐级减半到不小于目标尺寸，再双线性缩放到目标尺寸
+void scalePlane(const uint8_t *src, int srcStride, int width, int height,
+                uint8_t *dst, int dstWidth, int dstHeight,
+                std::vector<uint8_t> &scratch, HalveFn halve) {
+    int levels = 0;
+    int levelWidth = width;
+    int levelHeight = height;
+    while (levelWidth / 2 >= dstWidth && levelHeight / 2 >= dstHeight) {
+        levelWidth /= 2;
+        levelHeight /= 2;
+        ++levels;
+    }
+
+    // 中间结果在 scratch 的前后两半之间交替
+    const size_t half = static_cast<size_t>(width / 2) * static_cast<size_t>(height / 2);
+    if (levels > 0 && scratch.size() < half * 2) {
+        scratch.resize(half * 2);
+    }
+    const uint8_t *current = src;
+    int currentStride = srcStride;
+    int currentWidth = width;
+    int currentHeight = height;
+    for (int level = 0; level < levels; ++level) {
+        uint8_t *next = scratch.data() + (level % 2) * half;
+        halve(current, currentStride, next, currentWidth / 2, currentWidth, currentHeight);
+        current = next;
+        currentWidth /= 2;
+        currentHeight /= 2;
+        currentStride = currentWidth;
+    }
+
+    if (currentWidth == dstWidth && currentHeight == dstHeight) {
+        for (int row = 0; row < dstHeight; ++row) {
+            memcpy(dst + row * dstWidth, current + row * currentStride, dstWidth);
+        }
+    } else {
+        resizePlaneBilinear(current, currentStride, currentWidth, currentHeight,
+                            dst, dstWidth, dstWidth, dstHeight);
+    }
+}
+
+void scaleI420With(const I420Image &src, int dstWidth, int dstHeight,
+                   std::vector<uint8_t> &dst, std::vector<uint8_t> &scratch, HalveFn halve) {
+    const int chromaWidth = dstWidth / 2;
+    const int chromaHeight = dstHeight / 2;
+    const size_t lumaSize = static_cast<size_t>(dstWidth) * dstHeight;
+    const size_t chromaSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+    dst.resize(lumaSize + chromaSize * 2);
+
+    scalePlane(src.planes[0], src.strides[0], src.width, src.height,
+               dst.data(), dstWidth, dstHeight, scratch, halve);
+    for (int plane = 1; plane < 3; ++plane) {
+        scalePlane(src.planes[plane], src.strides[plane], (src.width + 1) / 2, (src.height + 1) / 2,
+                   dst.data() + lumaSize + (plane - 1) * chromaSize, chromaWidth, chromaHeight, scratch, halve);
+    }
+}
+
+} // namespace
+
+bool hasSimd() {
+#ifdef IMAGE_SCALE_NEON
+    return true;
+#else
+    return false;
+#endif
+}
+
+void halvePlaneScalar(const uint8_t *src, int srcStride, uint8_t *dst, int dstStride, int width, int height) {
+    const int dstWidth = width / 2;
+    for (int row = 0; row < height / 2; ++row) {
+        const uint8_t *row0 = src + (2 * row) * srcStride;
+        halveRowScalar(row0, row0 + srcStride, dst + row * dstStride, 0, dstWidth);
+    }
+}
+
+void halvePlane(const uint8_t *src, int srcStride, uint8_t *dst, int dstStride, int width, int height) {
+#ifdef IMAGE_SCALE_NEON
+    const int dstWidth = width / 2;
+    for (int row = 0; row < height / 2; ++row) {
+        const uint8_t *row0 = src + (2 * row) * srcStride;
+        uint8_t *out = dst + row * dstStride;
+        int done = halveRowNeon(row0, row0 + srcStride, out, dstWidth);
+        if (done < dstWidth) {
+            halveRowScalar(row0, row0 + srcStride, out, done, dstWidth);
+        }
+    }
+#else
+    halvePlaneScalar(src, srcStride, dst, dstStride, width, height);
+#endif
+}
+
+void resizePlaneBilinear(const uint8_t *src, int srcStride, int srcWidth, int srcHeight,
+                         uint8_t *dst, int dstStride, int dstWidth, int dstHeight) {
+    // 16.16 定点坐标，按像素中心对齐
+    const int64_t stepX = (static_cast<int64_t>(srcWidth) << 16) / dstWidth;
+    const int64_t stepY = (static_cast<int64_t>(srcHeight) << 16) / dstHeight;
+    for (int y = 0; y < dstHeight; ++y) {
+        int64_t fy = std::max<int64_t>(0, (y * stepY) + stepY / 2 - 0x8000);
+        int y0 = std::min(static_cast<int>(fy >> 16), srcHeight - 1);
+        int y1 = std::min(y0 + 1, srcHeight - 1);
+        int wy = static_cast<int>((fy >> 8) & 0xff);
+        const uint8_t *row0 = src + y0 * srcStride;
+        const uint8_t *row1 = src + y1 * srcStride;
+        uint8_t *out = dst + y * dstStride;
+        for (int x = 0; x < dstWidth; ++x) {
+            int64_t fx = std::max<int64_t>(0, (x * stepX) + stepX / 2 - 0x8000);
+            int x0 = std::min(static_cast<int>(fx >> 16), srcWidth - 1);
+            int x1 = std::min(x0 + 1, srcWidth - 1);
+            int wx = static_cast<int>((fx >> 8) & 0xff);
+            int top = row0[x0] * (256 - wx) + row0[x1] * wx;
+            int bottom = row1[x0] * (256 - wx) + row1[x1] * wx;
+            out[x] = static_cast<uint8_t>((top * (256 - wy) + bottom * wy + 32768) >> 16);
+        }
+    }
+}
+
+void scaleI420(const I420Image &src, int dstWidth, int dstHeight,
+               std::vector<uint8_t> &dst, std::vector<uint8_t> &scratch) {
+    scaleI420With(src, dstWidth, dstHeight, dst, scratch, halvePlane);
+}
+
+void scaleI420Scalar(const I420Image &src, int dstWidth, int dstHeight,
+                     std::vector<uint8_t> &dst, std::vector<uint8_t> &scratch) {
+    scaleI420With(src, dstWidth, dstHeight, dst, scratch, halvePlaneScalar);
+}
+
+} // namespace ImageScale
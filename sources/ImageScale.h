@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * I420 图像缩小
+ *
+ * 先按 2x2 均值逐级减半，直到再减半就会小于目标尺寸，最后用一次双线性插值缩放到目标尺寸。
+ * 每一级减半都用到全部源像素，缩小倍数很大时也不会像直接双线性那样跳过像素产生锯齿。
+ *
+ * ARM64 上减半使用 NEON 一次输出 16 个像素，其他平台使用结果完全一致的标量实现；
+ * 最后一步双线性只处理已经接近目标尺寸的图像，使用标量实现。
+ */
+namespace ImageScale {
+
+struct I420Image {
+    const uint8_t *planes[3] = {nullptr, nullptr, nullptr};
+    int strides[3] = {0, 0, 0};
+    int width = 0;
+    int height = 0;
+};
+
+/** 2x2 均值缩小一个平面，输出 (width / 2) x (height / 2)，舍入方式为 (a + b + c + d + 2) >> 2 */
+void halvePlane(const uint8_t *src, int srcStride, uint8_t *dst, int dstStride, int width, int height);
+void halvePlaneScalar(const uint8_t *src, int srcStride, uint8_t *dst, int dstStride, int width, int height);
+
+/** 双线性缩放一个平面到任意尺寸，8 位定点权重 */
+void resizePlaneBilinear(const uint8_t *src, int srcStride, int srcWidth, int srcHeight,
+                         uint8_t *dst, int dstStride, int dstWidth, int dstHeight);
+
+/**
+ * 把 src 缩放到 dstWidth x dstHeight（均为偶数），输出为紧密排列的 I420，
+ * 写入 dst 并调整其大小；scratch 保存逐级减半的中间结果，调用之间复用避免分配
+ */
+void scaleI420(const I420Image &src, int dstWidth, int dstHeight,
+               std::vector<uint8_t> &dst, std::vector<uint8_t> &scratch);
+
+/** 强制使用标量实现，用于基准对比和校验 */
+void scaleI420Scalar(const I420Image &src, int dstWidth, int dstHeight,
+                     std::vector<uint8_t> &dst, std::vector<uint8_t> &scratch);
+
+/** 当前构建是否使用了 SIMD 实现 */
+bool hasSimd();
+
+} // namespace ImageScale
@@ -0,0 +1,79 @@
+#include "JpegEncoder.h"
+#include <QDebug>
+#include <algorithm>
+
+#ifdef QUICKSTART_HAS_TURBOJPEG
+#include <turbojpeg.h>
+#else
+#include <QBuffer>
+#include <QImage>
+#include "ColorConvert.h"
+#endif
+
+JpegEncoder::JpegEncoder() {
+#ifdef QUICKSTART_HAS_TURBOJPEG
+    m_handle = tjInitCompress();
+    if (!m_handle) {
+        qWarning() << "JpegEncoder: tjInitCompress failed:" << tjGetErrorStr();
+    }
+#endif
+}
+
+JpegEncoder::~JpegEncoder() {
+#ifdef QUICKSTART_HAS_TURBOJPEG
+    if (m_handle) {
+        tjDestroy(m_handle);
+    }
+#endif
+}
+
+const char *JpegEncoder::backendName() {
+#ifdef QUICKSTART_HAS_TURBOJPEG
+    return "libjpeg-turbo";
+#else
+    return "qt";
+#endif
+}
+
+bool JpegEncoder::encode(const ImageScale::I420Image &image, int quality, std::vector<uint8_t> &out) {
+    if (image.width <= 0 || image.height <= 0) return false;
+    quality = std::min(100, std::max(1, quality));
+
+#ifdef QUICKSTART_HAS_TURBOJPEG
+    if (!m_handle) return false;
+
+    // 按最坏情况预留输出缓冲，TJFLAG_NOREALLOC 让库直接写入而不自行分配
+    unsigned long size = tjBufSize(image.width, image.height, TJSAMP_420);
+    if (out.size() < size) {
+        out.resize(size);
+    }
+    unsigned char *buffer = out.data();
+    const unsigned char *planes[3] = {image.planes[0], image.planes[1], image.planes[2]};
+    int strides[3] = {image.strides[0], image.strides[1], image.strides[2]};
+    if (tjCompressFromYUVPlanes(static_cast<tjhandle>(m_handle), planes, image.width, strides, image.height,
+                                TJSAMP_420, &buffer, &size, quality, TJFLAG_NOREALLOC | TJFLAG_FASTDCT) != 0) {
+        qWarning() << "JpegEncoder: compress failed:" << tjGetErrorStr2(static_cast<tjhandle>(m_handle));
+        return false;
+    }
+    out.resize(size);
+    return true;
+#else
+    const int stride = image.width * 4;
+    m_rgb.resize(static_cast<size_t>(stride) * image.height);
+    ColorConvert::i420ToRgb(image.planes[0], image.strides[0],
+                            image.planes[1], image.strides[1],
+                            image.planes[2], image.strides[2],
+                            m_rgb.data(), stride, image.width, image.height, ColorConvert::RgbLayout::Bgra32);
+
+    QImage rgb(m_rgb.data(), image.width, image.height, stride, QImage::Format_RGB32);
+    QByteArray bytes;
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::WriteOnly);
+    if (!rgb.save(&buffer, "JPG", quality)) {
+        qWarning() << "JpegEncoder: Qt JPEG plugin unavailable";
+        return false;
+    }
+    out.assign(bytes.constData(), bytes.constData() + bytes.size());
+    return true;
+#endif
+}
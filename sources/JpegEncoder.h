@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "ImageScale.h"
+
+/**
+ * I420 → JPEG 编码
+ *
+ * 链接了 libjpeg-turbo 时（QUICKSTART_HAS_TURBOJPEG）直接从 YUV 平面压缩，
+ * 跳过颜色转换，DCT 和熵编码使用 libjpeg-turbo 自带的 NEON/SSE 实现；
+ * 否则先用 ColorConvert 转为 RGB，再交给 Qt 的 JPEG 插件编码。
+ *
+ * 编码器复用内部的压缩句柄和缓冲，不是线程安全的，每个线程使用各自的实例。
+ */
+class JpegEncoder {
+public:
+    JpegEncoder();
+    ~JpegEncoder();
+
+    JpegEncoder(const JpegEncoder &) = delete;
+    JpegEncoder &operator=(const JpegEncoder &) = delete;
+
+    /** 宽高必须为偶数；quality 取 1-100。成功时 out 被替换为 JPEG 数据 */
+    bool encode(const ImageScale::I420Image &image, int quality, std::vector<uint8_t> &out);
+
+    /** 编码实现的名称，用于日志和基准输出 */
+    static const char *backendName();
+
+private:
+    void *m_handle = nullptr;
+    std::vector<uint8_t> m_rgb;
+};
@@ -3,12 +3,15 @@
 #include <QPainter>
 #include <QDebug>
 #include <QMessageBox>
+#include <QLineEdit>
 
 /**
  * MQTT 配置与语音通话入口页面
  *
  * 包含如下功能：
  * - 输入 MQTT Broker 地址、智能体 ID、客户端 ID
+ * - 选择/删除保存在 config.json 中的连接配置，开始通话时自动保存
+ * - 选中的配置未被修改时通知主窗口预热连接，修改或切换后取消
  * - 校验输入项非空
  * - 点击按钮后通过 MQTT 发起语音通话
  */
@@ -20,8 +23,115 @@ LoginWidget::LoginWidget(QWidget *parent)
 	setAttribute(Qt::WA_StyledBackground);
 	parent->installEventFilter(this);
 
+	ui.profileComboBox->lineEdit()->setPlaceholderText(QStringLiteral(u"配置名称（可选）"));
+	m_profiles.load();
+	reloadProfileList();
+	if (const ConnectionProfile *last = m_profiles.find(m_profiles.lastProfile()))
+	{
+		applyProfile(*last);
+	}
+
+	connect(ui.profileComboBox, QOverload<int>::of(&QComboBox::activated),
+	        this, &LoginWidget::onProfileActivated);
+	connect(ui.brokerUrlLineEdit, &QLineEdit::textEdited, this, &LoginWidget::onFieldEdited);
+	connect(ui.agentIdLineEdit, &QLineEdit::textEdited, this, &LoginWidget::onFieldEdited);
+	connect(ui.clientIdLineEdit, &QLineEdit::textEdited, this, &LoginWidget::onFieldEdited);
+
 	connect(this, SIGNAL(sigStartVoiceChat(const QString &, const QString &, const QString &)),
 	        parent, SLOT(slotOnStartVoiceChat(const QString &, const QString &, const QString &)));
+	connect(this, SIGNAL(sigPrewarmProfile(const QString &, const QString &, const QString &)),
+	        parent, SLOT(slotOnPrewarmProfile(const QString &, const QString &, const QString &)));
+	connect(this, SIGNAL(sigCancelPrewarm()), parent, SLOT(slotOnCancelPrewarm()));
+}
+
+void LoginWidget::showEvent(QShowEvent *event)
+{
+	QWidget::showEvent(event);
+	// 启动时和挂断回到登录页时，为当前配置重新预热
+	emitPrewarm();
+}
+
+void LoginWidget::reloadProfileList()
+{
+	const QString current = ui.profileComboBox->currentText();
+	QSignalBlocker blocker(ui.profileComboBox);
+	ui.profileComboBox->clear();
+	for (const ConnectionProfile &profile : m_profiles.profiles())
+	{
+		ui.profileComboBox->addItem(profile.name);
+	}
+	ui.profileComboBox->setEditText(current);
+	ui.deleteProfileBtn->setEnabled(!m_profiles.profiles().isEmpty());
+}
+
+void LoginWidget::applyProfile(const ConnectionProfile &profile)
+{
+	ui.profileComboBox->setEditText(profile.name);
+	ui.brokerUrlLineEdit->setText(profile.brokerUrl);
+	ui.agentIdLineEdit->setText(profile.agentId);
+	ui.clientIdLineEdit->setText(profile.clientId);
+	m_loadedProfile = profile;
+	m_profileLoaded = true;
+}
+
+void LoginWidget::emitPrewarm()
+{
+	if (!m_profileLoaded || !isVisible())
+		return;
+
+	emit sigPrewarmProfile(m_loadedProfile.brokerUrl, m_loadedProfile.clientId, m_loadedProfile.rtcAppId);
+}
+
+void LoginWidget::onProfileActivated(int index)
+{
+	const ConnectionProfile *profile = m_profiles.find(ui.profileComboBox->itemText(index));
+	if (profile == nullptr)
+		return;
+
+	applyProfile(*profile);
+	emitPrewarm();
+}
+
+void LoginWidget::onFieldEdited()
+{
+	if (!m_profileLoaded)
+		return;
+
+	m_profileLoaded = false;
+	emit sigCancelPrewarm();
+}
+
+void LoginWidget::on_deleteProfileBtn_clicked()
+{
+	const QString name = ui.profileComboBox->currentText().trimmed();
+	if (m_profiles.find(name) == nullptr)
+		return;
+
+	m_profiles.remove(name);
+	m_profiles.save();
+	ui.profileComboBox->setEditText(QString());
+	reloadProfileList();
+	if (m_profileLoaded)
+	{
+		m_profileLoaded = false;
+		emit sigCancelPrewarm();
+	}
+}
+
+void LoginWidget::rememberRtcAppId(const QString &appId)
+{
+	const ConnectionProfile *current = m_profiles.find(m_profiles.lastProfile());
+	if (current == nullptr || current->rtcAppId == appId)
+		return;
+
+	ConnectionProfile profile = *current;
+	profile.rtcAppId = appId;
+	m_profiles.upsert(profile);
+	m_profiles.save();
+	if (m_loadedProfile.name == profile.name)
+	{
+		m_loadedProfile.rtcAppId = appId;
+	}
 }
 
 bool LoginWidget::eventFilter(QObject *watched, QEvent *event)
@@ -68,8 +178,26 @@ void LoginWidget::on_startVoiceChatBtn_clicked()
 	if (!checkNotEmpty(QStringLiteral(u"Client ID"), ui.clientIdLineEdit->text()))
 		return;
 
-	emit sigStartVoiceChat(
-		ui.brokerUrlLineEdit->text().trimmed(),
-		ui.agentIdLineEdit->text().trimmed(),
-		ui.clientIdLineEdit->text().trimmed());
+	// 未填写配置名称时以 Client ID 命名保存
+	ConnectionProfile profile;
+	profile.name = ui.profileComboBox->currentText().trimmed();
+	profile.brokerUrl = ui.brokerUrlLineEdit->text().trimmed();
+	profile.agentId = ui.agentIdLineEdit->text().trimmed();
+	profile.clientId = ui.clientIdLineEdit->text().trimmed();
+	if (profile.name.isEmpty())
+		profile.name = profile.clientId;
+
+	// 地址和智能体没变时沿用记录的 RTC AppId
+	if (const ConnectionProfile *existing = m_profiles.find(profile.name))
+	{
+		if (existing->brokerUrl == profile.brokerUrl && existing->agentId == profile.agentId)
+			profile.rtcAppId = existing->rtcAppId;
+	}
+	m_profiles.upsert(profile);
+	m_profiles.setLastProfile(profile.name);
+	m_profiles.save();
+	reloadProfileList();
+	applyProfile(profile);
+
+	emit sigStartVoiceChat(profile.brokerUrl, profile.agentId, profile.clientId);
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <QtWidgets/QMainWindow>
 #include "ui_LoginWidget.h"
+#include "ConnectionProfile.h"
 
 class LoginWidget : public QWidget {
     Q_OBJECT
@@ -9,14 +10,33 @@ class LoginWidget : public QWidget {
 public:
     LoginWidget(QWidget *parent = Q_NULLPTR);
 
+    /** 通话建立后记录智能体返回的 RTC AppId，下次选中该配置时用于预热 RTC 引擎 */
+    void rememberRtcAppId(const QString &appId);
+
 protected:
     bool eventFilter(QObject *watched, QEvent *event) override;
+    void showEvent(QShowEvent *event) override;
     //void paintEvent(QPaintEvent *event)override;
 private
     slots:
             void on_startVoiceChatBtn_clicked();
+            void on_deleteProfileBtn_clicked();
+            void onProfileActivated(int index);
+            void onFieldEdited();
     signals:
             void sigStartVoiceChat(const QString &brokerUrl, const QString &agentId, const QString &clientId);
+            /** 选中的配置原样显示在输入框中，可以开始预热 */
+            void sigPrewarmProfile(const QString &brokerUrl, const QString &clientId, const QString &rtcAppId);
+            /** 之前的预热不再需要（配置被修改、删除或切换） */
+            void sigCancelPrewarm();
 private:
+    void reloadProfileList();
+    void applyProfile(const ConnectionProfile &profile);
+    void emitPrewarm();
+
     Ui::LoginForm ui;
+    ConnectionProfileStore m_profiles;
+    // 输入框与 m_loadedProfile 一致，未被手动修改
+    bool m_profileLoaded = false;
+    ConnectionProfile m_loadedProfile;
 };
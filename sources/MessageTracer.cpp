@@ -0,0 +1,448 @@
+#include "MessageTracer.h"
+#include "ThreadPolicy.h"
+#include <QDebug>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+TraceConfig TraceConfig::fromEnvironment() {
+    TraceConfig config;
+    const char *value = std::getenv("QUICKSTART_TRACE");
+    if (!value) {
+        return config;
+    }
+
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.compare(0, 5, "file=") == 0) config.filePath = item.substr(5);
+        else if (item.compare(0, 9, "capacity=") == 0) config.capacity = std::atoi(item.c_str() + 9);
+        else if (item.compare(0, 9, "flush_ms=") == 0) config.flushMs = std::atoi(item.c_str() + 9);
+        else if (!item.empty()) qWarning() << "QUICKSTART_TRACE: unknown option" << item.c_str();
+    }
+
+    config.capacity = std::max(256, config.capacity);
+    config.flushMs = std::max(10, config.flushMs);
+    return config;
+}
+
+namespace {
+
+const size_t kIdSize = 48;
+const size_t kDetailSize = 64;
+// 超过该时间没有后续打点的 id 不再与之后的打点连成区间（JSON-RPC id 会被复用）
+const int64_t kPendingExpiryNs = 60LL * 1000 * 1000 * 1000;
+
+thread_local const char *t_dispatchChannel = nullptr;
+thread_local char t_dispatchId[kIdSize] = {};
+
+int64_t monotonicNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+uint32_t currentThreadId() {
+    static thread_local uint32_t tid = static_cast<uint32_t>(syscall(SYS_gettid));
+    return tid;
+}
+
+void copyText(char *dst, size_t size, const char *src) {
+    if (!src) {
+        dst[0] = '\0';
+        return;
+    }
+    size_t length = strnlen(src, size - 1);
+    memcpy(dst, src, length);
+    dst[length] = '\0';
+}
+
+const char *pointName(TracePoint point) {
+    switch (point) {
+        case TracePoint::Receive: return "receive";
+        case TracePoint::Dispatch: return "dispatch";
+        case TracePoint::HandlerStart: return "handler.start";
+        case TracePoint::HandlerEnd: return "handler.end";
+        case TracePoint::Publish: return "publish";
+        case TracePoint::DeliveryComplete: return "delivery";
+    }
+    return "unknown";
+}
+
+void appendJsonString(std::string &out, const char *text) {
+    out += '"';
+    for (const char *p = text; *p; ++p) {
+        char c = *p;
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+void appendTimestamp(std::string &out, int64_t ns) {
+    // Chrome trace 的时间单位为微秒，保留纳秒精度
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%lld.%03lld",
+             static_cast<long long>(ns / 1000), static_cast<long long>(ns % 1000));
+    out += buffer;
+}
+
+} // namespace
+
+struct MessageTracer::Slot {
+    std::atomic<uint64_t> sequence{0};      // 写完后为槽位序号 + 1
+    int64_t timestampNs = 0;
+    uint32_t tid = 0;
+    TracePoint point = TracePoint::Receive;
+    const char *channel = "";
+    char id[kIdSize] = {};
+    char detail[kDetailSize] = {};
+};
+
+struct MessageTracer::Pending {
+    struct Last {
+        int64_t timestampNs;
+        uint32_t tid;
+        TracePoint point;
+    };
+    std::unordered_map<std::string, Last> last;
+    std::unordered_set<uint32_t> namedThreads;
+    std::string key;
+    uint64_t reportedDrops = 0;
+    int64_t newestNs = 0;
+    int pid = 0;
+};
+
+std::atomic<MessageTracer *> MessageTracer::s_instance{nullptr};
+
+MessageTracer::MessageTracer(const TraceConfig &config)
+        : m_config(config),
+          m_slots(new Slot[config.capacity]),
+          m_pending(new Pending) {
+    m_pending->pid = static_cast<int>(getpid());
+}
+
+void MessageTracer::install(const TraceConfig &config) {
+    if (!config.enabled() || enabled()) {
+        return;
+    }
+
+    FILE *file = fopen(config.filePath.c_str(), "w");
+    if (!file) {
+        qWarning() << "MessageTracer: cannot open" << config.filePath.c_str();
+        return;
+    }
+    fputs("[\n", file);
+
+    // 不释放：退出过程中其它线程可能仍在打点，shutdown 之后打点直接返回
+    auto *tracer = new MessageTracer(config);
+    tracer->m_file = file;
+    tracer->m_thread = std::thread(&MessageTracer::run, tracer);
+    s_instance.store(tracer, std::memory_order_release);
+    std::atexit(&MessageTracer::shutdown);
+    qInfo() << "MessageTracer: writing" << config.filePath.c_str();
+}
+
+void MessageTracer::shutdown() {
+    MessageTracer *tracer = s_instance.exchange(nullptr, std::memory_order_acq_rel);
+    if (!tracer) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(tracer->m_mutex);
+        tracer->m_stopping = true;
+    }
+    tracer->m_cond.notify_all();
+    tracer->m_thread.join();
+
+    fputs("\n]\n", tracer->m_file);
+    fclose(tracer->m_file);
+    tracer->m_file = nullptr;
+    uint64_t dropped = tracer->m_dropped.load(std::memory_order_relaxed);
+    if (dropped > 0) {
+        qWarning() << "MessageTracer: dropped" << dropped << "events, increase capacity";
+    }
+}
+
+void MessageTracer::mark(TracePoint point, const char *channel, const char *id, const char *detail) {
+    MessageTracer *tracer = s_instance.load(std::memory_order_acquire);
+    if (tracer) {
+        tracer->record(point, channel, id, detail);
+    }
+}
+
+void MessageTracer::markPayload(TracePoint point, const char *channel, const std::string &payload,
+                                const char *detail) {
+    MessageTracer *tracer = s_instance.load(std::memory_order_acquire);
+    if (!tracer) {
+        return;
+    }
+    char id[kIdSize];
+    if (!extractJsonRpcId(payload, id, sizeof(id))) {
+        id[0] = '\0';
+    }
+    tracer->record(point, channel, id, detail);
+}
+
+bool MessageTracer::extractJsonRpcId(const std::string &payload, char *id, size_t size) {
+    const size_t n = payload.size();
+    int depth = 0;
+    size_t i = 0;
+    while (i < n) {
+        char c = payload[i];
+        if (c == '"') {
+            size_t start = ++i;
+            while (i < n && payload[i] != '"') {
+                i += payload[i] == '\\' ? 2 : 1;
+            }
+            if (i >= n) {
+                return false;
+            }
+            size_t end = i++;
+            if (depth != 1 || end - start != 2 || payload.compare(start, 2, "id") != 0) {
+                continue;
+            }
+            while (i < n && std::isspace(static_cast<unsigned char>(payload[i]))) ++i;
+            // 值为 "id" 的字符串后面不是冒号
+            if (i >= n || payload[i] != ':') {
+                continue;
+            }
+            ++i;
+            while (i < n && std::isspace(static_cast<unsigned char>(payload[i]))) ++i;
+
+            size_t valueStart = i;
+            size_t valueEnd = i;
+            if (i < n && payload[i] == '"') {
+                valueStart = ++i;
+                while (i < n && payload[i] != '"' && payload[i] != '\\') ++i;
+                if (i >= n) {
+                    return false;
+                }
+                valueEnd = i;
+            } else {
+                while (i < n && (std::isdigit(static_cast<unsigned char>(payload[i])) || payload[i] == '-')) ++i;
+                valueEnd = i;
+            }
+            // null、空串等都当作没有 id
+            if (valueEnd == valueStart) {
+                return false;
+            }
+            size_t length = std::min(valueEnd - valueStart, size - 1);
+            memcpy(id, payload.data() + valueStart, length);
+            id[length] = '\0';
+            return true;
+        }
+        if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            --depth;
+        }
+        ++i;
+    }
+    return false;
+}
+
+void MessageTracer::record(TracePoint point, const char *channel, const char *id, const char *detail) {
+    const int64_t timestampNs = monotonicNs();
+    const uint64_t capacity = static_cast<uint64_t>(m_config.capacity);
+
+    // 只有已落盘的槽位才能复用，落盘线程跟不上时丢弃新的打点而不是覆盖
+    uint64_t index = m_head.load(std::memory_order_relaxed);
+    do {
+        if (index - m_flushed.load(std::memory_order_acquire) >= capacity) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    } while (!m_head.compare_exchange_weak(index, index + 1, std::memory_order_relaxed));
+
+    Slot &slot = m_slots[index % capacity];
+    slot.timestampNs = timestampNs;
+    slot.tid = currentThreadId();
+    slot.point = point;
+    slot.channel = channel;
+    copyText(slot.id, sizeof(slot.id), id);
+    copyText(slot.detail, sizeof(slot.detail), detail);
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+void MessageTracer::run() {
+    ThreadPolicy::registerCurrentThread(ThreadClass::Background, "trace-writer");
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        m_cond.wait_for(lock, std::chrono::milliseconds(m_config.flushMs), [this] { return m_stopping; });
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+void MessageTracer::flush() {
+    const uint64_t capacity = static_cast<uint64_t>(m_config.capacity);
+    uint64_t next = m_flushed.load(std::memory_order_relaxed);
+    // 遇到已分配但还没写完的槽位就停下，下一轮再继续
+    for (;;) {
+        const Slot &slot = m_slots[next % capacity];
+        if (slot.sequence.load(std::memory_order_acquire) != next + 1) {
+            break;
+        }
+        writeEvent(slot);
+        ++next;
+    }
+    m_flushed.store(next, std::memory_order_release);
+
+    Pending &pending = *m_pending;
+    for (auto it = pending.last.begin(); it != pending.last.end();) {
+        if (pending.newestNs - it->second.timestampNs > kPendingExpiryNs) {
+            it = pending.last.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+    if (dropped != pending.reportedDrops) {
+        pending.reportedDrops = dropped;
+        m_line.clear();
+        m_line += m_firstEvent ? "" : ",\n";
+        m_line += "{\"name\":\"trace.dropped\",\"ph\":\"C\",\"ts\":";
+        appendTimestamp(m_line, monotonicNs());
+        m_line += ",\"pid\":" + std::to_string(pending.pid) + ",\"args\":{\"events\":" + std::to_string(dropped) + "}}";
+        fputs(m_line.c_str(), m_file);
+        m_firstEvent = false;
+    }
+    fflush(m_file);
+}
+
+void MessageTracer::writeThreadName(uint32_t tid) {
+    Pending &pending = *m_pending;
+    if (!pending.namedThreads.insert(tid).second) {
+        return;
+    }
+
+    // 线程名取自 /proc，线程已退出时用编号代替
+    char name[64] = {};
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/task/%u/comm", tid);
+    FILE *comm = fopen(path, "r");
+    if (comm) {
+        if (fgets(name, sizeof(name), comm)) {
+            name[strcspn(name, "\n")] = '\0';
+        }
+        fclose(comm);
+    }
+    if (name[0] == '\0') {
+        snprintf(name, sizeof(name), "thread-%u", tid);
+    }
+
+    m_line += m_firstEvent ? "" : ",\n";
+    m_firstEvent = false;
+    m_line += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + std::to_string(pending.pid)
+              + ",\"tid\":" + std::to_string(tid) + ",\"args\":{\"name\":";
+    appendJsonString(m_line, name);
+    m_line += "}}";
+}
+
+void MessageTracer::writeEvent(const Slot &slot) {
+    Pending &pending = *m_pending;
+    const std::string pid = std::to_string(pending.pid);
+    pending.newestNs = std::max(pending.newestNs, slot.timestampNs);
+
+    m_line.clear();
+    writeThreadName(slot.tid);
+
+    // 所在线程上的瞬时事件
+    m_line += m_firstEvent ? "" : ",\n";
+    m_firstEvent = false;
+    m_line += "{\"name\":\"";
+    m_line += pointName(slot.point);
+    m_line += "\",\"cat\":";
+    appendJsonString(m_line, slot.channel);
+    m_line += ",\"ph\":\"i\",\"s\":\"t\",\"ts\":";
+    appendTimestamp(m_line, slot.timestampNs);
+    m_line += ",\"pid\":" + pid + ",\"tid\":" + std::to_string(slot.tid) + ",\"args\":{\"id\":";
+    appendJsonString(m_line, slot.id);
+    m_line += ",\"detail\":";
+    appendJsonString(m_line, slot.detail);
+    m_line += "}}";
+
+    if (slot.id[0] != '\0') {
+        pending.key.assign(slot.channel);
+        pending.key += ':';
+        pending.key += slot.id;
+
+        auto it = pending.last.find(pending.key);
+        if (it != pending.last.end()) {
+            // 与同一 id 的上一次打点连成一段异步区间；取时间与分配槽位之间可能被抢占，结束时间不早于开始时间
+            const Pending::Last &last = it->second;
+            std::string name = std::string(pointName(last.point)) + " -> " + pointName(slot.point);
+            for (const char *phase : {"b", "e"}) {
+                const bool begin = phase[0] == 'b';
+                m_line += ",\n{\"name\":";
+                appendJsonString(m_line, name.c_str());
+                m_line += ",\"cat\":";
+                appendJsonString(m_line, slot.channel);
+                m_line += ",\"ph\":\"";
+                m_line += phase;
+                m_line += "\",\"id\":";
+                appendJsonString(m_line, pending.key.c_str());
+                m_line += ",\"ts\":";
+                appendTimestamp(m_line, begin ? last.timestampNs : std::max(last.timestampNs, slot.timestampNs));
+                m_line += ",\"pid\":" + pid + ",\"tid\":" + std::to_string(begin ? last.tid : slot.tid);
+                if (begin) {
+                    m_line += ",\"args\":{\"detail\":";
+                    appendJsonString(m_line, slot.detail);
+                    m_line += "}";
+                }
+                m_line += "}";
+            }
+        }
+        pending.last[pending.key] = Pending::Last{slot.timestampNs, slot.tid, slot.point};
+    }
+
+    fputs(m_line.c_str(), m_file);
+}
+
+MessageTracer::DispatchScope::DispatchScope(const char *channel, const std::string &payload)
+        : m_previousChannel(t_dispatchChannel) {
+    memcpy(m_previousId, t_dispatchId, sizeof(m_previousId));
+    if (!enabled()) {
+        return;
+    }
+    t_dispatchChannel = channel;
+    if (!extractJsonRpcId(payload, t_dispatchId, sizeof(t_dispatchId))) {
+        t_dispatchId[0] = '\0';
+    }
+}
+
+MessageTracer::DispatchScope::~DispatchScope() {
+    t_dispatchChannel = m_previousChannel;
+    memcpy(t_dispatchId, m_previousId, sizeof(m_previousId));
+}
+
+MessageTracer::HandlerScope::HandlerScope(const char *name)
+        : m_name(name) {
+    // SDK 在其它线程上调用处理函数时拿不到分发中的消息，只记录瞬时事件
+    mark(TracePoint::HandlerStart, t_dispatchChannel ? t_dispatchChannel : "tool",
+         t_dispatchChannel ? t_dispatchId : nullptr, m_name);
+}
+
+MessageTracer::HandlerScope::~HandlerScope() {
+    mark(TracePoint::HandlerEnd, t_dispatchChannel ? t_dispatchChannel : "tool",
+         t_dispatchChannel ? t_dispatchId : nullptr, m_name);
+}
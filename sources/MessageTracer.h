@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * 消息追踪配置
+ *
+ * 通过环境变量 QUICKSTART_TRACE 以逗号分隔的选项开启：
+ *   file=PATH        Chrome trace 格式的输出文件，不指定则不追踪
+ *   capacity=N       预分配的打点槽位数，默认 16384，写入线程来不及落盘时新的打点被丢弃
+ *   flush_ms=N       落盘间隔，默认 500
+ * 例如：QUICKSTART_TRACE=file=/tmp/quickstart-trace.json
+ */
+struct TraceConfig {
+    std::string filePath;
+    int capacity = 16384;
+    int flushMs = 500;
+
+    bool enabled() const { return !filePath.empty(); }
+
+    static TraceConfig fromEnvironment();
+};
+
+/** 一条消息经过的阶段 */
+enum class TracePoint : uint8_t {
+    Receive,            // Paho 回调线程收到
+    Dispatch,           // 交给处理方（MCP SDK 或界面线程排空事件队列）
+    HandlerStart,
+    HandlerEnd,
+    Publish,            // 调用 Paho 发布
+    DeliveryComplete,   // Broker 确认（QoS 1）
+};
+
+/**
+ * MQTT / MCP 消息的端到端追踪
+ *
+ * 每次打点写入预分配的定长槽位：时间戳、线程、阶段、通道（agent / mcp）、
+ * JSON-RPC id 与简短说明（主题或工具名），打点时不加锁、不分配内存。
+ * 后台线程按 flush_ms 把已写完的槽位转换为 Chrome trace 事件追加到文件，
+ * 可直接用 chrome://tracing 或 ui.perfetto.dev 打开：
+ * - 每个打点是所在线程上的瞬时事件，看得出在哪个线程上执行
+ * - 同一通道、同一 id 的相邻两次打点之间生成一段异步区间（如 "receive -> dispatch"），
+ *   同一 id 的请求与应答排在同一条轨道上，耗时落在哪一段一目了然
+ * 没有 id 的通知只记录瞬时事件。
+ *
+ * 追踪器在 main() 中安装，进程退出时落盘剩余事件并补全 JSON；
+ * 被看门狗强制结束时文件缺少结尾的 "]"，两种查看工具都能正常打开。
+ */
+class MessageTracer {
+public:
+    static void install(const TraceConfig &config);
+    static bool enabled() { return s_instance.load(std::memory_order_acquire) != nullptr; }
+
+    /** channel 必须是字符串常量；id 与 detail 超长时截断 */
+    static void mark(TracePoint point, const char *channel, const char *id, const char *detail = nullptr);
+    /** 从 JSON-RPC 报文中找出顶层 id 后打点 */
+    static void markPayload(TracePoint point, const char *channel, const std::string &payload,
+                            const char *detail = nullptr);
+
+    /**
+     * 取报文顶层的 "id"（字符串或整数），找不到或为 null 时返回 false。
+     * 只扫描到 id 为止，不做完整解析。
+     */
+    static bool extractJsonRpcId(const std::string &payload, char *id, size_t size);
+
+    /**
+     * 当前线程正在分发的消息，MCP 工具处理函数拿不到 JSON-RPC id，
+     * 由分发处设置后用 HandlerScope 打点
+     */
+    class DispatchScope {
+    public:
+        DispatchScope(const char *channel, const std::string &payload);
+        ~DispatchScope();
+
+        DispatchScope(const DispatchScope &) = delete;
+        DispatchScope &operator=(const DispatchScope &) = delete;
+
+    private:
+        const char *m_previousChannel;
+        char m_previousId[48];
+    };
+
+    /** 在处理函数开始和结束时各打一次点，归到当前线程正在分发的消息上 */
+    class HandlerScope {
+    public:
+        explicit HandlerScope(const char *name);
+        ~HandlerScope();
+
+        HandlerScope(const HandlerScope &) = delete;
+        HandlerScope &operator=(const HandlerScope &) = delete;
+
+    private:
+        const char *m_name;
+    };
+
+private:
+    struct Slot;
+
+    explicit MessageTracer(const TraceConfig &config);
+
+    void record(TracePoint point, const char *channel, const char *id, const char *detail);
+    void run();
+    void flush();
+    void writeEvent(const Slot &slot);
+    void writeThreadName(uint32_t tid);
+    static void shutdown();
+
+    static std::atomic<MessageTracer *> s_instance;
+
+    const TraceConfig m_config;
+    std::unique_ptr<Slot[]> m_slots;
+    std::atomic<uint64_t> m_head{0};        // 下一个要分配的槽位
+    std::atomic<uint64_t> m_flushed{0};     // 之前的槽位已落盘，可以复用
+    std::atomic<uint64_t> m_dropped{0};
+
+    // 以下只在落盘线程上访问（shutdown 时线程已退出）
+    struct Pending;
+    std::unique_ptr<Pending> m_pending;
+    FILE *m_file = nullptr;
+    std::string m_line;
+    bool m_firstEvent = true;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_stopping = false;
+    std::thread m_thread;
+};
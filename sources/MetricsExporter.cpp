@@ -0,0 +1,196 @@
+#include "MetricsExporter.h"
+#include "ThreadPolicy.h"
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+MetricsConfig MetricsConfig::fromEnvironment() {
+    MetricsConfig config;
+    const char *value = std::getenv("QUICKSTART_METRICS");
+    if (!value) {
+        return config;
+    }
+
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item == "overlay") config.overlay = true;
+        else if (item.compare(0, 5, "file=") == 0) config.filePath = item.substr(5);
+        else if (item.compare(0, 12, "interval_ms=") == 0) config.intervalMs = std::atoi(item.c_str() + 12);
+        else if (item.compare(0, 7, "max_mb=") == 0) config.maxFileMb = std::atoi(item.c_str() + 7);
+        else if (item.compare(0, 8, "history=") == 0) config.historySize = std::atoi(item.c_str() + 8);
+        else if (!item.empty()) qWarning() << "QUICKSTART_METRICS: unknown option" << item.c_str();
+    }
+
+    config.intervalMs = std::max(100, config.intervalMs);
+    config.maxFileMb = std::max(0, config.maxFileMb);
+    config.historySize = std::max(2, config.historySize);
+    return config;
+}
+
+namespace {
+
+void appendJsonString(std::string &out, const std::string &text) {
+    out += '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+} // namespace
+
+MetricsExporter::MetricsExporter(const MetricsConfig &config)
+        : m_config(config) {
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+void MetricsExporter::addProvider(const std::string &name, Provider provider) {
+    std::lock_guard<std::mutex> lock(m_providerMutex);
+    for (auto &entry : m_providers) {
+        if (entry.first == name) {
+            entry.second = std::move(provider);
+            return;
+        }
+    }
+    m_providers.emplace_back(name, std::move(provider));
+}
+
+void MetricsExporter::removeProvider(const std::string &name) {
+    std::lock_guard<std::mutex> lock(m_providerMutex);
+    m_providers.erase(std::remove_if(m_providers.begin(), m_providers.end(),
+                                     [&](const auto &entry) { return entry.first == name; }),
+                      m_providers.end());
+}
+
+bool MetricsExporter::start() {
+    if (!m_config.exportEnabled()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    if (m_running) {
+        return true;
+    }
+    if (!openFile()) {
+        return false;
+    }
+    m_running = true;
+    m_thread = std::thread(&MetricsExporter::run, this);
+    qInfo() << "MetricsExporter: writing to" << m_config.filePath.c_str()
+            << "every" << m_config.intervalMs << "ms";
+    return true;
+}
+
+void MetricsExporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+    m_stateCond.notify_all();
+    m_thread.join();
+
+    // 最后导出一次，保证退出前的数据写入文件
+    exportNow();
+    std::lock_guard<std::mutex> lock(m_providerMutex);
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+void MetricsExporter::exportNow() {
+    auto now = std::chrono::system_clock::now();
+    writeRecord(std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count());
+}
+
+void MetricsExporter::run() {
+    ThreadPolicy::registerCurrentThread(ThreadClass::Background, "metrics");
+    std::unique_lock<std::mutex> lock(m_stateMutex);
+    while (m_running) {
+        if (m_stateCond.wait_for(lock, std::chrono::milliseconds(m_config.intervalMs),
+                                 [this] { return !m_running; })) {
+            break;
+        }
+        lock.unlock();
+        exportNow();
+        lock.lock();
+    }
+}
+
+bool MetricsExporter::openFile() {
+    std::lock_guard<std::mutex> lock(m_providerMutex);
+    m_file = fopen(m_config.filePath.c_str(), "a");
+    if (!m_file) {
+        qWarning() << "MetricsExporter: cannot open" << m_config.filePath.c_str();
+        return false;
+    }
+    return true;
+}
+
+void MetricsExporter::rotateIfNeeded() {
+    if (m_config.maxFileMb <= 0 || !m_file) {
+        return;
+    }
+    long size = ftell(m_file);
+    if (size < static_cast<long>(m_config.maxFileMb) * 1024 * 1024) {
+        return;
+    }
+
+    fclose(m_file);
+    std::string rotated = m_config.filePath + ".1";
+    if (rename(m_config.filePath.c_str(), rotated.c_str()) != 0) {
+        qWarning() << "MetricsExporter: rotate failed for" << m_config.filePath.c_str();
+    }
+    m_file = fopen(m_config.filePath.c_str(), "a");
+}
+
+void MetricsExporter::writeRecord(int64_t timestampMs) {
+    std::lock_guard<std::mutex> lock(m_providerMutex);
+    if (!m_file) {
+        return;
+    }
+
+    m_record.clear();
+    for (auto &entry : m_providers) {
+        entry.second(m_record);
+    }
+
+    m_line.clear();
+    m_line += "{\"ts_ms\":";
+    m_line += std::to_string(timestampMs);
+    char number[32];
+    for (const auto &value : m_record.values()) {
+        m_line += ',';
+        appendJsonString(m_line, value.first);
+        m_line += ':';
+        if (std::isfinite(value.second)) {
+            snprintf(number, sizeof(number), "%.6g", value.second);
+            m_line += number;
+        } else {
+            m_line += "null";
+        }
+    }
+    m_line += "}\n";
+
+    fwrite(m_line.data(), 1, m_line.size(), m_file);
+    fflush(m_file);
+    rotateIfNeeded();
+}
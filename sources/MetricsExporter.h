@@ -0,0 +1,97 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * 指标导出配置
+ *
+ * 通过环境变量 QUICKSTART_METRICS 以逗号分隔的选项开启：
+ *   file=PATH        追加写入的指标文件（JSON Lines），不指定则不导出
+ *   interval_ms=N    导出间隔，默认 5000
+ *   max_mb=N         文件超过该大小时轮转为 PATH.1，默认 16，0 表示不轮转
+ *   history=N        每条流保留的统计样本数，默认 150（2 秒一次约 5 分钟）
+ *   overlay          在视频画面上显示该画面的实时统计
+ * 例如：QUICKSTART_METRICS=file=/tmp/quickstart-metrics.jsonl,interval_ms=2000,overlay
+ */
+struct MetricsConfig {
+    std::string filePath;
+    int intervalMs = 5000;
+    int maxFileMb = 16;
+    int historySize = 150;
+    bool overlay = false;
+
+    bool exportEnabled() const { return !filePath.empty(); }
+
+    static MetricsConfig fromEnvironment();
+};
+
+/**
+ * 一次导出的指标集合，键为 "模块.名称" 形式的扁平名称，值为数值。
+ * 由 MetricsExporter 在导出线程上复用，提供方只调用 add。
+ */
+class MetricsRecord {
+public:
+    void add(const std::string &name, double value) { m_values.emplace_back(name, value); }
+    void clear() { m_values.clear(); }
+
+    const std::vector<std::pair<std::string, double>> &values() const { return m_values; }
+
+private:
+    std::vector<std::pair<std::string, double>> m_values;
+};
+
+/**
+ * 周期性指标导出
+ *
+ * 各模块注册提供方，导出线程按 interval_ms 依次调用提供方收集指标，
+ * 以一行 JSON 对象追加写入文件：{"ts_ms":..., "rtc.local.sent_kbps":..., ...}，
+ * 便于把通话质量与设备负载按时间对齐分析。
+ *
+ * 提供方在导出线程上调用，需自行保证线程安全；removeProvider 返回后不会再被调用。
+ */
+class MetricsExporter {
+public:
+    using Provider = std::function<void(MetricsRecord &record)>;
+
+    explicit MetricsExporter(const MetricsConfig &config);
+    ~MetricsExporter();
+
+    const MetricsConfig &config() const { return m_config; }
+
+    /** 同名提供方会被替换 */
+    void addProvider(const std::string &name, Provider provider);
+    void removeProvider(const std::string &name);
+
+    bool start();
+    void stop();
+
+    /** 立即导出一次，在调用线程上执行 */
+    void exportNow();
+
+private:
+    void run();
+    bool openFile();
+    void rotateIfNeeded();
+    void writeRecord(int64_t timestampMs);
+
+    const MetricsConfig m_config;
+
+    std::mutex m_providerMutex;   // 导出期间持有，保证 removeProvider 后不再回调
+    std::vector<std::pair<std::string, Provider>> m_providers;
+    MetricsRecord m_record;
+    std::string m_line;
+    FILE *m_file = nullptr;
+
+    std::mutex m_stateMutex;
+    std::condition_variable m_stateCond;
+    bool m_running = false;
+    std::thread m_thread;
+};
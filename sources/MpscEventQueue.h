@@ -0,0 +1,229 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * 有界多生产者/单消费者无锁事件队列，用于把 SDK/MQTT 回调线程上的事件交给界面线程
+ *
+ * - push() 可在任意线程调用，不加锁、不分配内存；队列已满时丢弃新事件并计数，返回 false。
+ *   只用于丢了也无妨的事件（统计等，之后还会有新的）
+ * - pushReliable() 用于不能丢、顺序有意义的事件（流的发布、用户离开、收到的消息等）：
+ *   队列已满时转入加锁的溢出列表，只有这时才加锁、分配内存。溢出列表非空期间，
+ *   后续的 pushReliable() 也进入溢出列表、push() 直接丢弃，同一线程入队的事件因此保持顺序
+ * - drain() 只能由消费者线程调用，一次取出调用时已入队的事件（环形数组取空后再取溢出列表，
+ *   每次合计至多一个容量），先合并被后续事件取代的旧事件，再按入队顺序逐个交给处理函数
+ *
+ * - consume() 同样只能由消费者线程调用，按入队顺序取出至多 max 个事件，不做合并
+ *
+ * 事件类型 T 需可默认构造、可移动赋值；使用 drain() 时还需提供
+ *   static bool supersedes(const T &newer, const T &older);
+ * 返回 true 表示 older 已被 newer 取代、不必再处理（例如同一条流的两次统计）。
+ *
+ * 实现为按序号认领的环形数组（Vyukov 算法）：每个槽位带序号，生产者 CAS 认领写入位置，
+ * 写完后发布序号，消费者只读取已发布的槽位。槽位在构造时一次性分配，容量向上取整为 2 的幂。
+ */
+template <typename T>
+class MpscEventQueue {
+public:
+    explicit MpscEventQueue(int capacity) {
+        size_t size = 1;
+        while (size < static_cast<size_t>(capacity < 1 ? 1 : capacity)) {
+            size <<= 1;
+        }
+        m_mask = size - 1;
+        m_cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        m_batch.reserve(size);
+        m_superseded.resize(size);
+    }
+
+    MpscEventQueue(const MpscEventQueue &) = delete;
+    MpscEventQueue &operator=(const MpscEventQueue &) = delete;
+
+    bool push(T &&event) {
+        if (m_spilling.load(std::memory_order_acquire) || !tryPush(event)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    void pushReliable(T &&event) {
+        if (!m_spilling.load(std::memory_order_acquire) && tryPush(event)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_spillMutex);
+        // 消费者可能刚取走溢出列表并腾出了空间
+        if (!m_spilling.load(std::memory_order_relaxed) && tryPush(event)) {
+            return;
+        }
+        m_spill.push_back(std::move(event));
+        m_spilling.store(true, std::memory_order_release);
+        m_spilled.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /** 返回实际交给处理函数的事件数 */
+    template <typename Handler>
+    int drain(Handler &&handler) {
+        m_batch.clear();
+        T event;
+        bool ringEmpty = false;
+        while (m_batch.size() <= m_mask) {
+            if (!pop(event)) {
+                ringEmpty = true;
+                break;
+            }
+            m_batch.push_back(std::move(event));
+        }
+        // 溢出列表中的事件都晚于环形数组中剩下的事件，环形数组取空后才能取；
+        // 每次至多取一个容量，合并的开销保持有界
+        if (ringEmpty) {
+            takeSpill(m_batch, m_mask + 1);
+        }
+
+        // 从最新的事件往前看，同类旧事件标记为已取代
+        const int count = static_cast<int>(m_batch.size());
+        if (m_superseded.size() < m_batch.size()) {
+            m_superseded.resize(m_batch.size());
+        }
+        std::fill(m_superseded.begin(), m_superseded.begin() + count, 0);
+        for (int newer = count - 1; newer > 0; --newer) {
+            if (m_superseded[newer]) continue;
+            for (int older = newer - 1; older >= 0; --older) {
+                if (!m_superseded[older] && T::supersedes(m_batch[newer], m_batch[older])) {
+                    m_superseded[older] = 1;
+                }
+            }
+        }
+
+        int handled = 0;
+        for (int i = 0; i < count; ++i) {
+            if (m_superseded[i]) continue;
+            handler(m_batch[i]);
+            ++handled;
+        }
+        m_coalesced += static_cast<uint64_t>(count - handled);
+        // 释放事件持有的资源（如消息的共享指针），容量保留复用
+        m_batch.clear();
+        return handled;
+    }
+
+    /**
+     * 逐个取出事件交给处理函数，不合并，适合每个事件都要保留的高频数据；
+     * 返回取出的事件数
+     */
+    template <typename Handler>
+    int consume(Handler &&handler, int max) {
+        int consumed = 0;
+        T event;
+        while (consumed < max) {
+            if (!pop(event)) {
+                m_batch.clear();
+                takeSpill(m_batch, static_cast<size_t>(max - consumed));
+                for (T &spilled : m_batch) {
+                    handler(spilled);
+                    ++consumed;
+                }
+                m_batch.clear();
+                break;
+            }
+            handler(event);
+            ++consumed;
+        }
+        return consumed;
+    }
+
+    /** 已入队、尚未取出的事件数（近似值，不含溢出列表），任意线程可读 */
+    size_t size() const {
+        const size_t enqueued = m_enqueuePos.load(std::memory_order_relaxed);
+        const size_t dequeued = m_dequeuedCount.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    /** 因队列满被丢弃的事件数，任意线程可读 */
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    /** 队列满时转入溢出列表的事件数，任意线程可读 */
+    uint64_t spilled() const { return m_spilled.load(std::memory_order_relaxed); }
+    /** 被合并掉的事件数，只能在消费者线程读取 */
+    uint64_t coalesced() const { return m_coalesced; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        T event;
+    };
+
+    /** 队列满时返回 false，event 保持不变 */
+    bool tryPush(T &event) {
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = m_cells[pos & m_mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.event = std::move(event);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // 消费者还没取走这一圈的槽位，队列已满
+                return false;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(T &event) {
+        Cell &cell = m_cells[m_dequeuePos & m_mask];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(m_dequeuePos + 1) < 0) {
+            return false;
+        }
+        event = std::move(cell.event);
+        cell.sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+        ++m_dequeuePos;
+        m_dequeuedCount.store(m_dequeuePos, std::memory_order_relaxed);
+        return true;
+    }
+
+    /** 从溢出列表头部取出至多 max 个追加到 out；取空后之后的 pushReliable() 回到环形数组 */
+    void takeSpill(std::vector<T> &out, size_t max) {
+        if (!m_spilling.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_spillMutex);
+        for (size_t i = 0; i < max && !m_spill.empty(); ++i) {
+            out.push_back(std::move(m_spill.front()));
+            m_spill.pop_front();
+        }
+        if (m_spill.empty()) {
+            m_spilling.store(false, std::memory_order_release);
+        }
+    }
+
+    size_t m_mask = 0;
+    std::unique_ptr<Cell[]> m_cells;
+    alignas(64) std::atomic<size_t> m_enqueuePos{0};
+    alignas(64) std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_spilled{0};
+    alignas(64) std::atomic<bool> m_spilling{false};
+    std::mutex m_spillMutex;
+    std::deque<T> m_spill;
+    alignas(64) size_t m_dequeuePos = 0;
+    std::atomic<size_t> m_dequeuedCount{0};
+    uint64_t m_coalesced = 0;
+    std::vector<T> m_batch;
+    std::vector<uint8_t> m_superseded;
+};
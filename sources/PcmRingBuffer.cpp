@@ -0,0 +1,70 @@
+#include "PcmRingBuffer.h"
+#include <algorithm>
+#include <cstring>
+
+PcmRingBuffer::PcmRingBuffer(size_t capacitySamples) {
+    size_t size = 1;
+    while (size < std::max<size_t>(capacitySamples, 1)) {
+        size <<= 1;
+    }
+    m_capacity = size;
+    m_mask = size - 1;
+    m_buffer.reset(new int16_t[size]());
+}
+
+size_t PcmRingBuffer::write(const int16_t *samples, size_t count, size_t channels) {
+    const uint64_t writePos = m_writePos.load(std::memory_order_relaxed);
+    const uint64_t readPos = m_readPos.load(std::memory_order_acquire);
+    const size_t space = m_capacity - static_cast<size_t>(writePos - readPos);
+    // 只写整帧：容量不是声道数的整数倍时，写半帧会让之后的采样左右声道错位
+    channels = std::max<size_t>(channels, 1);
+    const size_t toWrite = std::min(count, space) / channels * channels;
+    if (toWrite < count) {
+        m_overruns.fetch_add(count - toWrite, std::memory_order_relaxed);
+    }
+    if (toWrite == 0) {
+        return 0;
+    }
+
+    // 最多分两段拷贝（绕回环形缓冲起点）
+    const size_t offset = static_cast<size_t>(writePos) & m_mask;
+    const size_t first = std::min(toWrite, m_capacity - offset);
+    std::memcpy(m_buffer.get() + offset, samples, first * sizeof(int16_t));
+    std::memcpy(m_buffer.get(), samples + first, (toWrite - first) * sizeof(int16_t));
+
+    m_writePos.store(writePos + toWrite, std::memory_order_release);
+    return toWrite;
+}
+
+bool PcmRingBuffer::read(int16_t *samples, size_t count) {
+    const uint64_t readPos = m_readPos.load(std::memory_order_relaxed);
+    const uint64_t writePos = m_writePos.load(std::memory_order_acquire);
+    if (writePos - readPos < count) {
+        return false;
+    }
+
+    const size_t offset = static_cast<size_t>(readPos) & m_mask;
+    const size_t first = std::min(count, m_capacity - offset);
+    std::memcpy(samples, m_buffer.get() + offset, first * sizeof(int16_t));
+    std::memcpy(samples + first, m_buffer.get(), (count - first) * sizeof(int16_t));
+
+    m_readPos.store(readPos + count, std::memory_order_release);
+    return true;
+}
+
+size_t PcmRingBuffer::skip(size_t count) {
+    const uint64_t readPos = m_readPos.load(std::memory_order_relaxed);
+    const uint64_t writePos = m_writePos.load(std::memory_order_acquire);
+    const size_t skipped = std::min(count, static_cast<size_t>(writePos - readPos));
+    m_readPos.store(readPos + skipped, std::memory_order_release);
+    return skipped;
+}
+
+void PcmRingBuffer::clear() {
+    m_readPos.store(m_writePos.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+size_t PcmRingBuffer::available() const {
+    return static_cast<size_t>(m_writePos.load(std::memory_order_acquire)
+                               - m_readPos.load(std::memory_order_acquire));
+}
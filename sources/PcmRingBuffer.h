@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * 单生产者/单消费者无锁 PCM 环形缓冲（int16 交织采样）
+ *
+ * 生产者为引擎的音频回调线程，消费者为处理线程。空间不足时 write() 只写入能容纳的整帧
+ * （每帧 channels 个采样），丢弃的采样数计入 overruns()，不会阻塞音频线程；
+ * 只写整帧、读取也按整帧时，交织的声道不会错位。容量向上取整为 2 的幂。
+ */
+class PcmRingBuffer {
+public:
+    explicit PcmRingBuffer(size_t capacitySamples);
+
+    PcmRingBuffer(const PcmRingBuffer &) = delete;
+    PcmRingBuffer &operator=(const PcmRingBuffer &) = delete;
+
+    /** 生产者调用，count 为采样数（channels 的整数倍），返回实际写入的采样数 */
+    size_t write(const int16_t *samples, size_t count, size_t channels = 1);
+
+    /** 消费者调用，可读采样不足 count 时不读取并返回 false */
+    bool read(int16_t *samples, size_t count);
+
+    /** 消费者调用，丢弃最早的 count 个可读采样，返回实际丢弃数 */
+    size_t skip(size_t count);
+
+    /** 消费者调用，丢弃全部可读采样（例如格式变化后） */
+    void clear();
+
+    size_t available() const;
+    size_t capacity() const { return m_capacity; }
+    uint64_t overruns() const { return m_overruns.load(std::memory_order_relaxed); }
+
+private:
+    size_t m_capacity = 0;
+    size_t m_mask = 0;
+    std::unique_ptr<int16_t[]> m_buffer;
+    alignas(64) std::atomic<uint64_t> m_writePos{0};
+    alignas(64) std::atomic<uint64_t> m_readPos{0};
+    std::atomic<uint64_t> m_overruns{0};
+};
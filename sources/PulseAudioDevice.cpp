@@ -0,0 +1,417 @@
+#include "PulseAudioDevice.h"
+#include "ThreadPolicy.h"
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <pulse/pulseaudio.h>
+
+namespace {
+
+constexpr int kFrameMs = 10;
+constexpr const char *kNullSinkName = "quickstart_null";
+
+int64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+PulseAudioDeviceConfig PulseAudioDeviceConfig::fromEnvironment() {
+    PulseAudioDeviceConfig config;
+    const char *value = std::getenv("QUICKSTART_AUDIO_DEVICE");
+    if (!value) {
+        return config;
+    }
+
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item == "pulse") { config.enabled = true; continue; }
+        if (item == "null_sink") { config.nullSink = true; continue; }
+
+        auto pos = item.find('=');
+        if (pos == std::string::npos) {
+            if (!item.empty()) qWarning() << "QUICKSTART_AUDIO_DEVICE: unknown option" << item.c_str();
+            continue;
+        }
+        std::string key = item.substr(0, pos);
+        std::string text = item.substr(pos + 1);
+        int number = std::atoi(text.c_str());
+
+        if (key == "rate") config.sampleRate = number;
+        else if (key == "channels") config.channels = number;
+        else if (key == "fragment_ms") config.fragmentMs = number;
+        else if (key == "playback_ms") config.playbackMs = number;
+        else if (key == "jitter_min_ms") config.jitter.minMs = number;
+        else if (key == "jitter_max_ms") config.jitter.maxMs = number;
+        else if (key == "source") config.source = text;
+        else if (key == "sink") config.sink = text;
+        else if (key == "server") config.server = text;
+        else if (key == "report_ms") config.reportIntervalMs = number;
+        else qWarning() << "QUICKSTART_AUDIO_DEVICE: unknown key" << key.c_str();
+    }
+
+    config.channels = std::clamp(config.channels, 1, 2);
+    config.sampleRate = std::clamp(config.sampleRate, 8000, 48000);
+    config.fragmentMs = std::clamp(config.fragmentMs, 1, 100);
+    config.playbackMs = std::max(config.playbackMs, config.fragmentMs);
+    return config;
+}
+
+// ── PulseAudioDevice ──────────────────────────────────────────────
+
+PulseAudioDevice::PulseAudioDevice(const PulseAudioDeviceConfig &config)
+    : m_config(config),
+      m_captureFrame(size_t(config.sampleRate / 100) * config.channels),
+      m_jitter(config.jitter, config.sampleRate, config.channels) {
+}
+
+PulseAudioDevice::~PulseAudioDevice() {
+    stop();
+}
+
+bool PulseAudioDevice::start(IRtcEngine *engine) {
+    if (m_running) return true;
+    m_engine = engine;
+
+    m_mainloop = pa_threaded_mainloop_new();
+    if (!m_mainloop) {
+        qWarning() << "PulseAudio: failed to create mainloop";
+        return false;
+    }
+    m_context = pa_context_new(pa_threaded_mainloop_get_api(m_mainloop), "QuickStart");
+    pa_context_set_state_callback(m_context, &PulseAudioDevice::contextStateCallback, this);
+
+    if (pa_threaded_mainloop_start(m_mainloop) < 0) {
+        qWarning() << "PulseAudio: failed to start mainloop";
+        cleanup();
+        return false;
+    }
+
+    pa_threaded_mainloop_lock(m_mainloop);
+    bool ok = connectContext();
+    if (ok && m_config.nullSink) {
+        ok = loadNullSink();
+    }
+    if (ok) {
+        m_sourceName = m_config.nullSink ? std::string(kNullSinkName) + ".monitor" : m_config.source;
+        m_sinkName = m_config.nullSink ? kNullSinkName : m_config.sink;
+        m_recordStream = createStream("capture", true);
+        m_playbackStream = createStream("playback", false);
+        ok = m_recordStream && m_playbackStream
+             && waitStreamReady(m_recordStream) && waitStreamReady(m_playbackStream);
+    }
+    pa_threaded_mainloop_unlock(m_mainloop);
+
+    if (!ok) {
+        cleanup();
+        return false;
+    }
+
+    m_engine->setExternalAudioDevice(true);
+    m_running = true;
+    m_renderThread = std::thread(&PulseAudioDevice::renderLoop, this);
+
+    qDebug() << "PulseAudio device started:" << m_config.sampleRate << "Hz," << m_config.channels << "channel(s),"
+             << "fragment" << m_config.fragmentMs << "ms, playback" << m_config.playbackMs << "ms,"
+             << "source" << (m_sourceName.empty() ? "default" : m_sourceName.c_str())
+             << "sink" << (m_sinkName.empty() ? "default" : m_sinkName.c_str());
+    return true;
+}
+
+void PulseAudioDevice::stop() {
+    if (m_running.exchange(false)) {
+        if (m_renderThread.joinable()) {
+            m_renderThread.join();
+        }
+        if (m_engine) {
+            m_engine->setExternalAudioDevice(false);
+        }
+    }
+    cleanup();
+}
+
+// 释放流、模块和上下文；可以在 start 的任意失败点调用
+void PulseAudioDevice::cleanup() {
+    if (!m_mainloop) return;
+
+    pa_threaded_mainloop_lock(m_mainloop);
+    for (pa_stream **stream : {&m_recordStream, &m_playbackStream}) {
+        if (*stream) {
+            pa_stream_set_read_callback(*stream, nullptr, nullptr);
+            pa_stream_set_write_callback(*stream, nullptr, nullptr);
+            pa_stream_set_state_callback(*stream, nullptr, nullptr);
+            pa_stream_disconnect(*stream);
+            pa_stream_unref(*stream);
+            *stream = nullptr;
+        }
+    }
+    if (m_context && m_nullSinkModule != UINT32_MAX) {
+        waitOperation(pa_context_unload_module(m_context, m_nullSinkModule,
+                                               &PulseAudioDevice::successCallback, this));
+        m_nullSinkModule = UINT32_MAX;
+    }
+    if (m_context) {
+        pa_context_set_state_callback(m_context, nullptr, nullptr);
+        pa_context_disconnect(m_context);
+    }
+    pa_threaded_mainloop_unlock(m_mainloop);
+
+    pa_threaded_mainloop_stop(m_mainloop);
+    if (m_context) {
+        pa_context_unref(m_context);
+        m_context = nullptr;
+    }
+    pa_threaded_mainloop_free(m_mainloop);
+    m_mainloop = nullptr;
+    m_captureFill = 0;
+}
+
+// ── 连接与流（调用时持有主循环锁） ──────────────────────────────────
+
+bool PulseAudioDevice::connectContext() {
+    const char *server = m_config.server.empty() ? nullptr : m_config.server.c_str();
+    if (pa_context_connect(m_context, server, PA_CONTEXT_NOFLAGS, nullptr) < 0) {
+        qWarning() << "PulseAudio: connect failed:" << pa_strerror(pa_context_errno(m_context));
+        return false;
+    }
+    for (;;) {
+        pa_context_state_t state = pa_context_get_state(m_context);
+        if (state == PA_CONTEXT_READY) return true;
+        if (!PA_CONTEXT_IS_GOOD(state)) {
+            qWarning() << "PulseAudio: connect failed:" << pa_strerror(pa_context_errno(m_context));
+            return false;
+        }
+        pa_threaded_mainloop_wait(m_mainloop);
+    }
+}
+
+bool PulseAudioDevice::loadNullSink() {
+    std::string args = std::string("sink_name=") + kNullSinkName
+                       + " sink_properties=device.description=QuickStart-Null";
+    waitOperation(pa_context_load_module(m_context, "module-null-sink", args.c_str(),
+                                         &PulseAudioDevice::moduleLoadedCallback, this));
+    if (m_nullSinkModule == UINT32_MAX) {
+        qWarning() << "PulseAudio: failed to load module-null-sink:" << pa_strerror(pa_context_errno(m_context));
+        return false;
+    }
+    return true;
+}
+
+pa_stream *PulseAudioDevice::createStream(const char *name, bool record) {
+    pa_sample_spec spec;
+    spec.format = PA_SAMPLE_S16LE;
+    spec.rate = uint32_t(m_config.sampleRate);
+    spec.channels = uint8_t(m_config.channels);
+
+    pa_stream *stream = pa_stream_new(m_context, name, &spec, nullptr);
+    if (!stream) {
+        qWarning() << "PulseAudio: failed to create stream" << name;
+        return nullptr;
+    }
+    pa_stream_set_state_callback(stream, &PulseAudioDevice::streamStateCallback, this);
+
+    // 显式指定分片大小，配合 ADJUST_LATENCY 让服务端按该延迟配置设备缓冲
+    const uint32_t fragmentBytes = uint32_t(pa_usec_to_bytes(uint64_t(m_config.fragmentMs) * 1000, &spec));
+    pa_buffer_attr attr;
+    attr.maxlength = uint32_t(-1);
+    attr.tlength = uint32_t(-1);
+    attr.prebuf = uint32_t(-1);
+    attr.minreq = uint32_t(-1);
+    attr.fragsize = uint32_t(-1);
+
+    const pa_stream_flags_t flags = pa_stream_flags_t(PA_STREAM_ADJUST_LATENCY
+                                                      | PA_STREAM_INTERPOLATE_TIMING
+                                                      | PA_STREAM_AUTO_TIMING_UPDATE);
+    int ret;
+    if (record) {
+        attr.fragsize = fragmentBytes;
+        pa_stream_set_read_callback(stream, &PulseAudioDevice::recordCallback, this);
+        ret = pa_stream_connect_record(stream, m_sourceName.empty() ? nullptr : m_sourceName.c_str(), &attr, flags);
+    } else {
+        attr.tlength = uint32_t(pa_usec_to_bytes(uint64_t(m_config.playbackMs) * 1000, &spec));
+        attr.minreq = fragmentBytes;
+        attr.prebuf = fragmentBytes;
+        pa_stream_set_write_callback(stream, &PulseAudioDevice::playbackCallback, this);
+        ret = pa_stream_connect_playback(stream, m_sinkName.empty() ? nullptr : m_sinkName.c_str(), &attr, flags,
+                                         nullptr, nullptr);
+    }
+    if (ret < 0) {
+        qWarning() << "PulseAudio: failed to connect stream" << name << pa_strerror(pa_context_errno(m_context));
+        pa_stream_unref(stream);
+        return nullptr;
+    }
+    return stream;
+}
+
+bool PulseAudioDevice::waitStreamReady(pa_stream *stream) {
+    for (;;) {
+        pa_stream_state_t state = pa_stream_get_state(stream);
+        if (state == PA_STREAM_READY) {
+            const pa_buffer_attr *attr = pa_stream_get_buffer_attr(stream);
+            if (attr) {
+                qDebug() << "PulseAudio: stream ready, tlength" << attr->tlength << "minreq" << attr->minreq
+                         << "fragsize" << attr->fragsize;
+            }
+            return true;
+        }
+        if (!PA_STREAM_IS_GOOD(state)) {
+            qWarning() << "PulseAudio: stream failed:" << pa_strerror(pa_context_errno(m_context));
+            return false;
+        }
+        pa_threaded_mainloop_wait(m_mainloop);
+    }
+}
+
+void PulseAudioDevice::waitOperation(pa_operation *operation) {
+    if (!operation) return;
+    while (pa_operation_get_state(operation) == PA_OPERATION_RUNNING) {
+        pa_threaded_mainloop_wait(m_mainloop);
+    }
+    pa_operation_unref(operation);
+}
+
+// ── 主循环线程上的回调 ────────────────────────────────────────────
+
+void PulseAudioDevice::contextStateCallback(pa_context *, void *userdata) {
+    auto *self = static_cast<PulseAudioDevice *>(userdata);
+    pa_threaded_mainloop_signal(self->m_mainloop, 0);
+}
+
+void PulseAudioDevice::streamStateCallback(pa_stream *, void *userdata) {
+    auto *self = static_cast<PulseAudioDevice *>(userdata);
+    pa_threaded_mainloop_signal(self->m_mainloop, 0);
+}
+
+void PulseAudioDevice::moduleLoadedCallback(pa_context *, uint32_t index, void *userdata) {
+    auto *self = static_cast<PulseAudioDevice *>(userdata);
+    self->m_nullSinkModule = index;
+    pa_threaded_mainloop_signal(self->m_mainloop, 0);
+}
+
+void PulseAudioDevice::successCallback(pa_context *, int, void *userdata) {
+    auto *self = static_cast<PulseAudioDevice *>(userdata);
+    pa_threaded_mainloop_signal(self->m_mainloop, 0);
+}
+
+void PulseAudioDevice::recordCallback(pa_stream *stream, size_t, void *userdata) {
+    ThreadPolicy::adoptCurrentThread(ThreadClass::Audio, "pa-mainloop");
+    auto *self = static_cast<PulseAudioDevice *>(userdata);
+    while (pa_stream_readable_size(stream) > 0) {
+        const void *data = nullptr;
+        size_t bytes = 0;
+        if (pa_stream_peek(stream, &data, &bytes) < 0 || bytes == 0) {
+            break;
+        }
+        if (data) {
+            self->appendCapture(static_cast<const int16_t *>(data), bytes / sizeof(int16_t));
+        } else {
+            // 服务端缓冲中的空洞按静音处理
+            static const int16_t silence[480] = {};
+            size_t samples = bytes / sizeof(int16_t);
+            while (samples > 0) {
+                size_t chunk = std::min(samples, sizeof(silence) / sizeof(silence[0]));
+                self->appendCapture(silence, chunk);
+                samples -= chunk;
+            }
+        }
+        pa_stream_drop(stream);
+    }
+}
+
+void PulseAudioDevice::appendCapture(const int16_t *samples, size_t count) {
+    while (count > 0) {
+        size_t chunk = std::min(count, m_captureFrame.size() - m_captureFill);
+        std::memcpy(m_captureFrame.data() + m_captureFill, samples, chunk * sizeof(int16_t));
+        m_captureFill += chunk;
+        samples += chunk;
+        count -= chunk;
+
+        if (m_captureFill == m_captureFrame.size()) {
+            m_captureFill = 0;
+            if (m_running) {
+                RtcAudioFrame frame;
+                frame.data = m_captureFrame.data();
+                frame.samplesPerChannel = m_config.sampleRate / 100;
+                frame.channels = m_config.channels;
+                frame.sampleRate = m_config.sampleRate;
+                frame.timestampUs = nowUs();
+                m_engine->pushExternalAudioFrame(frame);
+            }
+        }
+    }
+}
+
+void PulseAudioDevice::playbackCallback(pa_stream *stream, size_t bytes, void *userdata) {
+    ThreadPolicy::adoptCurrentThread(ThreadClass::Audio, "pa-mainloop");
+    auto *self = static_cast<PulseAudioDevice *>(userdata);
+    void *buffer = nullptr;
+    size_t size = bytes;
+    // 直接写入服务端分配的内存块，省去一次拷贝
+    if (pa_stream_begin_write(stream, &buffer, &size) < 0 || !buffer) {
+        return;
+    }
+    size -= size % (sizeof(int16_t) * self->m_config.channels);
+    self->m_jitter.read(static_cast<int16_t *>(buffer), size / sizeof(int16_t));
+    pa_stream_write(stream, buffer, size, nullptr, 0, PA_SEEK_RELATIVE);
+}
+
+// ── 拉流线程 ──────────────────────────────────────────────────────
+
+void PulseAudioDevice::renderLoop() {
+    ThreadPolicy::registerCurrentThread(ThreadClass::Audio, "pa-render");
+    const int samplesPerChannel = m_config.sampleRate / 100;
+    std::vector<int16_t> frame(size_t(samplesPerChannel) * m_config.channels);
+    const auto interval = std::chrono::milliseconds(kFrameMs);
+    auto next = std::chrono::steady_clock::now();
+    auto lastReport = next;
+
+    while (m_running) {
+        m_engine->pullExternalAudioFrame(frame.data(), samplesPerChannel, m_config.channels, m_config.sampleRate);
+        m_jitter.write(frame.data(), frame.size());
+
+        auto now = std::chrono::steady_clock::now();
+        if (m_config.reportIntervalMs > 0 && now - lastReport >= std::chrono::milliseconds(m_config.reportIntervalMs)) {
+            report();
+            lastReport = now;
+        }
+
+        next += interval;
+        if (now > next + interval) {
+            next = now;
+        }
+        std::this_thread::sleep_until(next);
+    }
+}
+
+PulseAudioLatency PulseAudioDevice::latency() {
+    PulseAudioLatency result;
+    result.jitterBufferMs = m_jitter.bufferedMs();
+    result.jitterTargetMs = m_jitter.targetMs();
+    result.underruns = m_jitter.underruns();
+    result.droppedSamples = m_jitter.droppedSamples();
+    if (!m_mainloop) return result;
+
+    pa_threaded_mainloop_lock(m_mainloop);
+    pa_usec_t usec = 0;
+    int negative = 0;
+    if (m_recordStream && pa_stream_get_latency(m_recordStream, &usec, &negative) == 0) {
+        result.captureMs = negative ? 0 : usec / 1000.0;
+    }
+    if (m_playbackStream && pa_stream_get_latency(m_playbackStream, &usec, &negative) == 0) {
+        result.playbackMs = negative ? 0 : usec / 1000.0;
+    }
+    pa_threaded_mainloop_unlock(m_mainloop);
+    return result;
+}
+
+void PulseAudioDevice::report() {
+    PulseAudioLatency l = latency();
+    qInfo() << "PulseAudio: capture" << l.captureMs << "ms, jitter" << l.jitterBufferMs << "ms (target"
+            << l.jitterTargetMs << "ms), playback" << l.playbackMs << "ms, local path" << l.localPathMs() << "ms,"
+            << "underruns" << l.underruns << ", dropped samples" << l.droppedSamples;
+}
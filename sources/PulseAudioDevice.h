@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AudioJitterBuffer.h"
+#include "RtcBackend.h"
+
+struct pa_threaded_mainloop;
+struct pa_context;
+struct pa_stream;
+struct pa_operation;
+
+/**
+ * PulseAudio 外部音频设备配置
+ *
+ * 通过环境变量 QUICKSTART_AUDIO_DEVICE 开启，第一项为 pulse，其余为 key=value：
+ *   rate=N, channels=N     与引擎交换的 PCM 格式，默认 16000 Hz 单声道
+ *   fragment_ms=N          采集分片和播放 minreq 的时长，默认 10
+ *   playback_ms=N          服务端播放缓冲的目标时长（tlength），默认 20
+ *   jitter_min_ms=N, jitter_max_ms=N  播放端抖动缓冲的目标水位范围，默认 20 / 200
+ *   source=NAME, sink=NAME 指定设备，默认使用系统默认设备
+ *   null_sink              加载 module-null-sink 并在其上播放、从其 monitor 采集，用于无声卡的机器
+ *   server=ADDR            PulseAudio 服务器地址
+ *   report_ms=N            延迟统计输出间隔，默认 5000，0 表示不输出
+ * 例如：QUICKSTART_AUDIO_DEVICE=pulse,fragment_ms=5,jitter_min_ms=10
+ */
+struct PulseAudioDeviceConfig {
+    bool enabled = false;
+    int sampleRate = 16000;
+    int channels = 1;
+    int fragmentMs = 10;
+    int playbackMs = 20;
+    AudioJitterConfig jitter;
+    std::string source;
+    std::string sink;
+    std::string server;
+    bool nullSink = false;
+    int reportIntervalMs = 5000;
+
+    static PulseAudioDeviceConfig fromEnvironment();
+};
+
+/** 延迟统计，单位毫秒 */
+struct PulseAudioLatency {
+    double captureMs = 0;       // 采集流延迟（source 缓冲 + 客户端未读数据）
+    double playbackMs = 0;      // 播放流延迟（服务端缓冲 + sink 延迟）
+    double jitterBufferMs = 0;  // 抖动缓冲当前水位
+    double jitterTargetMs = 0;
+    uint64_t underruns = 0;
+    uint64_t droppedSamples = 0;
+
+    /** 本机部分的嘴到耳延迟估计：采集 + 抖动缓冲 + 播放（不含网络与对端） */
+    double localPathMs() const { return captureMs + jitterBufferMs + playbackMs; }
+};
+
+/**
+ * 基于 libpulse 异步 API（pa_threaded_mainloop）的外部音频设备
+ *
+ * - 采集：录音流按 fragment_ms 分片回调，在主循环线程上凑满 10 ms 后通过
+ *   IRtcEngine::pushExternalAudioFrame 交给引擎
+ * - 播放：拉流线程按 10 ms 节拍调用 pullExternalAudioFrame 写入 AudioJitterBuffer，
+ *   播放流的写回调通过 pa_stream_begin_write 直接把数据取到服务端内存块中
+ * - 两条流都使用 PA_STREAM_ADJUST_LATENCY 并显式指定缓冲属性，
+ *   由 pa_stream_get_latency 定期测量延迟
+ *
+ * 生命周期：start(engine) 在引擎 create 之后、加入房间之前调用；stop() 必须在引擎 destroy 之前调用。
+ */
+class PulseAudioDevice {
+public:
+    explicit PulseAudioDevice(const PulseAudioDeviceConfig &config);
+    ~PulseAudioDevice();
+
+    bool start(IRtcEngine *engine);
+    void stop();
+
+    bool isRunning() const { return m_running; }
+    PulseAudioLatency latency();
+
+private:
+    static void contextStateCallback(pa_context *context, void *userdata);
+    static void streamStateCallback(pa_stream *stream, void *userdata);
+    static void recordCallback(pa_stream *stream, size_t bytes, void *userdata);
+    static void playbackCallback(pa_stream *stream, size_t bytes, void *userdata);
+    static void moduleLoadedCallback(pa_context *context, uint32_t index, void *userdata);
+    static void successCallback(pa_context *context, int success, void *userdata);
+
+    bool connectContext();
+    bool loadNullSink();
+    pa_stream *createStream(const char *name, bool record);
+    bool waitStreamReady(pa_stream *stream);
+    void waitOperation(pa_operation *operation);
+    void appendCapture(const int16_t *samples, size_t count);
+    void renderLoop();
+    void report();
+    void cleanup();
+
+    PulseAudioDeviceConfig m_config;
+    IRtcEngine *m_engine = nullptr;
+    std::atomic<bool> m_running{false};
+
+    pa_threaded_mainloop *m_mainloop = nullptr;
+    pa_context *m_context = nullptr;
+    pa_stream *m_recordStream = nullptr;
+    pa_stream *m_playbackStream = nullptr;
+    uint32_t m_nullSinkModule = UINT32_MAX;
+    std::string m_sourceName;
+    std::string m_sinkName;
+
+    // 采集：主循环线程上凑满 10 ms 的缓冲
+    std::vector<int16_t> m_captureFrame;
+    size_t m_captureFill = 0;
+
+    // 播放：拉流线程 → 抖动缓冲 → 播放写回调
+    AudioJitterBuffer m_jitter;
+    std::thread m_renderThread;
+};
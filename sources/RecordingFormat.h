@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 通话录制文件（.qsrec）格式，CallRecorder 写入，tools/RecordingInfo 读取
+ *
+ * 所有整数为小端。文件由三部分组成，每部分的起始偏移与长度都是 4 KiB 的整数倍（可用 O_DIRECT 写入）：
+ *
+ *   [文件头 4096 字节] [记录 ...] [索引 + 文件尾]
+ *
+ * - 文件头：RecordingFileHeader，其余字节为 0
+ * - 记录：RecordHeader + payload，payload 补齐到 8 字节；记录可以跨越写盘块的边界。
+ *   同一轨道内按时间顺序排列；不同轨道的记录按到达写盘线程的先后交错，
+ *   时间戳之间最多相差约 flush_ms（见 RecorderConfig）。数据区末尾用 Padding 记录补齐到 4 KiB
+ * - 索引：RecordingIndexEntry 数组，每个写盘块（write_kb）一项，指向该块内第一条开始的记录；
+ *   之后补 0，最后 32 字节为 RecordingFileFooter，因此文件尾总在文件末尾的固定位置
+ *
+ * 时间戳为录制开始后的微秒数（单调时钟，所有轨道共用），
+ * 文件头中的 startUnixMs 给出对应的墙上时间。
+ * 进程异常退出时没有索引与文件尾，从文件头之后顺序读取记录仍可恢复到最后一个完整写盘块。
+ */
+namespace RecordingFormat {
+
+constexpr size_t kAlignment = 4096;
+constexpr size_t kHeaderSize = 4096;
+constexpr char kFileMagic[8] = {'Q', 'S', 'R', 'E', 'C', '0', '0', '1'};
+constexpr char kFooterMagic[8] = {'Q', 'S', 'R', 'E', 'C', 'I', 'D', 'X'};
+
+enum class RecordType : uint8_t {
+    Padding = 0,
+    MicAudio = 1,        // 本地麦克风 PCM
+    PlaybackAudio = 2,   // 远端混音后的播放 PCM
+    Video = 3,
+    Text = 4,
+};
+constexpr int kRecordTypeCount = 5;
+
+enum class VideoCodec : uint32_t {
+    I420 = 0,   // 紧凑排列的 Y、U、V 平面
+    Jpeg = 1,
+};
+
+enum class TextKind : uint32_t {
+    User = 0,         // 用户发送的文字
+    AgentDelta = 1,   // 智能体回答的增量文本
+    AgentEnd = 2,     // 智能体一次回答结束，无文本
+};
+
+struct RecordingFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    int64_t startUnixMs;
+    char roomId[64];
+};
+
+struct RecordHeader {
+    uint32_t size;          // payload 字节数，不含补齐
+    RecordType type;
+    uint8_t reserved[3];
+    int64_t timestampUs;
+};
+
+/** 音频记录的 payload：AudioHeader + 16 位交织 PCM */
+struct AudioHeader {
+    uint32_t sampleRate;
+    uint16_t channels;
+    uint16_t reserved;
+};
+
+/** 视频记录的 payload：VideoHeader + 流 ID（streamIdSize 字节，本地画面为空）+ 帧数据 */
+struct VideoHeader {
+    uint32_t width;
+    uint32_t height;
+    VideoCodec codec;
+    uint16_t streamIdSize;
+    uint8_t remote;
+    uint8_t reserved;
+};
+
+/** 文本记录的 payload：TextHeader + UTF-8 文本 */
+struct TextHeader {
+    TextKind kind;
+};
+
+struct RecordingIndexEntry {
+    int64_t timestampUs;
+    uint64_t offset;        // 记录头在文件中的偏移
+};
+
+struct RecordingFileFooter {
+    char magic[8];
+    uint64_t indexOffset;
+    uint64_t indexCount;
+    uint64_t dataEnd;       // 数据区结束偏移（含补齐），即索引起始
+};
+
+static_assert(sizeof(RecordHeader) == 16, "record header layout");
+static_assert(sizeof(AudioHeader) == 8, "audio header layout");
+static_assert(sizeof(VideoHeader) == 16, "video header layout");
+static_assert(sizeof(RecordingIndexEntry) == 16, "index entry layout");
+static_assert(sizeof(RecordingFileFooter) == 32, "footer layout");
+
+constexpr size_t alignRecord(size_t size) {
+    return (size + 7) & ~size_t(7);
+}
+
+constexpr size_t alignBlock(size_t size) {
+    return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+} // namespace RecordingFormat
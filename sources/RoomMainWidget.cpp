@@ -2,37 +2,294 @@
 #include "RoomMainWidget.h"
 #include "LoginWidget.h"
 #include "AgentClient.h"
+#include "AdaptiveVideoController.h"
+#include "ExternalVideoSource.h"
+#include "VideoFrameTap.h"
+#include "SnapshotCache.h"
+#include "TelemetryStream.h"
+#include "ActuatorToolAdapter.h"
+#include "CallRecorder.h"
+#include "FrameExporter.h"
+#include "AudioTap.h"
+#include "PulseAudioDevice.h"
+#include "VideoRenderer.h"
+#include "VideoGrid.h"
+#include "CpuUsage.h"
+#include "MetricsExporter.h"
+#include "RtcStatsCollector.h"
+#include "MpscEventQueue.h"
+#include "EventLoopDrain.h"
+#include "TeardownWorker.h"
+#include "ThreadPolicy.h"
+#include "RtcSdkLoader.h"
+#include "ConnectionPrewarmer.h"
+#include "BrokerRace.h"
+#include "AllocTracker.h"
 #include <QDebug>
 #include <vector>
 #include <QTimer>
 #include "VideoWidget.h"
 #include <QMessageBox>
 #include <QTextCursor>
+#include <cstring>
+
+/**
+ * SDK 回调线程交给界面线程的事件
+ *
+ * 定长结构，标识拷贝进内联数组，入队时不分配内存。房间状态按用户、
+ * 统计按流、语音检测结果只保留最新一次；流的发布/取消发布、用户离开和错误
+ * 各自带有副作用（订阅、移除画面、提示），全部按顺序保留。
+ * 只有统计在队列满时可以丢弃，其余事件经溢出列表送达。
+ */
+struct RtcUiEvent {
+    enum class Type : uint8_t {
+        None,
+        RoomState,
+        Error,
+        UserJoined,
+        UserLeave,
+        StreamVideo,
+        FirstLocalVideoFrame,
+        FirstRemoteVideoFrame,
+        LocalStats,
+        RemoteStats,
+        VoiceActivity,
+    };
+    static constexpr size_t kIdSize = 256;
+
+    Type type = Type::None;
+    int value = 0;                  // 房间状态、错误码、离开原因、是否发布或是否在说话
+    char streamId[kIdSize] = {};
+    char userId[kIdSize] = {};
+    RtcStatsSample stats;
+
+    RtcUiEvent() = default;
+    RtcUiEvent(Type eventType, int eventValue, const char *stream = nullptr, const char *user = nullptr)
+            : type(eventType), value(eventValue) {
+        copyId(streamId, stream);
+        copyId(userId, user);
+    }
+
+    /** 丢了也会被下一次统计补上 */
+    bool droppable() const {
+        return type == Type::LocalStats || type == Type::RemoteStats;
+    }
+
+    static bool supersedes(const RtcUiEvent &newer, const RtcUiEvent &older) {
+        if (newer.type != older.type) {
+            return false;
+        }
+        switch (newer.type) {
+            case Type::RoomState:
+                return strcmp(newer.userId, older.userId) == 0;
+            case Type::RemoteStats:
+                return strcmp(newer.streamId, older.streamId) == 0;
+            case Type::LocalStats:
+            case Type::VoiceActivity:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+private:
+    static void copyId(char (&dst)[kIdSize], const char *src) {
+        if (src) {
+            strncpy(dst, src, kIdSize - 1);
+        }
+    }
+};
+
+/**
+ * 登录页预先创建的 RTC 引擎
+ *
+ * 只在清理线程上读写；界面线程只在清理线程空闲时取回。
+ */
+struct RtcEnginePrewarm {
+    std::unique_ptr<IRtcEngine> engine;
+    std::string appId;      // 已用该 AppId 调用过 create()，为空表示未创建
+};
+
+namespace {
+
+// 缩略图画面请求的 simulcast 层
+const RtcRemoteVideoConfig kThumbnailVideo = {320, 180, 15};
+
+// 回调事件队列容量，界面线程每轮事件循环都会排空，只需容纳界面短暂卡顿期间的突发
+const int kRtcEventQueueCapacity = 256;
+
+QString formatStats(const RtcStatsSample &sample, bool local) {
+    QString text = QString("%1 %2 kbps  %3 fps  loss %4%  rtt %5 ms")
+            .arg(local ? "↑" : "↓")
+            .arg(sample.kbps, 0, 'f', 0)
+            .arg(sample.frameRate, 0, 'f', 0)
+            .arg(sample.lossRate * 100.0f, 0, 'f', 1)
+            .arg(sample.rttMs);
+    if (!local) {
+        text += QString("  jb %1 ms").arg(sample.jitterBufferMs);
+    }
+    return text;
+}
+
+} // namespace
 
 RoomMainWidget::RoomMainWidget(QWidget *parent)
         : QWidget(parent) {
     ui.setupUi(this);
     setWindowFlags(Qt::FramelessWindowHint | windowFlags());
 
+    // 模拟后端没有加载开销，直接创建；VolcEngine 后端延迟到加入房间时创建
+    m_rtcBackendType = rtcBackendTypeFromEnvironment();
+    if (m_rtcBackendType == RtcBackendType::Fake) {
+        m_rtc_engine = createRtcEngine(m_rtcBackendType);
+    }
+
+    // 通话质量统计始终收集，按配置显示在画面上或与进程 CPU 占用一起导出到文件
+    auto metricsConfig = MetricsConfig::fromEnvironment();
+    m_rtcStats = std::make_unique<RtcStatsCollector>(metricsConfig.historySize);
+    m_metrics = std::make_unique<MetricsExporter>(metricsConfig);
+    auto cpuSampler = std::make_shared<CpuUsageSampler>();
+    m_metrics->addProvider("cpu", [cpuSampler](MetricsRecord &record) {
+        auto sample = cpuSampler->sample();
+        record.add("cpu.process_percent", sample.processPercent);
+        record.add("cpu.system_percent", sample.systemPercent);
+    });
+    m_metrics->addProvider("rtc", [this](MetricsRecord &record) {
+        m_rtcStats->exportMetrics(record);
+    });
+    // 各登记线程的 CPU 时间、所在核心与迁移次数，用于核对大小核放置
+    m_metrics->addProvider("threads", [](MetricsRecord &record) {
+        ThreadPolicy::exportMetrics(record);
+    });
+    // 各 Broker 的平均连接耗时、失败与胜出次数，以及断线切换次数
+    m_metrics->addProvider("brokers", [](MetricsRecord &record) {
+        BrokerRace::exportMetrics(record);
+    });
+    // 以 QUICKSTART_ALLOC_TRACKING 编译时按子系统统计堆分配
+    if (AllocTracker::enabled()) {
+        m_metrics->addProvider("alloc", [](MetricsRecord &record) {
+            AllocTracker::exportMetrics(record);
+        });
+    }
+    auto telemetryConfig = TelemetryConfig::fromEnvironment();
+    if (telemetryConfig.enabled) {
+        m_telemetry = std::make_unique<TelemetryStream>(telemetryConfig);
+        m_metrics->addProvider("telemetry", [this](MetricsRecord &record) {
+            m_telemetry->exportMetrics(record);
+        });
+    }
+    auto actuatorConfig = ActuatorConfig::fromEnvironment();
+    if (actuatorConfig.enabled) {
+        m_actuators = std::make_unique<ActuatorToolAdapter>(actuatorConfig);
+        m_metrics->addProvider("actuator", [this](MetricsRecord &record) {
+            m_actuators->exportMetrics(record);
+        });
+    }
+    auto recorderConfig = RecorderConfig::fromEnvironment();
+    if (recorderConfig.enabled()) {
+        m_recorder = std::make_unique<CallRecorder>(recorderConfig);
+        m_metrics->addProvider("recorder", [this](MetricsRecord &record) {
+            m_recorder->exportMetrics(record);
+        });
+    }
+    auto frameExportConfig = FrameExportConfig::fromEnvironment();
+    if (frameExportConfig.enabled()) {
+        m_frameExporter = std::make_unique<FrameExporter>(frameExportConfig);
+        if (m_frameExporter->start()) {
+            m_metrics->addProvider("frame_export", [this](MetricsRecord &record) {
+                m_frameExporter->exportMetrics(record);
+            });
+        } else {
+            m_frameExporter.reset();
+        }
+    }
+    m_metrics->start();
+    m_statsOverlay = metricsConfig.overlay;
+
+    m_teardown = std::make_unique<TeardownWorker>(TeardownConfig::fromEnvironment());
+    m_prewarmConfig = PrewarmConfig::fromEnvironment();
+    m_prewarmer = std::make_unique<ConnectionPrewarmer>(m_prewarmConfig);
+    auto snapshotConfig = SnapshotConfig::fromEnvironment();
+    if (snapshotConfig.enabled) {
+        m_snapshotCache = std::make_unique<SnapshotCache>(snapshotConfig);
+    }
+    m_rtcEvents = std::make_unique<MpscEventQueue<RtcUiEvent>>(kRtcEventQueueCapacity);
+    m_rtcEventDrain = std::make_unique<EventLoopDrain>([this] { drainRtcEvents(); });
+
     setupView();
     setupSignals();
 }
 
+RoomMainWidget::~RoomMainWidget() {
+    // 断开未取走的预热连接，预热的引擎与其它清理步骤一起销毁
+    m_prewarmer.reset();
+    cancelRtcPrewarm();
+    // 先等后台清理完成，清理步骤仍会使用引擎
+    m_teardown.reset();
+    m_rtcPrewarm.reset();
+    // 已退出的 AgentClient 可能仍在执行快照工具，清理完成后才释放缓存
+    m_snapshotCache.reset();
+    // 再停止后端线程，避免析构过程中仍有回调进入
+    m_rtc_engine.reset();
+    m_metrics.reset();
+    m_recorder.reset();
+    m_frameExporter.reset();
+    m_telemetry.reset();
+    m_actuators.reset();
+    m_rtcEventDrain.reset();
+}
+
 void RoomMainWidget::leaveRoom() {
 }
 
 void RoomMainWidget::setupView() {
-    m_videoWidgetList.append(ui.remoteWidget1);
-    m_videoWidgetList.append(ui.remoteWidget2);
-    m_videoWidgetList.append(ui.remoteWidget3);
-
     m_loginWidget = QSharedPointer<LoginWidget>::create(this);
 
     // lightDot needs WA_StyledBackground for stylesheet to work
     ui.lightDot->setAttribute(Qt::WA_StyledBackground, true);
 
     toggleCallUI(false);
-    ui.sdkVersionLabel->setText(QStringLiteral(u"VolcEngineRTC v") + QString(bytertc::IRTCEngine::getSDKVersion()));
+    updateSdkVersionLabel();
+}
+
+void RoomMainWidget::showEvent(QShowEvent *event) {
+    QWidget::showEvent(event);
+    if (!m_sdkPreloadStarted) {
+        m_sdkPreloadStarted = true;
+        // 放到下一轮事件循环，先让登录界面完成第一次绘制
+        QTimer::singleShot(0, this, &RoomMainWidget::startSdkPreload);
+    }
+}
+
+void RoomMainWidget::startSdkPreload() {
+    if (m_rtc_engine || m_rtcBackendType != RtcBackendType::VolcEngine) {
+        return;
+    }
+    RtcSdkLoader &loader = RtcSdkLoader::instance();
+    loader.preloadAsync();
+
+    // 加载完成后补上版本号，界面线程上轮询，加载线程不接触界面对象
+    auto *poll = new QTimer(this);
+    connect(poll, &QTimer::timeout, this, [this, poll] {
+        if (RtcSdkLoader::instance().loading()) {
+            return;
+        }
+        poll->deleteLater();
+        updateSdkVersionLabel();
+    });
+    poll->start(50);
+}
+
+void RoomMainWidget::updateSdkVersionLabel() {
+    std::string version = m_rtc_engine ? m_rtc_engine->sdkVersion() : RtcSdkLoader::instance().sdkVersion();
+    const std::string error = m_rtc_engine ? std::string() : RtcSdkLoader::instance().lastError();
+    if (!error.empty()) {
+        ui.sdkVersionLabel->setText(QStringLiteral(u"VolcEngineRTC 加载失败"));
+        ui.sdkVersionLabel->setToolTip(QString::fromStdString(error));
+        return;
+    }
+    ui.sdkVersionLabel->setText(version.empty() ? QStringLiteral("VolcEngineRTC") : QString::fromStdString(version));
+    ui.sdkVersionLabel->setToolTip(QString());
 }
 
 void RoomMainWidget::on_closeBtn_clicked() {
@@ -62,9 +319,35 @@ void RoomMainWidget::mouseReleaseEvent(QMouseEvent *event) {
 }
 
 void RoomMainWidget::slotOnStartVoiceChat(const QString &brokerUrl, const QString &agentId, const QString &clientId) {
+    // 还排在清理之后的预热不再发起
+    ++m_prewarmRequest;
+    const uint64_t request = ++m_callRequest;
+
     toggleCallUI(true);
+    ui.roomIdLabel->setText(QStringLiteral(u"连接中…"));
+
+    // 上一次通话的会话还在后台关闭时，排到清理之后，等它发完 stopVoiceChat/destroySession
+    // 再用同一个 clientId 连接；界面线程不等待，期间挂断则不再发起
+    if (m_teardown->idle()) {
+        startAgentClient(brokerUrl, agentId, clientId);
+        return;
+    }
+    qDebug() << "connecting after previous teardown";
+    m_teardown->post("start-wait", [] {}, this, [this, request, brokerUrl, agentId, clientId] {
+        if (request == m_callRequest) {
+            startAgentClient(brokerUrl, agentId, clientId);
+        }
+    });
+}
+
+void RoomMainWidget::startAgentClient(const QString &brokerUrl, const QString &agentId, const QString &clientId) {
+    // 选中配置时已连好的连接直接交给 AgentClient
+    auto connectedClient = m_prewarmer->take(brokerUrl.toStdString(), clientId.toStdString());
 
     m_agentClient = new AgentClient(this);
+    m_agentClient->setSnapshotCache(m_snapshotCache.get());
+    m_agentClient->setTelemetryStream(m_telemetry.get());
+    m_agentClient->setActuatorTools(m_actuators.get());
 
     connect(m_agentClient, &AgentClient::voiceChatReady,
             this, &RoomMainWidget::slotOnVoiceChatReady);
@@ -75,17 +358,15 @@ void RoomMainWidget::slotOnStartVoiceChat(const QString &brokerUrl, const QStrin
     connect(m_agentClient, &AgentClient::lightStateChanged,
             this, &RoomMainWidget::setLightState);
 
+    // 错误可能在 AgentClient 排空事件时发出，模态对话框排到之后弹出
     connect(m_agentClient, &AgentClient::errorOccurred,
             this, [this](const QString &error) {
         QMessageBox::warning(this, QStringLiteral(u"错误"), error, QStringLiteral(u"确定"));
         if (!m_isInRoom) {
             toggleCallUI(false);
-            if (m_agentClient) {
-                m_agentClient->deleteLater();
-                m_agentClient = nullptr;
-            }
+            retireAgentClient();
         }
-    });
+    }, Qt::QueuedConnection);
 
     connect(m_agentClient, &AgentClient::textDeltaReceived,
             this, &RoomMainWidget::appendAgentDelta);
@@ -93,12 +374,123 @@ void RoomMainWidget::slotOnStartVoiceChat(const QString &brokerUrl, const QStrin
     connect(m_agentClient, &AgentClient::textFinished,
             this, &RoomMainWidget::finishAgentMessage);
 
-    m_agentClient->start(brokerUrl, agentId, clientId);
+    m_agentClient->start(brokerUrl, agentId, clientId, std::move(connectedClient));
+}
+
+void RoomMainWidget::slotOnPrewarmProfile(const QString &brokerUrl, const QString &clientId, const QString &rtcAppId) {
+    if (m_agentClient || m_isInRoom) {
+        return;
+    }
+
+    // 上一次通话可能还在后台用同一个 clientId 关闭会话，新连接会把它顶下线，排到清理之后再连
+    const uint64_t request = ++m_prewarmRequest;
+    std::string url = brokerUrl.toStdString();
+    std::string id = clientId.toStdString();
+    auto startMqtt = [this, request, url, id] {
+        if (request == m_prewarmRequest) {
+            m_prewarmer->prewarm(url, id);
+        }
+    };
+    if (m_teardown->idle()) {
+        startMqtt();
+    } else {
+        m_teardown->post("prewarm-wait", [] {}, this, startMqtt);
+    }
+
+    if (rtcAppId.isEmpty()) {
+        cancelRtcPrewarm();
+    } else {
+        prewarmRtcEngine(rtcAppId.toStdString());
+    }
+}
+
+void RoomMainWidget::slotOnCancelPrewarm() {
+    ++m_prewarmRequest;
+    m_prewarmer->cancel();
+    cancelRtcPrewarm();
+}
+
+void RoomMainWidget::prewarmRtcEngine(const std::string &appId) {
+    if (!m_prewarmConfig.rtc || appId == m_rtcPrewarmAppId) {
+        return;
+    }
+    if (!m_rtcPrewarm) {
+        // 引擎交给清理线程创建，清理线程空闲后加入房间时再取回
+        m_rtcPrewarm = std::make_shared<RtcEnginePrewarm>();
+        m_rtcPrewarm->engine = std::move(m_rtc_engine);
+    }
+    m_rtcPrewarmAppId = appId;
+
+    auto prewarm = m_rtcPrewarm;
+    RtcBackendType type = m_rtcBackendType;
+    IRtcEventHandler *handler = this;
+    m_teardown->post("rtc-prewarm", [prewarm, appId, type, handler] {
+        if (prewarm->appId == appId) {
+            return;
+        }
+        if (!prewarm->appId.empty()) {
+            prewarm->engine->destroy();
+            prewarm->appId.clear();
+        }
+        if (!prewarm->engine) {
+            // SDK 通常已在后台加载好，否则在这里等待
+            prewarm->engine = createRtcEngine(type);
+        }
+        if (prewarm->engine && prewarm->engine->create(appId, handler)) {
+            prewarm->appId = appId;
+        }
+    });
+}
+
+void RoomMainWidget::cancelRtcPrewarm() {
+    if (!m_rtcPrewarm || m_rtcPrewarmAppId.empty()) {
+        return;
+    }
+    m_rtcPrewarmAppId.clear();
+
+    // 引擎对象保留下来复用，只销毁底层引擎
+    auto prewarm = m_rtcPrewarm;
+    m_teardown->post("rtc-prewarm-cancel", [prewarm] {
+        if (!prewarm->appId.empty()) {
+            prewarm->engine->destroy();
+            prewarm->appId.clear();
+        }
+    });
+}
+
+std::string RoomMainWidget::reclaimPrewarmedEngine() {
+    if (!m_rtcPrewarm) {
+        return std::string();
+    }
+    std::string appId = m_rtcPrewarm->appId;
+    if (m_rtcPrewarm->engine) {
+        m_rtc_engine = std::move(m_rtcPrewarm->engine);
+    }
+    m_rtcPrewarm.reset();
+    m_rtcPrewarmAppId.clear();
+    return appId;
 }
 
 void RoomMainWidget::slotOnVoiceChatReady(const QString &appId, const QString &roomId,
                                            const QString &token, const QString &userId,
                                            const QString &targetUserId) {
+    // 引擎在通话间复用，必须等之前排队的销毁与预热完成；不在界面线程上等待，排到清理之后再加入
+    if (m_teardown->idle()) {
+        joinRoom(appId, roomId, token, targetUserId);
+        return;
+    }
+    qDebug() << "joining room after pending teardown";
+    const uint64_t request = m_callRequest;
+    m_teardown->post("join-wait", [] {}, this, [this, request, appId, roomId, token, targetUserId] {
+        if (request == m_callRequest && m_agentClient) {
+            joinRoom(appId, roomId, token, targetUserId);
+        }
+    });
+}
+
+void RoomMainWidget::joinRoom(const QString &appId, const QString &roomId,
+                              const QString &token, const QString &targetUserId) {
+    AllocScope allocScope(AllocSubsystem::RtcGlue);
     m_uid = targetUserId.toStdString();
     m_roomId = roomId.toStdString();
     m_appId = appId.toStdString();
@@ -106,42 +498,123 @@ void RoomMainWidget::slotOnVoiceChatReady(const QString &appId, const QString &r
 
     ui.roomIdLabel->setText(roomId);
 
-    bytertc::EngineConfig config;
-    config.app_id = m_appId.c_str();
-    config.parameters = "";
-    m_rtc_video = bytertc::IRTCEngine::createRTCEngine(config, this);
-    if (m_rtc_video == nullptr) {
-        qWarning() << "create engine failed";
+    // 清理线程已空闲，此时队列里只剩上一次通话的旧事件
+    m_rtcEvents->drain([](const RtcUiEvent &) {});
+    std::string prewarmedAppId = reclaimPrewarmedEngine();
+    if (!m_rtc_engine) {
+        // 第一次加入房间时创建引擎，SDK 通常已在后台加载完成，否则在这里等待加载
+        m_rtc_engine = createRtcEngine(m_rtcBackendType);
+    }
+    updateSdkVersionLabel();
+    if (!m_rtc_engine) {
+        // 插件加载失败：结束智能体会话回到登录页，提示原因
+        QString error = QString::fromStdString(RtcSdkLoader::instance().lastError());
+        if (error.isEmpty()) {
+            error = QStringLiteral(u"插件未能创建引擎");
+        }
+        failJoinRoom(QStringLiteral(u"无法加载 VolcEngineRTC：") + error);
         return;
     }
+    if (prewarmedAppId == m_appId) {
+        qDebug() << "using prewarmed RTC engine";
+    } else {
+        // 智能体换了 AppId，登录页按旧值创建的引擎作废
+        if (!prewarmedAppId.empty()) {
+            m_rtc_engine->destroy();
+        }
+        if (!m_rtc_engine->create(m_appId, this)) {
+            qWarning() << "create engine failed";
+            failJoinRoom(QStringLiteral(u"无法创建 RTC 引擎，请检查 AppId：") + appId);
+            return;
+        }
+    }
+    m_loginWidget->rememberRtcAppId(appId);
+
+    // 编码参数由自适应控制器按网络质量和 CPU 负载在档位间调整
+    auto *videoController = new AdaptiveVideoController(m_rtc_engine.get(), AdaptiveVideoConfig::fromEnvironment(), this);
+    videoController->start();
+    m_videoController.store(videoController, std::memory_order_release);
+
+    auto frameTapConfig = VideoFrameTapConfig::fromEnvironment();
+    if (frameTapConfig.enabled()) {
+        m_frameTap = std::make_unique<VideoFrameTap>(frameTapConfig);
+        m_frameTap->start();
+        m_rtc_engine->addVideoFrameObserver(m_frameTap.get());
+    }
+    if (m_snapshotCache) {
+        m_rtc_engine->addVideoFrameObserver(m_snapshotCache.get());
+    }
+    if (m_frameExporter) {
+        m_rtc_engine->addVideoFrameObserver(m_frameExporter.get());
+    }
 
-    bytertc::VideoEncoderConfig conf;
-    conf.frame_rate = 15;
-    conf.width = 360;
-    conf.height = 640;
-    m_rtc_video->setVideoEncoderConfig(conf);
+    // 开启语音检测时初始不发布音频，检测到说话后才打开上行
+    auto audioTapConfig = AudioTapConfig::fromEnvironment();
+    m_voiceActive = !audioTapConfig.vadEnabled;
+    if (audioTapConfig.enabled()) {
+        m_audioTap = std::make_unique<AudioTap>(audioTapConfig);
+        if (audioTapConfig.vadEnabled) {
+            m_audioTap->setVoiceActivityCallback([this](bool active) {
+                postRtcEvent(RtcUiEvent(RtcUiEvent::Type::VoiceActivity, active));
+            });
+        }
+        m_audioTap->start();
+        m_rtc_engine->addAudioFrameObserver(m_audioTap.get());
+    }
+
+    // 上一次通话的录制已在等待清理时结束，这里开始新文件
+    if (m_recorder && m_recorder->start(m_roomId)) {
+        m_rtc_engine->addVideoFrameObserver(m_recorder.get());
+        m_rtc_engine->addAudioFrameObserver(m_recorder.get());
+    }
+
+    // 进程内渲染时 SDK 只交出解码帧，不再使用原生窗口句柄
+    auto renderConfig = VideoRenderConfig::fromEnvironment();
+    if (renderConfig.inProcess) {
+        m_videoRenderer = new InProcessVideoRenderer(renderConfig, this);
+        m_rtc_engine->addVideoFrameObserver(m_videoRenderer);
+    }
 
     std::string stream_id = "";
 
-    setRenderCanvas(true, (void *) ui.localWidget->getVideoWidget()->winId(), stream_id, m_uid);
-    ui.localWidget->showVideo(m_uid.c_str());
-    m_rtc_video->startVideoCapture();
-    m_rtc_video->startAudioCapture();
-
-    m_rtc_room = m_rtc_video->createRTCRoom(m_roomId.c_str());
-    m_rtc_room->setRTCRoomEventHandler(this);
-    bytertc::UserInfo userInfo;
-    userInfo.uid = m_uid.c_str();
-    userInfo.extra_info = nullptr;
-
-    bytertc::RTCRoomConfig roomConfig;
-    roomConfig.stream_id = stream_id.c_str();
-    roomConfig.is_auto_publish_audio = true;
-    roomConfig.is_auto_publish_video = true;
-    roomConfig.is_auto_subscribe_audio = true;
-    roomConfig.is_auto_subscribe_video = true;
-    roomConfig.room_profile_type = bytertc::kRoomProfileTypeCommunication;
-    m_rtc_room->joinRoom(tokenStr.c_str(), userInfo, true, roomConfig);
+    setRenderCanvas(true, ui.videoGrid->localTile(), stream_id, m_uid);
+    ui.videoGrid->localTile()->showVideo(m_uid.c_str());
+    auto videoSourceConfig = ExternalVideoSourceConfig::fromEnvironment();
+    if (videoSourceConfig.type != ExternalVideoSourceConfig::Type::None) {
+        m_externalVideoSource = std::make_unique<ExternalVideoSource>(videoSourceConfig);
+        m_rtc_engine->setExternalVideoSource(true);
+    }
+    startLocalVideo();
+
+    // 配置了 PulseAudio 外部设备时由它负责采集和播放，启动失败则回退到 SDK 的设备管理
+    auto audioDeviceConfig = PulseAudioDeviceConfig::fromEnvironment();
+    if (audioDeviceConfig.enabled) {
+        m_audioDevice = std::make_unique<PulseAudioDevice>(audioDeviceConfig);
+        if (!m_audioDevice->start(m_rtc_engine.get())) {
+            qWarning() << "PulseAudio device unavailable, falling back to internal audio";
+            m_audioDevice.reset();
+        }
+    }
+    if (!m_audioDevice) {
+        m_rtc_engine->startAudioCapture();
+    }
+
+    m_rtc_room = m_rtc_engine->createRoom(m_roomId);
+    if (m_rtc_room == nullptr) {
+        qWarning() << "create room failed";
+        failJoinRoom(QStringLiteral(u"无法创建 RTC 房间：") + roomId);
+        return;
+    }
+
+    RtcRoomConfig roomConfig;
+    roomConfig.streamId = stream_id;
+    roomConfig.autoPublishAudio = m_voiceActive;
+    roomConfig.autoPublishVideo = true;
+    roomConfig.autoSubscribeAudio = true;
+    // 远端视频按网格中画面的可见性手动订阅
+    roomConfig.autoSubscribeVideo = false;
+    m_rtc_room->joinRoom(tokenStr, m_uid, roomConfig);
+    m_audioPublished = roomConfig.autoPublishAudio;
     m_isInRoom = true;
 
     qDebug() << "joinRoom: appId=" << m_appId.c_str()
@@ -149,6 +622,12 @@ void RoomMainWidget::slotOnVoiceChatReady(const QString &appId, const QString &r
              << ", uid(targetUserId)=" << m_uid.c_str();
 }
 
+void RoomMainWidget::failJoinRoom(const QString &reason) {
+    // 已启动的通话资源与智能体会话按挂断流程清理，回到登录页后再提示
+    slotOnHangup();
+    QMessageBox::warning(this, QStringLiteral(u"错误"), reason, QStringLiteral(u"确定"));
+}
+
 void RoomMainWidget::toggleCallUI(bool inCall) {
     m_loginWidget->setVisible(!inCall);
     ui.sidePanel->setVisible(inCall);
@@ -158,26 +637,14 @@ void RoomMainWidget::toggleCallUI(bool inCall) {
 
 void RoomMainWidget::slotOnHangup() {
     m_isInRoom = false;
+    // 还在等待清理的连接与加入房间不再进行
+    ++m_callRequest;
 
+    // 界面先回到登录页，网络与 SDK 的清理交给后台线程
     toggleCallUI(false);
     setLightState(false);
     clearChat();
 
-    if (m_agentClient) {
-        m_agentClient->stop();
-        m_agentClient->deleteLater();
-        m_agentClient = nullptr;
-    }
-
-    if (m_rtc_room) {
-        m_rtc_room->setRTCRoomEventHandler(nullptr);
-        m_rtc_room->leaveRoom();
-        m_rtc_room->destroy();
-        m_rtc_room = nullptr;
-    }
-    bytertc::IRTCEngine::destroyRTCEngine();
-    m_rtc_video = nullptr;
-
     // Reset mute buttons
     ui.muteAudioBtn->blockSignals(true);
     ui.muteAudioBtn->setChecked(false);
@@ -186,113 +653,385 @@ void RoomMainWidget::slotOnHangup() {
     ui.muteVideoBtn->blockSignals(true);
     ui.muteVideoBtn->setChecked(false);
     ui.muteVideoBtn->blockSignals(false);
+    m_voiceActive = true;
+
+    retireAgentClient();
 
+    // 画面解绑需要在引擎销毁之前、且画面组件仍存在时完成，留在界面线程上
     clearVideoView();
+    if (m_videoRenderer) {
+        m_rtc_engine->removeVideoFrameObserver(m_videoRenderer);
+        delete m_videoRenderer;
+        m_videoRenderer = nullptr;
+    }
+
+    // 控制器的定时器在界面线程上调用引擎，先停下；对象要等引擎销毁、不再有统计回调后才能释放
+    AdaptiveVideoController *controller = m_videoController.load(std::memory_order_relaxed);
+    if (controller) {
+        controller->stop();
+    }
+
+    struct CallResources {
+        std::unique_ptr<ExternalVideoSource> videoSource;
+        std::unique_ptr<VideoFrameTap> frameTap;
+        std::unique_ptr<AudioTap> audioTap;
+        std::unique_ptr<PulseAudioDevice> audioDevice;
+    };
+    auto resources = std::make_shared<CallResources>();
+    resources->videoSource = std::move(m_externalVideoSource);
+    resources->frameTap = std::move(m_frameTap);
+    resources->audioTap = std::move(m_audioTap);
+    resources->audioDevice = std::move(m_audioDevice);
+    IRtcEngine *engine = m_rtc_engine.get();
+    IRtcRoom *room = m_rtc_room;
+    m_rtc_room = nullptr;
+    RtcStatsCollector *stats = m_rtcStats.get();
+    SnapshotCache *snapshots = m_snapshotCache.get();
+    FrameExporter *frameExporter = m_frameExporter.get();
+    CallRecorder *recorder = m_recorder && m_recorder->recording() ? m_recorder.get() : nullptr;
+
+    // 还没加入过房间（引擎尚未创建）时只需要关闭智能体会话
+    if (!engine) {
+        return;
+    }
+
+    m_teardown->post("rtc", [engine, room, resources, stats, snapshots, frameExporter, recorder] {
+        AllocScope allocScope(AllocSubsystem::RtcGlue);
+        // 先停止外部视频采集线程，引擎销毁时会归还仍持有的帧，之后才能释放映射
+        if (resources->videoSource) {
+            resources->videoSource->stop();
+        } else {
+            engine->stopVideoCapture();
+        }
+        if (room) {
+            engine->destroyRoom(room);
+        }
+        if (resources->frameTap) {
+            engine->removeVideoFrameObserver(resources->frameTap.get());
+            resources->frameTap.reset();
+        }
+        if (snapshots) {
+            engine->removeVideoFrameObserver(snapshots);
+            snapshots->clear();
+        }
+        // 订阅者收到各路流结束，保持连接等待下一次通话
+        if (frameExporter) {
+            engine->removeVideoFrameObserver(frameExporter);
+            frameExporter->endCall();
+        }
+        if (resources->audioTap) {
+            engine->removeAudioFrameObserver(resources->audioTap.get());
+            resources->audioTap.reset();
+        }
+        // 观察者移除后不再有帧进入，写完剩余的块并补写索引
+        if (recorder) {
+            engine->removeVideoFrameObserver(recorder);
+            engine->removeAudioFrameObserver(recorder);
+            recorder->stop();
+        }
+        // 外部音频设备的回调线程会调用引擎，必须在引擎销毁前停止
+        resources->audioDevice.reset();
+        engine->destroy();
+        resources->videoSource.reset();
+        stats->clear();
+    }, this, [this, controller] {
+        // 引擎销毁后不再有回调，丢弃本次通话尚未处理的事件；已开始下一次通话时由其自行清理
+        if (!m_isInRoom) {
+            m_rtcEvents->drain([](const RtcUiEvent &) {});
+        }
+        AdaptiveVideoController *expected = controller;
+        m_videoController.compare_exchange_strong(expected, nullptr);
+        delete controller;
+    });
+}
+
+void RoomMainWidget::retireAgentClient() {
+    if (!m_agentClient) {
+        return;
+    }
+    AgentClient *client = m_agentClient;
+    m_agentClient = nullptr;
+
+    // 不再接收它的信号；stop() 要等待 MQTT 往返，放到后台，完成后回到界面线程释放
+    client->disconnect(this);
+    client->beginShutdown();
+    m_teardown->post("agent", [client] {
+        client->stop();
+    }, client, [client] {
+        client->deleteLater();
+    });
 }
 
+// ── SDK 回调（SDK 线程）──────────────────────────────────────────
+// 只做线程安全的统计汇总并把事件入队，不发信号、不打日志、不分配内存
+
 void RoomMainWidget::onRoomStateChanged(
             const char* room_id, const char* uid, int state, const char* extra_info) {
-    qDebug() << "onRoomStateChanged,roomid:" << room_id << ",uid:" << uid << ",state:" << state;
+    postRtcEvent(RtcUiEvent(RtcUiEvent::Type::RoomState, state, nullptr, uid));
 }
 
 void RoomMainWidget::onError(int err) {
-    qDebug() << "bytertc::OnError err" << err;
-    emit sigError(err);
+    postRtcEvent(RtcUiEvent(RtcUiEvent::Type::Error, err));
 }
 
-void RoomMainWidget::onUserJoined(const bytertc::UserInfo &user_info) {
-    qDebug() << "bytertc::OnUserJoined " << user_info.uid;
+void RoomMainWidget::onUserJoined(const char *uid) {
+    postRtcEvent(RtcUiEvent(RtcUiEvent::Type::UserJoined, 0, nullptr, uid));
 }
 
-void RoomMainWidget::onUserLeave(const char *uid, bytertc::UserOfflineReason reason) {
-    qDebug() << "user leave id = " << uid;
-    emit sigUserLeave(uid);
+void RoomMainWidget::onUserLeave(const char *uid, int reason) {
+    postRtcEvent(RtcUiEvent(RtcUiEvent::Type::UserLeave, reason, nullptr, uid));
 }
 
-void RoomMainWidget::onFirstLocalVideoFrameCaptured(bytertc::IVideoSource* video_source, const bytertc::VideoFrameInfo& info) {
-    qDebug() << "first local video frame is rendered";
+void RoomMainWidget::onFirstLocalVideoFrameCaptured() {
+    postRtcEvent(RtcUiEvent(RtcUiEvent::Type::FirstLocalVideoFrame, 0));
 }
 
-void RoomMainWidget::onFirstRemoteVideoFrameDecoded(const char* stream_id, const bytertc::StreamInfo& stream_info, const bytertc::VideoFrameInfo& info) {
-    qDebug() << "first remote video frame is decoded stream_id = " << stream_id << ", user_id = " << stream_info.user_id;
-    emit sigUserEnter(stream_id, stream_info.user_id);
+void RoomMainWidget::onFirstRemoteVideoFrameDecoded(const char* stream_id, const char* user_id) {
+    postRtcEvent(RtcUiEvent(RtcUiEvent::Type::FirstRemoteVideoFrame, 0, stream_id, user_id));
 }
 
-void RoomMainWidget::setRenderCanvas(bool isLocal, void *view, const std::string &stream_id, const std::string &user_id) {
-    if (m_rtc_video == nullptr) {
-        qDebug() << "byte engine is null ptr";
-        return;
+void RoomMainWidget::onUserPublishStreamVideo(const char *stream_id, const char *user_id, bool is_publish) {
+    postRtcEvent(RtcUiEvent(RtcUiEvent::Type::StreamVideo, is_publish, stream_id, user_id));
+}
+
+void RoomMainWidget::onNetworkQuality(const RtcNetworkQuality &local) {
+    AllocScope allocScope(AllocSubsystem::RtcGlue);
+    m_rtcStats->onNetworkQuality(local);
+    if (AdaptiveVideoController *controller = m_videoController.load(std::memory_order_acquire)) {
+        controller->onNetworkQuality(local);
+    }
+}
+
+void RoomMainWidget::onLocalStreamStats(const RtcLocalStreamStats &stats) {
+    AllocScope allocScope(AllocSubsystem::RtcGlue);
+    m_rtcStats->onLocalStreamStats(stats);
+    if (AdaptiveVideoController *controller = m_videoController.load(std::memory_order_acquire)) {
+        controller->onLocalStreamStats(stats);
+    }
+    if (m_statsOverlay) {
+        RtcUiEvent event(RtcUiEvent::Type::LocalStats, 0);
+        event.stats = RtcStatsCollector::toSample(stats);
+        postRtcEvent(std::move(event));
     }
+}
 
-    bytertc::VideoCanvas canvas;
-    canvas.view = view;
-    canvas.render_mode = bytertc::RenderMode::kRenderModeFit;
+void RoomMainWidget::onRemoteStreamStats(const char *stream_id, const char *user_id, const RtcRemoteStreamStats &stats) {
+    AllocScope allocScope(AllocSubsystem::RtcGlue);
+    m_rtcStats->onRemoteStreamStats(stream_id, user_id ? user_id : "", stats);
+    if (m_statsOverlay) {
+        RtcUiEvent event(RtcUiEvent::Type::RemoteStats, 0, stream_id, user_id);
+        event.stats = RtcStatsCollector::toSample(stats);
+        postRtcEvent(std::move(event));
+    }
+}
 
-    if (isLocal) {
-        m_rtc_video->setLocalVideoCanvas(canvas);
+void RoomMainWidget::postRtcEvent(RtcUiEvent &&event) {
+    if (event.droppable()) {
+        m_rtcEvents->push(std::move(event));
     } else {
-        m_rtc_video->setRemoteVideoCanvas(stream_id.c_str(), canvas);
+        m_rtcEvents->pushReliable(std::move(event));
     }
+    m_rtcEventDrain->wake();
 }
 
-void RoomMainWidget::setupSignals() {
-    connect(this, &RoomMainWidget::sigUserEnter, this, [=](const QString &streamID, const QString &userID) {
-        if (!m_isInRoom) {
-            qDebug() << "ignore sigUserEnter after leaving room";
-            return;
-        }
+// ── SDK 事件处理（界面线程）──────────────────────────────────────
 
-        if (m_activeWidgetMap.size() >= 3) {
-            qDebug() << "ignore add stream event,for users above 4";
-            return;
-        }
+void RoomMainWidget::drainRtcEvents() {
+    AllocScope allocScope(AllocSubsystem::RtcGlue);
+    m_rtcEvents->drain([this](const RtcUiEvent &event) { handleRtcEvent(event); });
 
-        if (m_activeWidgetMap.contains(userID)) {
-            qDebug() << "user id = " << userID << " is exist";
-            return;
-        }
+    const uint64_t dropped = m_rtcEvents->dropped();
+    if (dropped != m_reportedRtcEventDrops) {
+        qWarning() << "RTC event queue full, dropped" << dropped - m_reportedRtcEventDrops << "stats events";
+        m_reportedRtcEventDrops = dropped;
+    }
+}
 
-        for (int i = 0; i < m_videoWidgetList.size(); i++) {
-            if (!m_videoWidgetList[i]->isActive()) {
-                m_activeWidgetMap[userID] = m_videoWidgetList[i];
-                m_videoWidgetList[i]->showVideo(userID);
-                setRenderCanvas(false, (void *) m_videoWidgetList[i]->getVideoWidget()->winId(), streamID.toStdString(), userID.toStdString());
+void RoomMainWidget::handleRtcEvent(const RtcUiEvent &event) {
+    const QString streamID = QString::fromUtf8(event.streamId);
+    const QString userID = QString::fromUtf8(event.userId);
+
+    switch (event.type) {
+        case RtcUiEvent::Type::RoomState:
+            qDebug() << "onRoomStateChanged,uid:" << userID << ",state:" << event.value;
+            break;
+        case RtcUiEvent::Type::Error: {
+            qDebug() << "bytertc::OnError err" << event.value;
+            // 模态对话框会开嵌套事件循环，放到排空之后再弹出，不阻塞后续事件
+            const int errorCode = event.value;
+            QMetaObject::invokeMethod(this, [this, errorCode] {
+                QString errorInfo = "error:";
+                errorInfo += QString::number(errorCode);
+                QMessageBox::warning(this, QStringLiteral(u"提示"), errorInfo, QStringLiteral(u"确定"));
+            }, Qt::QueuedConnection);
+            break;
+        }
+        case RtcUiEvent::Type::UserJoined:
+            qDebug() << "bytertc::OnUserJoined " << userID;
+            break;
+        case RtcUiEvent::Type::UserLeave:
+            qDebug() << "user leave id = " << userID;
+            if (!m_isInRoom) {
+                qDebug() << "ignore user leave after leaving room";
                 break;
             }
+            for (const auto &stream : ui.videoGrid->remoteStreamsOfUser(userID)) {
+                removeRemoteStream(stream);
+            }
+            break;
+        case RtcUiEvent::Type::StreamVideo:
+            qDebug() << "user" << userID << (event.value ? "publish" : "unpublish") << "video stream_id = " << streamID;
+            if (!m_isInRoom) {
+                qDebug() << "ignore stream video event after leaving room";
+                break;
+            }
+            // 新画面先不订阅，等网格布局稳定后按可见性决定
+            if (event.value) {
+                ui.videoGrid->addRemote(streamID, userID);
+            } else {
+                removeRemoteStream(streamID);
+            }
+            break;
+        case RtcUiEvent::Type::FirstLocalVideoFrame:
+            qDebug() << "first local video frame is rendered";
+            break;
+        case RtcUiEvent::Type::FirstRemoteVideoFrame:
+            qDebug() << "first remote video frame is decoded stream_id = " << streamID << ", user_id = " << userID;
+            break;
+        case RtcUiEvent::Type::LocalStats:
+            if (m_isInRoom) {
+                ui.videoGrid->localTile()->setStatsText(formatStats(event.stats, true));
+            }
+            break;
+        case RtcUiEvent::Type::RemoteStats: {
+            VideoWidget *tile = ui.videoGrid->remoteTile(streamID);
+            if (m_isInRoom && tile && m_remoteVideo.value(streamID).subscribed) {
+                tile->setStatsText(formatStats(event.stats, false));
+            }
+            break;
         }
-    });
-
-    connect(this, &RoomMainWidget::sigUserLeave, this, [=](const QString &userID) {
-        if (!m_isInRoom) {
-            qDebug() << "ignore sigUserLeave after leaving room";
-            return;
-        }
+        case RtcUiEvent::Type::VoiceActivity:
+            m_voiceActive = event.value != 0;
+            updateAudioPublish();
+            break;
+        case RtcUiEvent::Type::None:
+            break;
+    }
+}
 
-        if (m_activeWidgetMap.contains(userID)) {
-            auto videoView = m_activeWidgetMap[userID];
-            videoView->hideVideo();
-            m_activeWidgetMap.remove(userID);
+void RoomMainWidget::setRenderCanvas(bool isLocal, VideoWidget *widget, const std::string &stream_id, const std::string &user_id) {
+    if (m_videoRenderer) {
+        if (isLocal) {
+            m_videoRenderer->attachLocal(widget->getVideoCanvas());
         } else {
-            qDebug() << "ignore user leave event";
+            m_videoRenderer->attachRemote(stream_id, widget->getVideoCanvas());
         }
-    });
+        return;
+    }
 
-    connect(this, &RoomMainWidget::sigError, this, [this](int errorCode) {
-        QString errorInfo = "error:";
-        errorInfo += QString::number(errorCode);
-        QMessageBox::warning(this, QStringLiteral(u"提示"), errorInfo, QStringLiteral(u"确定"));
-    });
+    void *view = (void *) widget->getVideoWidget()->winId();
+    if (isLocal) {
+        m_rtc_engine->setLocalVideoCanvas(view);
+    } else {
+        m_rtc_engine->setRemoteVideoCanvas(stream_id, view);
+    }
+}
+
+void RoomMainWidget::startLocalVideo() {
+    if (!m_externalVideoSource) {
+        m_rtc_engine->startVideoCapture();
+        return;
+    }
+    if (!m_externalVideoSource->start(m_rtc_engine.get())) {
+        qWarning() << "external video source failed to start, falling back to camera capture";
+        m_externalVideoSource.reset();
+        m_rtc_engine->setExternalVideoSource(false);
+        m_rtc_engine->startVideoCapture();
+    }
+}
+
+void RoomMainWidget::stopLocalVideo() {
+    if (m_externalVideoSource) {
+        m_externalVideoSource->stop();
+    } else {
+        m_rtc_engine->stopVideoCapture();
+    }
+}
+
+void RoomMainWidget::setupSignals() {
+    connect(ui.videoGrid, &VideoGrid::remoteTileChanged, this, &RoomMainWidget::updateRemoteSubscription);
 
     // Enter key in input field triggers send
     connect(ui.inputField, &QLineEdit::returnPressed, this, &RoomMainWidget::on_sendBtn_clicked);
 }
 
 void RoomMainWidget::clearVideoView() {
-    ui.localWidget->hideVideo();
-    for (auto uid : m_activeWidgetMap.keys()) {
-        m_activeWidgetMap[uid]->hideVideo();
+    ui.videoGrid->localTile()->hideVideo();
+    for (const auto &streamID : ui.videoGrid->remoteStreams()) {
+        removeRemoteStream(streamID);
     }
-    m_activeWidgetMap.clear();
+    m_remoteVideo.clear();
+}
+
+void RoomMainWidget::updateRemoteSubscription(const QString &streamId, bool visible, bool thumbnail) {
+    VideoWidget *tile = ui.videoGrid->remoteTile(streamId);
+    if (!m_isInRoom || !m_rtc_room || !tile) {
+        return;
+    }
+
+    const std::string stream = streamId.toStdString();
+    auto &state = m_remoteVideo[streamId];
+    if (visible) {
+        RtcRemoteVideoConfig config = thumbnail ? kThumbnailVideo : RtcRemoteVideoConfig();
+        if (!state.subscribed || config != state.config) {
+            m_rtc_room->setRemoteVideoConfig(stream, config);
+            state.config = config;
+        }
+        if (!state.subscribed) {
+            setRenderCanvas(false, tile, stream, tile->getUserId().toStdString());
+            m_rtc_room->subscribeStreamVideo(stream, true);
+            state.subscribed = true;
+        }
+    } else if (state.subscribed) {
+        m_rtc_room->subscribeStreamVideo(stream, false);
+        state.subscribed = false;
+        tile->setStatsText(QString());
+    }
+    qDebug() << "remote video" << streamId << (state.subscribed ? "subscribed" : "unsubscribed")
+             << (state.subscribed && thumbnail ? "(thumbnail)" : "");
+}
+
+void RoomMainWidget::removeRemoteStream(const QString &streamId) {
+    m_rtcStats->removeStream(streamId.toStdString());
+    // 帧抽取等按流占用的通道随流结束归还
+    if (m_frameTap) {
+        m_frameTap->releaseStream(streamId.toStdString());
+    }
+    if (m_frameExporter) {
+        m_frameExporter->releaseStream(streamId.toStdString());
+    }
+    if (m_snapshotCache) {
+        m_snapshotCache->releaseStream(streamId.toStdString());
+    }
+    auto it = m_remoteVideo.find(streamId);
+    if (it != m_remoteVideo.end()) {
+        if (it->subscribed && m_rtc_room) {
+            m_rtc_room->subscribeStreamVideo(streamId.toStdString(), false);
+        }
+        m_remoteVideo.erase(it);
+    }
+
+    VideoWidget *tile = ui.videoGrid->removeRemote(streamId);
+    if (!tile) {
+        return;
+    }
+    // 画面销毁前解除渲染绑定，原生渲染时 SDK 不能再持有窗口句柄
+    if (m_videoRenderer) {
+        m_videoRenderer->detach(tile->getVideoCanvas());
+    } else {
+        m_rtc_engine->setRemoteVideoCanvas(streamId.toStdString(), nullptr);
+    }
+    tile->deleteLater();
 }
 
 // --- Control bar slots ---
@@ -302,22 +1041,29 @@ void RoomMainWidget::on_hangupBtn_clicked() {
 }
 
 void RoomMainWidget::on_muteAudioBtn_clicked() {
-    bool bMute = ui.muteAudioBtn->isChecked();
-    if (m_rtc_room) {
-        m_rtc_room->publishStreamAudio(!bMute);
+    updateAudioPublish();
+}
+
+void RoomMainWidget::updateAudioPublish() {
+    if (!m_rtc_room) return;
+    // 手动静音优先于语音检测
+    bool publish = !ui.muteAudioBtn->isChecked() && m_voiceActive;
+    if (publish != m_audioPublished) {
+        m_rtc_room->publishStreamAudio(publish);
+        m_audioPublished = publish;
     }
 }
 
 void RoomMainWidget::on_muteVideoBtn_clicked() {
     bool bMute = ui.muteVideoBtn->isChecked();
-    if (m_rtc_video) {
+    if (m_rtc_room) {
         if (bMute) {
-            m_rtc_video->stopVideoCapture();
+            stopLocalVideo();
         } else {
-            m_rtc_video->startVideoCapture();
+            startLocalVideo();
         }
         QTimer::singleShot(10, this, [=] {
-            ui.localWidget->update();
+            ui.videoGrid->localTile()->update();
         });
     }
 }
@@ -336,17 +1082,22 @@ void RoomMainWidget::on_sendBtn_clicked() {
 }
 
 void RoomMainWidget::appendUserMessage(const QString &text) {
+    AllocScope allocScope(AllocSubsystem::UiTranscript);
     QTextCursor cursor = ui.chatDisplay->textCursor();
     cursor.movePosition(QTextCursor::End);
     if (!ui.chatDisplay->document()->isEmpty()) {
         cursor.insertText("\n");
     }
     cursor.insertText(QStringLiteral(u"You: ") + text);
+    if (m_recorder) {
+        m_recorder->recordText(RecordingFormat::TextKind::User, text.toStdString());
+    }
     ui.chatDisplay->setTextCursor(cursor);
     ui.chatDisplay->ensureCursorVisible();
 }
 
 void RoomMainWidget::appendAgentDelta(const QString &delta) {
+    AllocScope allocScope(AllocSubsystem::UiTranscript);
     QTextCursor cursor = ui.chatDisplay->textCursor();
     cursor.movePosition(QTextCursor::End);
     if (!m_agentMessageInProgress) {
@@ -357,15 +1108,22 @@ void RoomMainWidget::appendAgentDelta(const QString &delta) {
         m_agentMessageInProgress = true;
     }
     cursor.insertText(delta);
+    if (m_recorder) {
+        m_recorder->recordText(RecordingFormat::TextKind::AgentDelta, delta.toStdString());
+    }
     ui.chatDisplay->setTextCursor(cursor);
     ui.chatDisplay->ensureCursorVisible();
 }
 
 void RoomMainWidget::finishAgentMessage() {
     m_agentMessageInProgress = false;
+    if (m_recorder) {
+        m_recorder->recordText(RecordingFormat::TextKind::AgentEnd, std::string());
+    }
 }
 
 void RoomMainWidget::clearChat() {
+    AllocScope allocScope(AllocSubsystem::UiTranscript);
     ui.chatDisplay->clear();
     m_agentMessageInProgress = false;
 }
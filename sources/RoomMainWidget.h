@@ -3,18 +3,39 @@
 #include <QtWidgets/QMainWindow>
 #include <QSharedPointer>
 #include "ui_RoomMainWidget.h"
-#include "bytertc_engine.h"
-#include "bytertc_room.h"
-#include "bytertc_room_event_handler.h"
+#include "RtcBackend.h"
+#include "ConnectionPrewarmer.h"
+#include <atomic>
+#include <memory>
 
 class LoginWidget;
 class AgentClient;
+class AdaptiveVideoController;
+class ExternalVideoSource;
+class VideoFrameTap;
+class SnapshotCache;
+class TelemetryStream;
+class ActuatorToolAdapter;
+class CallRecorder;
+class FrameExporter;
+class AudioTap;
+class PulseAudioDevice;
+class InProcessVideoRenderer;
+class VideoWidget;
+class MetricsExporter;
+class RtcStatsCollector;
+class EventLoopDrain;
+class TeardownWorker;
+struct RtcUiEvent;
+struct RtcEnginePrewarm;
+template <typename T> class MpscEventQueue;
 
-class RoomMainWidget : public QWidget, public bytertc::IRTCRoomEventHandler, public bytertc::IRTCEngineEventHandler {
+class RoomMainWidget : public QWidget, public IRtcEventHandler {
     Q_OBJECT
 
 public:
     RoomMainWidget(QWidget *parent = Q_NULLPTR);
+    ~RoomMainWidget() override;
 
 private
     slots:
@@ -28,15 +49,20 @@ protected:
     void mousePressEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
     void mouseReleaseEvent(QMouseEvent *event) override;
+    void showEvent(QShowEvent *event) override;
 
 protected:
     void onRoomStateChanged(
             const char* room_id, const char* uid, int state, const char* extra_info) override;
     void onError(int err) override;
-    void onUserJoined(const bytertc::UserInfo &user_info) override;
-    void onUserLeave(const char *uid, bytertc::UserOfflineReason reason) override;
-    void onFirstLocalVideoFrameCaptured(bytertc::IVideoSource* video_source, const bytertc::VideoFrameInfo& info) override;
-    void onFirstRemoteVideoFrameDecoded(const char* stream_id, const bytertc::StreamInfo& stream_info, const bytertc::VideoFrameInfo& info) override;
+    void onUserJoined(const char *uid) override;
+    void onUserLeave(const char *uid, int reason) override;
+    void onUserPublishStreamVideo(const char *stream_id, const char *user_id, bool is_publish) override;
+    void onFirstLocalVideoFrameCaptured() override;
+    void onFirstRemoteVideoFrameDecoded(const char* stream_id, const char* user_id) override;
+    void onNetworkQuality(const RtcNetworkQuality &local) override;
+    void onLocalStreamStats(const RtcLocalStreamStats &stats) override;
+    void onRemoteStreamStats(const char *stream_id, const char *user_id, const RtcRemoteStreamStats &stats) override;
 
 public
     slots:
@@ -56,21 +82,43 @@ public
 
     void slotOnHangup();
 
+    /** 登录页选中了已保存的配置：预热 MQTT 连接，记录过 AppId 时预先创建 RTC 引擎 */
+    void slotOnPrewarmProfile(const QString &brokerUrl, const QString &clientId, const QString &rtcAppId);
+    void slotOnCancelPrewarm();
+
     signals:
             void sigJoinChannelSuccess(std::string channel, std::string uid, int elapsed);
     void sigJoinChannelFailed(std::string room_id, std::string uid, int error_code);
     void sigRoomJoinChannelSuccess(std::string channel, std::string uid, int elapsed);
-    void sigUserEnter(const QString &stream_id, const QString &uid);
-    void sigUserLeave(const QString &uid);
-    void sigError(int errorCode);
 
 private:
     void setupView();
+    void startSdkPreload();
+    void updateSdkVersionLabel();
     void setupSignals();
     void toggleCallUI(bool inCall);
     void leaveRoom();
-    void setRenderCanvas(bool isLocal, void *view, const std::string &stream_id, const std::string &id);
+    void retireAgentClient();
+    /** 清理线程空闲后调用：创建 AgentClient 并开始连接 */
+    void startAgentClient(const QString &brokerUrl, const QString &agentId, const QString &clientId);
+    /** 清理线程空闲后调用：取回或创建引擎并加入房间 */
+    void joinRoom(const QString &appId, const QString &roomId, const QString &token, const QString &targetUserId);
+    /** 加入房间失败：按挂断清理已启动的通话资源，回到登录页并提示原因 */
+    void failJoinRoom(const QString &reason);
+    void prewarmRtcEngine(const std::string &appId);
+    void cancelRtcPrewarm();
+    /** 在清理线程空闲之后调用，取回预热的引擎，返回已用于 create() 的 AppId，未创建时为空 */
+    std::string reclaimPrewarmedEngine();
+    void setRenderCanvas(bool isLocal, VideoWidget *widget, const std::string &stream_id, const std::string &id);
     void clearVideoView();
+    void updateRemoteSubscription(const QString &streamId, bool visible, bool thumbnail);
+    void removeRemoteStream(const QString &streamId);
+    void postRtcEvent(RtcUiEvent &&event);
+    void drainRtcEvents();
+    void handleRtcEvent(const RtcUiEvent &event);
+    void startLocalVideo();
+    void stopLocalVideo();
+    void updateAudioPublish();
 
     // Chat helpers
     void appendUserMessage(const QString &text);
@@ -87,13 +135,57 @@ private:
     QPoint m_prevGlobalPoint;
     QSharedPointer<LoginWidget> m_loginWidget;
     AgentClient *m_agentClient = nullptr;
-    bytertc::IRTCEngine* m_rtc_video = nullptr;
-    bytertc::IRTCRoom* m_rtc_room = nullptr;
+    // VolcEngine 后端在第一次加入房间时才创建，SDK 在窗口显示后于后台预加载
+    RtcBackendType m_rtcBackendType = RtcBackendType::Fake;
+    std::unique_ptr<IRtcEngine> m_rtc_engine;
+    bool m_sdkPreloadStarted = false;
+    IRtcRoom* m_rtc_room = nullptr;
+    // 界面线程创建和清除，SDK 线程的统计回调读取；引擎可能早于控制器创建
+    std::atomic<AdaptiveVideoController *> m_videoController{nullptr};
+    std::unique_ptr<ExternalVideoSource> m_externalVideoSource;
+    std::unique_ptr<VideoFrameTap> m_frameTap;
+    // camera_snapshot 工具的帧缓存，跨通话保留，挂断时清空
+    std::unique_ptr<SnapshotCache> m_snapshotCache;
+    // 传感器遥测，连接智能体后由 AgentClient 发布
+    std::unique_ptr<TelemetryStream> m_telemetry;
+    // 执行器工具，经共享内存命令环转发给控制进程
+    std::unique_ptr<ActuatorToolAdapter> m_actuators;
+    // 通话录制，跨通话复用，每次通话一个文件
+    std::unique_ptr<CallRecorder> m_recorder;
+    // 解码帧导出给其它进程，跨通话复用，订阅者不必重连
+    std::unique_ptr<FrameExporter> m_frameExporter;
+    std::unique_ptr<AudioTap> m_audioTap;
+    std::unique_ptr<PulseAudioDevice> m_audioDevice;
+    InProcessVideoRenderer *m_videoRenderer = nullptr;
+    std::unique_ptr<RtcStatsCollector> m_rtcStats;
+    std::unique_ptr<MetricsExporter> m_metrics;
+    bool m_statsOverlay = false;
+    // SDK 回调线程只入队，界面线程每轮事件循环排空一次
+    std::unique_ptr<MpscEventQueue<RtcUiEvent>> m_rtcEvents;
+    std::unique_ptr<EventLoopDrain> m_rtcEventDrain;
+    uint64_t m_reportedRtcEventDrops = 0;
+    // 挂断时的网络与 SDK 清理在后台按顺序执行
+    std::unique_ptr<TeardownWorker> m_teardown;
+    // 登录页预热：MQTT 连接在独立线程上建立；RTC 引擎的创建与销毁复用清理线程，天然与挂断清理保持顺序
+    PrewarmConfig m_prewarmConfig;
+    std::unique_ptr<ConnectionPrewarmer> m_prewarmer;
+    std::shared_ptr<RtcEnginePrewarm> m_rtcPrewarm;
+    std::string m_rtcPrewarmAppId;
+    // 每次预热、取消或开始通话加一，等待清理完成后才发起的预热据此判断是否已过期
+    uint64_t m_prewarmRequest = 0;
+    // 每次开始通话或挂断加一，排在清理之后的连接与加入房间据此判断是否已过期
+    uint64_t m_callRequest = 0;
+    bool m_voiceActive = true;
+    bool m_audioPublished = false;
     std::string m_appId;
     std::string m_uid;
     std::string m_roomId;
     bool m_isInRoom = false;
-    QList<VideoWidget *> m_videoWidgetList;
-    QMap<QString, VideoWidget *> m_activeWidgetMap;
+    // 远端视频的手动订阅状态，按网格画面的可见性更新
+    struct RemoteVideoSubscription {
+        bool subscribed = false;
+        RtcRemoteVideoConfig config;
+    };
+    QMap<QString, RemoteVideoSubscription> m_remoteVideo;
     bool m_agentMessageInProgress = false;
 };
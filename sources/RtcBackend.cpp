@@ -0,0 +1,40 @@
+#include "RtcBackend.h"
+#include "FakeRtcBackend.h"
+#include "RtcSdkLoader.h"
+#include <QDebug>
+#include <cstdlib>
+#include <cstring>
+
+RtcBackendType rtcBackendTypeFromEnvironment() {
+    const char *value = std::getenv("QUICKSTART_RTC_BACKEND");
+#ifdef QUICKSTART_NO_VOLCENGINE_RTC
+    if (value && std::strcmp(value, "fake") != 0) {
+        qWarning() << "VolcEngineRTC backend not built, using fake RTC backend";
+    }
+    return RtcBackendType::Fake;
+#else
+    if (value && std::strcmp(value, "fake") == 0) {
+        return RtcBackendType::Fake;
+    }
+    return RtcBackendType::VolcEngine;
+#endif
+}
+
+std::unique_ptr<IRtcEngine> createRtcEngine(RtcBackendType type) {
+    switch (type) {
+    case RtcBackendType::Fake:
+        qDebug() << "Using fake RTC backend";
+        return std::make_unique<FakeRtcEngine>(FakeRtcConfig::fromEnvironment());
+    case RtcBackendType::VolcEngine:
+#ifndef QUICKSTART_NO_VOLCENGINE_RTC
+        // SDK 在插件中按需加载，通常窗口显示后已在后台加载完成
+        if (auto engine = RtcSdkLoader::instance().createEngine()) {
+            return engine;
+        }
+        // 不悄悄换成模拟后端，由界面提示加载失败；需要模拟后端时设置 QUICKSTART_RTC_BACKEND=fake
+        qWarning() << "VolcEngineRTC plugin unavailable:" << RtcSdkLoader::instance().lastError().c_str();
+#endif
+        break;
+    }
+    return nullptr;
+}
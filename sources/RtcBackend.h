@@ -0,0 +1,289 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * RTC 后端抽象
+ *
+ * 将 RoomMainWidget 与具体的 RTC SDK 解耦，分为以下几部分：
+ * - IRtcEngine：引擎（采集、编码配置、渲染画布、帧回调）
+ * - IRtcRoom：房间（加入/离开、发布控制）
+ * - IRtcEventHandler：引擎与房间事件的统一回调
+ * - IRtcVideoFrameObserver / IRtcAudioFrameObserver：原始音视频帧回调
+ *
+ * 目前有两种实现：
+ * - VolcEngine：基于 VolcEngineRTC SDK 的真实实现（VolcRtcBackend）
+ * - Fake：进程内的模拟实现（FakeRtcBackend），按配置的速率生成
+ *   合成音视频帧和房间事件，用于在没有 SDK 和设备的机器上做测试与性能测量
+ *
+ * 与 SDK 一致，所有回调都运行在后端内部线程上，实现方需自行切换到 UI 线程。
+ */
+
+enum class RtcBackendType {
+    VolcEngine,
+    Fake,
+};
+
+enum class RtcPixelFormat {
+    I420,
+    NV12,
+};
+
+/** 视频编码参数（对应 bytertc::VideoEncoderConfig） */
+struct RtcVideoEncoderProfile {
+    int width = 360;
+    int height = 640;
+    int frameRate = 15;
+    int maxBitrateKbps = -1;  // -1 表示由 SDK 自动计算
+    int minBitrateKbps = 0;
+};
+
+/** 一帧视频的只读视图，数据只在回调期间有效 */
+struct RtcVideoFrame {
+    RtcPixelFormat format = RtcPixelFormat::I420;
+    int width = 0;
+    int height = 0;
+    const uint8_t *planes[3] = {nullptr, nullptr, nullptr};
+    int strides[3] = {0, 0, 0};
+    int64_t timestampUs = 0;
+};
+
+/**
+ * 推送给引擎的外部视频帧
+ *
+ * 引擎直接引用 planes 指向的内存而不拷贝，用完后调用且只调用一次
+ * release(opaque, bufferIndex) 归还缓冲（可能在引擎内部线程上），
+ * 推送失败时也会同步调用 release。
+ */
+struct RtcExternalVideoFrame {
+    RtcPixelFormat format = RtcPixelFormat::I420;
+    int width = 0;
+    int height = 0;
+    uint8_t *planes[3] = {nullptr, nullptr, nullptr};
+    int strides[3] = {0, 0, 0};
+    int64_t timestampUs = 0;
+
+    void (*release)(void *opaque, int bufferIndex) = nullptr;
+    void *opaque = nullptr;
+    int bufferIndex = -1;
+};
+
+/** 一帧 16 位交织 PCM 音频的只读视图，数据只在回调期间有效 */
+struct RtcAudioFrame {
+    const int16_t *data = nullptr;
+    int samplesPerChannel = 0;
+    int channels = 1;
+    int sampleRate = 16000;
+    int64_t timestampUs = 0;
+};
+
+/**
+ * 网络质量，评分与 bytertc::NetworkQuality 一致：
+ * 0 未知，1 极好，2 好，3 较差，4 差，5 极差，6 断开
+ */
+struct RtcNetworkQuality {
+    int txQuality = 0;
+    int rxQuality = 0;
+    float lossRate = 0.0f;  // 0~1
+    int rttMs = 0;
+};
+
+/** 本地视频流统计，每个统计周期（通常 2 秒）回调一次 */
+struct RtcLocalStreamStats {
+    float sentKbps = 0.0f;
+    float inputFrameRate = 0.0f;
+    float encoderOutputFrameRate = 0.0f;
+    int encodedWidth = 0;
+    int encodedHeight = 0;
+    float lossRate = 0.0f;  // 0~1
+    int rttMs = 0;
+};
+
+/** 远端视频流统计，每个统计周期（通常 2 秒）每条已订阅的流回调一次 */
+struct RtcRemoteStreamStats {
+    float receivedKbps = 0.0f;
+    float lossRate = 0.0f;           // 0~1
+    int rttMs = 0;
+    int jitterBufferDelayMs = 0;
+    int e2eDelayMs = 0;
+    float decodeTimeMs = 0.0f;       // 平均每帧解码耗时，SDK 未提供时为 0
+    float decoderOutputFrameRate = 0.0f;
+    float renderFrameRate = 0.0f;
+    int width = 0;
+    int height = 0;
+    int stallCount = 0;
+    int stallDurationMs = 0;
+};
+
+/**
+ * 期望接收的远端视频规格（对应 bytertc::RemoteVideoConfig）。
+ * 发布端开启 simulcast 时服务端按此选择最接近的一层，0 表示不限制（最高一层）。
+ */
+struct RtcRemoteVideoConfig {
+    int width = 0;
+    int height = 0;
+    int frameRate = 0;
+
+    bool operator==(const RtcRemoteVideoConfig &other) const {
+        return width == other.width && height == other.height && frameRate == other.frameRate;
+    }
+    bool operator!=(const RtcRemoteVideoConfig &other) const { return !(*this == other); }
+};
+
+struct RtcRoomConfig {
+    std::string streamId;
+    bool autoPublishAudio = true;
+    bool autoPublishVideo = true;
+    bool autoSubscribeAudio = true;
+    bool autoSubscribeVideo = true;
+};
+
+class IRtcEventHandler {
+public:
+    virtual ~IRtcEventHandler() = default;
+
+    virtual void onRoomStateChanged(const char *roomId, const char *uid, int state, const char *extraInfo) {}
+    virtual void onError(int err) {}
+    virtual void onUserJoined(const char *uid) {}
+    virtual void onUserLeave(const char *uid, int reason) {}
+    /** 远端用户发布/取消发布视频流，关闭自动订阅时据此手动订阅 */
+    virtual void onUserPublishStreamVideo(const char *streamId, const char *userId, bool isPublish) {}
+    virtual void onFirstLocalVideoFrameCaptured() {}
+    virtual void onFirstRemoteVideoFrameDecoded(const char *streamId, const char *userId) {}
+    virtual void onNetworkQuality(const RtcNetworkQuality &local) {}
+    virtual void onLocalStreamStats(const RtcLocalStreamStats &stats) {}
+    virtual void onRemoteStreamStats(const char *streamId, const char *userId, const RtcRemoteStreamStats &stats) {}
+};
+
+class IRtcVideoFrameObserver {
+public:
+    virtual ~IRtcVideoFrameObserver() = default;
+
+    virtual void onLocalVideoFrame(const RtcVideoFrame &frame) {}
+    virtual void onRemoteVideoFrame(const char *streamId, const char *userId, const RtcVideoFrame &frame) {}
+};
+
+class IRtcAudioFrameObserver {
+public:
+    virtual ~IRtcAudioFrameObserver() = default;
+
+    /** 本地麦克风采集的音频 */
+    virtual void onRecordAudioFrame(const RtcAudioFrame &frame) {}
+    /** 所有远端用户混音后的播放音频 */
+    virtual void onPlaybackAudioFrame(const RtcAudioFrame &frame) {}
+};
+
+class IRtcRoom {
+public:
+    virtual ~IRtcRoom() = default;
+
+    virtual int joinRoom(const std::string &token, const std::string &userId, const RtcRoomConfig &config) = 0;
+    virtual int leaveRoom() = 0;
+    virtual int publishStreamAudio(bool publish) = 0;
+
+    /** 手动订阅/取消订阅远端视频，joinRoom 时需关闭 autoSubscribeVideo */
+    virtual int subscribeStreamVideo(const std::string &streamId, bool subscribe) = 0;
+    virtual int setRemoteVideoConfig(const std::string &streamId, const RtcRemoteVideoConfig &config) = 0;
+};
+
+class IRtcEngine {
+public:
+    virtual ~IRtcEngine() = default;
+
+    virtual RtcBackendType type() const = 0;
+    virtual std::string sdkVersion() const = 0;
+
+    /** 创建底层引擎，handler 接收引擎和房间事件 */
+    virtual bool create(const std::string &appId, IRtcEventHandler *handler) = 0;
+    /** 销毁底层引擎，之前创建的房间必须已通过 destroyRoom 释放 */
+    virtual void destroy() = 0;
+
+    virtual int setVideoEncoderProfile(const RtcVideoEncoderProfile &profile) = 0;
+    virtual int setLocalVideoCanvas(void *view) = 0;
+    virtual int setRemoteVideoCanvas(const std::string &streamId, void *view) = 0;
+
+    virtual int startVideoCapture() = 0;
+    virtual int stopVideoCapture() = 0;
+    virtual int startAudioCapture() = 0;
+    virtual int stopAudioCapture() = 0;
+
+    /** 切换为外部视频源，之后通过 pushExternalVideoFrame 提供本地视频 */
+    virtual int setExternalVideoSource(bool enable) = 0;
+    virtual int pushExternalVideoFrame(const RtcExternalVideoFrame &frame) = 0;
+
+    /**
+     * 切换为外部音频设备：麦克风音频由调用方通过 pushExternalAudioFrame 按 10 ms 提供，
+     * 远端音频由调用方通过 pullExternalAudioFrame 按 10 ms 拉取并自行播放
+     */
+    virtual int setExternalAudioDevice(bool enable) = 0;
+    virtual int pushExternalAudioFrame(const RtcAudioFrame &frame) = 0;
+    /** 拉取 samplesPerChannel 个采样的播放音频写入 data，没有远端音频时为静音 */
+    virtual int pullExternalAudioFrame(int16_t *data, int samplesPerChannel, int channels, int sampleRate) = 0;
+
+    /** 创建房间，返回的指针归引擎所有，通过 destroyRoom 释放 */
+    virtual IRtcRoom *createRoom(const std::string &roomId) = 0;
+    virtual void destroyRoom(IRtcRoom *room) = 0;
+
+    /**
+     * 注册/移除原始帧观察者，可同时存在多个。
+     * remove 返回后保证不会再回调该观察者。
+     */
+    virtual void addVideoFrameObserver(IRtcVideoFrameObserver *observer) = 0;
+    virtual void removeVideoFrameObserver(IRtcVideoFrameObserver *observer) = 0;
+    virtual void addAudioFrameObserver(IRtcAudioFrameObserver *observer) = 0;
+    virtual void removeAudioFrameObserver(IRtcAudioFrameObserver *observer) = 0;
+};
+
+/**
+ * 观察者列表，供后端实现在回调线程上分发。
+ * 分发期间持有锁，因此 remove 返回后不会再有进行中的回调。
+ */
+template <typename Observer>
+class RtcObserverList {
+public:
+    void add(Observer *observer) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (std::find(m_observers.begin(), m_observers.end(), observer) == m_observers.end()) {
+            m_observers.push_back(observer);
+        }
+    }
+
+    void remove(Observer *observer) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_observers.erase(std::remove(m_observers.begin(), m_observers.end(), observer), m_observers.end());
+    }
+
+    bool empty() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_observers.empty();
+    }
+
+    template <typename Fn>
+    void forEach(Fn &&fn) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto *observer : m_observers) {
+            fn(observer);
+        }
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<Observer *> m_observers;
+};
+
+/**
+ * 根据环境变量 QUICKSTART_RTC_BACKEND（"volc" 或 "fake"）选择后端，默认 VolcEngine。
+ * 未编译 VolcEngineRTC 支持时总是返回 Fake。
+ */
+RtcBackendType rtcBackendTypeFromEnvironment();
+
+/**
+ * 创建后端引擎。VolcEngine 后端通过 RtcSdkLoader 加载插件，尚未加载完成时会阻塞等待，
+ * 插件不可用时返回 nullptr（原因见 RtcSdkLoader::lastError()），不退回 Fake。
+ */
+std::unique_ptr<IRtcEngine> createRtcEngine(RtcBackendType type);
@@ -0,0 +1,129 @@
+#include "RtcSdkLoader.h"
+#include "RtcBackend.h"
+#include <QDebug>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <unistd.h>
+
+RtcSdkLoader &RtcSdkLoader::instance() {
+    static RtcSdkLoader loader;
+    return loader;
+}
+
+RtcSdkLoader::~RtcSdkLoader() {
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool RtcSdkLoader::eagerLoadRequested() {
+    const char *value = std::getenv("QUICKSTART_EAGER_SDK_LOAD");
+    return value && std::strcmp(value, "0") != 0 && value[0] != '\0';
+}
+
+std::string RtcSdkLoader::pluginPath() {
+    const char *value = std::getenv("QUICKSTART_RTC_PLUGIN");
+    if (value && value[0] != '\0') {
+        return value;
+    }
+
+    // 与可执行文件放在同一目录；dlopen 不会使用主程序的 RUNPATH 查找，因此拼出完整路径
+    char exe[4096];
+    ssize_t length = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    if (length <= 0) {
+        return QUICKSTART_RTC_PLUGIN_NAME;
+    }
+    exe[length] = '\0';
+    std::string path(exe);
+    return path.substr(0, path.rfind('/') + 1) + QUICKSTART_RTC_PLUGIN_NAME;
+}
+
+void RtcSdkLoader::preloadAsync() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_state != State::Idle) {
+        return;
+    }
+    m_state = State::Loading;
+    m_thread = std::thread(&RtcSdkLoader::loadNow, this);
+}
+
+bool RtcSdkLoader::load() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_state == State::Idle) {
+        m_state = State::Loading;
+        lock.unlock();
+        loadNow();
+        lock.lock();
+    }
+    m_cond.wait(lock, [this] { return m_state == State::Loaded || m_state == State::Failed; });
+    return m_state == State::Loaded;
+}
+
+bool RtcSdkLoader::loaded() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_state == State::Loaded;
+}
+
+bool RtcSdkLoader::loading() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_state == State::Loading;
+}
+
+void RtcSdkLoader::loadNow() {
+    auto start = std::chrono::steady_clock::now();
+    const std::string path = pluginPath();
+
+    // RTLD_NOW：在加载线程上一次完成全部符号解析和重定位，之后调用 SDK 不再有延迟绑定的开销
+    void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    const std::string error = handle ? std::string("missing entry points") : std::string(dlerror());
+    QuickStartRtcCreateEngineFn createEngine = nullptr;
+    QuickStartRtcSdkVersionFn sdkVersion = nullptr;
+    if (handle) {
+        createEngine = reinterpret_cast<QuickStartRtcCreateEngineFn>(dlsym(handle, QUICKSTART_RTC_PLUGIN_CREATE_ENGINE));
+        sdkVersion = reinterpret_cast<QuickStartRtcSdkVersionFn>(dlsym(handle, QUICKSTART_RTC_PLUGIN_SDK_VERSION));
+    }
+    int elapsedMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_loadTimeMs = elapsedMs;
+    if (handle && createEngine && sdkVersion) {
+        m_handle = handle;
+        m_createEngine = createEngine;
+        m_sdkVersion = sdkVersion;
+        m_state = State::Loaded;
+        qInfo() << "RtcSdkLoader: loaded" << path.c_str() << "in" << elapsedMs << "ms";
+    } else {
+        m_state = State::Failed;
+        m_error = path + ": " + error;
+        qWarning() << "RtcSdkLoader: cannot load" << path.c_str() << ":" << error.c_str();
+    }
+    m_cond.notify_all();
+}
+
+std::unique_ptr<IRtcEngine> RtcSdkLoader::createEngine() {
+    if (!load()) {
+        return nullptr;
+    }
+    return std::unique_ptr<IRtcEngine>(m_createEngine());
+}
+
+std::string RtcSdkLoader::sdkVersion() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_state != State::Loaded) {
+        return std::string();
+    }
+    return std::string("VolcEngineRTC v") + m_sdkVersion();
+}
+
+std::string RtcSdkLoader::lastError() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_state == State::Failed ? m_error : std::string();
+}
+
+int RtcSdkLoader::loadTimeMs() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_state == State::Loaded || m_state == State::Failed ? m_loadTimeMs : -1;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class IRtcEngine;
+
+// VolcEngineRTC 后端插件（libQuickStartVolcRtc.so）导出的入口，插件与主程序共用 RtcBackend.h 的接口
+#define QUICKSTART_RTC_PLUGIN_NAME "libQuickStartVolcRtc.so"
+#define QUICKSTART_RTC_PLUGIN_CREATE_ENGINE "quickstart_rtc_create_engine"
+#define QUICKSTART_RTC_PLUGIN_SDK_VERSION "quickstart_rtc_sdk_version"
+
+extern "C" {
+typedef IRtcEngine *(*QuickStartRtcCreateEngineFn)();
+typedef const char *(*QuickStartRtcSdkVersionFn)();
+}
+
+/**
+ * VolcEngineRTC SDK 的按需加载
+ *
+ * 主程序不再在链接期依赖 libVolcEngineRTC.so，SDK 与 VolcRtcEngine 一起编译为插件，
+ * 由这里 dlopen。窗口显示后调用 preloadAsync() 在后台线程加载，
+ * 加入房间前 createEngine() 等待加载完成再创建引擎，通常此时早已加载好。
+ *
+ * 设置环境变量 QUICKSTART_EAGER_SDK_LOAD=1 时在创建窗口前同步加载，
+ * 与改动前链接期加载的启动路径一致，用于对比启动耗时。
+ *
+ * 插件默认从可执行文件所在目录加载，可用 QUICKSTART_RTC_PLUGIN 指定完整路径。
+ * 加载后不会卸载。所有方法线程安全。
+ */
+class RtcSdkLoader {
+public:
+    static RtcSdkLoader &instance();
+
+    static bool eagerLoadRequested();
+
+    /** 在后台线程开始加载，已开始或已完成时直接返回 */
+    void preloadAsync();
+    /** 同步加载（或等待进行中的后台加载），返回是否可用 */
+    bool load();
+    bool loaded() const;
+    /** 后台加载正在进行 */
+    bool loading() const;
+
+    /** 插件不可用时返回 nullptr */
+    std::unique_ptr<IRtcEngine> createEngine();
+    /** 未加载时返回空串 */
+    std::string sdkVersion() const;
+    /** 加载耗时（毫秒），未完成时为 -1 */
+    int loadTimeMs() const;
+    /** 加载失败的原因（dlerror 等），未失败时为空串 */
+    std::string lastError() const;
+
+private:
+    enum class State { Idle, Loading, Loaded, Failed };
+
+    RtcSdkLoader() = default;
+    ~RtcSdkLoader();
+
+    void loadNow();
+    static std::string pluginPath();
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    State m_state = State::Idle;
+    std::thread m_thread;
+    void *m_handle = nullptr;
+    QuickStartRtcCreateEngineFn m_createEngine = nullptr;
+    QuickStartRtcSdkVersionFn m_sdkVersion = nullptr;
+    int m_loadTimeMs = -1;
+    std::string m_error;
+};
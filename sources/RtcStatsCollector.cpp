@@ -0,0 +1,187 @@
+#include "RtcStatsCollector.h"
+#include <algorithm>
+#include <chrono>
+#include "MetricsExporter.h"
+
+namespace {
+
+int64_t steadyMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+// ── RtcStatsRing ──────────────────────────────────────────────────
+
+RtcStatsRing::RtcStatsRing(int capacity)
+        : m_samples(std::max(1, capacity)) {
+}
+
+void RtcStatsRing::push(const RtcStatsSample &sample) {
+    m_samples[m_next] = sample;
+    m_next = (m_next + 1) % static_cast<int>(m_samples.size());
+    m_size = std::min(m_size + 1, static_cast<int>(m_samples.size()));
+}
+
+const RtcStatsSample &RtcStatsRing::at(int index) const {
+    const int capacity = static_cast<int>(m_samples.size());
+    return m_samples[(m_next - m_size + index + capacity) % capacity];
+}
+
+// ── RtcStatsCollector ─────────────────────────────────────────────
+
+RtcStatsCollector::RtcStatsCollector(int historySize)
+        : m_historySize(historySize) {
+}
+
+RtcStatsCollector::Stream &RtcStatsCollector::streamLocked(const std::string &streamId) {
+    auto it = m_streams.find(streamId);
+    if (it == m_streams.end()) {
+        it = m_streams.emplace(streamId, Stream(m_historySize)).first;
+    }
+    return it->second;
+}
+
+void RtcStatsCollector::onNetworkQuality(const RtcNetworkQuality &quality) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_quality = quality;
+    m_hasQuality = true;
+}
+
+RtcStatsSample RtcStatsCollector::toSample(const RtcLocalStreamStats &stats) {
+    RtcStatsSample sample;
+    sample.timeMs = steadyMs();
+    sample.kbps = stats.sentKbps;
+    sample.lossRate = stats.lossRate;
+    sample.rttMs = stats.rttMs;
+    sample.frameRate = stats.encoderOutputFrameRate;
+    sample.width = stats.encodedWidth;
+    sample.height = stats.encodedHeight;
+    return sample;
+}
+
+RtcStatsSample RtcStatsCollector::toSample(const RtcRemoteStreamStats &stats) {
+    RtcStatsSample sample;
+    sample.timeMs = steadyMs();
+    sample.kbps = stats.receivedKbps;
+    sample.lossRate = stats.lossRate;
+    sample.rttMs = stats.rttMs;
+    sample.jitterBufferMs = stats.jitterBufferDelayMs;
+    sample.e2eDelayMs = stats.e2eDelayMs;
+    sample.decodeTimeMs = stats.decodeTimeMs;
+    sample.frameRate = stats.renderFrameRate;
+    sample.width = stats.width;
+    sample.height = stats.height;
+    sample.stallCount = stats.stallCount;
+    return sample;
+}
+
+void RtcStatsCollector::onLocalStreamStats(const RtcLocalStreamStats &stats) {
+    RtcStatsSample sample = toSample(stats);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    streamLocked(std::string()).ring.push(sample);
+}
+
+void RtcStatsCollector::onRemoteStreamStats(const std::string &streamId, const std::string &userId,
+                                            const RtcRemoteStreamStats &stats) {
+    if (streamId.empty()) return;
+
+    RtcStatsSample sample = toSample(stats);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stream &stream = streamLocked(streamId);
+    stream.userId = userId;
+    stream.ring.push(sample);
+}
+
+void RtcStatsCollector::removeStream(const std::string &streamId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_streams.erase(streamId);
+}
+
+void RtcStatsCollector::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_streams.clear();
+    m_quality = RtcNetworkQuality();
+    m_hasQuality = false;
+}
+
+bool RtcStatsCollector::latest(const std::string &streamId, RtcStatsSample &sample) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_streams.find(streamId);
+    if (it == m_streams.end() || it->second.ring.size() == 0) {
+        return false;
+    }
+    sample = it->second.ring.latest();
+    return true;
+}
+
+std::vector<RtcStatsSample> RtcStatsCollector::history(const std::string &streamId) const {
+    std::vector<RtcStatsSample> samples;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_streams.find(streamId);
+    if (it != m_streams.end()) {
+        samples.reserve(it->second.ring.size());
+        for (int i = 0; i < it->second.ring.size(); ++i) {
+            samples.push_back(it->second.ring.at(i));
+        }
+    }
+    return samples;
+}
+
+RtcNetworkQuality RtcStatsCollector::networkQuality() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_quality;
+}
+
+void RtcStatsCollector::exportMetrics(MetricsRecord &record) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_hasQuality) {
+        record.add("rtc.net.tx_quality", m_quality.txQuality);
+        record.add("rtc.net.rx_quality", m_quality.rxQuality);
+        record.add("rtc.net.loss", m_quality.lossRate);
+        record.add("rtc.net.rtt_ms", m_quality.rttMs);
+    }
+
+    for (auto &entry : m_streams) {
+        Stream &stream = entry.second;
+        const RtcStatsRing &ring = stream.ring;
+
+        // 只汇总上次导出之后的新样本，导出间隔长于统计周期时不丢失峰值
+        int count = 0;
+        double kbps = 0, loss = 0, fps = 0, jitterBuffer = 0, e2eDelay = 0, decode = 0;
+        int maxRtt = 0, maxJitterBuffer = 0, stalls = 0;
+        for (int i = 0; i < ring.size(); ++i) {
+            const RtcStatsSample &sample = ring.at(i);
+            if (sample.timeMs <= stream.exportedUntilMs) continue;
+            ++count;
+            kbps += sample.kbps;
+            loss += sample.lossRate;
+            fps += sample.frameRate;
+            jitterBuffer += sample.jitterBufferMs;
+            e2eDelay += sample.e2eDelayMs;
+            decode += sample.decodeTimeMs;
+            maxRtt = std::max(maxRtt, sample.rttMs);
+            maxJitterBuffer = std::max(maxJitterBuffer, sample.jitterBufferMs);
+            stalls += sample.stallCount;
+        }
+        if (count == 0) continue;
+        stream.exportedUntilMs = ring.latest().timeMs;
+
+        const bool local = entry.first.empty();
+        const std::string prefix = local ? "rtc.local." : "rtc.remote." + entry.first + ".";
+        record.add(prefix + (local ? "sent_kbps" : "recv_kbps"), kbps / count);
+        record.add(prefix + "loss", loss / count);
+        record.add(prefix + "rtt_ms_max", maxRtt);
+        record.add(prefix + "fps", fps / count);
+        record.add(prefix + "width", ring.latest().width);
+        record.add(prefix + "height", ring.latest().height);
+        if (!local) {
+            record.add(prefix + "jitter_buffer_ms", jitterBuffer / count);
+            record.add(prefix + "jitter_buffer_ms_max", maxJitterBuffer);
+            record.add(prefix + "e2e_delay_ms", e2eDelay / count);
+            record.add(prefix + "decode_ms", decode / count);
+            record.add(prefix + "stalls", stalls);
+        }
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "RtcBackend.h"
+
+class MetricsRecord;
+
+/** 一个统计周期的流质量样本，本地流与远端流共用 */
+struct RtcStatsSample {
+    int64_t timeMs = 0;          // steady_clock 毫秒
+    float kbps = 0.0f;           // 本地为发送码率，远端为接收码率
+    float lossRate = 0.0f;       // 0~1
+    int rttMs = 0;
+    int jitterBufferMs = 0;      // 仅远端
+    int e2eDelayMs = 0;          // 仅远端
+    float decodeTimeMs = 0.0f;   // 仅远端
+    float frameRate = 0.0f;      // 本地为编码输出帧率，远端为渲染帧率
+    int width = 0;
+    int height = 0;
+    int stallCount = 0;          // 仅远端
+};
+
+/**
+ * 固定容量的统计样本环形缓冲，写满后覆盖最旧的样本，构造后不再分配内存
+ */
+class RtcStatsRing {
+public:
+    explicit RtcStatsRing(int capacity);
+
+    void push(const RtcStatsSample &sample);
+    int size() const { return m_size; }
+    /** 按时间顺序访问，0 为最旧的样本 */
+    const RtcStatsSample &at(int index) const;
+    const RtcStatsSample &latest() const { return at(m_size - 1); }
+
+private:
+    std::vector<RtcStatsSample> m_samples;
+    int m_next = 0;
+    int m_size = 0;
+};
+
+/**
+ * RTC 质量统计汇总
+ *
+ * 接收引擎的本地/远端流统计与网络质量回调（可在 SDK 线程上调用），
+ * 为每条流保存一段固定长度的时间序列。界面按需读取最新样本显示在画面上，
+ * MetricsExporter 导出时汇总上次导出以来的样本（均值与峰值）。
+ *
+ * 本地流的键为空串。所有方法线程安全。
+ */
+class RtcStatsCollector {
+public:
+    explicit RtcStatsCollector(int historySize);
+
+    void onNetworkQuality(const RtcNetworkQuality &quality);
+    void onLocalStreamStats(const RtcLocalStreamStats &stats);
+    void onRemoteStreamStats(const std::string &streamId, const std::string &userId, const RtcRemoteStreamStats &stats);
+
+    /** 把引擎的统计回调转换为样本，时间戳取当前时刻 */
+    static RtcStatsSample toSample(const RtcLocalStreamStats &stats);
+    static RtcStatsSample toSample(const RtcRemoteStreamStats &stats);
+
+    void removeStream(const std::string &streamId);
+    void clear();
+
+    bool latest(const std::string &streamId, RtcStatsSample &sample) const;
+    /** 复制一条流的完整时间序列（按时间顺序） */
+    std::vector<RtcStatsSample> history(const std::string &streamId) const;
+    RtcNetworkQuality networkQuality() const;
+
+    /** MetricsExporter 提供方：rtc.net.*、rtc.local.*、rtc.remote.<streamId>.* */
+    void exportMetrics(MetricsRecord &record);
+
+private:
+    struct Stream {
+        std::string userId;
+        RtcStatsRing ring;
+        int64_t exportedUntilMs = 0;
+
+        explicit Stream(int capacity) : ring(capacity) {}
+    };
+
+    Stream &streamLocked(const std::string &streamId);
+
+    const int m_historySize;
+    mutable std::mutex m_mutex;
+    std::map<std::string, Stream> m_streams;
+    RtcNetworkQuality m_quality;
+    bool m_hasQuality = false;
+};
@@ -0,0 +1,400 @@
+#include "SnapshotCache.h"
+#include "ThreadPolicy.h"
+#include <QByteArray>
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace {
+
+int64_t steadyMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int evenDown(int value) {
+    return std::max(2, value & ~1);
+}
+
+} // namespace
+
+SnapshotConfig SnapshotConfig::fromEnvironment() {
+    SnapshotConfig config;
+    const char *value = std::getenv("QUICKSTART_SNAPSHOT");
+    if (!value) {
+        return config;
+    }
+
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item == "off") config.enabled = false;
+        else if (item.compare(0, 12, "interval_ms=") == 0) config.intervalMs = std::atoi(item.c_str() + 12);
+        else if (item.compare(0, 9, "chunk_kb=") == 0) config.chunkKb = std::atoi(item.c_str() + 9);
+        else if (item.compare(0, 10, "max_width=") == 0) config.maxWidth = std::atoi(item.c_str() + 10);
+        else if (item.compare(0, 5, "keep=") == 0) config.keep = std::atoi(item.c_str() + 5);
+        else if (!item.empty()) qWarning() << "QUICKSTART_SNAPSHOT: unknown option" << item.c_str();
+    }
+
+    config.intervalMs = std::max(0, config.intervalMs);
+    config.chunkKb = std::max(1, std::min(config.chunkKb, 1024));
+    config.maxWidth = std::max(16, config.maxWidth);
+    config.keep = std::max(1, std::min(config.keep, 32));
+    return config;
+}
+
+// ── 帧与通道 ──────────────────────────────────────────────────────
+
+struct SnapshotCache::Frame {
+    std::vector<uint8_t> data;     // 紧密排列的 Y、U、V 平面
+    int width = 0;
+    int height = 0;
+    int64_t capturedMs = 0;
+
+    ImageScale::I420Image image() const {
+        ImageScale::I420Image image;
+        const size_t lumaSize = static_cast<size_t>(width) * height;
+        const int chromaWidth = (width + 1) / 2;
+        const size_t chromaSize = static_cast<size_t>(chromaWidth) * ((height + 1) / 2);
+        image.planes[0] = data.data();
+        image.planes[1] = data.data() + lumaSize;
+        image.planes[2] = data.data() + lumaSize + chromaSize;
+        image.strides[0] = width;
+        image.strides[1] = chromaWidth;
+        image.strides[2] = chromaWidth;
+        image.width = width;
+        image.height = height;
+        return image;
+    }
+};
+
+struct SnapshotCache::Channel {
+    enum State : int {
+        kFree = 0,
+        kClaiming = 1,
+        kActive = 2,
+        kReleasing = 3,    // 流已结束，没有回调在写时可被新的流占用
+    };
+
+    // 低两位为缓冲下标，kFresh 表示生产者放入后还没被读取
+    static constexpr uint32_t kFresh = 4;
+
+    std::atomic<int> state{kFree};
+    char streamId[128] = {};
+    bool isLocal = false;
+    // 正在写这路流的回调数；先加一再检查状态，为 0 时才能把通道交给新的流
+    std::atomic<int> busy{0};
+    // 每次被新的流占用加一，读端据此丢弃上一路流留下的帧
+    std::atomic<uint32_t> epoch{0};
+
+    Frame frames[3];
+    std::atomic<uint32_t> ready{1};
+    std::atomic<int64_t> lastFrameMs{0};
+
+    // 以下只在生产者线程访问
+    uint32_t writeIndex = 0;
+
+    // 以下只在持有 m_mutex 时访问
+    uint32_t readIndex = 2;
+    uint32_t readEpoch = 0;
+    bool hasFrame = false;
+
+    void reset() {
+        ready.store(1, std::memory_order_relaxed);
+        lastFrameMs.store(0, std::memory_order_relaxed);
+        writeIndex = 0;
+        readIndex = 2;
+        hasFrame = false;
+        for (auto &frame : frames) {
+            frame.width = 0;
+            frame.height = 0;
+        }
+        state.store(kFree, std::memory_order_release);
+    }
+};
+
+struct SnapshotCache::Snapshot {
+    std::string id;
+    std::string streamId;
+    int width = 0;
+    int height = 0;
+    int64_t capturedMs = 0;
+    std::vector<uint8_t> jpeg;
+};
+
+// ── SnapshotCache ─────────────────────────────────────────────────
+
+SnapshotCache::SnapshotCache(const SnapshotConfig &config)
+    : m_config(config) {
+    for (auto &channel : m_channels) {
+        channel = std::make_unique<Channel>();
+    }
+    qDebug() << "SnapshotCache: interval" << m_config.intervalMs << "ms, chunk" << m_config.chunkKb << "KB,"
+             << "simd" << ImageScale::hasSimd() << "jpeg" << JpegEncoder::backendName();
+}
+
+SnapshotCache::~SnapshotCache() = default;
+
+void SnapshotCache::onLocalVideoFrame(const RtcVideoFrame &frame) {
+    ThreadPolicy::adoptCurrentThread(ThreadClass::Video, "rtc-video");
+    if (!m_config.enabled || !m_toolRegistered.load(std::memory_order_relaxed)) return;
+    if (Channel *channel = channelFor("local", true)) {
+        store(channel, frame);
+        channel->busy.fetch_sub(1);
+    }
+}
+
+void SnapshotCache::onRemoteVideoFrame(const char *streamId, const char *userId, const RtcVideoFrame &frame) {
+    ThreadPolicy::adoptCurrentThread(ThreadClass::Video, "rtc-video");
+    if (!m_config.enabled || !m_toolRegistered.load(std::memory_order_relaxed)) return;
+    if (Channel *channel = channelFor(streamId ? streamId : "", false)) {
+        store(channel, frame);
+        channel->busy.fetch_sub(1);
+    }
+}
+
+void SnapshotCache::setToolRegistered(bool registered) {
+    m_toolRegistered.store(registered, std::memory_order_relaxed);
+}
+
+void SnapshotCache::releaseStream(const std::string &streamId) {
+    for (auto &channel : m_channels) {
+        if (channel->state.load(std::memory_order_acquire) != Channel::kActive) continue;
+        // 与 channelFor() 相同，计数期间标识稳定
+        channel->busy.fetch_add(1);
+        int expected = Channel::kActive;
+        if (channel->state.load() == Channel::kActive
+            && !channel->isLocal && std::strcmp(channel->streamId, streamId.c_str()) == 0
+            && channel->state.compare_exchange_strong(expected, Channel::kReleasing)) {
+            qDebug() << "SnapshotCache: released stream" << streamId.c_str();
+        }
+        channel->busy.fetch_sub(1);
+    }
+}
+
+SnapshotCache::Channel *SnapshotCache::channelFor(const char *streamId, bool isLocal) {
+    for (auto &channel : m_channels) {
+        if (channel->state.load(std::memory_order_acquire) != Channel::kActive) continue;
+        // 先计数再比较标识：计数之后仍为 kActive，通道就不会被新的流占用，标识也不会被改写
+        channel->busy.fetch_add(1);
+        if (channel->state.load() == Channel::kActive
+            && channel->isLocal == isLocal && std::strcmp(channel->streamId, streamId) == 0) {
+            return channel.get();
+        }
+        channel->busy.fetch_sub(1);
+    }
+
+    // 首次出现的流：占用空闲的通道，或已结束且没有回调在写的通道
+    for (auto &channel : m_channels) {
+        int expected = channel->state.load();
+        if (expected == Channel::kReleasing && channel->busy.load() != 0) continue;
+        if ((expected == Channel::kFree || expected == Channel::kReleasing)
+            && channel->state.compare_exchange_strong(expected, Channel::kClaiming)) {
+            std::snprintf(channel->streamId, sizeof(channel->streamId), "%s", streamId);
+            channel->isLocal = isLocal;
+            // 三个缓冲的分工不变，只丢弃上一路流还没被读取的帧
+            channel->ready.fetch_and(~Channel::kFresh);
+            channel->lastFrameMs.store(0, std::memory_order_relaxed);
+            channel->epoch.fetch_add(1, std::memory_order_release);
+            channel->busy.fetch_add(1);
+            channel->state.store(Channel::kActive, std::memory_order_release);
+            return channel.get();
+        }
+    }
+
+    if (m_droppedFrames.fetch_add(1, std::memory_order_relaxed) == 0) {
+        qWarning() << "SnapshotCache: too many streams, ignoring" << streamId;
+    }
+    return nullptr;
+}
+
+void SnapshotCache::store(Channel *channel, const RtcVideoFrame &frame) {
+    if (frame.format != RtcPixelFormat::I420 || frame.width <= 0 || frame.height <= 0) return;
+
+    int64_t now = steadyMs();
+    int64_t last = channel->lastFrameMs.load(std::memory_order_relaxed);
+    if (last != 0 && now - last < m_config.intervalMs) return;
+
+    Frame &target = channel->frames[channel->writeIndex];
+    const int chromaWidth = (frame.width + 1) / 2;
+    const int chromaHeight = (frame.height + 1) / 2;
+    const size_t lumaSize = static_cast<size_t>(frame.width) * frame.height;
+    const size_t chromaSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+    target.data.resize(lumaSize + chromaSize * 2);
+
+    uint8_t *dst = target.data.data();
+    const int widths[3] = {frame.width, chromaWidth, chromaWidth};
+    const int heights[3] = {frame.height, chromaHeight, chromaHeight};
+    for (int plane = 0; plane < 3; ++plane) {
+        const uint8_t *src = frame.planes[plane];
+        for (int row = 0; row < heights[plane]; ++row) {
+            std::memcpy(dst, src + static_cast<size_t>(row) * frame.strides[plane], widths[plane]);
+            dst += widths[plane];
+        }
+    }
+    target.width = frame.width;
+    target.height = frame.height;
+    target.capturedMs = now;
+
+    channel->writeIndex = channel->ready.exchange(channel->writeIndex | Channel::kFresh,
+                                                  std::memory_order_acq_rel) & 3;
+    channel->lastFrameMs.store(now, std::memory_order_relaxed);
+}
+
+SnapshotCache::Channel *SnapshotCache::selectChannel(const SnapshotRequest &request, std::string &error) {
+    Channel *selected = nullptr;
+    for (auto &channel : m_channels) {
+        if (channel->state.load(std::memory_order_acquire) != Channel::kActive) continue;
+        if (channel->isLocal != !request.remote) continue;
+        if (request.remote && !request.streamId.empty()) {
+            if (request.streamId == channel->streamId) return channel.get();
+            continue;
+        }
+        // 未指定远端流时取最近收到画面的一路
+        if (!selected || channel->lastFrameMs.load(std::memory_order_relaxed)
+                             > selected->lastFrameMs.load(std::memory_order_relaxed)) {
+            selected = channel.get();
+        }
+    }
+    if (!selected) {
+        if (!request.remote) error = "No local video";
+        else if (!request.streamId.empty()) error = "Unknown stream: " + request.streamId;
+        else error = "No remote video";
+    }
+    return selected;
+}
+
+bool SnapshotCache::capture(const SnapshotRequest &request, SnapshotChunk &out, std::string &error) {
+    if (!m_config.enabled) {
+        error = "Snapshots are disabled";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Channel *channel = selectChannel(request, error);
+    if (!channel) return false;
+
+    // 通道换了一路流时，读端缓冲里是上一路流的帧
+    const uint32_t epoch = channel->epoch.load(std::memory_order_acquire);
+    if (channel->readEpoch != epoch) {
+        channel->readEpoch = epoch;
+        channel->hasFrame = false;
+    }
+    if (channel->ready.load(std::memory_order_relaxed) & Channel::kFresh) {
+        channel->readIndex = channel->ready.exchange(channel->readIndex, std::memory_order_acq_rel) & 3;
+        channel->hasFrame = true;
+    }
+    if (!channel->hasFrame) {
+        error = "No frame received yet";
+        return false;
+    }
+    const Frame &frame = channel->frames[channel->readIndex];
+
+    // 等比缩放到请求的宽高以内，不放大，宽高取偶数
+    double scale = 1.0;
+    if (request.width > 0 && request.height > 0) {
+        scale = std::min(static_cast<double>(request.width) / frame.width,
+                         static_cast<double>(request.height) / frame.height);
+    } else if (request.width > 0) {
+        scale = static_cast<double>(request.width) / frame.width;
+    } else if (request.height > 0) {
+        scale = static_cast<double>(request.height) / frame.height;
+    }
+    scale = std::min({scale, 1.0, static_cast<double>(m_config.maxWidth) / frame.width});
+    const int width = std::min(evenDown(static_cast<int>(frame.width * scale)), frame.width & ~1);
+    const int height = std::min(evenDown(static_cast<int>(frame.height * scale)), frame.height & ~1);
+    if (width < 2 || height < 2) {
+        error = "Frame too small";
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    ImageScale::scaleI420(frame.image(), width, height, m_scaled, m_scratch);
+    auto scaled = std::chrono::steady_clock::now();
+
+    ImageScale::I420Image image;
+    image.planes[0] = m_scaled.data();
+    image.planes[1] = m_scaled.data() + static_cast<size_t>(width) * height;
+    image.planes[2] = image.planes[1] + static_cast<size_t>(width / 2) * (height / 2);
+    image.strides[0] = width;
+    image.strides[1] = width / 2;
+    image.strides[2] = width / 2;
+    image.width = width;
+    image.height = height;
+
+    // 淘汰最旧的快照并复用其缓冲
+    std::unique_ptr<Snapshot> snapshot;
+    if (static_cast<int>(m_snapshots.size()) >= m_config.keep) {
+        snapshot = std::move(m_snapshots.front());
+        m_snapshots.pop_front();
+    } else {
+        snapshot = std::make_unique<Snapshot>();
+    }
+    if (!m_encoder.encode(image, std::max(1, std::min(request.quality, 100)), snapshot->jpeg)) {
+        error = "JPEG encoding failed";
+        return false;
+    }
+    auto encoded = std::chrono::steady_clock::now();
+
+    snapshot->id = "snap-" + std::to_string(++m_nextSnapshot);
+    snapshot->streamId = channel->isLocal ? std::string("local") : std::string(channel->streamId);
+    snapshot->width = width;
+    snapshot->height = height;
+    snapshot->capturedMs = frame.capturedMs;
+
+    qDebug() << "SnapshotCache:" << snapshot->id.c_str() << snapshot->streamId.c_str()
+             << frame.width << "x" << frame.height << "->" << width << "x" << height
+             << snapshot->jpeg.size() << "bytes, scale"
+             << std::chrono::duration<double, std::milli>(scaled - start).count() << "ms, encode"
+             << std::chrono::duration<double, std::milli>(encoded - scaled).count() << "ms";
+
+    fillChunk(*snapshot, 0, out);
+    m_snapshots.push_back(std::move(snapshot));
+    return true;
+}
+
+bool SnapshotCache::chunk(const std::string &snapshotId, int index, SnapshotChunk &out, std::string &error) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto &snapshot : m_snapshots) {
+        if (snapshot->id != snapshotId) continue;
+        const size_t chunkBytes = static_cast<size_t>(m_config.chunkKb) * 1024;
+        const int chunks = static_cast<int>((snapshot->jpeg.size() + chunkBytes - 1) / chunkBytes);
+        if (index < 0 || index >= chunks) {
+            error = "Chunk out of range";
+            return false;
+        }
+        fillChunk(*snapshot, index, out);
+        return true;
+    }
+    error = "Unknown or expired snapshot: " + snapshotId;
+    return false;
+}
+
+void SnapshotCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto &channel : m_channels) {
+        channel->reset();
+    }
+    m_snapshots.clear();
+}
+
+void SnapshotCache::fillChunk(const Snapshot &snapshot, int index, SnapshotChunk &out) const {
+    const size_t chunkBytes = static_cast<size_t>(m_config.chunkKb) * 1024;
+    const size_t offset = static_cast<size_t>(index) * chunkBytes;
+    const size_t length = std::min(chunkBytes, snapshot.jpeg.size() - offset);
+
+    out.snapshotId = snapshot.id;
+    out.streamId = snapshot.streamId;
+    out.width = snapshot.width;
+    out.height = snapshot.height;
+    out.bytes = snapshot.jpeg.size();
+    out.chunk = index;
+    out.chunks = static_cast<int>((snapshot.jpeg.size() + chunkBytes - 1) / chunkBytes);
+    out.ageMs = steadyMs() - snapshot.capturedMs;
+    out.data = QByteArray::fromRawData(reinterpret_cast<const char *>(snapshot.jpeg.data() + offset),
+                                       static_cast<int>(length)).toBase64().toStdString();
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "JpegEncoder.h"
+#include "RtcBackend.h"
+
+/**
+ * 摄像头快照配置
+ *
+ * 通过环境变量 QUICKSTART_SNAPSHOT 以逗号分隔的选项覆盖：
+ *   off              不缓存视频帧，camera_snapshot 工具返回错误
+ *   interval_ms=N    每路流缓存帧的最小间隔，默认 200，快照最多比实时画面旧这么久
+ *   chunk_kb=N       每次工具调用返回的 JPEG 分块大小（编码前），默认 32
+ *   max_width=N      输出宽度上限，默认 1920
+ *   keep=N           保留最近 N 张快照供分块读取，默认 4
+ * 例如：QUICKSTART_SNAPSHOT=interval_ms=100,chunk_kb=64
+ */
+struct SnapshotConfig {
+    bool enabled = true;
+    int intervalMs = 200;
+    int chunkKb = 32;
+    int maxWidth = 1920;
+    int keep = 4;
+
+    static SnapshotConfig fromEnvironment();
+};
+
+/** 一次快照请求；width / height 为 0 时按另一边等比缩放，都为 0 时保持原始分辨率 */
+struct SnapshotRequest {
+    bool remote = false;
+    std::string streamId;      // 远端流，空表示最近有画面的那一路
+    int width = 0;
+    int height = 0;
+    int quality = 75;
+};
+
+/** 快照的一个分块，data 为该块 JPEG 数据的 Base64 */
+struct SnapshotChunk {
+    std::string snapshotId;
+    std::string streamId;
+    int width = 0;
+    int height = 0;
+    size_t bytes = 0;          // 整张 JPEG 的字节数
+    int chunk = 0;
+    int chunks = 0;
+    int64_t ageMs = 0;         // 快照画面距今的时间
+    std::string data;
+};
+
+/**
+ * camera_snapshot 工具的帧缓存
+ *
+ * 作为 IRtcVideoFrameObserver 注册到引擎，按 interval_ms 把本地和各路远端的 I420 帧
+ * 拷贝进该流的三缓冲：回调线程写一块、快照读一块、一块存放最新的完整帧，
+ * 两边通过一次原子交换换手，回调路径上没有锁，只在分辨率变大时重新分配。
+ * 工具调用因此不用等待采集，直接取最新帧缩放（ImageScale）并编码（JpegEncoder）。
+ *
+ * 大图按 chunk_kb 分块：首次调用返回第一块和 snapshot_id，调用方再按序号取其余分块，
+ * 每次 MCP 应答都不大，不会长时间占住 MQTT 连接，其他消息可以穿插发送。
+ *
+ * 只有 camera_snapshot 工具注册之后（setToolRegistered）才拷贝帧，没有工具可用时回调直接返回。
+ * 远端流结束时调用 releaseStream()，该通道在没有回调写入后留给之后出现的流。
+ *
+ * capture() / chunk() 在 MCP 工具线程上调用，彼此串行；
+ * clear() 只能在 removeVideoFrameObserver 之后调用。
+ */
+class SnapshotCache : public IRtcVideoFrameObserver {
+public:
+    static constexpr int kMaxStreams = 16;
+
+    explicit SnapshotCache(const SnapshotConfig &config);
+    ~SnapshotCache() override;
+
+    SnapshotCache(const SnapshotCache &) = delete;
+    SnapshotCache &operator=(const SnapshotCache &) = delete;
+
+    void onLocalVideoFrame(const RtcVideoFrame &frame) override;
+    void onRemoteVideoFrame(const char *streamId, const char *userId, const RtcVideoFrame &frame) override;
+
+    /** 取最新帧生成快照并返回第一块，失败时 error 为原因 */
+    bool capture(const SnapshotRequest &request, SnapshotChunk &out, std::string &error);
+    /** 读取已生成快照的第 index 块 */
+    bool chunk(const std::string &snapshotId, int index, SnapshotChunk &out, std::string &error);
+
+    /** 挂断后丢弃缓存的帧和快照 */
+    void clear();
+
+    /** camera_snapshot 工具注册后开始缓存帧，注销后停止；任意线程可调用 */
+    void setToolRegistered(bool registered);
+    /** 远端流结束，归还它占用的通道；任意线程可调用 */
+    void releaseStream(const std::string &streamId);
+
+private:
+    struct Frame;
+    struct Channel;
+    struct Snapshot;
+
+    Channel *channelFor(const char *streamId, bool isLocal);
+    void store(Channel *channel, const RtcVideoFrame &frame);
+    Channel *selectChannel(const SnapshotRequest &request, std::string &error);
+    void fillChunk(const Snapshot &snapshot, int index, SnapshotChunk &out) const;
+
+    const SnapshotConfig m_config;
+    std::unique_ptr<Channel> m_channels[kMaxStreams];
+    std::atomic<uint64_t> m_droppedFrames{0};
+    std::atomic<bool> m_toolRegistered{false};
+
+    std::mutex m_mutex;
+    // 以下由 m_mutex 保护
+    JpegEncoder m_encoder;
+    std::vector<uint8_t> m_scaled;
+    std::vector<uint8_t> m_scratch;
+    std::deque<std::unique_ptr<Snapshot>> m_snapshots;
+    uint64_t m_nextSnapshot = 0;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/**
+ * 有界单生产者/单消费者无锁队列，存放对象指针，满时丢弃最旧的元素
+ *
+ * - push() 只能由生产者线程调用；队列已满时把最旧的元素出队并返回给生产者，
+ *   由生产者负责回收（例如作为下一帧的缓冲），否则返回 nullptr
+ * - pop() 只能由消费者线程调用，队列为空时返回 nullptr
+ *
+ * 生产者丢弃最旧元素与消费者出队都通过对 m_tail 的 CAS 完成，
+ * 因此同一个元素只会被其中一方取得。容量向上取整为 2 的幂。
+ */
+template <typename T>
+class SpscFrameQueue {
+public:
+    explicit SpscFrameQueue(int capacity) {
+        uint64_t size = 1;
+        while (size < static_cast<uint64_t>(capacity < 1 ? 1 : capacity)) {
+            size <<= 1;
+        }
+        m_capacity = size;
+        m_mask = size - 1;
+        m_slots.reset(new std::atomic<T *>[size]);
+        for (uint64_t i = 0; i < size; ++i) {
+            m_slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    SpscFrameQueue(const SpscFrameQueue &) = delete;
+    SpscFrameQueue &operator=(const SpscFrameQueue &) = delete;
+
+    T *push(T *item) {
+        const uint64_t head = m_head.load(std::memory_order_relaxed);
+        T *evicted = nullptr;
+        uint64_t tail = m_tail.load(std::memory_order_acquire);
+        while (head - tail >= m_capacity) {
+            T *oldest = m_slots[tail & m_mask].load(std::memory_order_relaxed);
+            if (m_tail.compare_exchange_weak(tail, tail + 1,
+                                             std::memory_order_acq_rel, std::memory_order_acquire)) {
+                evicted = oldest;
+                break;
+            }
+        }
+        m_slots[head & m_mask].store(item, std::memory_order_relaxed);
+        m_head.store(head + 1, std::memory_order_release);
+        return evicted;
+    }
+
+    T *pop() {
+        uint64_t tail = m_tail.load(std::memory_order_acquire);
+        while (tail != m_head.load(std::memory_order_acquire)) {
+            T *item = m_slots[tail & m_mask].load(std::memory_order_relaxed);
+            if (m_tail.compare_exchange_weak(tail, tail + 1,
+                                             std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return item;
+            }
+        }
+        return nullptr;
+    }
+
+    bool empty() const {
+        return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire);
+    }
+
+    int capacity() const { return static_cast<int>(m_capacity); }
+
+private:
+    uint64_t m_capacity = 0;
+    uint64_t m_mask = 0;
+    std::unique_ptr<std::atomic<T *>[]> m_slots;
+    alignas(64) std::atomic<uint64_t> m_head{0};
+    alignas(64) std::atomic<uint64_t> m_tail{0};
+};
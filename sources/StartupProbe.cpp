@@ -0,0 +1,71 @@
+#include "StartupProbe.h"
+#include "RtcSdkLoader.h"
+#include <QCoreApplication>
+#include <QEvent>
+#include <QTimer>
+#include <QWidget>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <time.h>
+
+namespace StartupProbe {
+
+namespace {
+
+class FirstPaintFilter : public QObject {
+public:
+    explicit FirstPaintFilter(QObject *parent) : QObject(parent) {}
+
+    bool eventFilter(QObject *watched, QEvent *event) override {
+        if (event->type() == QEvent::Paint && !m_painted) {
+            m_painted = true;
+            // 绘制事件之后同一轮会刷新到屏幕，下一轮事件循环再记录时间
+            QTimer::singleShot(0, this, [this] { reportFirstPaint(); });
+        }
+        return QObject::eventFilter(watched, event);
+    }
+
+private:
+    void reportFirstPaint() {
+        std::printf("first_paint_ns=%lld\n", static_cast<long long>(monotonicNs()));
+        std::fflush(stdout);
+        waitForSdk();
+    }
+
+    void waitForSdk() {
+        if (RtcSdkLoader::instance().loading()) {
+            QTimer::singleShot(5, this, [this] { waitForSdk(); });
+            return;
+        }
+        if (RtcSdkLoader::instance().loaded()) {
+            std::printf("sdk_ready_ns=%lld\n", static_cast<long long>(monotonicNs()));
+            std::fflush(stdout);
+        }
+        QCoreApplication::quit();
+    }
+
+    bool m_painted = false;
+};
+
+} // namespace
+
+bool enabled() {
+    const char *value = std::getenv("QUICKSTART_STARTUP_PROBE");
+    return value && value[0] != '\0' && std::strcmp(value, "0") != 0;
+}
+
+void install(QWidget *window) {
+    if (!enabled()) {
+        return;
+    }
+    window->installEventFilter(new FirstPaintFilter(window));
+}
+
+int64_t monotonicNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+} // namespace StartupProbe
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+class QWidget;
+
+/**
+ * 启动耗时探针，供 QuickStart --bench startup 使用
+ *
+ * 设置环境变量 QUICKSTART_STARTUP_PROBE=1 时，窗口第一次绘制完成后向标准输出打印
+ *   first_paint_ns=<CLOCK_MONOTONIC 纳秒>
+ * 若 SDK 正在后台加载，等加载结束后再打印 sdk_ready_ns=...，随后退出事件循环。
+ * 父进程在启动子进程前记录同一时钟，两者相减即为启动到首帧绘制的耗时。
+ */
+namespace StartupProbe {
+
+bool enabled();
+
+/** 在 window 显示前调用，未开启时不做任何事 */
+void install(QWidget *window);
+
+int64_t monotonicNs();
+
+} // namespace StartupProbe
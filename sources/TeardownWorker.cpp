@@ -0,0 +1,113 @@
+#include "TeardownWorker.h"
+#include "ThreadPolicy.h"
+#include <QDebug>
+#include <QMetaObject>
+#include <QObject>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+
+TeardownConfig TeardownConfig::fromEnvironment() {
+    TeardownConfig config;
+    const char *value = std::getenv("QUICKSTART_TEARDOWN");
+    if (!value) {
+        return config;
+    }
+
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.compare(0, 17, "exit_deadline_ms=") == 0) config.exitDeadlineMs = std::atoi(item.c_str() + 17);
+        else if (item.compare(0, 13, "step_warn_ms=") == 0) config.stepWarnMs = std::atoi(item.c_str() + 13);
+        else if (!item.empty()) qWarning() << "QUICKSTART_TEARDOWN: unknown option" << item.c_str();
+    }
+
+    config.exitDeadlineMs = std::max(0, config.exitDeadlineMs);
+    config.stepWarnMs = std::max(0, config.stepWarnMs);
+    return config;
+}
+
+TeardownWorker::TeardownWorker(const TeardownConfig &config)
+        : m_config(config) {
+    m_thread = std::thread(&TeardownWorker::run, this);
+}
+
+TeardownWorker::~TeardownWorker() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cond.notify_all();
+    m_thread.join();
+}
+
+void TeardownWorker::post(const char *name, std::function<void()> step,
+                          QObject *context, std::function<void()> done) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_steps.push_back(Step{name, std::move(step), context, std::move(done)});
+    }
+    m_cond.notify_all();
+}
+
+int TeardownWorker::waitIdle() {
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idleCond.wait(lock, [this] { return m_steps.empty() && !m_running; });
+    return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count());
+}
+
+bool TeardownWorker::idle() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_steps.empty() && !m_running;
+}
+
+void TeardownWorker::run() {
+    ThreadPolicy::registerCurrentThread(ThreadClass::Background, "teardown");
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_cond.wait(lock, [this] { return m_stopping || !m_steps.empty(); });
+        // 退出前也要执行完已提交的步骤
+        if (m_steps.empty()) {
+            break;
+        }
+        Step step = std::move(m_steps.front());
+        m_steps.pop_front();
+        m_running = true;
+        lock.unlock();
+
+        auto start = std::chrono::steady_clock::now();
+        step.run();
+        int elapsedMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count());
+        if (elapsedMs >= m_config.stepWarnMs) {
+            qWarning() << "Teardown:" << step.name.c_str() << "took" << elapsedMs << "ms";
+        } else {
+            qDebug() << "Teardown:" << step.name.c_str() << "done in" << elapsedMs << "ms";
+        }
+        // 投递之后 context 才销毁时，Qt 随对象一起丢弃排队的调用
+        QObject *context = step.context.data();
+        if (context && step.done) {
+            QMetaObject::invokeMethod(context, std::move(step.done), Qt::QueuedConnection);
+        }
+
+        lock.lock();
+        m_running = false;
+        if (m_steps.empty()) {
+            m_idleCond.notify_all();
+        }
+    }
+}
+
+void TeardownWorker::armExitDeadline(int timeoutMs, int exitCode) {
+    if (timeoutMs <= 0) {
+        return;
+    }
+    std::thread([timeoutMs, exitCode] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+        qWarning() << "Teardown: exit deadline of" << timeoutMs << "ms exceeded, terminating";
+        std::_Exit(exitCode);
+    }).detach();
+}
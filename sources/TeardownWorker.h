@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * 后台清理配置
+ *
+ * 通过环境变量 QUICKSTART_TEARDOWN 以 "key=value" 形式覆盖：
+ *   exit_deadline_ms=N   事件循环退出后等待清理完成的最长时间，超时直接结束进程，默认 5000，0 表示不限
+ *   step_warn_ms=N       单步清理超过该时间时输出警告，默认 1000
+ */
+struct TeardownConfig {
+    int exitDeadlineMs = 5000;
+    int stepWarnMs = 1000;
+
+    static TeardownConfig fromEnvironment();
+};
+
+/**
+ * 挂断与关闭窗口时的后台清理线程
+ *
+ * 界面线程只做界面相关的收尾，然后把网络与 SDK 的清理步骤（停止智能体会话、
+ * 断开 MQTT、退出房间、销毁引擎等）提交到这里，立即回到登录界面。
+ *
+ * 顺序保证：
+ * - 所有步骤在同一个线程上按提交顺序逐个执行，前一步返回后才开始下一步
+ * - 步骤的 done 回调在该步执行完后投递到 context 所在线程；context 已销毁则不再调用
+ * - 复用同一资源（如 RTC 引擎）前确认 idle()，否则把后续操作作为空步骤的 done 回调排在清理之后，
+ *   界面线程不必 waitIdle() 等待
+ * - 析构时执行完全部已提交的步骤再退出，进程退出的总时长由 armExitDeadline 兜底
+ */
+class TeardownWorker {
+public:
+    explicit TeardownWorker(const TeardownConfig &config);
+    ~TeardownWorker();
+
+    TeardownWorker(const TeardownWorker &) = delete;
+    TeardownWorker &operator=(const TeardownWorker &) = delete;
+
+    void post(const char *name, std::function<void()> step,
+              QObject *context = nullptr, std::function<void()> done = std::function<void()>());
+
+    /** 等待已提交的步骤全部执行完，返回等待的毫秒数 */
+    int waitIdle();
+    bool idle() const;
+
+    /**
+     * 启动看门狗：timeoutMs 后进程仍未退出则以 exitCode 直接结束进程，
+     * 用于限制退出时等待后台清理与析构的总时长。timeoutMs <= 0 时不启用。
+     */
+    static void armExitDeadline(int timeoutMs, int exitCode);
+
+private:
+    struct Step {
+        std::string name;
+        std::function<void()> run;
+        // context 可能在步骤执行期间被界面线程销毁，执行完后先检查再投递
+        QPointer<QObject> context;
+        std::function<void()> done;
+    };
+
+    void run();
+
+    const TeardownConfig m_config;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::condition_variable m_idleCond;
+    std::deque<Step> m_steps;
+    bool m_running = false;      // 正在执行一步
+    bool m_stopping = false;
+    std::thread m_thread;
+};
@@ -0,0 +1,340 @@
+#include "TelemetryStream.h"
+#include "ThreadPolicy.h"
+#include "MetricsExporter.h"
+#include "MpscEventQueue.h"
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+namespace {
+
+// 发布线程检查缓冲的间隔
+const int kPollMs = 10;
+
+int64_t unixTimeUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void appendInt(std::string &out, int64_t value) {
+    char buffer[24];
+    int length = std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value));
+    out.append(buffer, length);
+}
+
+} // namespace
+
+TelemetryConfig TelemetryConfig::fromEnvironment() {
+    TelemetryConfig config;
+    const char *value = std::getenv("QUICKSTART_TELEMETRY");
+    if (!value) {
+        return config;
+    }
+
+    config.enabled = true;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item == "on") config.enabled = true;
+        else if (item == "off") config.enabled = false;
+        else if (item.compare(0, 6, "topic=") == 0) config.topicPrefix = item.substr(6);
+        else if (item.compare(0, 9, "batch_ms=") == 0) config.batchMs = std::atoi(item.c_str() + 9);
+        else if (item.compare(0, 10, "batch_max=") == 0) config.batchMax = std::atoi(item.c_str() + 10);
+        else if (item.compare(0, 8, "rate_hz=") == 0) config.rateHz = std::atoi(item.c_str() + 8);
+        else if (item.compare(0, 9, "capacity=") == 0) config.capacity = std::atoi(item.c_str() + 9);
+        else if (item.compare(0, 9, "keyframe=") == 0) config.keyframeInterval = std::atoi(item.c_str() + 9);
+        else if (item.compare(0, 13, "synthetic_hz=") == 0) config.syntheticHz = std::atoi(item.c_str() + 13);
+        else if (!item.empty()) qWarning() << "QUICKSTART_TELEMETRY: unknown option" << item.c_str();
+    }
+
+    if (config.topicPrefix.empty()) config.topicPrefix = "$telemetry";
+    config.batchMs = std::max(kPollMs, config.batchMs);
+    config.batchMax = std::max(1, config.batchMax);
+    config.rateHz = std::max(1, std::min(config.rateHz, 1000));
+    config.capacity = std::max(config.batchMax, config.capacity);
+    config.keyframeInterval = std::max(1, config.keyframeInterval);
+    config.syntheticHz = std::max(0, std::min(config.syntheticHz, 10000));
+    return config;
+}
+
+// ── 通道 ──────────────────────────────────────────────────────────
+
+struct TelemetryStream::Channel {
+    std::string name;
+    double scale = 0.001;
+};
+
+// ── TelemetryStream ───────────────────────────────────────────────
+
+TelemetryStream::TelemetryStream(const TelemetryConfig &config)
+    : m_config(config),
+      m_queue(std::make_unique<MpscEventQueue<TelemetrySample>>(config.capacity)),
+      m_channels(new Channel[kMaxChannels]) {
+    m_batch.reserve(m_config.batchMax);
+    m_lastQuantized.resize(kMaxChannels, 0);
+    m_thread = std::thread(&TelemetryStream::run, this);
+    if (m_config.syntheticHz > 0) {
+        m_syntheticThread = std::thread(&TelemetryStream::syntheticLoop, this);
+    }
+    qDebug() << "TelemetryStream: batch" << m_config.batchMs << "ms /" << m_config.batchMax
+             << "samples, rate" << m_config.rateHz << "Hz, capacity" << m_config.capacity;
+}
+
+TelemetryStream::~TelemetryStream() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cond.notify_all();
+    if (m_syntheticThread.joinable()) {
+        m_syntheticThread.join();
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+int TelemetryStream::registerChannel(const std::string &name, double scale) {
+    std::lock_guard<std::mutex> lock(m_channelMutex);
+    const int count = m_channelCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; ++i) {
+        if (m_channels[i].name == name) return i;
+    }
+    if (count >= kMaxChannels) {
+        qWarning() << "TelemetryStream: too many channels, ignoring" << name.c_str();
+        return -1;
+    }
+
+    // 通道名原样写进 JSON，不允许需要转义的字符
+    Channel &channel = m_channels[count];
+    channel.name = name;
+    for (char &c : channel.name) {
+        if (c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20) c = '_';
+    }
+    channel.scale = scale > 0 ? scale : 0.001;
+    m_channelCount.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+bool TelemetryStream::record(int channel, double value, int64_t timestampUs) {
+    if (channel < 0 || channel >= m_channelCount.load(std::memory_order_acquire)) return false;
+    if (!m_attached.load(std::memory_order_relaxed)) {
+        m_discarded.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    TelemetrySample sample;
+    sample.channel = static_cast<uint16_t>(channel);
+    sample.timestampUs = timestampUs ? timestampUs : unixTimeUs();
+    sample.value = value;
+    if (!m_queue->push(std::move(sample))) {
+        return false;
+    }
+    m_recorded.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+uint64_t TelemetryStream::attach(const std::string &agentId, const std::string &clientId, Publisher publisher) {
+    std::lock_guard<std::mutex> lock(m_publishMutex);
+    m_publisher = std::move(publisher);
+    m_topic = m_config.topicPrefix + "/" + agentId + "/" + clientId;
+    m_needKeyframe = true;
+    m_attached.store(true, std::memory_order_relaxed);
+    qDebug() << "TelemetryStream: publishing to" << m_topic.c_str();
+    return ++m_attachToken;
+}
+
+void TelemetryStream::detach(uint64_t token) {
+    std::lock_guard<std::mutex> lock(m_publishMutex);
+    if (token != m_attachToken || !m_publisher) {
+        return;
+    }
+    m_attached.store(false, std::memory_order_relaxed);
+    m_publisher = nullptr;
+}
+
+void TelemetryStream::run() {
+    ThreadPolicy::registerCurrentThread(ThreadClass::Background, "telemetry");
+    using Clock = std::chrono::steady_clock;
+    const auto minInterval = std::chrono::microseconds(1000000 / m_config.rateHz);
+    Clock::time_point lastPublish;
+    Clock::time_point batchStart;
+    bool pending = false;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        m_cond.wait_for(lock, std::chrono::milliseconds(kPollMs), [this] { return m_stopping; });
+        if (m_stopping) break;
+        lock.unlock();
+
+        // 从第一次看到缓冲非空开始计时，攒够时间或数量后在限速允许时发布
+        auto now = Clock::now();
+        const size_t queued = m_queue->size();
+        if (queued > 0 && !pending) {
+            pending = true;
+            batchStart = now;
+        }
+        if (pending && now - lastPublish >= minInterval
+            && (queued >= static_cast<size_t>(m_config.batchMax)
+                || now - batchStart >= std::chrono::milliseconds(m_config.batchMs))) {
+            m_batch.clear();
+            m_queue->consume([this](const TelemetrySample &sample) {
+                m_batch.push_back(sample);
+            }, m_config.batchMax);
+            if (!m_batch.empty()) {
+                publishBatch(m_batch, unixTimeUs());
+                lastPublish = now;
+            }
+            // 限速时缓冲里可能还有积压，从现在起重新计时
+            pending = m_queue->size() > 0;
+            batchStart = now;
+        }
+
+        lock.lock();
+    }
+}
+
+void TelemetryStream::publishBatch(const std::vector<TelemetrySample> &batch, int64_t nowUs) {
+    int64_t oldestUs = batch.front().timestampUs;
+    for (const auto &sample : batch) {
+        oldestUs = std::min(oldestUs, sample.timestampUs);
+    }
+    const int64_t lagMs = std::max<int64_t>(0, (nowUs - oldestUs) / 1000);
+    m_lastLagMs.store(lagMs, std::memory_order_relaxed);
+    if (lagMs > m_maxLagMs.load(std::memory_order_relaxed)) {
+        m_maxLagMs.store(lagMs, std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lock(m_publishMutex);
+    if (!m_publisher) {
+        // 断开与 detach 之间取出的样本
+        m_discarded.fetch_add(batch.size(), std::memory_order_relaxed);
+        return;
+    }
+
+    const bool keyframe = m_needKeyframe || m_seq % m_config.keyframeInterval == 0;
+    const int channelCount = m_channelCount.load(std::memory_order_acquire);
+    if (keyframe) {
+        std::fill(m_lastQuantized.begin(), m_lastQuantized.end(), 0);
+        m_announcedChannels = 0;
+    }
+
+    std::string &out = m_payload;
+    out.clear();
+    out += "{\"jsonrpc\":\"2.0\",\"method\":\"telemetry\",\"params\":{\"seq\":";
+    appendInt(out, static_cast<int64_t>(m_seq));
+    out += keyframe ? ",\"keyframe\":true,\"t0\":" : ",\"keyframe\":false,\"t0\":";
+    appendInt(out, batch.front().timestampUs);
+
+    if (m_announcedChannels < channelCount) {
+        out += ",\"channels\":[";
+        for (int i = m_announcedChannels; i < channelCount; ++i) {
+            char scale[32];
+            std::snprintf(scale, sizeof(scale), "%.9g", m_channels[i].scale);
+            if (i > m_announcedChannels) out += ',';
+            out += "{\"id\":";
+            appendInt(out, i);
+            out += ",\"name\":\"";
+            out += m_channels[i].name;
+            out += "\",\"scale\":";
+            out += scale;
+            out += '}';
+        }
+        out += ']';
+        m_announcedChannels = channelCount;
+    }
+
+    out += ",\"samples\":[";
+    int64_t previousUs = batch.front().timestampUs;
+    bool first = true;
+    for (const auto &sample : batch) {
+        const Channel &channel = m_channels[sample.channel];
+        const int64_t quantized = std::llround(sample.value / channel.scale);
+        if (!first) out += ',';
+        first = false;
+        appendInt(out, sample.channel);
+        out += ',';
+        appendInt(out, sample.timestampUs - previousUs);
+        out += ',';
+        appendInt(out, quantized - m_lastQuantized[sample.channel]);
+        previousUs = sample.timestampUs;
+        m_lastQuantized[sample.channel] = quantized;
+    }
+    out += "],\"dropped\":";
+    appendInt(out, static_cast<int64_t>(m_queue->dropped()));
+    out += ",\"lag_ms\":";
+    appendInt(out, lagMs);
+    out += "}}";
+
+    // 发布失败时接收方会看到 seq 跳变，下一批改发关键批让基准重新对齐
+    ++m_seq;
+    if (m_publisher(m_topic, out)) {
+        m_needKeyframe = false;
+        m_published.fetch_add(batch.size(), std::memory_order_relaxed);
+        m_batches.fetch_add(1, std::memory_order_relaxed);
+        m_bytes.fetch_add(out.size(), std::memory_order_relaxed);
+    } else {
+        m_needKeyframe = true;
+        m_publishFailures.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void TelemetryStream::syntheticLoop() {
+    ThreadPolicy::registerCurrentThread(ThreadClass::Background, "telemetry-synth");
+    // 6 轴关节、IMU 与温度，正弦波加少量抖动
+    int joints[6];
+    for (int i = 0; i < 6; ++i) {
+        joints[i] = registerChannel("joint." + std::to_string(i) + ".position", 0.0001);
+    }
+    const int accelX = registerChannel("imu.accel_x", 0.001);
+    const int accelY = registerChannel("imu.accel_y", 0.001);
+    const int accelZ = registerChannel("imu.accel_z", 0.001);
+    const int gyroZ = registerChannel("imu.gyro_z", 0.0001);
+    const int temperature = registerChannel("env.temperature", 0.01);
+
+    const auto period = std::chrono::microseconds(1000000 / m_config.syntheticHz);
+    auto next = std::chrono::steady_clock::now();
+    uint64_t tick = 0;
+    uint32_t seed = 12345;
+    auto noise = [&seed]() { seed = seed * 1664525u + 1013904223u; return (int(seed >> 24) - 128) / 12800.0; };
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        next += period;
+        if (m_cond.wait_until(lock, next, [this] { return m_stopping; })) break;
+        lock.unlock();
+
+        const double t = static_cast<double>(tick++) / m_config.syntheticHz;
+        const int64_t now = unixTimeUs();
+        for (int i = 0; i < 6; ++i) {
+            record(joints[i], 0.8 * std::sin(t * (0.5 + 0.1 * i)), now);
+        }
+        record(accelX, 0.2 * std::sin(t * 3.0) + noise(), now);
+        record(accelY, 0.2 * std::cos(t * 3.0) + noise(), now);
+        record(accelZ, 9.81 + noise(), now);
+        record(gyroZ, 0.05 * std::sin(t), now);
+        if (tick % static_cast<uint64_t>(std::max(1, m_config.syntheticHz)) == 0) {
+            record(temperature, 36.5 + 0.5 * std::sin(t / 60.0), now);
+        }
+
+        lock.lock();
+    }
+}
+
+void TelemetryStream::exportMetrics(MetricsRecord &record) {
+    record.add("telemetry.recorded", static_cast<double>(m_recorded.load(std::memory_order_relaxed)));
+    record.add("telemetry.published", static_cast<double>(m_published.load(std::memory_order_relaxed)));
+    record.add("telemetry.batches", static_cast<double>(m_batches.load(std::memory_order_relaxed)));
+    record.add("telemetry.bytes", static_cast<double>(m_bytes.load(std::memory_order_relaxed)));
+    record.add("telemetry.dropped", static_cast<double>(m_queue->dropped()));
+    record.add("telemetry.discarded", static_cast<double>(m_discarded.load(std::memory_order_relaxed)));
+    record.add("telemetry.publish_failures", static_cast<double>(m_publishFailures.load(std::memory_order_relaxed)));
+    record.add("telemetry.backlog", static_cast<double>(m_queue->size()));
+    record.add("telemetry.lag_ms", static_cast<double>(m_lastLagMs.load(std::memory_order_relaxed)));
+    // 峰值只统计上次导出以来
+    record.add("telemetry.max_lag_ms", static_cast<double>(m_maxLagMs.exchange(0, std::memory_order_relaxed)));
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class MetricsRecord;
+template <typename T> class MpscEventQueue;
+
+/**
+ * 遥测上报配置
+ *
+ * 通过环境变量 QUICKSTART_TELEMETRY 以逗号分隔的选项开启：
+ *   on               使用默认参数开启
+ *   topic=PREFIX     发布主题前缀，实际主题为 PREFIX/{agentId}/{clientId}，默认 $telemetry
+ *   batch_ms=N       最长攒批时间，默认 100
+ *   batch_max=N      单批最多样本数，攒够即发布，默认 512
+ *   rate_hz=N        每秒最多发布的批数，默认 20，超出时样本在缓冲中排队
+ *   capacity=N       样本缓冲容量，默认 8192，满时丢弃新样本
+ *   keyframe=N       每 N 批发送一次绝对值（关键批），默认 50
+ *   synthetic_hz=N   内置的模拟传感器按该频率产生样本，用于联调，默认 0（关闭）
+ * 例如：QUICKSTART_TELEMETRY=batch_ms=50,rate_hz=10,synthetic_hz=200
+ */
+struct TelemetryConfig {
+    bool enabled = false;
+    std::string topicPrefix = "$telemetry";
+    int batchMs = 100;
+    int batchMax = 512;
+    int rateHz = 20;
+    int capacity = 8192;
+    int keyframeInterval = 50;
+    int syntheticHz = 0;
+
+    static TelemetryConfig fromEnvironment();
+};
+
+/** 一个遥测样本；timestampUs 为 Unix 时间（微秒） */
+struct TelemetrySample {
+    uint16_t channel = 0;
+    int64_t timestampUs = 0;
+    double value = 0;
+};
+
+/**
+ * 传感器遥测上报
+ *
+ * 关节、IMU、环境等读数由各采集线程调用 record() 写入预分配的无锁 MPSC 缓冲
+ * （MpscEventQueue），不加锁、不分配内存，缓冲满时丢弃并计数。
+ * 发布线程按 batch_ms / batch_max 攒批，受 rate_hz 限速，
+ * 把一批样本编码为一条 JSON-RPC 通知发布到独立主题，不经过智能体协议的 publishToAgent：
+ *
+ *   {"jsonrpc":"2.0","method":"telemetry","params":{
+ *      "seq":N, "keyframe":true|false, "t0":首个样本时间,
+ *      "channels":[{"id":0,"name":"imu.accel_x","scale":0.001}, ...],   // 仅关键批或有新通道时
+ *      "samples":[通道, 时间差, 值差, 通道, 时间差, 值差, ...],
+ *      "dropped":累计丢弃数, "lag_ms":本批最旧样本的等待时间}}
+ *
+ * 差分编码：值按通道的 scale 量化为整数，与该通道上一次发布的量化值相减；
+ * 时间为与本批上一个样本的微秒差（首个样本为 0）。关键批开始时各通道的基准重置为 0，
+ * 每个通道的首个样本即为绝对值；seq 不连续（QoS 0 丢包）时接收方丢弃到下一个关键批为止。
+ *
+ * 发布线程每 10 毫秒检查一次缓冲，不需要采集线程唤醒。
+ * 发布函数由 AgentClient 在连接后 attach()，断开前 detach()；未连接期间的样本直接丢弃。
+ * registerChannel() / record() 可在任意线程调用。
+ */
+class TelemetryStream {
+public:
+    using Publisher = std::function<bool(const std::string &topic, const std::string &payload)>;
+
+    static constexpr int kMaxChannels = 1024;
+
+    explicit TelemetryStream(const TelemetryConfig &config);
+    ~TelemetryStream();
+
+    TelemetryStream(const TelemetryStream &) = delete;
+    TelemetryStream &operator=(const TelemetryStream &) = delete;
+
+    const TelemetryConfig &config() const { return m_config; }
+
+    /**
+     * 注册通道，同名通道返回已有的 id；scale 为量化精度（如 0.001 表示保留三位小数）。
+     * 通道数超过 kMaxChannels 时返回 -1。
+     */
+    int registerChannel(const std::string &name, double scale = 0.001);
+
+    /** 写入一个样本，timestampUs 为 0 时取当前时间；缓冲满时返回 false */
+    bool record(int channel, double value, int64_t timestampUs = 0);
+
+    /**
+     * 开始发布，替换之前的发布函数，下一批为关键批。
+     * 返回的标识交给 detach()：挂断后旧会话在后台断开时，不会误摘下一次通话的发布函数。
+     */
+    uint64_t attach(const std::string &agentId, const std::string &clientId, Publisher publisher);
+    /** 仍是 token 对应的发布函数时摘除，返回后它不会再被调用 */
+    void detach(uint64_t token);
+
+    void exportMetrics(MetricsRecord &record);
+
+private:
+    struct Channel;
+
+    void run();
+    void syntheticLoop();
+    void publishBatch(const std::vector<TelemetrySample> &batch, int64_t nowUs);
+
+    const TelemetryConfig m_config;
+    std::unique_ptr<MpscEventQueue<TelemetrySample>> m_queue;
+
+    // 通道表只追加：写入者持有 m_channelMutex 填好条目后再增加 m_channelCount
+    std::unique_ptr<Channel[]> m_channels;
+    std::atomic<int> m_channelCount{0};
+    std::mutex m_channelMutex;
+
+    std::atomic<bool> m_attached{false};
+    std::atomic<uint64_t> m_recorded{0};
+    std::atomic<uint64_t> m_discarded{0};        // 未连接期间丢弃的样本
+    std::atomic<uint64_t> m_published{0};        // 已发布的样本
+    std::atomic<uint64_t> m_batches{0};
+    std::atomic<uint64_t> m_bytes{0};
+    std::atomic<uint64_t> m_publishFailures{0};
+    std::atomic<int64_t> m_lastLagMs{0};
+    std::atomic<int64_t> m_maxLagMs{0};
+
+    // 发布函数与编码状态，由 m_publishMutex 保护
+    std::mutex m_publishMutex;
+    Publisher m_publisher;
+    uint64_t m_attachToken = 0;
+    std::string m_topic;
+    uint64_t m_seq = 0;
+    bool m_needKeyframe = true;
+    int m_announcedChannels = 0;
+    std::vector<int64_t> m_lastQuantized;     // 各通道上一次发布的量化值
+    std::string m_payload;
+
+    // 只在发布线程访问
+    std::vector<TelemetrySample> m_batch;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_stopping = false;
+    std::thread m_thread;
+    std::thread m_syntheticThread;
+};
@@ -0,0 +1,449 @@
+#include "ThreadPolicy.h"
+#include "MetricsExporter.h"
+#include <QDebug>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+const char *const kClassNames[kThreadClassCount] = {"ui", "mqtt", "audio", "video", "background"};
+
+thread_local bool t_registered = false;
+// 线程退出时置位，之后（其它 thread_local 析构中）再进入回调也不重新登记
+thread_local bool t_exited = false;
+
+pid_t currentThreadId() {
+    return static_cast<pid_t>(syscall(SYS_gettid));
+}
+
+/** "0-3,6" 或 "0-3+6" 形式的核心列表 */
+bool parseCpuList(const std::string &text, char separator, std::vector<int> &cpus) {
+    std::stringstream ss(text);
+    std::string part;
+    while (std::getline(ss, part, separator)) {
+        if (part.empty()) continue;
+        char *end = nullptr;
+        long first = std::strtol(part.c_str(), &end, 10);
+        long last = first;
+        if (end == part.c_str()) return false;
+        if (*end == '-') {
+            const char *next = end + 1;
+            last = std::strtol(next, &end, 10);
+            if (end == next) return false;
+        }
+        if (*end != '\0' && *end != '\n') return false;
+        if (first < 0 || last < first || last >= CPU_SETSIZE) return false;
+        for (long cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return !cpus.empty();
+}
+
+bool readFile(const char *path, char *buf, size_t size) {
+    FILE *fp = std::fopen(path, "r");
+    if (!fp) return false;
+    size_t len = std::fread(buf, 1, size - 1, fp);
+    std::fclose(fp);
+    buf[len] = '\0';
+    return len > 0;
+}
+
+uint32_t readCpuValue(int cpu, const char *file) {
+    char path[128];
+    char buf[32];
+    std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/%s", cpu, file);
+    if (!readFile(path, buf, sizeof(buf))) return 0;
+    return static_cast<uint32_t>(std::strtoul(buf, nullptr, 10));
+}
+
+int findClass(const std::string &name) {
+    for (int i = 0; i < kThreadClassCount; ++i) {
+        if (name == kClassNames[i]) return i;
+    }
+    return -1;
+}
+
+struct ThreadEntry {
+    pid_t tid = 0;
+    ThreadClass threadClass = ThreadClass::Background;
+    std::string baseName;
+    size_t suffix = 0;          // 在同名线程中的序号，0 表示不加后缀
+    std::string name;
+    std::string metricPrefix;   // "threads.<名称>."
+
+    bool sampled = false;
+    uint64_t lastTicks = 0;
+    std::chrono::steady_clock::time_point lastTime;
+    int lastCpu = -1;
+    uint64_t observedMigrations = 0;
+};
+
+/** 进程内唯一的登记表，不释放（退出时其它线程可能仍在登记） */
+struct Registry {
+    std::mutex mutex;
+    ThreadPolicyConfig config;
+    bool installed = false;
+    bool warned[kThreadClassCount] = {};
+    std::vector<ThreadEntry> threads;
+    // 每个名称下正在使用的序号，线程退出时释放，新线程取最小的空闲序号
+    std::map<std::string, std::vector<bool>> suffixes;
+    long ticksPerSecond = sysconf(_SC_CLK_TCK);
+
+    static Registry &instance() {
+        static Registry *registry = new Registry;
+        return *registry;
+    }
+};
+
+void warnOnce(Registry &registry, ThreadClass threadClass, const char *what, int error) {
+    bool &warned = registry.warned[static_cast<int>(threadClass)];
+    if (warned) return;
+    warned = true;
+    qWarning() << "ThreadPolicy:" << threadClassName(threadClass) << what << "failed:" << strerror(error);
+}
+
+/** 在 registry.mutex 下调用；tid 可以是其他线程 */
+void applyPolicy(Registry &registry, pid_t tid, ThreadClass threadClass) {
+    const ThreadClassPolicy &policy = registry.config.policy(threadClass);
+    if (!policy.configured()) return;
+
+    if (policy.cores != ThreadClassPolicy::Cores::Any) {
+        const CpuTopology &topology = ThreadPolicy::topology();
+        const std::vector<int> &cpus = policy.cores == ThreadClassPolicy::Cores::Big ? topology.big
+                                     : policy.cores == ThreadClassPolicy::Cores::Little ? topology.little
+                                     : policy.cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus) {
+            CPU_SET(cpu, &set);
+        }
+        if (CPU_COUNT(&set) > 0 && sched_setaffinity(tid, sizeof(set), &set) != 0) {
+            warnOnce(registry, threadClass, "sched_setaffinity", errno);
+        }
+    }
+
+    if (policy.fifoPriority > 0) {
+        sched_param param{};
+        param.sched_priority = policy.fifoPriority;
+        if (sched_setscheduler(tid, SCHED_FIFO, &param) != 0) {
+            warnOnce(registry, threadClass, "SCHED_FIFO", errno);
+        }
+    }
+    // Linux 上 nice 按线程生效；SCHED_FIFO 设置失败时 nice 仍然有用
+    if (policy.hasNice && setpriority(PRIO_PROCESS, static_cast<id_t>(tid), policy.nice) != 0) {
+        warnOnce(registry, threadClass, "setpriority", errno);
+    }
+}
+
+/** 线程退出时移除自己的登记并释放序号，登记表只保留存活的线程 */
+struct EntryOwner {
+    pid_t tid = 0;
+
+    ~EntryOwner() {
+        t_exited = true;
+        if (tid == 0) return;
+        Registry &registry = Registry::instance();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        auto it = std::find_if(registry.threads.begin(), registry.threads.end(),
+                               [&](const ThreadEntry &entry) { return entry.tid == tid; });
+        if (it == registry.threads.end()) return;
+        std::vector<bool> &used = registry.suffixes[it->baseName];
+        used[it->suffix] = false;
+        while (!used.empty() && !used.back()) {
+            used.pop_back();
+        }
+        if (used.empty()) {
+            registry.suffixes.erase(it->baseName);
+        }
+        registry.threads.erase(it);
+    }
+};
+
+thread_local EntryOwner t_entry;
+
+void addThread(ThreadClass threadClass, const char *name, bool rename) {
+    if (t_registered || t_exited) return;
+    t_registered = true;
+
+    const pid_t tid = currentThreadId();
+    // 主线程的名字就是进程名（ps / pkill 看到的），不改
+    if (rename && tid != getpid()) {
+        char shortName[16];
+        std::snprintf(shortName, sizeof(shortName), "%s", name);
+        pthread_setname_np(pthread_self(), shortName);
+    }
+
+    Registry &registry = Registry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    // 同名且同时存活的线程（多个 SDK 回调线程）加序号区分；重建的采集线程沿用已退出线程释放的序号
+    std::vector<bool> &used = registry.suffixes[name];
+    const size_t suffix = static_cast<size_t>(std::find(used.begin(), used.end(), false) - used.begin());
+    if (suffix == used.size()) {
+        used.push_back(true);
+    } else {
+        used[suffix] = true;
+    }
+
+    ThreadEntry entry;
+    entry.tid = tid;
+    entry.threadClass = threadClass;
+    entry.baseName = name;
+    entry.suffix = suffix;
+    entry.name = suffix == 0 ? entry.baseName : entry.baseName + "-" + std::to_string(suffix + 1);
+    entry.metricPrefix = "threads." + entry.name + ".";
+    registry.threads.push_back(std::move(entry));
+    t_entry.tid = tid;
+
+    if (registry.installed) {
+        applyPolicy(registry, tid, threadClass);
+    }
+}
+
+/**
+ * 读 /proc/self/task/TID/stat 中的 utime + stime 与当前所在核心（第 39 个字段）。
+ * 线程已退出时返回 false。
+ */
+bool readThreadStat(pid_t tid, uint64_t &ticks, int &cpu) {
+    char path[64];
+    char buf[1024];
+    std::snprintf(path, sizeof(path), "/proc/self/task/%d/stat", static_cast<int>(tid));
+    if (!readFile(path, buf, sizeof(buf))) return false;
+
+    // comm 字段可能包含空格，从最后一个 ')' 之后开始解析
+    const char *p = std::strrchr(buf, ')');
+    if (!p) return false;
+
+    unsigned long long utime = 0, stime = 0;
+    int processor = -1;
+    int matched = std::sscanf(p + 2,
+                              "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu"
+                              " %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s"
+                              " %*s %*s %*s %*s %*s %*s %*s %*s %d",
+                              &utime, &stime, &processor);
+    if (matched < 2) return false;
+    ticks = utime + stime;
+    cpu = matched == 3 ? processor : -1;
+    return true;
+}
+
+/** /proc/self/task/TID/sched 中的 se.nr_migrations，内核未开启 CONFIG_SCHED_DEBUG 时没有 */
+bool readMigrations(pid_t tid, uint64_t &migrations) {
+    char path[64];
+    char buf[4096];
+    std::snprintf(path, sizeof(path), "/proc/self/task/%d/sched", static_cast<int>(tid));
+    if (!readFile(path, buf, sizeof(buf))) return false;
+
+    const char *line = std::strstr(buf, "nr_migrations");
+    if (!line) return false;
+    const char *colon = std::strchr(line, ':');
+    if (!colon) return false;
+    migrations = std::strtoull(colon + 1, nullptr, 10);
+    return true;
+}
+
+} // namespace
+
+const char *threadClassName(ThreadClass threadClass) {
+    return kClassNames[static_cast<int>(threadClass)];
+}
+
+// ── 配置 ─────────────────────────────────────────────────────────
+
+bool ThreadPolicyConfig::configured() const {
+    return std::any_of(std::begin(classes), std::end(classes),
+                       [](const ThreadClassPolicy &policy) { return policy.configured(); });
+}
+
+ThreadPolicyConfig ThreadPolicyConfig::fromEnvironment() {
+    ThreadPolicyConfig config;
+    const char *value = std::getenv("QUICKSTART_THREADS");
+    if (!value) {
+        return config;
+    }
+
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) continue;
+        const size_t eq = item.find('=');
+        const std::string key = item.substr(0, eq);
+        const std::string arg = eq == std::string::npos ? std::string() : item.substr(eq + 1);
+        const size_t underscore = key.find('_');
+        const int index = findClass(key.substr(0, underscore));
+        if (index < 0 || eq == std::string::npos) {
+            qWarning() << "QUICKSTART_THREADS: unknown option" << item.c_str();
+            continue;
+        }
+
+        ThreadClassPolicy &policy = config.classes[index];
+        const std::string option = underscore == std::string::npos ? std::string() : key.substr(underscore + 1);
+        if (option.empty()) {
+            policy.cpus.clear();
+            if (arg == "big") policy.cores = ThreadClassPolicy::Cores::Big;
+            else if (arg == "little") policy.cores = ThreadClassPolicy::Cores::Little;
+            else if (arg == "all") policy.cores = ThreadClassPolicy::Cores::Any;
+            else if (parseCpuList(arg, '+', policy.cpus)) policy.cores = ThreadClassPolicy::Cores::List;
+            else qWarning() << "QUICKSTART_THREADS: invalid cores" << item.c_str();
+        } else if (option == "nice") {
+            policy.hasNice = true;
+            policy.nice = std::max(-20, std::min(std::atoi(arg.c_str()), 19));
+        } else if (option == "fifo") {
+            policy.fifoPriority = std::max(0, std::min(std::atoi(arg.c_str()), 99));
+        } else {
+            qWarning() << "QUICKSTART_THREADS: unknown option" << item.c_str();
+        }
+    }
+    return config;
+}
+
+// ── 核心拓扑 ─────────────────────────────────────────────────────
+
+bool CpuTopology::isLittle(int cpu) const {
+    return heterogeneous() && std::binary_search(little.begin(), little.end(), cpu);
+}
+
+std::string CpuTopology::describe() const {
+    auto list = [](const std::vector<int> &cpus) {
+        std::string text;
+        for (int cpu : cpus) {
+            if (!text.empty()) text += ',';
+            text += std::to_string(cpu);
+        }
+        return text;
+    };
+    if (!heterogeneous()) {
+        return std::to_string(online.size()) + " cores, homogeneous";
+    }
+    return "big " + list(big) + " / little " + list(little);
+}
+
+CpuTopology CpuTopology::detect() {
+    CpuTopology topology;
+    char buf[256];
+    if (!readFile("/sys/devices/system/cpu/online", buf, sizeof(buf))
+            || !parseCpuList(buf, ',', topology.online)) {
+        const long count = sysconf(_SC_NPROCESSORS_ONLN);
+        for (long cpu = 0; cpu < std::max(1L, count); ++cpu) {
+            topology.online.push_back(static_cast<int>(cpu));
+        }
+    }
+
+    topology.capacity.assign(topology.online.back() + 1, 0);
+    for (int cpu : topology.online) {
+        uint32_t capacity = readCpuValue(cpu, "cpu_capacity");
+        if (capacity == 0) {
+            capacity = readCpuValue(cpu, "cpufreq/cpuinfo_max_freq");
+        }
+        topology.capacity[cpu] = capacity;
+    }
+
+    uint32_t lowest = UINT32_MAX;
+    for (int cpu : topology.online) {
+        if (topology.capacity[cpu] > 0) lowest = std::min(lowest, topology.capacity[cpu]);
+    }
+    for (int cpu : topology.online) {
+        // 读不到算力的核心当作大核，不把线程限制到可能不存在的小核上
+        if (lowest != UINT32_MAX && topology.capacity[cpu] == lowest) topology.little.push_back(cpu);
+        else topology.big.push_back(cpu);
+    }
+    if (topology.big.empty() || topology.little.empty()) {
+        topology.big = topology.online;
+        topology.little = topology.online;
+    }
+    return topology;
+}
+
+// ── 登记与放置 ───────────────────────────────────────────────────
+
+const CpuTopology &ThreadPolicy::topology() {
+    static const CpuTopology topology = CpuTopology::detect();
+    return topology;
+}
+
+void ThreadPolicy::install(const ThreadPolicyConfig &config) {
+    qInfo() << "ThreadPolicy: cpu topology" << topology().describe().c_str();
+    if (!config.configured()) {
+        return;
+    }
+
+    Registry &registry = Registry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.config = config;
+    registry.installed = true;
+    for (const ThreadEntry &entry : registry.threads) {
+        applyPolicy(registry, entry.tid, entry.threadClass);
+    }
+}
+
+void ThreadPolicy::registerCurrentThread(ThreadClass threadClass, const char *name) {
+    addThread(threadClass, name, true);
+}
+
+void ThreadPolicy::adoptCurrentThread(ThreadClass threadClass, const char *name) {
+    addThread(threadClass, name, false);
+}
+
+void ThreadPolicy::exportMetrics(MetricsRecord &record) {
+    Registry &registry = Registry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    const CpuTopology &cores = topology();
+    const auto now = std::chrono::steady_clock::now();
+
+    for (auto it = registry.threads.begin(); it != registry.threads.end();) {
+        ThreadEntry &entry = *it;
+        uint64_t ticks = 0;
+        int cpu = -1;
+        // 正在退出的线程读不到，登记由它自己的 EntryOwner 移除
+        if (!readThreadStat(entry.tid, ticks, cpu)) {
+            ++it;
+            continue;
+        }
+
+        if (entry.sampled && cpu >= 0 && entry.lastCpu >= 0 && cpu != entry.lastCpu) {
+            ++entry.observedMigrations;
+        }
+        if (entry.sampled && registry.ticksPerSecond > 0) {
+            const double seconds = std::chrono::duration<double>(now - entry.lastTime).count();
+            if (seconds > 0.0) {
+                const double cpuSeconds = static_cast<double>(ticks - entry.lastTicks) / registry.ticksPerSecond;
+                record.add(entry.metricPrefix + "cpu_percent", 100.0 * cpuSeconds / seconds);
+            }
+        }
+        if (registry.ticksPerSecond > 0) {
+            record.add(entry.metricPrefix + "cpu_s", static_cast<double>(ticks) / registry.ticksPerSecond);
+        }
+        if (cpu >= 0) {
+            record.add(entry.metricPrefix + "cpu", cpu);
+            if (cores.heterogeneous()) {
+                record.add(entry.metricPrefix + "on_little", cores.isLittle(cpu) ? 1.0 : 0.0);
+            }
+        }
+        uint64_t migrations = 0;
+        if (!readMigrations(entry.tid, migrations)) {
+            migrations = entry.observedMigrations;
+        }
+        record.add(entry.metricPrefix + "migrations", static_cast<double>(migrations));
+
+        entry.sampled = true;
+        entry.lastTicks = ticks;
+        entry.lastTime = now;
+        entry.lastCpu = cpu;
+        ++it;
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class MetricsRecord;
+
+/** 线程类别，同一类别的线程使用同一套放置策略 */
+enum class ThreadClass : uint8_t {
+    Ui,           // Qt 界面线程
+    Mqtt,         // Paho 回调线程；MCP 工具也在其上同步执行，不单独成类
+    Audio,        // 音频采集 / 播放 / 处理，包括 SDK 的音频回调线程
+    Video,        // 视频采集 / 渲染 / 取帧，包括 SDK 的视频回调线程
+    Background,   // 指标导出、追踪落盘、遥测等后台线程
+};
+
+constexpr int kThreadClassCount = 5;
+
+/** 类别在配置与日志中的名称：ui / mqtt / audio / video / background */
+const char *threadClassName(ThreadClass threadClass);
+
+/** 一个线程类别的放置策略 */
+struct ThreadClassPolicy {
+    enum class Cores {
+        Any,      // 不设置亲和性
+        Big,      // 除最慢一档以外的核心
+        Little,   // 最慢一档的核心
+        List,     // 指定的核心
+    };
+
+    Cores cores = Cores::Any;
+    std::vector<int> cpus;     // Cores::List 时使用
+    bool hasNice = false;
+    int nice = 0;
+    int fifoPriority = 0;      // 1..99 时改用 SCHED_FIFO，0 表示保持 SCHED_OTHER
+
+    bool configured() const { return cores != Cores::Any || hasNice || fifoPriority > 0; }
+};
+
+/**
+ * 线程放置配置
+ *
+ * 通过环境变量 QUICKSTART_THREADS 以逗号分隔的选项开启，CLASS 为上面的类别名称：
+ *   CLASS=CORES       核心：big、little、all，或核心编号，如 4-7、0+2+4-5
+ *   CLASS_nice=N      nice 值（-20..19），负值需要 CAP_SYS_NICE 或 RLIMIT_NICE
+ *   CLASS_fifo=N      使用 SCHED_FIFO 及优先级 N（1..99），需要 CAP_SYS_NICE 或 RLIMIT_RTPRIO
+ * 例如：QUICKSTART_THREADS=audio=big,audio_fifo=20,video=big,mqtt=big,background=little,background_nice=5
+ * 不设置时不改变任何线程，只做命名与统计。
+ */
+struct ThreadPolicyConfig {
+    ThreadClassPolicy classes[kThreadClassCount];
+
+    const ThreadClassPolicy &policy(ThreadClass threadClass) const {
+        return classes[static_cast<int>(threadClass)];
+    }
+    bool configured() const;
+
+    static ThreadPolicyConfig fromEnvironment();
+};
+
+/**
+ * 核心拓扑
+ *
+ * 从 /sys/devices/system/cpu 读取在线核心与每个核心的算力（cpu_capacity，
+ * 没有时用 cpufreq/cpuinfo_max_freq）。算力最低的一档为小核，其余为大核
+ * （三档的 SoC 上中核与超大核都归为大核）；各核心相同或读不到时大核、小核都是全部核心。
+ */
+struct CpuTopology {
+    std::vector<int> online;
+    std::vector<int> big;
+    std::vector<int> little;
+    std::vector<uint32_t> capacity;   // 按核心编号索引，读不到为 0
+
+    bool heterogeneous() const { return !little.empty() && little.size() != online.size(); }
+    bool isLittle(int cpu) const;
+    std::string describe() const;
+
+    static CpuTopology detect();
+};
+
+/**
+ * 线程登记与放置
+ *
+ * 我们创建的线程在线程函数开头调用 registerCurrentThread() 命名（pthread_setname_np，
+ * 追踪文件与 top -H 中可见）并登记；SDK、Paho、Qt 等不归我们管理的线程在第一次进入我们的回调时
+ * 调用 adoptCurrentThread() 只登记不改名，之后的调用只检查一个 thread_local 标志。
+ * 登记时按所属类别应用 install() 给出的亲和性、nice 与调度策略；install() 之前登记的线程
+ * 在 install() 时补上。设置失败（权限不足、核心不存在）只告警一次，线程照常运行。
+ *
+ * exportMetrics() 作为指标提供方，读取 /proc/self/task/TID 下每个登记线程的 CPU 时间、
+ * 当前所在核心与迁移次数（内核没有 sched 统计时按两次采样间所在核心的变化计数，为下限）。
+ * 线程退出时由 thread_local 的析构移除自己的登记并释放名称序号，登记表只含存活的线程，
+ * 不依赖导出清理。
+ *
+ * 以上接口均线程安全。
+ */
+class ThreadPolicy {
+public:
+    static void install(const ThreadPolicyConfig &config);
+
+    static void registerCurrentThread(ThreadClass threadClass, const char *name);
+    static void adoptCurrentThread(ThreadClass threadClass, const char *name);
+
+    static const CpuTopology &topology();
+
+    /** 指标：threads.<名称>.cpu_percent / cpu_s / cpu / migrations / on_little */
+    static void exportMetrics(MetricsRecord &record);
+};
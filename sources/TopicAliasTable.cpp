@@ -0,0 +1,65 @@
+#include "TopicAliasTable.h"
+#include <algorithm>
+
+void TopicAliasTable::reset(int maximum) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maximum = std::max(0, std::min(maximum, 65535));
+    m_entries.clear();
+}
+
+int TopicAliasTable::maximum() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_maximum;
+}
+
+mqtt::message_ptr TopicAliasTable::makeMessage(const std::string &topic, const std::string &payload, int qos,
+                                               mqtt::properties props) {
+    int alias = 0;
+    bool established = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = std::find_if(m_entries.begin(), m_entries.end(),
+                               [&](const Entry &entry) { return entry.topic == topic; });
+        if (it != m_entries.end()) {
+            alias = it->alias;
+            established = it->established;
+            it->established = true;
+        } else if (static_cast<int>(m_entries.size()) < m_maximum) {
+            alias = static_cast<int>(m_entries.size()) + 1;
+            m_entries.push_back({topic, alias, true});
+        }
+        if (established) {
+            ++m_aliasedMessages;
+            m_savedBytes += topic.size();
+        }
+    }
+
+    if (alias == 0) {
+        auto msg = mqtt::make_message(topic, payload, qos, false);
+        msg->set_properties(props);
+        return msg;
+    }
+    props.add(mqtt::property(mqtt::property::TOPIC_ALIAS, alias));
+    auto msg = mqtt::make_message(established ? std::string() : topic, payload, qos, false);
+    msg->set_properties(props);
+    return msg;
+}
+
+void TopicAliasTable::failed(const std::string &topic) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto &entry : m_entries) {
+        if (entry.topic == topic) {
+            entry.established = false;
+        }
+    }
+}
+
+uint64_t TopicAliasTable::aliasedMessages() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_aliasedMessages;
+}
+
+uint64_t TopicAliasTable::savedBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_savedBytes;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <mqtt/message.h>
+#include <mqtt/properties.h>
+
+/**
+ * MQTT 5 出站主题别名
+ *
+ * 每次连接后用 CONNACK 中服务器给出的 Topic Alias Maximum 调用 reset()。
+ * 高频主题（智能体协议、遥测）第一次发布时带完整主题并登记别名，之后只发别名、主题为空，
+ * 每条消息省去 `$agent/{agentId}/{clientId}` 这类几十字节的主题。服务器不支持（上限为 0）
+ * 或别名用完时照常发送完整主题。
+ *
+ * 同一主题只能由一个线程发布（发布顺序即建立顺序）；不同主题可在不同线程上并发。
+ * reset() 只在没有其他线程发布时调用（连接建立之后、遥测 attach 之前）。
+ */
+class TopicAliasTable {
+public:
+    /** 新连接：之前的别名全部失效 */
+    void reset(int maximum);
+    int maximum() const;
+
+    /**
+     * 生成发往 topic 的消息并加上别名属性，props 中可带其他属性（响应主题等）。
+     * 发布抛出异常时调用 failed(topic)，下一条消息重新带上完整主题。
+     */
+    mqtt::message_ptr makeMessage(const std::string &topic, const std::string &payload, int qos,
+                                  mqtt::properties props = mqtt::properties());
+    void failed(const std::string &topic);
+
+    /** 以别名发送（省去主题）的消息数与省下的字节数 */
+    uint64_t aliasedMessages() const;
+    uint64_t savedBytes() const;
+
+private:
+    struct Entry {
+        std::string topic;
+        int alias;
+        bool established;
+    };
+
+    mutable std::mutex m_mutex;
+    int m_maximum = 0;
+    std::vector<Entry> m_entries;
+    uint64_t m_aliasedMessages = 0;
+    uint64_t m_savedBytes = 0;
+};
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <mcp_mqtt/mcp_server.h>
+#include "MessageTracer.h"
+
+/**
+ * 由 C++ 参数结构体注册 MCP 工具
+ *
+ * 参数结构体用 constexpr 的 fields() 描述每个成员（名称、说明、是否必填、枚举取值、整数范围），
+ * 工具的 inputSchema 与参数解码都从这一张表生成，二者不会不一致：
+ *
+ *   enum class Unit { Celsius, Fahrenheit };
+ *   constexpr std::array<std::string_view, 2> kUnits = {"celsius", "fahrenheit"};
+ *
+ *   struct TemperatureArgs {
+ *       Unit unit = Unit::Celsius;
+ *       static constexpr auto fields() {
+ *           return std::make_tuple(
+ *               TypedTool::enumeration("unit", &TemperatureArgs::unit, kUnits, "Temperature unit"));
+ *       }
+ *   };
+ *
+ *   TypedTool::registerTool<TemperatureArgs>(server, "get_temperature", "Read the temperature",
+ *       [](const TemperatureArgs &args) { ... return mcp_mqtt::ToolCallResult::success(...); });
+ *
+ * 成员类型支持 std::string、bool、整数、浮点数，以及下标与取值表对应的枚举。
+ * 键名的哈希在编译期算好，解码时遍历一次参数对象，按哈希和名称直接写入结构体成员，
+ * 字符串按引用读取、枚举按取值表比较，不生成中间 JSON 值；未提供的成员保留结构体中的默认值，
+ * 值为 null 视为未提供，未知的键忽略。类型不符、枚举取值或整数范围不合法、缺少必填参数时返回错误。
+ */
+namespace TypedTool {
+
+constexpr bool Required = true;
+
+constexpr uint32_t hashKey(std::string_view key) {
+    uint32_t hash = 2166136261u;
+    for (char c : key) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+template <typename S, typename T>
+struct Field {
+    std::string_view name;
+    uint32_t hash;
+    T S::*member;
+    std::string_view description;
+    bool required;
+    const std::string_view *labels;   // 枚举取值，下标即枚举值
+    size_t labelCount;
+    int64_t minimum;
+    int64_t maximum;
+};
+
+template <typename S, typename T>
+constexpr Field<S, T> field(std::string_view name, T S::*member, std::string_view description,
+                            bool required = false) {
+    static_assert(!std::is_enum_v<T>, "use TypedTool::enumeration() for enum members");
+    return {name, hashKey(name), member, description, required, nullptr, 0,
+            std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()};
+}
+
+/** 带取值范围（闭区间）的整数成员 */
+template <typename S, typename T>
+constexpr Field<S, T> range(std::string_view name, T S::*member, int64_t minimum, int64_t maximum,
+                            std::string_view description, bool required = false) {
+    static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>, "range() is for integer members");
+    return {name, hashKey(name), member, description, required, nullptr, 0, minimum, maximum};
+}
+
+/** 枚举成员，labels[i] 为枚举值 i 对应的字符串；labels 须为静态存储的 constexpr 数组 */
+template <typename S, typename E, size_t N>
+constexpr Field<S, E> enumeration(std::string_view name, E S::*member, const std::array<std::string_view, N> &labels,
+                                  std::string_view description, bool required = false) {
+    static_assert(std::is_enum_v<E>, "enumeration() is for enum members");
+    return {name, hashKey(name), member, description, required, labels.data(), N, 0, static_cast<int64_t>(N) - 1};
+}
+
+namespace detail {
+
+template <typename Tuple, typename Fn, size_t... I>
+void forEachField(const Tuple &fields, Fn &&fn, std::index_sequence<I...>) {
+    (fn(std::integral_constant<size_t, I>(), std::get<I>(fields)), ...);
+}
+
+template <typename Tuple, typename Fn>
+void forEachField(const Tuple &fields, Fn &&fn) {
+    forEachField(fields, std::forward<Fn>(fn), std::make_index_sequence<std::tuple_size_v<Tuple>>());
+}
+
+inline bool fail(std::string &error, std::string_view name, const char *what) {
+    error = "Invalid argument '";
+    error.append(name.data(), name.size());
+    error += "': ";
+    error += what;
+    return false;
+}
+
+template <typename S, typename T>
+void addProperty(mcp_mqtt::ToolInputSchema &schema, const Field<S, T> &f) {
+    nlohmann::json property;
+    if constexpr (std::is_enum_v<T>) {
+        property["type"] = "string";
+        auto labels = nlohmann::json::array();
+        for (size_t i = 0; i < f.labelCount; ++i) {
+            labels.push_back(std::string(f.labels[i]));
+        }
+        property["enum"] = std::move(labels);
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        property["type"] = "string";
+    } else if constexpr (std::is_same_v<T, bool>) {
+        property["type"] = "boolean";
+    } else if constexpr (std::is_integral_v<T>) {
+        property["type"] = "integer";
+        if (f.minimum != std::numeric_limits<int64_t>::min()) property["minimum"] = f.minimum;
+        if (f.maximum != std::numeric_limits<int64_t>::max()) property["maximum"] = f.maximum;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        property["type"] = "number";
+    } else {
+        static_assert(std::is_void_v<T>, "unsupported tool argument type");
+    }
+    property["description"] = std::string(f.description);
+    schema.properties[std::string(f.name)] = std::move(property);
+    if (f.required) {
+        schema.required.push_back(std::string(f.name));
+    }
+}
+
+template <typename S, typename T>
+bool decodeValue(const Field<S, T> &f, const nlohmann::json &value, S &out, std::string &error) {
+    if constexpr (std::is_enum_v<T>) {
+        if (!value.is_string()) return fail(error, f.name, "expected a string");
+        const std::string &text = value.get_ref<const std::string &>();
+        for (size_t i = 0; i < f.labelCount; ++i) {
+            if (f.labels[i] == text) {
+                out.*f.member = static_cast<T>(i);
+                return true;
+            }
+        }
+        std::string expected = "expected one of";
+        for (size_t i = 0; i < f.labelCount; ++i) {
+            expected += i == 0 ? " '" : ", '";
+            expected.append(f.labels[i].data(), f.labels[i].size());
+            expected += '\'';
+        }
+        return fail(error, f.name, expected.c_str());
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        if (!value.is_string()) return fail(error, f.name, "expected a string");
+        out.*f.member = value.get_ref<const std::string &>();
+        return true;
+    } else if constexpr (std::is_same_v<T, bool>) {
+        if (!value.is_boolean()) return fail(error, f.name, "expected a boolean");
+        out.*f.member = value.get<bool>();
+        return true;
+    } else if constexpr (std::is_integral_v<T>) {
+        int64_t n = 0;
+        if (value.is_number_unsigned()) {
+            const uint64_t u = value.get<uint64_t>();
+            if (u > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+                return fail(error, f.name, "out of range");
+            }
+            n = static_cast<int64_t>(u);
+        } else if (value.is_number_integer()) {
+            n = value.get<int64_t>();
+        } else if (value.is_number_float()) {
+            // 模型常把整数写成 640.0，只接受没有小数部分的值
+            const double d = value.get<double>();
+            if (std::trunc(d) != d || std::fabs(d) > 9.0e15) return fail(error, f.name, "expected an integer");
+            n = static_cast<int64_t>(d);
+        } else {
+            return fail(error, f.name, "expected an integer");
+        }
+        const int64_t minimum = std::max<int64_t>(f.minimum, static_cast<int64_t>(std::numeric_limits<T>::min()));
+        const int64_t maximum = std::is_unsigned_v<T> && sizeof(T) >= sizeof(int64_t)
+                ? f.maximum : std::min<int64_t>(f.maximum, static_cast<int64_t>(std::numeric_limits<T>::max()));
+        if (n < minimum || n > maximum) {
+            const std::string what = "must be between " + std::to_string(minimum) + " and " + std::to_string(maximum);
+            return fail(error, f.name, what.c_str());
+        }
+        out.*f.member = static_cast<T>(n);
+        return true;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        if (!value.is_number()) return fail(error, f.name, "expected a number");
+        out.*f.member = value.get<T>();
+        return true;
+    } else {
+        static_assert(std::is_void_v<T>, "unsupported tool argument type");
+        return false;
+    }
+}
+
+} // namespace detail
+
+/** 按 S::fields() 生成 inputSchema */
+template <typename S>
+void fillSchema(mcp_mqtt::ToolInputSchema &schema) {
+    schema.properties = nlohmann::json::object();
+    schema.required.clear();
+    detail::forEachField(S::fields(), [&](auto, const auto &f) { detail::addProperty(schema, f); });
+}
+
+/** 把参数对象解码进 out，失败时 error 为说明 */
+template <typename S>
+bool decode(const nlohmann::json &args, S &out, std::string &error) {
+    static constexpr auto kFields = S::fields();
+    static_assert(std::tuple_size_v<decltype(kFields)> <= 64, "too many tool arguments");
+
+    uint64_t seen = 0;
+    if (args.is_object()) {
+        for (auto it = args.begin(); it != args.end(); ++it) {
+            if (it.value().is_null()) continue;
+            const std::string &key = it.key();
+            const uint32_t hash = hashKey(key);
+            bool ok = true;
+            detail::forEachField(kFields, [&](auto index, const auto &f) {
+                if (ok && f.hash == hash && f.name == key) {
+                    ok = detail::decodeValue(f, it.value(), out, error);
+                    seen |= uint64_t(1) << decltype(index)::value;
+                }
+            });
+            if (!ok) return false;
+        }
+    } else if (!args.is_null()) {
+        error = "Arguments must be an object";
+        return false;
+    }
+
+    bool complete = true;
+    detail::forEachField(kFields, [&](auto index, const auto &f) {
+        if (complete && f.required && !(seen & (uint64_t(1) << decltype(index)::value))) {
+            error = "Missing parameter: ";
+            error.append(f.name.data(), f.name.size());
+            complete = false;
+        }
+    });
+    return complete;
+}
+
+/**
+ * 注册工具：handler 签名为 mcp_mqtt::ToolCallResult(const S &)，参数不合法时不会被调用。
+ * name 须为静态存储的字符串（追踪时直接引用）。
+ */
+template <typename S, typename Handler>
+void registerTool(mcp_mqtt::McpServer &server, const char *name, const std::string &description, Handler handler) {
+    mcp_mqtt::Tool tool;
+    tool.name = name;
+    tool.description = description;
+    fillSchema<S>(tool.inputSchema);
+
+    server.registerTool(tool, [name, handler = std::move(handler)](const nlohmann::json &args) -> mcp_mqtt::ToolCallResult {
+        MessageTracer::HandlerScope trace(name);
+        S decoded;
+        std::string error;
+        if (!decode(args, decoded, error)) {
+            return mcp_mqtt::ToolCallResult::error(error);
+        }
+        return handler(decoded);
+    });
+}
+
+} // namespace TypedTool
@@ -0,0 +1,157 @@
+#include "VideoCanvas.h"
+#include <QPaintEvent>
+#include <QPainter>
+#include <QStyleOption>
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+int64_t steadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+VideoCanvas::VideoCanvas(QWidget *parent)
+        : QWidget(parent) {
+}
+
+void VideoCanvas::setFrameSink(std::shared_ptr<VideoFrameSink> sink) {
+    m_sink = std::move(sink);
+    m_frameSize = QSize();
+    m_pendingArrivalNs = 0;
+    m_rendered = 0;
+    m_droppedBase = m_sink ? m_sink->droppedFrames() : 0;
+    m_latencySumNs = 0;
+    m_latencyMaxNs = 0;
+    m_statsText.clear();
+    update();
+}
+
+void VideoCanvas::setStatsVisible(bool visible) {
+    m_showStats = visible;
+    update(statsRect());
+}
+
+bool VideoCanvas::present() {
+    if (!m_sink || !isVisible()) return false;
+
+    const VideoFrameSink::Slot *slot = m_sink->acquire();
+    if (!slot || slot->image.isNull()) return false;
+
+    if (slot->image.size() != m_frameSize) {
+        // 分辨率变化时整体重绘（含黑边）
+        m_frameSize = slot->image.size();
+        update();
+    } else {
+        QRegion region = damageRegion(slot->damage, m_frameSize);
+        if (region.isEmpty()) {
+            // 画面没有变化，不需要重绘即视为已呈现
+            m_rendered++;
+            return true;
+        }
+        update(region);
+    }
+    m_pendingArrivalNs = slot->arrivalNs;
+    return true;
+}
+
+VideoCanvas::Stats VideoCanvas::takeStats() {
+    Stats stats;
+    stats.rendered = m_rendered;
+    uint64_t dropped = m_sink ? m_sink->droppedFrames() : 0;
+    stats.dropped = dropped - m_droppedBase;
+    stats.avgLatencyMs = m_rendered ? m_latencySumNs / 1e6 / m_rendered : 0;
+    stats.maxLatencyMs = m_latencyMaxNs / 1e6;
+
+    m_rendered = 0;
+    m_droppedBase = dropped;
+    m_latencySumNs = 0;
+    m_latencyMaxNs = 0;
+
+    if (m_showStats) {
+        m_statsText = QString("%1 fps  drop %2  %3/%4 ms")
+                .arg(stats.rendered)
+                .arg(stats.dropped)
+                .arg(stats.avgLatencyMs, 0, 'f', 1)
+                .arg(stats.maxLatencyMs, 0, 'f', 1);
+        update(statsRect());
+    }
+    return stats;
+}
+
+void VideoCanvas::paintEvent(QPaintEvent *event) {
+    QPainter painter(this);
+
+    // 样式表背景只在重绘区域内绘制
+    QStyleOption option;
+    option.initFrom(this);
+    style()->drawPrimitive(QStyle::PE_Widget, &option, &painter, this);
+
+    if (m_sink && !m_frameSize.isEmpty()) {
+        const VideoFrameSink::Slot &slot = m_sink->current();
+        if (!slot.image.isNull()) {
+            painter.setRenderHint(QPainter::SmoothPixmapTransform);
+            painter.drawImage(targetRect(slot.image.size()), slot.image);
+        }
+    }
+
+    if (m_showStats && !m_statsText.isEmpty() && event->rect().intersects(statsRect())) {
+        painter.fillRect(statsRect(), QColor(0, 0, 0, 160));
+        painter.setPen(QColor(0xE0, 0xE0, 0xE0));
+        painter.drawText(statsRect().adjusted(6, 0, -6, 0), Qt::AlignVCenter | Qt::AlignLeft, m_statsText);
+    }
+
+    if (m_pendingArrivalNs != 0) {
+        int64_t latency = steadyNs() - m_pendingArrivalNs;
+        m_pendingArrivalNs = 0;
+        m_rendered++;
+        m_latencySumNs += latency;
+        m_latencyMaxNs = std::max(m_latencyMaxNs, latency);
+    }
+}
+
+void VideoCanvas::resizeEvent(QResizeEvent *event) {
+    QWidget::resizeEvent(event);
+    update();
+}
+
+QRect VideoCanvas::targetRect(const QSize &frameSize) const {
+    QSize scaled = frameSize.scaled(size(), Qt::KeepAspectRatio);
+    QRect target(QPoint(0, 0), scaled);
+    target.moveCenter(rect().center());
+    return target;
+}
+
+QRegion VideoCanvas::damageRegion(uint64_t damage, const QSize &frameSize) const {
+    if (damage == ~uint64_t(0)) {
+        return QRegion(targetRect(frameSize));
+    }
+
+    const QRect target = targetRect(frameSize);
+    const double sx = double(target.width()) / frameSize.width();
+    const double sy = double(target.height()) / frameSize.height();
+    const int tileW = (frameSize.width() + VideoFrameSink::kGrid - 1) / VideoFrameSink::kGrid;
+    const int tileH = (frameSize.height() + VideoFrameSink::kGrid - 1) / VideoFrameSink::kGrid;
+
+    QRegion region;
+    for (int bit = 0; bit < VideoFrameSink::kGrid * VideoFrameSink::kGrid; ++bit) {
+        if (!(damage & (uint64_t(1) << bit))) continue;
+        int tx = bit % VideoFrameSink::kGrid;
+        int ty = bit / VideoFrameSink::kGrid;
+        // 外扩 1 像素，覆盖缩放滤波对相邻像素的影响
+        QRect tile(target.x() + int(tx * tileW * sx) - 1, target.y() + int(ty * tileH * sy) - 1,
+                   int(tileW * sx) + 3, int(tileH * sy) + 3);
+        region += tile.intersected(target);
+    }
+    if (m_showStats) {
+        region += statsRect();
+    }
+    return region;
+}
+
+QRect VideoCanvas::statsRect() const {
+    return QRect(4, 4, std::min(width() - 8, 220), 20);
+}
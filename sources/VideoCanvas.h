@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QWidget>
+#include <memory>
+#include "VideoRenderer.h"
+
+/**
+ * VideoWidget 中的画面区域
+ *
+ * 原生渲染时只作为交给 SDK 的窗口；进程内渲染时由 InProcessVideoRenderer 设置帧源，
+ * 每个刷新节拍调用 present() 取最新帧，只重绘发生变化的区域。
+ */
+class VideoCanvas : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit VideoCanvas(QWidget *parent = Q_NULLPTR);
+
+    void setFrameSink(std::shared_ptr<VideoFrameSink> sink);
+    std::shared_ptr<VideoFrameSink> frameSink() const { return m_sink; }
+
+    /** 有新帧时发起局部重绘，返回是否有新帧 */
+    bool present();
+
+    void setStatsVisible(bool visible);
+
+    /** 统计窗口内的渲染帧数、丢帧数与呈现延迟，读取后清零 */
+    struct Stats {
+        uint64_t rendered = 0;
+        uint64_t dropped = 0;
+        double avgLatencyMs = 0;
+        double maxLatencyMs = 0;
+    };
+    Stats takeStats();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    QRect targetRect(const QSize &frameSize) const;
+    QRegion damageRegion(uint64_t damage, const QSize &frameSize) const;
+    QRect statsRect() const;
+
+    std::shared_ptr<VideoFrameSink> m_sink;
+    QSize m_frameSize;
+    bool m_showStats = false;
+    QString m_statsText;
+
+    // 已提交重绘、等待 paintEvent 的帧
+    int64_t m_pendingArrivalNs = 0;
+
+    uint64_t m_rendered = 0;
+    uint64_t m_droppedBase = 0;
+    int64_t m_latencySumNs = 0;
+    int64_t m_latencyMaxNs = 0;
+};
@@ -0,0 +1,51 @@
+#include "VideoFramePool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+VideoFramePool::VideoFramePool(int count, size_t bufferSize)
+    : m_count(std::clamp(count, 1, kMaxBuffers)), m_bufferSize(bufferSize) {
+    uint64_t mask = 0;
+    for (int i = 0; i < m_count; ++i) {
+        void *ptr = nullptr;
+        if (posix_memalign(&ptr, 64, m_bufferSize) != 0) {
+            throw std::bad_alloc();
+        }
+        m_buffers[i] = static_cast<uint8_t *>(ptr);
+        mask |= (uint64_t(1) << i);
+    }
+    m_freeMask.store(mask, std::memory_order_release);
+}
+
+VideoFramePool::~VideoFramePool() {
+    for (int i = 0; i < m_count; ++i) {
+        std::free(m_buffers[i]);
+    }
+}
+
+int VideoFramePool::acquire() {
+    uint64_t mask = m_freeMask.load(std::memory_order_acquire);
+    while (mask != 0) {
+        int index = __builtin_ctzll(mask);
+        uint64_t desired = mask & ~(uint64_t(1) << index);
+        if (m_freeMask.compare_exchange_weak(mask, desired,
+                                             std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return index;
+        }
+    }
+    m_exhausted.fetch_add(1, std::memory_order_relaxed);
+    return -1;
+}
+
+void VideoFramePool::release(int index) {
+    if (index < 0 || index >= m_count) return;
+    m_freeMask.fetch_or(uint64_t(1) << index, std::memory_order_release);
+}
+
+int VideoFramePool::inUse() const {
+    return m_count - __builtin_popcountll(m_freeMask.load(std::memory_order_relaxed));
+}
+
+void VideoFramePool::releaseCallback(void *opaque, int bufferIndex) {
+    static_cast<VideoFramePool *>(opaque)->release(bufferIndex);
+}
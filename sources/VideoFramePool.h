@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 预分配的视频帧缓冲池
+ *
+ * 启动时一次性分配 count 块 64 字节对齐、大小相同的缓冲，之后不再分配内存。
+ * acquire/release 通过原子位图实现，无锁且可在不同线程上调用
+ * （通常 acquire 在采集线程，release 在 RTC 引擎内部线程）。
+ * 最多支持 64 块缓冲。
+ */
+class VideoFramePool {
+public:
+    static constexpr int kMaxBuffers = 64;
+
+    VideoFramePool(int count, size_t bufferSize);
+    ~VideoFramePool();
+
+    VideoFramePool(const VideoFramePool &) = delete;
+    VideoFramePool &operator=(const VideoFramePool &) = delete;
+
+    /** 取出一块空闲缓冲，返回其索引；池已耗尽时返回 -1 */
+    int acquire();
+    void release(int index);
+
+    uint8_t *data(int index) const { return m_buffers[index]; }
+    size_t bufferSize() const { return m_bufferSize; }
+    int count() const { return m_count; }
+    int inUse() const;
+
+    /** 因池耗尽而 acquire 失败的次数 */
+    uint64_t exhaustedCount() const { return m_exhausted.load(std::memory_order_relaxed); }
+
+    /** 适合作为 RtcExternalVideoFrame::release 的回调，opaque 为 VideoFramePool* */
+    static void releaseCallback(void *opaque, int bufferIndex);
+
+private:
+    int m_count;
+    size_t m_bufferSize;
+    uint8_t *m_buffers[kMaxBuffers] = {};
+    std::atomic<uint64_t> m_freeMask{0};
+    std::atomic<uint64_t> m_exhausted{0};
+};
@@ -0,0 +1,351 @@
+#include "VideoFrameTap.h"
+#include "ThreadPolicy.h"
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <vector>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+VideoFrameTapConfig VideoFrameTapConfig::fromEnvironment() {
+    VideoFrameTapConfig config;
+    const char *value = std::getenv("QUICKSTART_FRAME_TAP");
+    if (!value) {
+        return config;
+    }
+
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item == "remote") config.tapRemote = true;
+        else if (item == "local") config.tapLocal = true;
+        else if (item == "rgb") config.layout = ColorConvert::RgbLayout::Rgb24;
+        else if (item == "bgr") config.layout = ColorConvert::RgbLayout::Bgr24;
+        else if (item == "bgra") config.layout = ColorConvert::RgbLayout::Bgra32;
+        else if (item == "rgba") config.layout = ColorConvert::RgbLayout::Rgba32;
+        else if (item.compare(0, 6, "queue=") == 0) config.queueDepth = std::atoi(item.c_str() + 6);
+        else if (!item.empty()) qWarning() << "QUICKSTART_FRAME_TAP: unknown option" << item.c_str();
+    }
+
+    config.queueDepth = std::max(1, std::min(config.queueDepth, 64));
+    return config;
+}
+
+// ── 帧与通道 ──────────────────────────────────────────────────────
+
+struct VideoFrameTap::Frame {
+    struct FreeDeleter {
+        void operator()(uint8_t *ptr) const { std::free(ptr); }
+    };
+
+    std::unique_ptr<uint8_t, FreeDeleter> data;
+    size_t capacity = 0;
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+    int64_t timestampUs = 0;
+    uint64_t seq = 0;
+
+    bool reserve(size_t size) {
+        if (size <= capacity) return true;
+        void *ptr = nullptr;
+        if (posix_memalign(&ptr, 64, size) != 0) {
+            return false;
+        }
+        data.reset(static_cast<uint8_t *>(ptr));
+        capacity = size;
+        return true;
+    }
+};
+
+struct VideoFrameTap::Channel {
+    enum State : int {
+        kFree = 0,
+        kClaiming = 1,
+        kActive = 2,
+        kReleasing = 3,    // 流已结束，等回调线程不再使用后由消费线程丢弃剩余的帧并归还
+    };
+
+    explicit Channel(int queueDepth)
+        : frames(queueDepth + 2), ready(queueDepth), recycled(queueDepth + 2) {
+        for (auto &frame : frames) {
+            recycled.push(&frame);
+        }
+    }
+
+    std::atomic<int> state{kFree};
+    std::atomic<int> busy{0};          // 正在 produce() 的回调线程数
+    char streamId[128] = {};
+    char userId[128] = {};
+    bool isLocal = false;
+
+    std::vector<Frame> frames;
+    SpscFrameQueue<Frame> ready;   // 生产者 → 消费者
+    SpscFrameQueue<Frame> recycled;   // 消费者 → 生产者，容量不小于帧数，不会发生丢弃
+
+    // 以下只在生产者线程访问
+    Frame *spare = nullptr;
+    uint64_t seq = 0;
+};
+
+// ── 默认消费者 ────────────────────────────────────────────────────
+
+class VideoFrameTap::StatsConsumer : public IVideoFrameTapConsumer {
+public:
+    void onTappedFrame(const TappedVideoFrame &frame) override {
+        auto &stats = m_streams[frame.isLocal ? std::string("local") : std::string(frame.streamId)];
+        if (stats.frames > 0 && frame.seq > stats.lastSeq + 1) {
+            stats.skipped += frame.seq - stats.lastSeq - 1;
+        }
+        stats.frames++;
+        stats.lastSeq = frame.seq;
+        stats.width = frame.width;
+        stats.height = frame.height;
+
+        auto now = std::chrono::steady_clock::now();
+        if (m_lastReport.time_since_epoch().count() == 0) {
+            m_lastReport = now;
+            return;
+        }
+        double elapsed = std::chrono::duration<double>(now - m_lastReport).count();
+        if (elapsed < 5.0) return;
+
+        for (auto &entry : m_streams) {
+            qInfo() << "VideoFrameTap:" << entry.first.c_str()
+                    << entry.second.width << "x" << entry.second.height
+                    << "fps" << entry.second.frames / elapsed
+                    << "skipped" << entry.second.skipped;
+            entry.second.frames = 0;
+            entry.second.skipped = 0;
+        }
+        m_lastReport = now;
+    }
+
+    void onStreamReleased(const char *streamId) override {
+        m_streams.erase(streamId);
+    }
+
+private:
+    struct StreamStats {
+        uint64_t frames = 0;
+        uint64_t skipped = 0;
+        uint64_t lastSeq = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    std::map<std::string, StreamStats> m_streams;
+    std::chrono::steady_clock::time_point m_lastReport;
+};
+
+// ── VideoFrameTap ─────────────────────────────────────────────────
+
+VideoFrameTap::VideoFrameTap(const VideoFrameTapConfig &config, IVideoFrameTapConsumer *consumer)
+    : m_config(config), m_consumer(consumer) {
+    if (!m_consumer) {
+        m_defaultConsumer = std::make_unique<StatsConsumer>();
+        m_consumer = m_defaultConsumer.get();
+    }
+    for (auto &channel : m_channels) {
+        channel = std::make_unique<Channel>(m_config.queueDepth);
+    }
+}
+
+VideoFrameTap::~VideoFrameTap() {
+    stop();
+}
+
+void VideoFrameTap::start() {
+    if (m_running.exchange(true)) return;
+    m_thread = std::thread(&VideoFrameTap::consumerLoop, this);
+    qDebug() << "VideoFrameTap started, remote" << m_config.tapRemote << "local" << m_config.tapLocal
+             << "simd" << ColorConvert::hasSimd() << "queue" << m_config.queueDepth;
+}
+
+void VideoFrameTap::stop() {
+    if (!m_running.exchange(false)) return;
+    wakeConsumer();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    qDebug() << "VideoFrameTap stopped, dropped frames" << droppedFrames();
+}
+
+void VideoFrameTap::onLocalVideoFrame(const RtcVideoFrame &frame) {
+    ThreadPolicy::adoptCurrentThread(ThreadClass::Video, "rtc-video");
+    if (!m_config.tapLocal || !m_running.load(std::memory_order_relaxed)) return;
+    if (Channel *channel = channelFor("local", "", true)) {
+        produce(channel, frame);
+        finishFrame(channel);
+    }
+}
+
+void VideoFrameTap::onRemoteVideoFrame(const char *streamId, const char *userId, const RtcVideoFrame &frame) {
+    ThreadPolicy::adoptCurrentThread(ThreadClass::Video, "rtc-video");
+    if (!m_config.tapRemote || !m_running.load(std::memory_order_relaxed)) return;
+    if (Channel *channel = channelFor(streamId ? streamId : "", userId ? userId : "", false)) {
+        produce(channel, frame);
+        finishFrame(channel);
+    }
+}
+
+VideoFrameTap::Channel *VideoFrameTap::channelFor(const char *streamId, const char *userId, bool isLocal) {
+    for (auto &channel : m_channels) {
+        if (channel->state.load(std::memory_order_acquire) != Channel::kActive) continue;
+        // 先计数再比较标识，与消费线程的回收配对：计数之后仍为 kActive，
+        // 消费线程就不会归还通道，标识也不会被新的流改写
+        channel->busy.fetch_add(1);
+        if (channel->state.load() == Channel::kActive
+            && channel->isLocal == isLocal && std::strcmp(channel->streamId, streamId) == 0) {
+            return channel.get();
+        }
+        finishFrame(channel.get());
+    }
+
+    // 首次出现的流：占用一个空闲通道，写好标识后再对消费者可见
+    for (auto &channel : m_channels) {
+        int expected = Channel::kFree;
+        if (channel->state.compare_exchange_strong(expected, Channel::kClaiming, std::memory_order_acq_rel)) {
+            std::snprintf(channel->streamId, sizeof(channel->streamId), "%s", streamId);
+            std::snprintf(channel->userId, sizeof(channel->userId), "%s", userId);
+            channel->isLocal = isLocal;
+            channel->seq = 0;
+            channel->busy.fetch_add(1);
+            channel->state.store(Channel::kActive, std::memory_order_release);
+            qDebug() << "VideoFrameTap: tapping stream" << streamId << "user" << userId;
+            return channel.get();
+        }
+    }
+
+    if (m_droppedFrames.fetch_add(1, std::memory_order_relaxed) == 0) {
+        qWarning() << "VideoFrameTap: too many streams, ignoring" << streamId;
+    }
+    return nullptr;
+}
+
+void VideoFrameTap::releaseStream(const std::string &streamId) {
+    for (auto &channel : m_channels) {
+        if (channel->state.load(std::memory_order_acquire) != Channel::kActive) continue;
+        // 与 channelFor() 相同，计数期间标识稳定
+        channel->busy.fetch_add(1);
+        int expected = Channel::kActive;
+        if (channel->state.load() == Channel::kActive
+            && !channel->isLocal && std::strcmp(channel->streamId, streamId.c_str()) == 0
+            && channel->state.compare_exchange_strong(expected, Channel::kReleasing)) {
+            qDebug() << "VideoFrameTap: released stream" << streamId.c_str();
+        }
+        finishFrame(channel.get());
+    }
+}
+
+void VideoFrameTap::finishFrame(Channel *channel) {
+    channel->busy.fetch_sub(1);
+    // 写帧期间流被释放，消费线程可能因为 busy 跳过了回收
+    if (channel->state.load(std::memory_order_acquire) == Channel::kReleasing) {
+        wakeConsumer();
+    }
+}
+
+void VideoFrameTap::produce(Channel *channel, const RtcVideoFrame &frame) {
+    if (frame.format != RtcPixelFormat::I420 || frame.width <= 0 || frame.height <= 0) {
+        if (m_droppedFrames.fetch_add(1, std::memory_order_relaxed) == 0) {
+            qWarning() << "VideoFrameTap: only I420 frames are supported";
+        }
+        return;
+    }
+
+    uint64_t seq = ++channel->seq;
+    Frame *target = channel->spare ? channel->spare : channel->recycled.pop();
+    channel->spare = nullptr;
+    if (!target) {
+        m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const int bpp = ColorConvert::bytesPerPixel(m_config.layout);
+    const int stride = (frame.width * bpp + 63) & ~63;
+    if (!target->reserve(static_cast<size_t>(stride) * frame.height)) {
+        channel->spare = target;
+        m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ColorConvert::i420ToRgb(frame.planes[0], frame.strides[0],
+                            frame.planes[1], frame.strides[1],
+                            frame.planes[2], frame.strides[2],
+                            target->data.get(), stride, frame.width, frame.height, m_config.layout);
+    target->width = frame.width;
+    target->height = frame.height;
+    target->stride = stride;
+    target->timestampUs = frame.timestampUs;
+    target->seq = seq;
+
+    // 队列已满时最旧的帧被挤出，留作下一帧的缓冲
+    if (Frame *evicted = channel->ready.push(target)) {
+        channel->spare = evicted;
+        m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+    wakeConsumer();
+}
+
+void VideoFrameTap::wakeConsumer() {
+    m_wakeSeq.fetch_add(1);
+    if (m_consumerWaiting.load()) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_wakeSeq), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    }
+}
+
+void VideoFrameTap::consumerLoop() {
+    ThreadPolicy::registerCurrentThread(ThreadClass::Video, "frame-tap");
+    while (m_running.load(std::memory_order_acquire)) {
+        uint32_t seq = m_wakeSeq.load();
+        bool delivered = false;
+
+        for (auto &channel : m_channels) {
+            const int state = channel->state.load(std::memory_order_acquire);
+            if (state == Channel::kReleasing) {
+                // 回调线程还在写帧时不能动生产者一侧的队列，等它写完再唤醒
+                if (channel->busy.load() != 0) continue;
+                // 结束的流：丢弃未取走的帧，缓冲留给下一路流
+                while (Frame *frame = channel->ready.pop()) {
+                    channel->recycled.push(frame);
+                }
+                m_consumer->onStreamReleased(channel->streamId);
+                channel->state.store(Channel::kFree, std::memory_order_release);
+                continue;
+            }
+            if (state != Channel::kActive) continue;
+            while (Frame *frame = channel->ready.pop()) {
+                TappedVideoFrame tapped;
+                tapped.streamId = channel->streamId;
+                tapped.userId = channel->userId;
+                tapped.isLocal = channel->isLocal;
+                tapped.width = frame->width;
+                tapped.height = frame->height;
+                tapped.stride = frame->stride;
+                tapped.layout = m_config.layout;
+                tapped.data = frame->data.get();
+                tapped.timestampUs = frame->timestampUs;
+                tapped.seq = frame->seq;
+                m_consumer->onTappedFrame(tapped);
+                channel->recycled.push(frame);
+                delivered = true;
+            }
+        }
+
+        if (!delivered) {
+            // 先登记等待再比较序号：生产者要么看到等待标志并唤醒，要么序号已变使 FUTEX_WAIT 立即返回
+            m_consumerWaiting.store(1);
+            struct timespec ts = {0, 100 * 1000 * 1000};
+            syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_wakeSeq), FUTEX_WAIT_PRIVATE, seq, &ts, nullptr, 0);
+            m_consumerWaiting.store(0);
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include "ColorConvert.h"
+#include "RtcBackend.h"
+#include "SpscFrameQueue.h"
+
+/**
+ * 视频帧抽取配置
+ *
+ * 通过环境变量 QUICKSTART_FRAME_TAP 开启，逗号分隔：
+ *   remote / local   抽取远端和/或本地帧（至少指定一个）
+ *   rgb / bgr / bgra / rgba  输出像素格式，默认 bgr
+ *   queue=N          每路流的队列长度，默认 2，满时丢弃最旧帧
+ * 例如：QUICKSTART_FRAME_TAP=remote,bgr,queue=4
+ */
+struct VideoFrameTapConfig {
+    bool tapRemote = false;
+    bool tapLocal = false;
+    ColorConvert::RgbLayout layout = ColorConvert::RgbLayout::Bgr24;
+    int queueDepth = 2;
+
+    bool enabled() const { return tapRemote || tapLocal; }
+
+    static VideoFrameTapConfig fromEnvironment();
+};
+
+/** 交给消费者的已转换帧，data 仅在 onTappedFrame 调用期间有效 */
+struct TappedVideoFrame {
+    const char *streamId = "";
+    const char *userId = "";
+    bool isLocal = false;
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+    ColorConvert::RgbLayout layout = ColorConvert::RgbLayout::Bgr24;
+    const uint8_t *data = nullptr;
+    int64_t timestampUs = 0;
+    uint64_t seq = 0;              // 该流的帧序号，不连续说明中间有帧被丢弃
+};
+
+/** 帧消费者，在 VideoFrameTap 的消费线程上调用 */
+class IVideoFrameTapConsumer {
+public:
+    virtual ~IVideoFrameTapConsumer() = default;
+
+    virtual void onTappedFrame(const TappedVideoFrame &frame) = 0;
+    /** 流已结束（releaseStream），之后同一编号再出现时是新的流 */
+    virtual void onStreamReleased(const char *streamId) { (void)streamId; }
+};
+
+/**
+ * 解码后视频帧抽取
+ *
+ * 作为 IRtcVideoFrameObserver 注册到引擎，在引擎回调线程上把 I420 帧转换为 RGB/BGR，
+ * 放入该流的有界 SPSC 队列（满时丢弃最旧帧），由独立的消费线程交给 IVideoFrameTapConsumer。
+ *
+ * 每路流有固定数量的帧缓冲（队列长度 + 2），在生产者和消费者之间通过两个无锁队列循环，
+ * 稳定运行时回调路径上没有内存分配和锁；只有分辨率变大时才重新分配该缓冲。
+ * 未指定消费者时使用内置的统计消费者，定期输出各路流的帧率和丢帧数。
+ *
+ * 远端流结束（用户离开或取消发布）时由界面线程调用 releaseStream()，等仍在写帧的回调线程退出后，
+ * 消费线程丢弃其未取走的帧并归还通道，通道数只限制同时存在的流。每次通话新建一个 VideoFrameTap，通道随之全部重置。
+ *
+ * 生命周期：start() → addVideoFrameObserver → ... → removeVideoFrameObserver → stop()。
+ */
+class VideoFrameTap : public IRtcVideoFrameObserver {
+public:
+    static constexpr int kMaxStreams = 16;
+
+    explicit VideoFrameTap(const VideoFrameTapConfig &config, IVideoFrameTapConsumer *consumer = nullptr);
+    ~VideoFrameTap() override;
+
+    void start();
+    void stop();
+
+    void onLocalVideoFrame(const RtcVideoFrame &frame) override;
+    void onRemoteVideoFrame(const char *streamId, const char *userId, const RtcVideoFrame &frame) override;
+
+    /** 远端流结束，归还它占用的通道；任意线程可调用 */
+    void releaseStream(const std::string &streamId);
+
+    uint64_t droppedFrames() const { return m_droppedFrames.load(std::memory_order_relaxed); }
+
+private:
+    struct Frame;
+    struct Channel;
+    class StatsConsumer;
+
+    /** 返回的通道已标记为正在写入，写完后调用 finishFrame() */
+    Channel *channelFor(const char *streamId, const char *userId, bool isLocal);
+    void finishFrame(Channel *channel);
+    void produce(Channel *channel, const RtcVideoFrame &frame);
+    void consumerLoop();
+    void wakeConsumer();
+
+    VideoFrameTapConfig m_config;
+    IVideoFrameTapConsumer *m_consumer = nullptr;
+    std::unique_ptr<IVideoFrameTapConsumer> m_defaultConsumer;
+    std::unique_ptr<Channel> m_channels[kMaxStreams];
+    std::atomic<bool> m_running{false};
+    std::atomic<uint32_t> m_wakeSeq{0};
+    std::atomic<uint32_t> m_consumerWaiting{0};
+    std::atomic<uint64_t> m_droppedFrames{0};
+    std::thread m_thread;
+};
@@ -0,0 +1,204 @@
+#include "VideoGrid.h"
+#include <QDebug>
+#include <QEvent>
+#include <QGridLayout>
+#include <QScrollBar>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include "VideoWidget.h"
+
+VideoGridConfig VideoGridConfig::fromEnvironment() {
+    VideoGridConfig config;
+    const char *value = std::getenv("QUICKSTART_VIDEO_GRID");
+    if (!value) {
+        return config;
+    }
+
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        auto pos = item.find('=');
+        if (pos == std::string::npos) continue;
+        std::string key = item.substr(0, pos);
+        int number = std::atoi(item.c_str() + pos + 1);
+
+        if (key == "columns") config.maxColumns = number;
+        else if (key == "min_tile") config.minTileWidth = number;
+        else if (key == "thumbnail") config.thumbnailWidth = number;
+        else if (key == "settle_ms") config.settleMs = number;
+        else qWarning() << "QUICKSTART_VIDEO_GRID: unknown key" << key.c_str();
+    }
+
+    config.maxColumns = std::max(1, config.maxColumns);
+    config.minTileWidth = std::max(80, config.minTileWidth);
+    config.settleMs = std::max(0, config.settleMs);
+    return config;
+}
+
+VideoGrid::VideoGrid(QWidget *parent)
+        : QScrollArea(parent), m_config(VideoGridConfig::fromEnvironment()) {
+    setFrameShape(QFrame::NoFrame);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    setWidgetResizable(true);
+    viewport()->setAutoFillBackground(false);
+
+    m_container = new QWidget();
+    m_container->setAutoFillBackground(false);
+    m_layout = new QGridLayout(m_container);
+    m_layout->setContentsMargins(0, 0, 0, 0);
+    m_layout->setSpacing(4);
+    setWidget(m_container);
+
+    m_localTile = new VideoWidget(m_container);
+
+    m_settleTimer.setSingleShot(true);
+    m_settleTimer.setInterval(m_config.settleMs);
+    connect(&m_settleTimer, &QTimer::timeout, this, &VideoGrid::updateVisibility);
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, &VideoGrid::scheduleVisibilityUpdate);
+
+    relayout();
+}
+
+VideoWidget *VideoGrid::addRemote(const QString &streamId, const QString &userId) {
+    if (VideoWidget *existing = remoteTile(streamId)) {
+        return existing;
+    }
+
+    RemoteTile tile;
+    tile.streamId = streamId;
+    tile.userId = userId;
+    tile.widget = new VideoWidget(m_container);
+    tile.widget->showVideo(userId);
+    m_remoteTiles.push_back(tile);
+
+    relayout();
+    return tile.widget;
+}
+
+VideoWidget *VideoGrid::removeRemote(const QString &streamId) {
+    auto it = std::find_if(m_remoteTiles.begin(), m_remoteTiles.end(),
+                           [&](const RemoteTile &tile) { return tile.streamId == streamId; });
+    if (it == m_remoteTiles.end()) {
+        return nullptr;
+    }
+
+    VideoWidget *widget = it->widget;
+    m_layout->removeWidget(widget);
+    widget->hide();
+    m_remoteTiles.erase(it);
+
+    relayout();
+    return widget;
+}
+
+VideoWidget *VideoGrid::remoteTile(const QString &streamId) const {
+    for (const auto &tile : m_remoteTiles) {
+        if (tile.streamId == streamId) return tile.widget;
+    }
+    return nullptr;
+}
+
+QStringList VideoGrid::remoteStreams() const {
+    QStringList streams;
+    for (const auto &tile : m_remoteTiles) {
+        streams.append(tile.streamId);
+    }
+    return streams;
+}
+
+QStringList VideoGrid::remoteStreamsOfUser(const QString &userId) const {
+    QStringList streams;
+    for (const auto &tile : m_remoteTiles) {
+        if (tile.userId == userId) streams.append(tile.streamId);
+    }
+    return streams;
+}
+
+bool VideoGrid::eventFilter(QObject *watched, QEvent *event) {
+    if (watched == m_watchedWindow && event->type() == QEvent::WindowStateChange) {
+        scheduleVisibilityUpdate();
+    }
+    return QScrollArea::eventFilter(watched, event);
+}
+
+void VideoGrid::resizeEvent(QResizeEvent *event) {
+    QScrollArea::resizeEvent(event);
+    scheduleVisibilityUpdate();
+}
+
+void VideoGrid::showEvent(QShowEvent *event) {
+    QScrollArea::showEvent(event);
+    // 最小化只改变顶层窗口的状态，需要监听顶层窗口
+    if (window() != m_watchedWindow) {
+        if (m_watchedWindow) m_watchedWindow->removeEventFilter(this);
+        m_watchedWindow = window();
+        m_watchedWindow->installEventFilter(this);
+    }
+    scheduleVisibilityUpdate();
+}
+
+void VideoGrid::hideEvent(QHideEvent *event) {
+    QScrollArea::hideEvent(event);
+    scheduleVisibilityUpdate();
+}
+
+void VideoGrid::relayout() {
+    for (int i = 0; i < m_layout->rowCount(); ++i) m_layout->setRowStretch(i, 0);
+    for (int i = 0; i < m_layout->columnCount(); ++i) m_layout->setColumnStretch(i, 0);
+
+    std::vector<VideoWidget *> tiles;
+    tiles.push_back(m_localTile);
+    for (const auto &tile : m_remoteTiles) {
+        tiles.push_back(tile.widget);
+    }
+    for (auto *widget : tiles) {
+        m_layout->removeWidget(widget);
+    }
+
+    const int count = static_cast<int>(tiles.size());
+    const int columns = std::min(m_config.maxColumns, static_cast<int>(std::ceil(std::sqrt(double(count)))));
+    const int rows = (count + columns - 1) / columns;
+    for (int i = 0; i < count; ++i) {
+        tiles[i]->setMinimumSize(m_config.minTileWidth, m_config.minTileWidth * 3 / 4);
+        m_layout->addWidget(tiles[i], i / columns, i % columns);
+    }
+    for (int i = 0; i < rows; ++i) m_layout->setRowStretch(i, 1);
+    for (int i = 0; i < columns; ++i) m_layout->setColumnStretch(i, 1);
+
+    scheduleVisibilityUpdate();
+}
+
+void VideoGrid::scheduleVisibilityUpdate() {
+    // 拖动窗口大小或滚动期间只重启计时，稳定后统一更新，避免反复订阅
+    m_settleTimer.start();
+}
+
+void VideoGrid::updateVisibility() {
+    const bool shown = isVisible() && !window()->isMinimized();
+    const QRect viewportRect = viewport()->rect();
+
+    // 回调方可能在信号中增删画面，先收集变化再发出
+    std::vector<RemoteTile> changed;
+    for (auto &tile : m_remoteTiles) {
+        bool visible = false;
+        if (shown) {
+            // 露出不到四分之一的画面按不可见处理
+            QRect tileRect(tile.widget->mapTo(viewport(), QPoint(0, 0)), tile.widget->size());
+            QRect exposed = viewportRect.intersected(tileRect);
+            visible = !exposed.isEmpty() && exposed.height() * 4 >= tileRect.height();
+        }
+        bool thumbnail = tile.widget->width() < m_config.thumbnailWidth;
+        if (visible != tile.visible || (visible && thumbnail != tile.thumbnail)) {
+            tile.visible = visible;
+            tile.thumbnail = thumbnail;
+            changed.push_back(tile);
+        }
+    }
+
+    for (const auto &tile : changed) {
+        emit remoteTileChanged(tile.streamId, tile.visible, tile.thumbnail);
+    }
+}
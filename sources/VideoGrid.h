@@ -0,0 +1,84 @@
+#pragma once
+
+#include <QScrollArea>
+#include <QStringList>
+#include <QTimer>
+#include <vector>
+
+class QGridLayout;
+class VideoWidget;
+
+/**
+ * 视频网格配置
+ *
+ * 通过环境变量 QUICKSTART_VIDEO_GRID 以 "key=value,key=value" 形式覆盖：
+ *   columns=N        最多列数，默认 4
+ *   min_tile=N       画面最小宽度（像素），放不下时网格纵向滚动，默认 240
+ *   thumbnail=N      画面宽度小于该值时视为缩略图，只订阅小分辨率层，默认 480
+ *   settle_ms=N      布局、滚动或窗口状态变化后等待稳定再更新订阅，默认 250
+ */
+struct VideoGridConfig {
+    int maxColumns = 4;
+    int minTileWidth = 240;
+    int thumbnailWidth = 480;
+    int settleMs = 250;
+
+    static VideoGridConfig fromEnvironment();
+};
+
+/**
+ * 按需创建画面的视频网格
+ *
+ * 第一个画面固定为本地预览，远端画面随流的发布/取消发布增删，
+ * 列数随画面数量按近似正方形排布，超出可视区域时纵向滚动。
+ *
+ * 布局、滚动、显示/隐藏或窗口最小化后，网格重新计算每个远端画面是否可见、
+ * 是否为缩略图，有变化时发出 remoteTileChanged，由调用方据此订阅、取消订阅或切换 simulcast 层。
+ */
+class VideoGrid : public QScrollArea {
+    Q_OBJECT
+
+public:
+    explicit VideoGrid(QWidget *parent = Q_NULLPTR);
+
+    VideoWidget *localTile() const { return m_localTile; }
+
+    /** 为远端流创建画面，已存在时返回已有画面 */
+    VideoWidget *addRemote(const QString &streamId, const QString &userId);
+    /** 移除远端流的画面，返回被移除的画面（已脱离布局，稍后删除），不存在时返回 nullptr */
+    VideoWidget *removeRemote(const QString &streamId);
+    VideoWidget *remoteTile(const QString &streamId) const;
+    QStringList remoteStreams() const;
+    QStringList remoteStreamsOfUser(const QString &userId) const;
+    int remoteCount() const { return static_cast<int>(m_remoteTiles.size()); }
+
+signals:
+    void remoteTileChanged(const QString &streamId, bool visible, bool thumbnail);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    struct RemoteTile {
+        QString streamId;
+        QString userId;
+        VideoWidget *widget = nullptr;
+        bool visible = false;
+        bool thumbnail = false;
+    };
+
+    void relayout();
+    void scheduleVisibilityUpdate();
+    void updateVisibility();
+
+    VideoGridConfig m_config;
+    QWidget *m_container = nullptr;
+    QGridLayout *m_layout = nullptr;
+    VideoWidget *m_localTile = nullptr;
+    std::vector<RemoteTile> m_remoteTiles;
+    QTimer m_settleTimer;
+    QWidget *m_watchedWindow = nullptr;
+};
@@ -0,0 +1,248 @@
+#include "VideoRenderer.h"
+#include "ThreadPolicy.h"
+#include <QDebug>
+#include <QGuiApplication>
+#include <QScreen>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include "ColorConvert.h"
+#include "VideoCanvas.h"
+
+namespace {
+
+int64_t steadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+VideoRenderConfig VideoRenderConfig::fromEnvironment() {
+    VideoRenderConfig config;
+    const char *value = std::getenv("QUICKSTART_RENDER");
+    if (!value) {
+        return config;
+    }
+
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item == "native") config.inProcess = false;
+        else if (item == "inprocess") config.inProcess = true;
+        else if (item == "stats") config.showStats = true;
+        else if (item.compare(0, 10, "report_ms=") == 0) config.reportIntervalMs = std::atoi(item.c_str() + 10);
+        else if (!item.empty()) qWarning() << "QUICKSTART_RENDER: unknown option" << item.c_str();
+    }
+    return config;
+}
+
+// ── VideoFrameSink ────────────────────────────────────────────────
+
+VideoFrameSink::VideoFrameSink() = default;
+
+void VideoFrameSink::pushFrame(const RtcVideoFrame &frame) {
+    if (frame.format != RtcPixelFormat::I420 || frame.width <= 0 || frame.height <= 0) {
+        return;
+    }
+    m_received.fetch_add(1, std::memory_order_relaxed);
+
+    Slot &slot = m_slots[m_writeIndex];
+    slot.arrivalNs = steadyNs();
+    if (slot.image.width() != frame.width || slot.image.height() != frame.height) {
+        slot.image = QImage(frame.width, frame.height, QImage::Format_RGB32);
+    }
+    ColorConvert::i420ToRgb(frame.planes[0], frame.strides[0],
+                            frame.planes[1], frame.strides[1],
+                            frame.planes[2], frame.strides[2],
+                            slot.image.bits(), slot.image.bytesPerLine(),
+                            frame.width, frame.height, ColorConvert::RgbLayout::Bgra32);
+
+    uint64_t damage = computeDamage(frame);
+    // 就绪帧还没被取走就会被这一帧替换，它的变化区域要一并重绘。
+    // 消费者恰好在此之后取走时只会多画几个格子，不会漏画
+    if (m_ready.load(std::memory_order_acquire) & kFresh) {
+        damage |= m_lastDamage;
+    }
+    slot.damage = damage;
+    m_lastDamage = damage;
+
+    uint32_t prev = m_ready.exchange(uint32_t(m_writeIndex) | kFresh, std::memory_order_acq_rel);
+    m_writeIndex = int(prev & 3);
+    if (prev & kFresh) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+const VideoFrameSink::Slot *VideoFrameSink::acquire() {
+    if (!(m_ready.load(std::memory_order_acquire) & kFresh)) {
+        return nullptr;
+    }
+    uint32_t prev = m_ready.exchange(uint32_t(m_presentIndex), std::memory_order_acq_rel);
+    m_presentIndex = int(prev & 3);
+    return &m_slots[m_presentIndex];
+}
+
+uint64_t VideoFrameSink::computeDamage(const RtcVideoFrame &frame) {
+    const int width = frame.width;
+    const int height = frame.height;
+    if (width != m_prevWidth || height != m_prevHeight) {
+        m_prevWidth = width;
+        m_prevHeight = height;
+        m_prevLuma.resize(size_t(width) * height);
+        for (int y = 0; y < height; ++y) {
+            memcpy(m_prevLuma.data() + size_t(y) * width, frame.planes[0] + size_t(y) * frame.strides[0], width);
+        }
+        return ~uint64_t(0);
+    }
+
+    const int tileW = (width + kGrid - 1) / kGrid;
+    const int tileH = (height + kGrid - 1) / kGrid;
+    uint64_t damage = 0;
+    for (int y = 0; y < height; ++y) {
+        const uint8_t *row = frame.planes[0] + size_t(y) * frame.strides[0];
+        uint8_t *prev = m_prevLuma.data() + size_t(y) * width;
+        const int ty = y / tileH;
+        for (int tx = 0; tx < kGrid; ++tx) {
+            const uint64_t bit = uint64_t(1) << (ty * kGrid + tx);
+            if (damage & bit) continue;
+            const int x0 = tx * tileW;
+            const int len = std::min(tileW, width - x0);
+            if (len > 0 && memcmp(row + x0, prev + x0, len) != 0) {
+                damage |= bit;
+            }
+        }
+        memcpy(prev, row, width);
+    }
+    return damage;
+}
+
+// ── InProcessVideoRenderer ────────────────────────────────────────
+
+InProcessVideoRenderer::InProcessVideoRenderer(const VideoRenderConfig &config, QObject *parent)
+        : QObject(parent), m_config(config) {
+    // 没有直接的 vsync 通知，按主屏刷新率驱动呈现节拍
+    double refreshRate = 60.0;
+    if (QScreen *screen = QGuiApplication::primaryScreen()) {
+        if (screen->refreshRate() > 1.0) refreshRate = screen->refreshRate();
+    }
+    m_clock.setTimerType(Qt::PreciseTimer);
+    m_clock.setInterval(std::max(4, int(1000.0 / refreshRate)));
+    connect(&m_clock, &QTimer::timeout, this, &InProcessVideoRenderer::onTick);
+
+    qInfo() << "InProcessVideoRenderer: refresh" << refreshRate << "Hz, simd"
+            << ColorConvert::hasSimd();
+}
+
+InProcessVideoRenderer::~InProcessVideoRenderer() {
+    m_clock.stop();
+    for (auto &entry : m_canvases) {
+        if (entry.second) entry.second->setFrameSink(nullptr);
+    }
+}
+
+void InProcessVideoRenderer::attachLocal(VideoCanvas *canvas) {
+    attach(std::string(), canvas);
+}
+
+void InProcessVideoRenderer::attachRemote(const std::string &streamId, VideoCanvas *canvas) {
+    attach(streamId, canvas);
+}
+
+void InProcessVideoRenderer::attach(const std::string &key, VideoCanvas *canvas) {
+    if (!canvas) return;
+    detach(canvas);
+
+    auto sink = std::make_shared<VideoFrameSink>();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_sinks[key] = sink;
+    }
+    auto it = m_canvases.find(key);
+    if (it != m_canvases.end() && it->second && it->second != canvas) {
+        it->second->setFrameSink(nullptr);
+    }
+    canvas->setFrameSink(sink);
+    canvas->setStatsVisible(m_config.showStats);
+    m_canvases[key] = canvas;
+
+    if (!m_clock.isActive()) {
+        m_lastReportNs = m_lastStatsNs = steadyNs();
+        m_clock.start();
+    }
+}
+
+void InProcessVideoRenderer::detach(VideoCanvas *canvas) {
+    for (auto it = m_canvases.begin(); it != m_canvases.end();) {
+        if (it->second == canvas) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_sinks.erase(it->first);
+            }
+            it = m_canvases.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (canvas) canvas->setFrameSink(nullptr);
+    if (m_canvases.empty()) m_clock.stop();
+}
+
+void InProcessVideoRenderer::onLocalVideoFrame(const RtcVideoFrame &frame) {
+    ThreadPolicy::adoptCurrentThread(ThreadClass::Video, "rtc-video");
+    std::shared_ptr<VideoFrameSink> sink;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_sinks.find(std::string());
+        if (it == m_sinks.end()) return;
+        sink = it->second;
+    }
+    sink->pushFrame(frame);
+}
+
+void InProcessVideoRenderer::onRemoteVideoFrame(const char *streamId, const char *userId, const RtcVideoFrame &frame) {
+    ThreadPolicy::adoptCurrentThread(ThreadClass::Video, "rtc-video");
+    if (!streamId || !*streamId) return;
+    std::shared_ptr<VideoFrameSink> sink;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_sinks.find(streamId);
+        if (it == m_sinks.end()) return;
+        sink = it->second;
+    }
+    sink->pushFrame(frame);
+}
+
+void InProcessVideoRenderer::onTick() {
+    for (auto &entry : m_canvases) {
+        if (entry.second) entry.second->present();
+    }
+
+    int64_t now = steadyNs();
+    if (now - m_lastStatsNs >= 1000000000LL) {
+        m_lastStatsNs = now;
+        report();
+    }
+}
+
+void InProcessVideoRenderer::report() {
+    // 每秒刷新一次画面上的统计；日志按 report_ms 输出
+    int64_t now = steadyNs();
+    bool log = m_config.reportIntervalMs > 0
+            && now - m_lastReportNs >= int64_t(m_config.reportIntervalMs) * 1000000;
+    if (log) m_lastReportNs = now;
+
+    for (auto &entry : m_canvases) {
+        if (!entry.second) continue;
+        VideoCanvas::Stats stats = entry.second->takeStats();
+        if (log) {
+            auto sink = entry.second->frameSink();
+            qInfo() << "InProcessVideoRenderer:" << (entry.first.empty() ? "local" : entry.first.c_str())
+                    << "fps" << stats.rendered << "dropped/s" << stats.dropped
+                    << "received total" << (sink ? sink->receivedFrames() : 0)
+                    << "latency avg" << stats.avgLatencyMs << "ms max" << stats.maxLatencyMs << "ms";
+        }
+    }
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <QImage>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "RtcBackend.h"
+
+class VideoCanvas;
+
+/**
+ * 视频渲染方式配置
+ *
+ * 通过环境变量 QUICKSTART_RENDER 选择：
+ *   native（默认）   把 VideoWidget 的原生窗口句柄交给 SDK 渲染
+ *   inprocess        SDK 只解码，帧经 InProcessVideoRenderer 在本进程内绘制到 VideoCanvas
+ * inprocess 之后可以追加：
+ *   stats            在画面左上角显示渲染/丢帧/呈现延迟
+ *   report_ms=N      统计输出间隔，默认 10000，0 表示不输出
+ * 例如：QUICKSTART_RENDER=inprocess,stats
+ */
+struct VideoRenderConfig {
+    bool inProcess = false;
+    bool showStats = false;
+    int reportIntervalMs = 10000;
+
+    static VideoRenderConfig fromEnvironment();
+};
+
+/**
+ * 单个画面的三缓冲帧交接
+ *
+ * 引擎回调线程（生产者）把 I420 帧转换到写槽，再与就绪槽交换；
+ * 界面线程（消费者）在每个刷新节拍取走最新的就绪帧与呈现槽交换。
+ * 生产者覆盖了尚未被取走的就绪帧时计为丢帧，因此界面总是只绘制最新的一帧，
+ * 双方都不会阻塞。
+ *
+ * 每帧按 8x8 网格比较亮度平面得到变化区域（damage），界面只重绘变化的格子；
+ * 上一帧被丢弃时，其变化区域会合并到下一帧。
+ */
+class VideoFrameSink {
+public:
+    static constexpr int kGrid = 8;
+
+    struct Slot {
+        QImage image;
+        uint64_t damage = 0;     // 相对上一次呈现的帧变化的格子，bit = y * kGrid + x
+        int64_t arrivalNs = 0;   // 引擎交出该帧的时间，用于统计呈现延迟
+    };
+
+    VideoFrameSink();
+
+    /** 生产者：转换并发布一帧 */
+    void pushFrame(const RtcVideoFrame &frame);
+
+    /** 消费者：有新帧时取走并返回，否则返回 nullptr */
+    const Slot *acquire();
+
+    /** 消费者：最近一次取走的帧（可能为空图像） */
+    const Slot &current() const { return m_slots[m_presentIndex]; }
+
+    uint64_t receivedFrames() const { return m_received.load(std::memory_order_relaxed); }
+    uint64_t droppedFrames() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t kFresh = 4;
+
+    uint64_t computeDamage(const RtcVideoFrame &frame);
+
+    Slot m_slots[3];
+    std::atomic<uint32_t> m_ready{1};
+    std::atomic<uint64_t> m_received{0};
+    std::atomic<uint64_t> m_dropped{0};
+
+    // 以下只在生产者线程访问
+    int m_writeIndex = 0;
+    uint64_t m_lastDamage = 0;
+    std::vector<uint8_t> m_prevLuma;
+    int m_prevWidth = 0;
+    int m_prevHeight = 0;
+
+    // 以下只在消费者线程访问
+    int m_presentIndex = 2;
+};
+
+/**
+ * 进程内视频渲染器
+ *
+ * 作为 IRtcVideoFrameObserver 接收解码后的帧，按流分发到对应 VideoCanvas 的 VideoFrameSink。
+ * 界面线程上的定时器按屏幕刷新率触发，每个节拍每个画面最多呈现一帧，
+ * 并定期输出各画面的渲染帧数、丢帧数和呈现延迟。
+ *
+ * attach/detach 只在界面线程调用；回调线程上只在查找画面时短暂持锁。
+ */
+class InProcessVideoRenderer : public QObject, public IRtcVideoFrameObserver {
+    Q_OBJECT
+
+public:
+    explicit InProcessVideoRenderer(const VideoRenderConfig &config, QObject *parent = nullptr);
+    ~InProcessVideoRenderer() override;
+
+    void attachLocal(VideoCanvas *canvas);
+    void attachRemote(const std::string &streamId, VideoCanvas *canvas);
+    void detach(VideoCanvas *canvas);
+
+    void onLocalVideoFrame(const RtcVideoFrame &frame) override;
+    void onRemoteVideoFrame(const char *streamId, const char *userId, const RtcVideoFrame &frame) override;
+
+private:
+    void attach(const std::string &key, VideoCanvas *canvas);
+    void onTick();
+    void report();
+
+    VideoRenderConfig m_config;
+    QTimer m_clock;
+    int64_t m_lastReportNs = 0;
+    int64_t m_lastStatsNs = 0;
+
+    std::mutex m_mutex;
+    std::map<std::string, std::shared_ptr<VideoFrameSink>> m_sinks;   // 本地画面的键为空串
+    std::map<std::string, QPointer<VideoCanvas>> m_canvases;
+};
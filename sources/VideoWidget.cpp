@@ -6,6 +6,7 @@
 VideoWidget::VideoWidget(QWidget *parent)
         : QWidget(parent) {
     ui.setupUi(this);
+    ui.statsLabel->hide();
     hideVideo();
 }
 
@@ -25,6 +26,7 @@ void VideoWidget::hideVideo() {
     m_uid.clear();
     ui.label->hide();
     ui.videoCanvas->hide();
+    setStatsText(QString());
     m_bActive = false;
 }
 
@@ -36,6 +38,15 @@ QWidget *VideoWidget::getVideoWidget() {
     return ui.videoCanvas;
 }
 
+VideoCanvas *VideoWidget::getVideoCanvas() {
+    return ui.videoCanvas;
+}
+
+void VideoWidget::setStatsText(const QString &text) {
+    ui.statsLabel->setText(text);
+    ui.statsLabel->setVisible(!text.isEmpty());
+}
+
 bool VideoWidget::isActive() {
     return m_bActive;
 }
\ No newline at end of file
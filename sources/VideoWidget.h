@@ -11,6 +11,11 @@ public:
 
     QWidget *getVideoWidget();
 
+    VideoCanvas *getVideoCanvas();
+
+    /** 在画面下方显示流质量统计，空串时隐藏 */
+    void setStatsText(const QString &text);
+
     void showVideo(const QString &uid);
 
     void hideVideo();
@@ -0,0 +1,62 @@
+#include "VoiceActivityDetector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 底噪每帧向当前电平靠近的比例：下降快（约 20 ms），上升慢（约 10 s）
+constexpr double kFloorFallRate = 0.5;
+constexpr double kFloorRisePerMs = 0.0001;
+constexpr double kMinDb = -96.0;
+
+} // namespace
+
+VoiceActivityDetector::VoiceActivityDetector(const VoiceActivityConfig &config)
+    : m_config(config) {
+}
+
+bool VoiceActivityDetector::process(const int16_t *samples, int sampleCount, int frameMs) {
+    if (sampleCount <= 0) {
+        return m_active;
+    }
+
+    int64_t energy = 0;
+    for (int i = 0; i < sampleCount; ++i) {
+        energy += int32_t(samples[i]) * samples[i];
+    }
+    double meanSquare = double(energy) / sampleCount;
+    m_levelDb = meanSquare > 0 ? std::max(kMinDb, 10.0 * std::log10(meanSquare / (32768.0 * 32768.0))) : kMinDb;
+
+    if (m_levelDb < m_noiseFloorDb) {
+        m_noiseFloorDb += (m_levelDb - m_noiseFloorDb) * kFloorFallRate;
+    } else {
+        m_noiseFloorDb += (m_levelDb - m_noiseFloorDb) * std::min(1.0, kFloorRisePerMs * frameMs);
+    }
+
+    bool speech = m_levelDb > std::max(m_config.thresholdDb, m_noiseFloorDb + m_config.marginDb);
+    if (speech) {
+        m_silenceMs = 0;
+        m_speechMs += frameMs;
+        if (!m_active && m_speechMs >= m_config.attackMs) {
+            m_active = true;
+        }
+    } else {
+        m_speechMs = 0;
+        if (m_active) {
+            m_silenceMs += frameMs;
+            if (m_silenceMs >= m_config.hangoverMs) {
+                m_active = false;
+                m_silenceMs = 0;
+            }
+        }
+    }
+    return m_active;
+}
+
+void VoiceActivityDetector::reset() {
+    m_active = false;
+    m_speechMs = 0;
+    m_silenceMs = 0;
+    m_levelDb = kMinDb;
+    m_noiseFloorDb = -60.0;
+}
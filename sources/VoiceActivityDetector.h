@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * 基于能量的语音活动检测
+ *
+ * 每帧计算 RMS 电平（dBFS），并跟踪一个自适应的底噪：低于底噪时快速下降，
+ * 其余时间缓慢上升（稳态噪声最终会被当作底噪）。电平同时高于 thresholdDb 和
+ * 底噪 + marginDb 的帧视为语音帧。
+ *
+ * 连续语音达到 attackMs 后打开，最后一个语音帧之后保持 hangoverMs 再关闭，
+ * 避免在词与词之间的短停顿上来回切换。
+ */
+struct VoiceActivityConfig {
+    double thresholdDb = -50.0;
+    double marginDb = 12.0;
+    int attackMs = 30;
+    int hangoverMs = 600;
+};
+
+class VoiceActivityDetector {
+public:
+    explicit VoiceActivityDetector(const VoiceActivityConfig &config = VoiceActivityConfig());
+
+    /** 处理一帧交织 PCM，返回处理后的检测状态 */
+    bool process(const int16_t *samples, int sampleCount, int frameMs);
+
+    void reset();
+
+    bool isActive() const { return m_active; }
+    double levelDb() const { return m_levelDb; }
+    double noiseFloorDb() const { return m_noiseFloorDb; }
+
+private:
+    VoiceActivityConfig m_config;
+    bool m_active = false;
+    int m_speechMs = 0;
+    int m_silenceMs = 0;
+    double m_levelDb = -96.0;
+    double m_noiseFloorDb = -60.0;
+};
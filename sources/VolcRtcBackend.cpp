@@ -0,0 +1,536 @@
+#include "VolcRtcBackend.h"
+#include <QDebug>
+#include <cstring>
+
+// ── 房间 ──────────────────────────────────────────────────────────
+
+class VolcRtcEngine::Room : public IRtcRoom {
+public:
+    Room(bytertc::IRTCRoom *room, const std::string &roomId)
+        : m_room(room), m_roomId(roomId) {}
+
+    ~Room() override {
+        if (m_room) {
+            m_room->setRTCRoomEventHandler(nullptr);
+            m_room->destroy();
+        }
+    }
+
+    bytertc::IRTCRoom *sdkRoom() const { return m_room; }
+
+    int joinRoom(const std::string &token, const std::string &userId, const RtcRoomConfig &config) override {
+        // SDK 只保存指针，字符串需在房间生命周期内保持有效
+        m_userId = userId;
+        m_streamId = config.streamId;
+
+        bytertc::UserInfo userInfo;
+        userInfo.uid = m_userId.c_str();
+        userInfo.extra_info = nullptr;
+
+        bytertc::RTCRoomConfig roomConfig;
+        roomConfig.stream_id = m_streamId.c_str();
+        roomConfig.is_auto_publish_audio = config.autoPublishAudio;
+        roomConfig.is_auto_publish_video = config.autoPublishVideo;
+        roomConfig.is_auto_subscribe_audio = config.autoSubscribeAudio;
+        roomConfig.is_auto_subscribe_video = config.autoSubscribeVideo;
+        roomConfig.room_profile_type = bytertc::kRoomProfileTypeCommunication;
+        return m_room->joinRoom(token.c_str(), userInfo, true, roomConfig);
+    }
+
+    int leaveRoom() override {
+        return m_room->leaveRoom();
+    }
+
+    int publishStreamAudio(bool publish) override {
+        return m_room->publishStreamAudio(publish);
+    }
+
+    int subscribeStreamVideo(const std::string &streamId, bool subscribe) override {
+        return m_room->subscribeStreamVideo(streamId.c_str(), subscribe);
+    }
+
+    int setRemoteVideoConfig(const std::string &streamId, const RtcRemoteVideoConfig &config) override {
+        bytertc::RemoteVideoConfig remoteConfig;
+        remoteConfig.resolution_width = config.width;
+        remoteConfig.resolution_height = config.height;
+        remoteConfig.framerate = config.frameRate;
+        return m_room->setRemoteVideoConfig(streamId.c_str(), remoteConfig);
+    }
+
+private:
+    bytertc::IRTCRoom *m_room;
+    std::string m_roomId;
+    std::string m_userId;
+    std::string m_streamId;
+};
+
+// ── 视频帧回调 ────────────────────────────────────────────────────
+
+class VolcRtcEngine::VideoSink : public bytertc::IVideoSink {
+public:
+    VideoSink(VolcRtcEngine *owner, bool isLocal, const std::string &streamId, const std::string &userId)
+        : isLocal(isLocal), streamId(streamId), userId(userId), m_owner(owner) {}
+
+    bool onFrame(bytertc::IVideoFrame *video_frame) override {
+        m_owner->dispatchVideoFrame(this, video_frame);
+        return true;
+    }
+
+    int getRenderElapse() override {
+        return 0;
+    }
+
+    const bool isLocal;
+    const std::string streamId;
+    const std::string userId;
+
+private:
+    VolcRtcEngine *m_owner;
+};
+
+// ── VolcRtcEngine 实现 ────────────────────────────────────────────
+
+VolcRtcEngine::VolcRtcEngine() = default;
+
+VolcRtcEngine::~VolcRtcEngine() {
+    destroy();
+}
+
+std::string VolcRtcEngine::sdkVersion() const {
+    return std::string("VolcEngineRTC v") + bytertc::IRTCEngine::getSDKVersion();
+}
+
+bool VolcRtcEngine::create(const std::string &appId, IRtcEventHandler *handler) {
+    if (m_engine) {
+        qWarning() << "VolcRtcEngine already created";
+        return false;
+    }
+
+    // SDK 可能在 createRTCEngine 返回前就在自己的线程上回调，处理者须先设置好
+    m_handler.store(handler, std::memory_order_release);
+
+    bytertc::EngineConfig config;
+    config.app_id = appId.c_str();
+    config.parameters = "";
+    m_engine = bytertc::IRTCEngine::createRTCEngine(config, this);
+    if (m_engine == nullptr) {
+        qWarning() << "create engine failed";
+        m_handler.store(nullptr, std::memory_order_release);
+        return false;
+    }
+
+    updateVideoSinks();
+    updateAudioCallbacks();
+    return true;
+}
+
+void VolcRtcEngine::destroy() {
+    if (!m_engine) {
+        return;
+    }
+    if (m_room) {
+        destroyRoom(m_room.get());
+    }
+    if (m_audioCallbacksEnabled) {
+        m_engine->registerAudioFrameObserver(nullptr);
+        m_audioCallbacksEnabled = false;
+    }
+
+    bytertc::IRTCEngine::destroyRTCEngine();
+    m_engine = nullptr;
+    m_handler.store(nullptr, std::memory_order_release);
+
+    // 引擎销毁后 SDK 不再回调 sink，可以安全释放
+    std::lock_guard<std::mutex> lock(m_sinkMutex);
+    m_localSink.reset();
+    m_remoteSinks.clear();
+    m_remoteStreams.clear();
+}
+
+int VolcRtcEngine::setVideoEncoderProfile(const RtcVideoEncoderProfile &profile) {
+    if (!m_engine) return -1;
+
+    bytertc::VideoEncoderConfig conf;
+    conf.frame_rate = profile.frameRate;
+    conf.width = profile.width;
+    conf.height = profile.height;
+    conf.max_bitrate = profile.maxBitrateKbps;
+    conf.min_bitrate = profile.minBitrateKbps;
+    return m_engine->setVideoEncoderConfig(conf);
+}
+
+int VolcRtcEngine::setLocalVideoCanvas(void *view) {
+    if (!m_engine) return -1;
+
+    bytertc::VideoCanvas canvas;
+    canvas.view = view;
+    canvas.render_mode = bytertc::RenderMode::kRenderModeFit;
+    return m_engine->setLocalVideoCanvas(canvas);
+}
+
+int VolcRtcEngine::setRemoteVideoCanvas(const std::string &streamId, void *view) {
+    if (!m_engine) return -1;
+
+    bytertc::VideoCanvas canvas;
+    canvas.view = view;
+    canvas.render_mode = bytertc::RenderMode::kRenderModeFit;
+    return m_engine->setRemoteVideoCanvas(streamId.c_str(), canvas);
+}
+
+int VolcRtcEngine::startVideoCapture() {
+    return m_engine ? m_engine->startVideoCapture() : -1;
+}
+
+int VolcRtcEngine::stopVideoCapture() {
+    return m_engine ? m_engine->stopVideoCapture() : -1;
+}
+
+int VolcRtcEngine::startAudioCapture() {
+    return m_engine ? m_engine->startAudioCapture() : -1;
+}
+
+int VolcRtcEngine::stopAudioCapture() {
+    return m_engine ? m_engine->stopAudioCapture() : -1;
+}
+
+int VolcRtcEngine::setExternalVideoSource(bool enable) {
+    if (!m_engine) return -1;
+    return m_engine->setVideoSourceType(bytertc::kStreamIndexMain,
+            enable ? bytertc::VideoSourceType::kVideoSourceTypeExternal
+                   : bytertc::VideoSourceType::kVideoSourceTypeInternal);
+}
+
+namespace {
+
+// 外部帧的释放信息，随 VideoFrameBuilder::user_opaque 交给 SDK
+struct ExternalFrameRelease {
+    void (*release)(void *opaque, int bufferIndex);
+    void *opaque;
+    int bufferIndex;
+};
+
+int releaseExternalFrame(bytertc::VideoFrameBuilder *builder) {
+    auto *info = static_cast<ExternalFrameRelease *>(builder->user_opaque);
+    if (info) {
+        if (info->release) info->release(info->opaque, info->bufferIndex);
+        delete info;
+    }
+    return 0;
+}
+
+} // namespace
+
+int VolcRtcEngine::pushExternalVideoFrame(const RtcExternalVideoFrame &frame) {
+    if (!m_engine) {
+        if (frame.release) frame.release(frame.opaque, frame.bufferIndex);
+        return -1;
+    }
+
+    // SDK 直接引用帧内存，通过 memory_deleter 通知归还，中间不做拷贝
+    bytertc::VideoFrameBuilder builder;
+    builder.frame_type = bytertc::kVideoFrameTypeRawMemory;
+    builder.pixel_fmt = frame.format == RtcPixelFormat::NV12
+            ? bytertc::kVideoPixelFormatNV12 : bytertc::kVideoPixelFormatI420;
+    builder.width = frame.width;
+    builder.height = frame.height;
+    builder.timestamp_us = frame.timestampUs;
+    for (int i = 0; i < 3; ++i) {
+        builder.data[i] = frame.planes[i];
+        builder.linesize[i] = frame.strides[i];
+    }
+    builder.user_opaque = new ExternalFrameRelease{frame.release, frame.opaque, frame.bufferIndex};
+    builder.memory_deleter = releaseExternalFrame;
+
+    bytertc::IVideoFrame *videoFrame = bytertc::buildVideoFrame(builder);
+    if (!videoFrame) {
+        releaseExternalFrame(&builder);
+        return -1;
+    }
+    int ret = m_engine->pushExternalVideoFrame(videoFrame);
+    if (ret != 0) {
+        videoFrame->release();
+    }
+    return ret;
+}
+
+int VolcRtcEngine::setExternalAudioDevice(bool enable) {
+    if (!m_engine) return -1;
+    int ret = m_engine->setAudioSourceType(enable ? bytertc::kAudioSourceTypeExternal
+                                                  : bytertc::kAudioSourceTypeInternal);
+    if (ret != 0) return ret;
+    return m_engine->setAudioRenderType(enable ? bytertc::kAudioRenderTypeExternal
+                                               : bytertc::kAudioRenderTypeInternal);
+}
+
+int VolcRtcEngine::pushExternalAudioFrame(const RtcAudioFrame &frame) {
+    if (!m_engine || !frame.data) return -1;
+
+    // 帧只在调用期间被引用，不需要 SDK 额外拷贝一次
+    bytertc::AudioFrameBuilder builder;
+    builder.sample_rate = static_cast<bytertc::AudioSampleRate>(frame.sampleRate);
+    builder.channel = static_cast<bytertc::AudioChannel>(frame.channels);
+    builder.timestamp_us = frame.timestampUs;
+    builder.data = reinterpret_cast<uint8_t *>(const_cast<int16_t *>(frame.data));
+    builder.data_size = int64_t(frame.samplesPerChannel) * frame.channels * sizeof(int16_t);
+    builder.deep_copy = false;
+
+    bytertc::IAudioFrame *audioFrame = bytertc::buildAudioFrame(builder);
+    if (!audioFrame) return -1;
+    int ret = m_engine->pushExternalAudioFrame(audioFrame);
+    audioFrame->release();
+    return ret;
+}
+
+int VolcRtcEngine::pullExternalAudioFrame(int16_t *data, int samplesPerChannel, int channels, int sampleRate) {
+    const size_t bytes = size_t(samplesPerChannel) * channels * sizeof(int16_t);
+    if (!m_engine) {
+        std::memset(data, 0, bytes);
+        return -1;
+    }
+
+    // SDK 直接写入调用方的缓冲
+    bytertc::AudioFrameBuilder builder;
+    builder.sample_rate = static_cast<bytertc::AudioSampleRate>(sampleRate);
+    builder.channel = static_cast<bytertc::AudioChannel>(channels);
+    builder.data = reinterpret_cast<uint8_t *>(data);
+    builder.data_size = int64_t(bytes);
+    builder.deep_copy = false;
+
+    bytertc::IAudioFrame *audioFrame = bytertc::buildAudioFrame(builder);
+    if (!audioFrame) {
+        std::memset(data, 0, bytes);
+        return -1;
+    }
+    int ret = m_engine->pullExternalAudioFrame(audioFrame);
+    audioFrame->release();
+    if (ret != 0) {
+        std::memset(data, 0, bytes);
+    }
+    return ret;
+}
+
+IRtcRoom *VolcRtcEngine::createRoom(const std::string &roomId) {
+    if (!m_engine || m_room) {
+        qWarning() << "VolcRtcEngine: cannot create room" << roomId.c_str();
+        return nullptr;
+    }
+
+    auto *sdkRoom = m_engine->createRTCRoom(roomId.c_str());
+    if (!sdkRoom) {
+        return nullptr;
+    }
+    sdkRoom->setRTCRoomEventHandler(this);
+    m_room = std::make_unique<Room>(sdkRoom, roomId);
+    return m_room.get();
+}
+
+void VolcRtcEngine::destroyRoom(IRtcRoom *room) {
+    if (!room || room != m_room.get()) {
+        return;
+    }
+    m_room->leaveRoom();
+    m_room.reset();
+}
+
+void VolcRtcEngine::addVideoFrameObserver(IRtcVideoFrameObserver *observer) {
+    m_videoObservers.add(observer);
+    updateVideoSinks();
+}
+
+void VolcRtcEngine::removeVideoFrameObserver(IRtcVideoFrameObserver *observer) {
+    m_videoObservers.remove(observer);
+}
+
+void VolcRtcEngine::addAudioFrameObserver(IRtcAudioFrameObserver *observer) {
+    m_audioObservers.add(observer);
+    updateAudioCallbacks();
+}
+
+void VolcRtcEngine::removeAudioFrameObserver(IRtcAudioFrameObserver *observer) {
+    m_audioObservers.remove(observer);
+}
+
+// 只有存在观察者时才挂接 sink，避免 SDK 为无人消费的帧做格式转换
+void VolcRtcEngine::updateVideoSinks() {
+    if (!m_engine || m_videoObservers.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_sinkMutex);
+    if (!m_localSink) {
+        m_localSink = std::make_unique<VideoSink>(this, true, std::string(), std::string());
+        bytertc::LocalVideoSinkConfig config;
+        config.required_pixel_format = bytertc::kVideoPixelFormatI420;
+        m_engine->setLocalVideoSink(bytertc::kStreamIndexMain, m_localSink.get(), config);
+    }
+    for (const auto &[streamId, userId] : m_remoteStreams) {
+        if (m_remoteSinks.count(streamId)) continue;
+        auto sink = std::make_unique<VideoSink>(this, false, streamId, userId);
+        bytertc::RemoteVideoSinkConfig config;
+        config.required_pixel_format = bytertc::kVideoPixelFormatI420;
+        m_engine->setRemoteVideoSink(streamId.c_str(), sink.get(), config);
+        m_remoteSinks[streamId] = std::move(sink);
+    }
+}
+
+void VolcRtcEngine::updateAudioCallbacks() {
+    if (!m_engine || m_audioCallbacksEnabled || m_audioObservers.empty()) {
+        return;
+    }
+
+    bytertc::AudioFormat format;
+    format.sample_rate = bytertc::kAudioSampleRate16000;
+    format.channel = bytertc::kAudioChannelMono;
+    m_engine->enableAudioFrameCallback(bytertc::AudioFrameCallbackMethod::kRecord, format);
+    m_engine->enableAudioFrameCallback(bytertc::AudioFrameCallbackMethod::kPlayback, format);
+    m_engine->registerAudioFrameObserver(this);
+    m_audioCallbacksEnabled = true;
+}
+
+void VolcRtcEngine::dispatchVideoFrame(const VideoSink *sink, bytertc::IVideoFrame *frame) {
+    RtcVideoFrame view;
+    view.format = RtcPixelFormat::I420;
+    view.width = frame->width();
+    view.height = frame->height();
+    for (int i = 0; i < 3; ++i) {
+        view.planes[i] = frame->getPlaneData(i);
+        view.strides[i] = frame->getPlaneStride(i);
+    }
+    view.timestampUs = frame->timestampUs();
+
+    m_videoObservers.forEach([&](IRtcVideoFrameObserver *observer) {
+        if (sink->isLocal) {
+            observer->onLocalVideoFrame(view);
+        } else {
+            observer->onRemoteVideoFrame(sink->streamId.c_str(), sink->userId.c_str(), view);
+        }
+    });
+}
+
+static RtcAudioFrame toRtcAudioFrame(const bytertc::IAudioFrame &audio_frame) {
+    RtcAudioFrame frame;
+    frame.data = reinterpret_cast<const int16_t *>(audio_frame.data());
+    frame.channels = static_cast<int>(audio_frame.channel());
+    frame.sampleRate = static_cast<int>(audio_frame.sample_rate());
+    frame.samplesPerChannel = frame.channels > 0
+            ? static_cast<int>(audio_frame.data_size() / sizeof(int16_t) / frame.channels) : 0;
+    frame.timestampUs = audio_frame.timestamp_us();
+    return frame;
+}
+
+// ── SDK 事件 ──────────────────────────────────────────────────────
+
+void VolcRtcEngine::onRoomStateChanged(
+            const char *room_id, const char *uid, int state, const char *extra_info) {
+    if (IRtcEventHandler *handler = eventHandler()) handler->onRoomStateChanged(room_id, uid, state, extra_info);
+}
+
+void VolcRtcEngine::onError(int err) {
+    if (IRtcEventHandler *handler = eventHandler()) handler->onError(err);
+}
+
+void VolcRtcEngine::onUserJoined(const bytertc::UserInfo &user_info) {
+    if (IRtcEventHandler *handler = eventHandler()) handler->onUserJoined(user_info.uid);
+}
+
+void VolcRtcEngine::onUserLeave(const char *uid, bytertc::UserOfflineReason reason) {
+    if (IRtcEventHandler *handler = eventHandler()) handler->onUserLeave(uid, static_cast<int>(reason));
+}
+
+void VolcRtcEngine::onUserPublishStreamVideo(const char *stream_id, const bytertc::StreamInfo &stream_info, bool is_publish) {
+    // 取消发布时保留 sink：SDK 可能仍在回调，重新发布同一条流时会复用
+    if (IRtcEventHandler *handler = eventHandler()) handler->onUserPublishStreamVideo(stream_id, stream_info.user_id, is_publish);
+}
+
+void VolcRtcEngine::onFirstLocalVideoFrameCaptured(bytertc::IVideoSource *video_source, const bytertc::VideoFrameInfo &info) {
+    if (IRtcEventHandler *handler = eventHandler()) handler->onFirstLocalVideoFrameCaptured();
+}
+
+void VolcRtcEngine::onFirstRemoteVideoFrameDecoded(const char *stream_id, const bytertc::StreamInfo &stream_info, const bytertc::VideoFrameInfo &info) {
+    {
+        std::lock_guard<std::mutex> lock(m_sinkMutex);
+        m_remoteStreams[stream_id] = stream_info.user_id ? stream_info.user_id : "";
+    }
+    updateVideoSinks();
+
+    if (IRtcEventHandler *handler = eventHandler()) handler->onFirstRemoteVideoFrameDecoded(stream_id, stream_info.user_id);
+}
+
+void VolcRtcEngine::onNetworkQuality(const bytertc::NetworkQualityStats &localQuality,
+                                     const bytertc::NetworkQualityStats *remoteQualities, int remoteQualityNum) {
+    IRtcEventHandler *handler = eventHandler();
+    if (!handler) return;
+
+    RtcNetworkQuality quality;
+    quality.txQuality = static_cast<int>(localQuality.tx_quality);
+    quality.rxQuality = static_cast<int>(localQuality.rx_quality);
+    quality.lossRate = static_cast<float>(localQuality.fraction_lost);
+    quality.rttMs = localQuality.rtt;
+    handler->onNetworkQuality(quality);
+}
+
+void VolcRtcEngine::onLocalStreamStats(const char *stream_id, const bytertc::LocalStreamStats &stats) {
+    IRtcEventHandler *handler = eventHandler();
+    if (!handler) return;
+
+    RtcLocalStreamStats local;
+    local.sentKbps = stats.video_stats.sent_kbitrate;
+    local.inputFrameRate = static_cast<float>(stats.video_stats.input_frame_rate);
+    local.encoderOutputFrameRate = static_cast<float>(stats.video_stats.encoder_output_frame_rate);
+    local.encodedWidth = stats.video_stats.encoded_frame_width;
+    local.encodedHeight = stats.video_stats.encoded_frame_height;
+    local.lossRate = stats.video_stats.video_loss_rate;
+    local.rttMs = stats.video_stats.rtt;
+    handler->onLocalStreamStats(local);
+}
+
+void VolcRtcEngine::onRemoteStreamStats(const char *stream_id, const bytertc::RemoteStreamStats &stats) {
+    IRtcEventHandler *handler = eventHandler();
+    if (!handler) return;
+
+    // SDK 不单独上报解码耗时，decodeTimeMs 保持为 0
+    RtcRemoteStreamStats remote;
+    remote.receivedKbps = stats.video_stats.received_kbitrate;
+    remote.lossRate = stats.video_stats.video_loss_rate;
+    remote.rttMs = stats.video_stats.rtt;
+    remote.jitterBufferDelayMs = stats.video_stats.jitter_buffer_delay;
+    remote.e2eDelayMs = stats.video_stats.e2e_delay;
+    remote.decoderOutputFrameRate = static_cast<float>(stats.video_stats.decoder_output_frame_rate);
+    remote.renderFrameRate = static_cast<float>(stats.video_stats.renderer_output_frame_rate);
+    remote.width = stats.video_stats.width;
+    remote.height = stats.video_stats.height;
+    remote.stallCount = stats.video_stats.stall_count;
+    remote.stallDurationMs = stats.video_stats.stall_duration;
+    handler->onRemoteStreamStats(stream_id, stats.uid, remote);
+}
+
+void VolcRtcEngine::onRecordAudioFrame(const bytertc::IAudioFrame &audio_frame) {
+    RtcAudioFrame frame = toRtcAudioFrame(audio_frame);
+    m_audioObservers.forEach([&](IRtcAudioFrameObserver *observer) {
+        observer->onRecordAudioFrame(frame);
+    });
+}
+
+void VolcRtcEngine::onPlaybackAudioFrame(const bytertc::IAudioFrame &audio_frame) {
+    RtcAudioFrame frame = toRtcAudioFrame(audio_frame);
+    m_audioObservers.forEach([&](IRtcAudioFrameObserver *observer) {
+        observer->onPlaybackAudioFrame(frame);
+    });
+}
+
+void VolcRtcEngine::onRemoteUserAudioFrame(const char *stream_id, const bytertc::StreamInfo &stream_info, const bytertc::IAudioFrame &audio_frame) {
+}
+
+void VolcRtcEngine::onMixedAudioFrame(const bytertc::IAudioFrame &audio_frame) {
+}
+
+// ── 插件入口 ──────────────────────────────────────────────────────
+// 本文件编译为 libQuickStartVolcRtc.so，由 RtcSdkLoader 按需 dlopen
+
+extern "C" __attribute__((visibility("default"))) IRtcEngine *quickstart_rtc_create_engine() {
+    return new VolcRtcEngine();
+}
+
+extern "C" __attribute__((visibility("default"))) const char *quickstart_rtc_sdk_version() {
+    return bytertc::IRTCEngine::getSDKVersion();
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "RtcBackend.h"
+#include "bytertc_engine.h"
+#include "bytertc_room.h"
+#include "bytertc_room_event_handler.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * 基于 VolcEngineRTC SDK 的 RTC 后端
+ *
+ * 将 SDK 的引擎/房间事件转换为 IRtcEventHandler 回调，
+ * 并通过 IVideoSink / IAudioFrameObserver 将原始帧分发给已注册的观察者。
+ * SDK 引擎是进程内单例，同一时间只能 create 一个 VolcRtcEngine。
+ */
+class VolcRtcEngine : public IRtcEngine,
+                      private bytertc::IRTCEngineEventHandler,
+                      private bytertc::IRTCRoomEventHandler,
+                      private bytertc::IAudioFrameObserver {
+public:
+    VolcRtcEngine();
+    ~VolcRtcEngine() override;
+
+    RtcBackendType type() const override { return RtcBackendType::VolcEngine; }
+    std::string sdkVersion() const override;
+
+    bool create(const std::string &appId, IRtcEventHandler *handler) override;
+    void destroy() override;
+
+    int setVideoEncoderProfile(const RtcVideoEncoderProfile &profile) override;
+    int setLocalVideoCanvas(void *view) override;
+    int setRemoteVideoCanvas(const std::string &streamId, void *view) override;
+
+    int startVideoCapture() override;
+    int stopVideoCapture() override;
+    int startAudioCapture() override;
+    int stopAudioCapture() override;
+
+    int setExternalVideoSource(bool enable) override;
+    int pushExternalVideoFrame(const RtcExternalVideoFrame &frame) override;
+    int setExternalAudioDevice(bool enable) override;
+    int pushExternalAudioFrame(const RtcAudioFrame &frame) override;
+    int pullExternalAudioFrame(int16_t *data, int samplesPerChannel, int channels, int sampleRate) override;
+
+    IRtcRoom *createRoom(const std::string &roomId) override;
+    void destroyRoom(IRtcRoom *room) override;
+
+    void addVideoFrameObserver(IRtcVideoFrameObserver *observer) override;
+    void removeVideoFrameObserver(IRtcVideoFrameObserver *observer) override;
+    void addAudioFrameObserver(IRtcAudioFrameObserver *observer) override;
+    void removeAudioFrameObserver(IRtcAudioFrameObserver *observer) override;
+
+private:
+    class Room;
+    class VideoSink;
+
+    // bytertc::IRTCEngineEventHandler / IRTCRoomEventHandler
+    void onRoomStateChanged(
+            const char *room_id, const char *uid, int state, const char *extra_info) override;
+    void onError(int err) override;
+    void onUserJoined(const bytertc::UserInfo &user_info) override;
+    void onUserLeave(const char *uid, bytertc::UserOfflineReason reason) override;
+    void onUserPublishStreamVideo(const char *stream_id, const bytertc::StreamInfo &stream_info, bool is_publish) override;
+    void onFirstLocalVideoFrameCaptured(bytertc::IVideoSource *video_source, const bytertc::VideoFrameInfo &info) override;
+    void onFirstRemoteVideoFrameDecoded(const char *stream_id, const bytertc::StreamInfo &stream_info, const bytertc::VideoFrameInfo &info) override;
+    void onNetworkQuality(const bytertc::NetworkQualityStats &localQuality,
+                          const bytertc::NetworkQualityStats *remoteQualities, int remoteQualityNum) override;
+    void onLocalStreamStats(const char *stream_id, const bytertc::LocalStreamStats &stats) override;
+    void onRemoteStreamStats(const char *stream_id, const bytertc::RemoteStreamStats &stats) override;
+
+    // bytertc::IAudioFrameObserver
+    void onRecordAudioFrame(const bytertc::IAudioFrame &audio_frame) override;
+    void onPlaybackAudioFrame(const bytertc::IAudioFrame &audio_frame) override;
+    void onRemoteUserAudioFrame(const char *stream_id, const bytertc::StreamInfo &stream_info, const bytertc::IAudioFrame &audio_frame) override;
+    void onMixedAudioFrame(const bytertc::IAudioFrame &audio_frame) override;
+
+    IRtcEventHandler *eventHandler() const { return m_handler.load(std::memory_order_acquire); }
+    void dispatchVideoFrame(const VideoSink *sink, bytertc::IVideoFrame *frame);
+    void updateVideoSinks();
+    void updateAudioCallbacks();
+
+    bytertc::IRTCEngine *m_engine = nullptr;
+    // SDK 事件线程读取，create() 在创建引擎之前设置
+    std::atomic<IRtcEventHandler *> m_handler{nullptr};
+    std::unique_ptr<Room> m_room;
+
+    RtcObserverList<IRtcVideoFrameObserver> m_videoObservers;
+    RtcObserverList<IRtcAudioFrameObserver> m_audioObservers;
+
+    // 远端流在首帧解码后登记，用于在有观察者时挂接 IVideoSink
+    std::mutex m_sinkMutex;
+    std::map<std::string, std::string> m_remoteStreams;  // streamId -> userId
+    std::unique_ptr<VideoSink> m_localSink;
+    std::map<std::string, std::unique_ptr<VideoSink>> m_remoteSinks;
+    bool m_audioCallbacksEnabled = false;
+};
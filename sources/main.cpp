@@ -1,14 +1,38 @@
 ﻿#include "RoomMainWidget.h"
+#include "Benchmarks.h"
+#include "TeardownWorker.h"
+#include "RtcSdkLoader.h"
+#include "StartupProbe.h"
+#include "MessageTracer.h"
+#include "ThreadPolicy.h"
 #include <QtWidgets/QApplication>
 #include <QDesktopWidget>
+#include <cstring>
 
 int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        return Benchmarks::run(argc - 2, argv + 2);
+    }
+
     qputenv("QT_AUTO_SCREEN_SCALE_FACTOR", "1");
 
+    // 开启后进程退出时补全追踪文件
+    MessageTracer::install(TraceConfig::fromEnvironment());
+
+    // 按线程类别设置核心亲和性与优先级；之后创建的线程登记时按类别生效
+    ThreadPolicy::adoptCurrentThread(ThreadClass::Ui, "ui");
+    ThreadPolicy::install(ThreadPolicyConfig::fromEnvironment());
+
+    // 默认窗口显示后才在后台加载 RTC SDK；对比启动耗时时可改回启动即同步加载（相当于链接期加载）
+    if (RtcSdkLoader::eagerLoadRequested()) {
+        RtcSdkLoader::instance().load();
+    }
+
     QApplication a(argc, argv);
     a.setQuitOnLastWindowClosed(true);
     a.setWindowIcon(QIcon(":/QuickStart/app.ico"));
     RoomMainWidget w;
+    StartupProbe::install(&w);
     w.show();
 
     auto desktopWidget = qApp->desktop();
@@ -20,5 +44,8 @@ int main(int argc, char *argv[]) {
     selfGem.moveCenter(screenGem.center());
     w.setGeometry(selfGem);
 
-    return a.exec();
+    int ret = a.exec();
+    // 窗口析构时会等待后台清理，看门狗限制退出的总时长
+    TeardownWorker::armExitDeadline(TeardownConfig::fromEnvironment().exitDeadlineMs, ret);
+    return ret;
 }
@@ -0,0 +1,268 @@
+/**
+ * AgentMessageDecoder：快速路径与 nlohmann 完整解析对照，nlohmann 拒绝的输入快速路径必须返回 false，
+ * 快速路径接受的输入解码结果必须与 nlohmann 一致
+ */
+#include "AgentMessageDecoder.h"
+#include <cstdint>
+#include <cstdio>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(condition)                                                            \
+    do {                                                                            \
+        if (!(condition)) {                                                         \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++g_failures;                                                           \
+        }                                                                           \
+    } while (0)
+
+enum class Expect {
+    Fast,       // 合法且快速路径应当直接处理
+    Any,        // 合法与否不限，快速路径可以退回 nlohmann
+    Invalid,    // 非法，nlohmann 抛出异常
+};
+
+/** 失败时打印出错的输入，控制字符与非 ASCII 字节按 \xNN 输出 */
+void report(const std::string &payload, const char *what) {
+    std::string printable;
+    for (unsigned char c : payload) {
+        if (c < 0x20 || c >= 0x7F) {
+            char hex[8];
+            std::snprintf(hex, sizeof(hex), "\\x%02x", c);
+            printable += hex;
+        } else {
+            printable += static_cast<char>(c);
+        }
+    }
+    std::fprintf(stderr, "  %s: %s\n", what, printable.c_str());
+    ++g_failures;
+}
+
+bool sameResult(const std::string &fast, const std::string &reference) {
+    if (fast.empty() || reference.empty()) return fast == reference;
+    return nlohmann::json::parse(fast) == nlohmann::json::parse(reference);
+}
+
+/** 对照一条输入，返回 nlohmann 是否接受 */
+bool compare(const std::string &payload, Expect expect) {
+    AgentMessage reference;
+    bool parsed = true;
+    try {
+        AgentMessageDecoder::decodeJson(payload, reference);
+    } catch (const nlohmann::json::exception &) {
+        parsed = false;
+    }
+    AgentMessage fast;
+    const bool handled = AgentMessageDecoder::decodeFast(payload, fast);
+
+    if (expect == Expect::Invalid && parsed) report(payload, "nlohmann accepted an invalid case");
+    if (expect == Expect::Fast && !parsed) report(payload, "nlohmann rejected a valid case");
+    if (!parsed) {
+        if (handled) report(payload, "fast path accepted what nlohmann rejects");
+        return false;
+    }
+    if (expect == Expect::Fast && !handled) report(payload, "fast path fell back");
+    if (!handled) return true;
+    if (fast.kind != reference.kind || fast.id != reference.id
+        || fast.hasError != reference.hasError || fast.errorMessage != reference.errorMessage
+        || fast.hasResult != reference.hasResult || !sameResult(fast.result, reference.result)
+        || fast.method != reference.method || fast.textDelta != reference.textDelta) {
+        report(payload, "fast path result differs");
+    }
+    return true;
+}
+
+std::string delta(const std::string &text, const std::string &extra = "") {
+    return R"({"method":"textTalkDelta","params":{"textDelta":")" + text + R"("})" + extra + "}";
+}
+
+const std::vector<std::string> &wellFormed() {
+    static const std::vector<std::string> cases = {
+        delta("x"),
+        delta("你好，世界"),
+        delta(R"(line\nbreak \"quoted\" \\ \/ \b\f\r\t)"),
+        delta(R"(中文 😀)"),
+        delta("\xF0\x9F\x98\x80 \xC2\xA9 \xEF\xBF\xBF \xF4\x8F\xBF\xBF \x7F"),
+        delta("x", R"(,"q":0,"r":-0,"s":1.5e-3,"t":-12.25E+2,"u":1e9)"),
+        delta("x", R"(,"q":1.5e307,"r":-9e307,"s":0.00e999,"t":1e-400,"u":0.001e-99999)"),
+        delta("x", R"(,"nested":{"a":[1,{"b":[]},"c",true,false,null],"d":{}},"e":[])"),
+        delta("x", R"(,"s":"é\n")"),
+        " \r\n\t{ \"method\" : \"textTalkDelta\" , \"params\" : { \"textDelta\" : \"x\" } } \n",
+        R"({"method":"textTalkDelta","params":{"other":1}})",
+        R"({"method":"textTalkDelta"})",
+        R"({"method":"textTalkStart","params":[1,2,3]})",
+        R"({"id":"abc","result":{"a": [1, 2.5, "x"], "b": null}})",
+        R"({"id":"Abc","result":"text"})",
+        R"({"jsonrpc":"2.0","id":42,"result":true})",
+        R"({"id":-7,"result":[]})",
+        R"({"id":1.5,"result":0})",
+        R"({"id":1e2,"result":0})",
+        R"({"id":true,"result":0})",
+        R"({"id":"1","error":{"code":-32600,"message":"bad \"request\""}})",
+        R"({"id":"1","error":{"code":-32600}})",
+        R"({"id":"1","error":{},"result":1})",
+        R"({"id":null,"method":"ping"})",
+        R"({"id":"1","id":2,"result":1})",
+        R"({"params":{"textDelta":"a"},"method":"textTalkDelta","params":{"textDelta":"b"}})",
+        R"({})",
+        R"({"other":"value"})",
+    };
+    return cases;
+}
+
+void testWellFormed() {
+    for (const std::string &payload : wellFormed()) {
+        compare(payload, Expect::Fast);
+    }
+}
+
+/** 合法但快速路径不处理的形状：退回 nlohmann 即可 */
+void testFallbackShapes() {
+    CHECK(compare(R"({"id":9223372036854775808,"result":1})", Expect::Any));
+    CHECK(compare(R"({"id":-9223372036854775809,"result":1})", Expect::Any));
+    CHECK(compare(R"({"id":1,"result":1})", Expect::Any));
+    CHECK(compare(R"({"id":1.7e308,"result":1})", Expect::Any));
+    CHECK(compare(R"({"id":"1","result":17e307})", Expect::Any));
+    CHECK(compare(R"([1,2])", Expect::Any));
+    CHECK(compare(R"("text")", Expect::Any));
+    CHECK(compare("\xEF\xBB\xBF{\"method\":\"ping\"}", Expect::Any));
+    std::string deep = R"({"method":"ping","deep":)";
+    for (int i = 0; i < 300; ++i) deep += '[';
+    for (int i = 0; i < 300; ++i) deep += ']';
+    CHECK(compare(deep + "}", Expect::Any));
+}
+
+void testMalformed() {
+    const std::vector<std::string> cases = {
+        // 数字
+        delta("x", R"(,"q":--)"),
+        delta("x", R"(,"z":1-2)"),
+        delta("x", R"(,"z":01)"),
+        delta("x", R"(,"z":-01)"),
+        delta("x", R"(,"z":1.)"),
+        delta("x", R"(,"z":.5)"),
+        delta("x", R"(,"z":+1)"),
+        delta("x", R"(,"z":-)"),
+        delta("x", R"(,"z":1e)"),
+        delta("x", R"(,"z":1e+)"),
+        delta("x", R"(,"z":1.e5)"),
+        delta("x", R"(,"z":0x10)"),
+        delta("x", R"(,"z":1.5.5)"),
+        delta("x", R"(,"z":1e400)"),
+        delta("x", R"(,"z":-2e308)"),
+        delta("x", R"(,"z":0.5e310)"),
+        delta("x", R"(,"z":1e99999999999)"),
+        delta("x", ",\"z\":1" + std::string(400, '0')),
+        R"({"id":01,"result":1})",
+        R"({"id":1-2,"result":1})",
+        // 字面量
+        delta("x", R"(,"z":tru)"),
+        delta("x", R"(,"z":nul)"),
+        delta("x", R"(,"z":True)"),
+        delta("x", R"(,"z":truex)"),
+        // 字符串中的控制字符与非法 UTF-8
+        delta("a\nb"),
+        delta("a\tb"),
+        delta(std::string("a\0b", 3)),
+        delta("x", ",\"z\":\"a\x01\""),
+        delta("\xFF"),
+        delta("\x80"),
+        delta("\xC0\xAF"),
+        delta("\xC1\xBF"),
+        delta("\xE0\x80\xAF"),
+        delta("\xED\xA0\x80"),
+        delta("\xF0\x80\x80\x80"),
+        delta("\xF4\x90\x80\x80"),
+        delta("\xF5\x80\x80\x80"),
+        delta("\xE4\xB8"),
+        delta("\xE4\xB8x"),
+        delta("x", ",\"z\":\"\xFF\""),
+        "{\"method\":\"textTalkDelta\",\"k\xFF\":1}",
+        // 转义
+        delta(R"(\x)"),
+        delta(R"(\u12)"),
+        delta(R"(\u12g4)"),
+        delta(R"(\ud800)"),
+        delta(R"(\udc00)"),
+        delta(R"(\ud800A)"),
+        delta("x", R"(,"z":"\q")"),
+        delta("x", R"(,"z":"\ud800")"),
+        // 结构
+        delta("x", R"(,"z":{"a":--})"),
+        delta("x", R"(,"z":{"a":1,})"),
+        delta("x", R"(,"z":[1,])"),
+        delta("x", R"(,"z":[1,,2])"),
+        delta("x", R"(,"z":[,1])"),
+        delta("x", R"(,"z":{"a" 1})"),
+        delta("x", R"(,"z":{"a":1 "b":2})"),
+        delta("x", R"(,"z":{1:2})"),
+        delta("x", R"(,"z":[1 2])"),
+        delta("x", R"(,"z":{"a":[}])"),
+        delta("x", R"(,"z":[{]})"),
+        delta("x", R"(,"z":{)"),
+        delta("x", R"(,)"),
+        R"({"method":"textTalkDelta","params":{"textDelta":"x"}} x)",
+        R"({"method":"textTalkDelta","params":{"textDelta":"x"}}})",
+        R"({"method":"textTalkDelta",})",
+        R"({"method" "textTalkDelta"})",
+        R"({"id":"1","result":})",
+        R"({"id":"1","result":{"a":1})",
+        R"({"method":"textTalkDelta")",
+        "",
+        "   ",
+    };
+    for (const std::string &payload : cases) {
+        compare(payload, Expect::Invalid);
+    }
+}
+
+/** 对合法输入做确定性的单字节替换、插入与删除，逐条对照两条路径 */
+void testMutations() {
+    static const char kBytes[] = "{}[]\":,\\-+.0123456789eEtfnulrsaxq \n\t\x01\x7F\x80\xBF\xC2\xE4\xED\xF0\xFF";
+    uint32_t seed = 12345;
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    };
+    int mutated = 0;
+    int rejected = 0;
+    for (const std::string &original : wellFormed()) {
+        for (int round = 0; round < 2000; ++round) {
+            std::string payload = original;
+            const int edits = 1 + static_cast<int>(next() % 2);
+            for (int edit = 0; edit < edits && !payload.empty(); ++edit) {
+                const size_t at = next() % payload.size();
+                const char byte = kBytes[next() % (sizeof(kBytes) - 1)];
+                switch (next() % 3) {
+                    case 0: payload[at] = byte; break;
+                    case 1: payload.insert(payload.begin() + static_cast<std::ptrdiff_t>(at), byte); break;
+                    default: payload.erase(at, 1); break;
+                }
+            }
+            if (!compare(payload, Expect::Any)) ++rejected;
+            ++mutated;
+        }
+    }
+    // 大部分变异输入应当非法，确认对照确实覆盖了拒绝的分支
+    CHECK(rejected > mutated / 4);
+}
+
+} // namespace
+
+int main() {
+    testWellFormed();
+    testFallbackShapes();
+    testMalformed();
+    testMutations();
+    if (g_failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("AgentMessageDecoderTest passed\n");
+    return 0;
+}
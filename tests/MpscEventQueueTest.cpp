@@ -0,0 +1,154 @@
+/**
+ * MpscEventQueue：队列满时不可丢弃的事件经溢出列表按顺序送达，可丢弃的事件被丢弃
+ */
+#include "MpscEventQueue.h"
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(condition)                                                            \
+    do {                                                                            \
+        if (!(condition)) {                                                         \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++g_failures;                                                           \
+        }                                                                           \
+    } while (0)
+
+struct Event {
+    int producer = 0;
+    int seq = 0;
+    bool stats = false;
+
+    static bool supersedes(const Event &newer, const Event &older) {
+        return newer.stats && older.stats && newer.producer == older.producer;
+    }
+};
+
+Event reliable(int producer, int seq) {
+    Event event;
+    event.producer = producer;
+    event.seq = seq;
+    return event;
+}
+
+Event stats(int producer, int seq) {
+    Event event = reliable(producer, seq);
+    event.stats = true;
+    return event;
+}
+
+/** 消费者不运行时填满队列：超出容量的不可丢弃事件全部送达且保持顺序，统计被丢弃 */
+void testOverflowKeepsOrder() {
+    MpscEventQueue<Event> queue(8);
+    int next = 0;
+    for (int i = 0; i < 100; ++i) {
+        queue.pushReliable(reliable(0, next++));
+        // 溢出期间统计直接丢弃，不会插到溢出的事件前面
+        queue.push(stats(1, i));
+    }
+    CHECK(queue.spilled() > 0);
+    CHECK(queue.dropped() > 0);
+
+    std::vector<int> seen;
+    while (queue.drain([&seen](const Event &event) {
+        if (!event.stats) seen.push_back(event.seq);
+    }) > 0) {
+    }
+    CHECK(static_cast<int>(seen.size()) == next);
+    for (size_t i = 0; i < seen.size(); ++i) {
+        CHECK(seen[i] == static_cast<int>(i));
+    }
+
+    // 溢出列表取空后回到环形数组
+    const uint64_t spilled = queue.spilled();
+    queue.pushReliable(reliable(0, next));
+    CHECK(queue.spilled() == spilled);
+    int delivered = -1;
+    queue.drain([&delivered](const Event &event) { delivered = event.seq; });
+    CHECK(delivered == next);
+}
+
+/** 消费者排空到一半时继续入队：环形数组里剩下的较早事件先于溢出列表送达 */
+void testPartialDrain() {
+    MpscEventQueue<Event> queue(4);
+    int next = 0;
+    for (int i = 0; i < 10; ++i) {
+        queue.pushReliable(reliable(0, next++));
+    }
+    std::vector<int> seen;
+    queue.consume([&seen](const Event &event) { seen.push_back(event.seq); }, 2);
+    for (int i = 0; i < 10; ++i) {
+        queue.pushReliable(reliable(0, next++));
+    }
+    while (queue.consume([&seen](const Event &event) { seen.push_back(event.seq); }, 3) > 0) {
+    }
+    CHECK(static_cast<int>(seen.size()) == next);
+    for (size_t i = 0; i < seen.size(); ++i) {
+        CHECK(seen[i] == static_cast<int>(i));
+    }
+}
+
+/** 多个生产者与消费者并发：每个生产者的不可丢弃事件全部送达，且各自保持顺序 */
+void testConcurrentProducers() {
+    constexpr int kProducers = 4;
+    constexpr int kEvents = 50000;
+    MpscEventQueue<Event> queue(16);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&queue, p] {
+            for (int i = 0; i < kEvents; ++i) {
+                queue.pushReliable(reliable(p, i));
+                if (i % 3 == 0) {
+                    queue.push(stats(kProducers + p, i));
+                }
+            }
+        });
+    }
+
+    int expected[kProducers] = {};
+    bool ordered = true;
+    auto handle = [&expected, &ordered](const Event &event) {
+        if (event.stats) return;
+        if (event.seq != expected[event.producer]) ordered = false;
+        expected[event.producer] = event.seq + 1;
+    };
+    auto finished = [&expected] {
+        for (int count : expected) {
+            if (count != kEvents) return false;
+        }
+        return true;
+    };
+    while (!finished() && ordered) {
+        if (queue.drain(handle) == 0) {
+            std::this_thread::yield();
+        }
+    }
+    for (auto &producer : producers) {
+        producer.join();
+    }
+    queue.drain(handle);
+
+    CHECK(ordered);
+    for (int count : expected) {
+        CHECK(count == kEvents);
+    }
+}
+
+} // namespace
+
+int main() {
+    testOverflowKeepsOrder();
+    testPartialDrain();
+    testConcurrentProducers();
+    if (g_failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("MpscEventQueueTest passed\n");
+    return 0;
+}
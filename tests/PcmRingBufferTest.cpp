@@ -0,0 +1,107 @@
+/**
+ * PcmRingBuffer：空间不足时只写入整帧，交织的声道不会错位
+ */
+#include "PcmRingBuffer.h"
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(condition)                                                            \
+    do {                                                                            \
+        if (!(condition)) {                                                         \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++g_failures;                                                           \
+        }                                                                           \
+    } while (0)
+
+/** 第 frame 帧第 channel 声道的采样值，读出后据此检查声道是否对齐 */
+int16_t sampleOf(int frame, int channel, int channels) {
+    return static_cast<int16_t>(frame * channels + channel);
+}
+
+std::vector<int16_t> frames(int first, int count, int channels) {
+    std::vector<int16_t> samples;
+    for (int frame = first; frame < first + count; ++frame) {
+        for (int channel = 0; channel < channels; ++channel) {
+            samples.push_back(sampleOf(frame, channel, channels));
+        }
+    }
+    return samples;
+}
+
+/** 读出的每帧第 0 个采样都必须是左声道（声道 0） */
+bool aligned(const std::vector<int16_t> &samples, int channels) {
+    for (size_t i = 0; i < samples.size(); ++i) {
+        if (samples[i] % channels != static_cast<int>(i % channels)) return false;
+    }
+    return true;
+}
+
+/** 立体声溢出：剩余空间为奇数个采样时只写入整帧，之后读出的左右声道仍然对齐 */
+void testStereoOverrun() {
+    constexpr int kChannels = 2;
+    PcmRingBuffer ring(8);
+    CHECK(ring.capacity() == 8);
+
+    // 写入 3 帧后跳过 1 个采样，剩余空间为奇数
+    std::vector<int16_t> first = frames(0, 3, kChannels);
+    CHECK(ring.write(first.data(), first.size(), kChannels) == first.size());
+    CHECK(ring.skip(1) == 1);
+    // 剩余 3 个采样的空间，只能写入 1 帧
+    std::vector<int16_t> second = frames(3, 2, kChannels);
+    CHECK(ring.write(second.data(), second.size(), kChannels) == 2);
+    CHECK(ring.overruns() == 2);
+    CHECK(ring.available() == 7);
+
+    // 跳过被 skip 截断的第 0 帧剩下的右声道，之后每帧都应左右对齐
+    CHECK(ring.skip(1) == 1);
+    std::vector<int16_t> out(6);
+    CHECK(ring.read(out.data(), out.size()));
+    CHECK(aligned(out, kChannels));
+    CHECK(out[0] == sampleOf(1, 0, kChannels));
+    CHECK(out[4] == sampleOf(3, 0, kChannels));
+}
+
+/** 声道数不整除容量（5.1 声道）时反复溢出，读出的帧始终对齐且顺序不乱 */
+void testRepeatedOverrun() {
+    constexpr int kChannels = 6;
+    constexpr int kFramesPerWrite = 5;
+    PcmRingBuffer ring(64);
+    int nextFrame = 0;
+    int expectedFrame = -1;
+    bool ordered = true;
+    std::vector<int16_t> out(kChannels);
+    for (int round = 0; round < 200; ++round) {
+        std::vector<int16_t> samples = frames(nextFrame, kFramesPerWrite, kChannels);
+        const size_t written = ring.write(samples.data(), samples.size(), kChannels);
+        CHECK(written % kChannels == 0);
+        nextFrame += kFramesPerWrite;
+        // 读得比写得慢，保持溢出
+        for (int i = 0; i < 3 && ring.read(out.data(), out.size()); ++i) {
+            CHECK(aligned(out, kChannels));
+            const int frame = out[0] / kChannels;
+            if (frame <= expectedFrame) ordered = false;
+            expectedFrame = frame;
+        }
+    }
+    CHECK(ordered);
+    CHECK(ring.overruns() > 0);
+    CHECK(ring.overruns() % kChannels == 0);
+}
+
+} // namespace
+
+int main() {
+    testStereoOverrun();
+    testRepeatedOverrun();
+    if (g_failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("PcmRingBufferTest passed\n");
+    return 0;
+}
@@ -0,0 +1,173 @@
+/**
+ * 执行器控制进程的替身，用于联调 QUICKSTART_ACTUATOR
+ *
+ * 打开 QuickStart 创建的共享内存段，打印工具描述，然后逐条取出命令、
+ * 回显参数并立即应答。真实的控制进程在同样的位置驱动执行器即可。
+ *
+ *   ./ActuatorControlStub [/quickstart-actuator] [--busy-poll] [--quiet] [--fail TOOL]
+ *
+ * --busy-poll 一直自旋不睡眠（独占一个核，换取最低延迟），--fail 让指定工具返回错误码 1。
+ */
+#include "ActuatorRing.h"
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void onSignal(int) {
+    g_stop = 1;
+}
+
+const char *typeName(uint32_t type) {
+    switch (type) {
+        case ActuatorValue::kNumber: return "number";
+        case ActuatorValue::kInteger: return "integer";
+        case ActuatorValue::kBoolean: return "boolean";
+        case ActuatorValue::kEnum: return "enum";
+        case ActuatorValue::kString: return "string";
+        default: return "none";
+    }
+}
+
+std::string enumLabel(const ActuatorFieldDescriptor &field, int64_t index) {
+    std::string labels(field.enumLabels, strnlen(field.enumLabels, sizeof(field.enumLabels)));
+    size_t begin = 0;
+    for (int64_t i = 0; i < index && begin != std::string::npos; ++i) {
+        begin = labels.find('|', begin);
+        if (begin != std::string::npos) ++begin;
+    }
+    if (begin == std::string::npos) return "?";
+    return labels.substr(begin, labels.find('|', begin) - begin);
+}
+
+void describeCommand(const ActuatorToolDescriptor &tool, const ActuatorMessage &command, char *out, size_t size) {
+    int written = std::snprintf(out, size, "ok %s", tool.name);
+    for (uint32_t i = 0; i < command.fieldCount && i < tool.fieldCount && written > 0
+                         && static_cast<size_t>(written) < size; ++i) {
+        const ActuatorFieldDescriptor &field = tool.fields[i];
+        const ActuatorValue &value = command.fields[i];
+        char *p = out + written;
+        const size_t left = size - static_cast<size_t>(written);
+        int n = 0;
+        switch (value.type) {
+            case ActuatorValue::kNumber:
+                n = std::snprintf(p, left, " %s=%g", field.name, value.number);
+                break;
+            case ActuatorValue::kInteger:
+                n = std::snprintf(p, left, " %s=%lld", field.name, static_cast<long long>(value.integer));
+                break;
+            case ActuatorValue::kBoolean:
+                n = std::snprintf(p, left, " %s=%s", field.name, value.integer ? "true" : "false");
+                break;
+            case ActuatorValue::kEnum:
+                n = std::snprintf(p, left, " %s=%s", field.name, enumLabel(field, value.integer).c_str());
+                break;
+            case ActuatorValue::kString:
+                n = std::snprintf(p, left, " %s=%.*s", field.name, static_cast<int>(sizeof(value.text)), value.text);
+                break;
+            default:
+                break;
+        }
+        if (n < 0) break;
+        written += n;
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string name = "/quickstart-actuator";
+    std::string failTool;
+    bool busyPoll = false;
+    bool quiet = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--busy-poll") busyPoll = true;
+        else if (arg == "--quiet") quiet = true;
+        else if (arg == "--fail" && i + 1 < argc) failTool = argv[++i];
+        else if (!arg.empty() && arg[0] != '-') name = arg;
+        else {
+            std::fprintf(stderr, "usage: %s [SHM_NAME] [--busy-poll] [--quiet] [--fail TOOL]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    // QuickStart 可能还没启动，或者正在重建共享内存段，等它出现
+    std::unique_ptr<ActuatorRing> ring;
+    std::string error;
+    bool reported = false;
+    while (!g_stop && !(ring = ActuatorRing::attach(name, error))) {
+        if (!reported) {
+            std::fprintf(stderr, "waiting for %s (%s)\n", name.c_str(), error.c_str());
+            reported = true;
+        }
+        usleep(100000);
+    }
+    if (!ring) return 0;
+
+    const ActuatorRingHeader &header = ring->header();
+    std::printf("attached %s: %u slots, %u tools\n", name.c_str(), header.slotCount, header.toolCount);
+    for (uint32_t t = 0; t < header.toolCount; ++t) {
+        const ActuatorToolDescriptor &tool = header.tools[t];
+        std::printf("  [%u] %s\n", t, tool.name);
+        for (uint32_t f = 0; f < tool.fieldCount; ++f) {
+            const ActuatorFieldDescriptor &field = tool.fields[f];
+            std::printf("        %-16s %-8s%s%s%s\n", field.name, typeName(field.type),
+                        field.required ? " required" : "",
+                        field.type == ActuatorValue::kEnum ? " " : "",
+                        field.type == ActuatorValue::kEnum ? field.enumLabels : "");
+        }
+    }
+    std::fflush(stdout);
+
+    unsigned long long handled = 0;
+    ActuatorMessage command{};
+    while (!g_stop) {
+        if (!ring->pop(ActuatorRing::Direction::Command, command)) {
+            // 睡眠的超时只用于检查退出信号
+            ring->wait(ActuatorRing::Direction::Command, busyPoll ? 100000 : 200000, busyPoll ? 100000 : 20);
+            continue;
+        }
+
+        ActuatorMessage ack{};
+        ack.id = command.id;
+        ack.tool = command.tool;
+        ack.sentNs = command.sentNs;
+        ack.receivedNs = ActuatorRing::nowNs();
+        if (command.tool >= header.toolCount) {
+            ack.status = -1;
+            std::snprintf(ack.text, sizeof(ack.text), "unknown tool %u", command.tool);
+        } else {
+            const ActuatorToolDescriptor &tool = header.tools[command.tool];
+            if (!failTool.empty() && failTool == tool.name) {
+                ack.status = 1;
+                std::snprintf(ack.text, sizeof(ack.text), "%s failed (simulated)", tool.name);
+            } else {
+                describeCommand(tool, command, ack.text, sizeof(ack.text));
+            }
+        }
+        ack.ackNs = ActuatorRing::nowNs();
+        while (!ring->push(ActuatorRing::Direction::Ack, ack) && !g_stop) {
+            // 应答环满说明 QuickStart 已退出或卡住，稍后重试
+            usleep(1000);
+        }
+
+        ++handled;
+        if (!quiet) {
+            std::printf("#%llu id=%llu queue_us=%.1f %s\n", handled, static_cast<unsigned long long>(command.id),
+                        (ack.receivedNs - command.sentNs) / 1000.0, ack.text);
+            std::fflush(stdout);
+        }
+    }
+
+    std::printf("handled %llu commands\n", handled);
+    return 0;
+}
@@ -0,0 +1,312 @@
+/**
+ * 解码帧导出（QUICKSTART_FRAME_EXPORT）的参考消费者，其它语言的消费者按同样的步骤实现
+ *
+ * 连接 QuickStart 的控制套接字，映射各路流的 memfd 帧环，每次 eventfd 通知后就地读取各路流的最新一帧，
+ * 每秒输出帧率、跳过的帧数（消费者跟不上时）与处理期间被覆盖的帧数。
+ *
+ *   ./FrameExportClient [SOCKET] [--slow MS] [--dump DIR]
+ *
+ * --slow 在每帧的处理中睡眠，模拟慢消费者；--dump 把每个帧环的第一帧按紧凑排列写到 DIR
+ * （文件名为 流-宽x高.格式，格式为 i420 / rgb / bgr / bgra / rgba）。
+ */
+#include "FrameExportFormat.h"
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace FrameExportFormat;
+
+namespace {
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void onSignal(int) {
+    g_stop = 1;
+}
+
+struct MappedStream {
+    void *base = nullptr;
+    size_t mapSize = 0;
+    uint32_t generation = 0;
+    std::string name;
+    uint64_t lastSeq = 0;
+    bool dumped = false;
+
+    // 本秒内的统计
+    uint64_t frames = 0;
+    uint64_t skipped = 0;
+    uint64_t torn = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    const RingHeader &header() const { return *static_cast<const RingHeader *>(base); }
+
+    void unmap() {
+        if (base) {
+            munmap(base, mapSize);
+        }
+        base = nullptr;
+        generation = 0;
+    }
+};
+
+const char *formatName(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::I420: return "i420";
+        case PixelFormat::Rgb24: return "rgb";
+        case PixelFormat::Bgr24: return "bgr";
+        case PixelFormat::Bgra32: return "bgra";
+        case PixelFormat::Rgba32: return "rgba";
+    }
+    return "raw";
+}
+
+/** 收一条控制消息，附带的描述符写入 fd（没有时为 -1）；连接断开或出错返回 false */
+bool receiveMessage(int socketFd, ControlMessage &message, int &fd) {
+    fd = -1;
+    iovec iov = {&message, sizeof(message)};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    msghdr header = {};
+    header.msg_iov = &iov;
+    header.msg_iovlen = 1;
+    header.msg_control = control;
+    header.msg_controllen = sizeof(control);
+    ssize_t n = recvmsg(socketFd, &header, MSG_CMSG_CLOEXEC);
+    if (n != static_cast<ssize_t>(sizeof(message))) {
+        return false;
+    }
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(&header); cmsg; cmsg = CMSG_NXTHDR(&header, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+    return message.version == kVersion;
+}
+
+void mapStream(MappedStream &stream, const ControlMessage &message, int fd) {
+    stream.unmap();
+    void *base = mmap(nullptr, message.mapSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        std::fprintf(stderr, "cannot map stream %u: %s\n", message.stream, std::strerror(errno));
+        return;
+    }
+    const auto *header = static_cast<const RingHeader *>(base);
+    if (header->magic != kRingMagic || header->version != kVersion || header->slotCount == 0
+        || header->slotCount > static_cast<uint32_t>(kMaxSlots)
+        || header->dataOffset + header->slotSize * header->slotCount > message.mapSize) {
+        std::fprintf(stderr, "stream %u: unexpected ring layout\n", message.stream);
+        munmap(base, message.mapSize);
+        return;
+    }
+    stream.base = base;
+    stream.mapSize = message.mapSize;
+    stream.generation = message.generation;
+    stream.name = message.local ? std::string("local") : std::string(message.streamId);
+    stream.lastSeq = 0;
+    stream.dumped = false;
+    std::printf("stream %u: %s%s%s, %s, %u slots of %" PRIu64 " bytes\n", message.stream, stream.name.c_str(),
+                message.userId[0] ? " user " : "", message.userId, formatName(header->format),
+                header->slotCount, header->slotSize);
+}
+
+/** 按紧凑排列写出一帧 */
+void dumpFrame(const std::string &dir, const MappedStream &stream, const SlotHeader &slot, const uint8_t *data) {
+    const PixelFormat format = stream.header().format;
+    char path[512];
+    std::snprintf(path, sizeof(path), "%s/%s-%ux%u.%s", dir.c_str(), stream.name.c_str(), slot.width, slot.height,
+                  formatName(format));
+    FILE *out = std::fopen(path, "wb");
+    if (!out) {
+        std::fprintf(stderr, "cannot write %s: %s\n", path, std::strerror(errno));
+        return;
+    }
+    if (format == PixelFormat::I420) {
+        const uint32_t widths[3] = {slot.width, (slot.width + 1) / 2, (slot.width + 1) / 2};
+        const uint32_t heights[3] = {slot.height, (slot.height + 1) / 2, (slot.height + 1) / 2};
+        for (int plane = 0; plane < 3; ++plane) {
+            for (uint32_t y = 0; y < heights[plane]; ++y) {
+                std::fwrite(data + slot.planeOffsets[plane] + static_cast<size_t>(y) * slot.strides[plane], 1,
+                            widths[plane], out);
+            }
+        }
+    } else {
+        const uint32_t rowBytes = slot.width * (format == PixelFormat::Rgb24 || format == PixelFormat::Bgr24 ? 3 : 4);
+        for (uint32_t y = 0; y < slot.height; ++y) {
+            std::fwrite(data + static_cast<size_t>(y) * slot.strides[0], 1, rowBytes, out);
+        }
+    }
+    std::fclose(out);
+    std::printf("wrote %s\n", path);
+}
+
+/** 就地读取最新一帧：这里只计算第一行的校验和代表实际处理 */
+void consumeLatest(MappedStream &stream, int slowMs, const std::string &dumpDir) {
+    const RingHeader &header = stream.header();
+    const uint64_t seq = header.latestSeq.load(std::memory_order_acquire);
+    if (seq == 0 || seq == stream.lastSeq) {
+        return;
+    }
+    if (stream.lastSeq != 0 && seq > stream.lastSeq + 1) {
+        stream.skipped += seq - stream.lastSeq - 1;
+    }
+    stream.lastSeq = seq;
+
+    const uint32_t index = static_cast<uint32_t>((seq - 1) % header.slotCount);
+    const SlotHeader &slot = slotHeaders(stream.base)[index];
+    const uint8_t *data = slotData(stream.base, header, index);
+    const uint64_t version = slot.version.load(std::memory_order_acquire);
+    if ((version & 1) || slot.seq != seq) {
+        stream.torn++;
+        return;
+    }
+
+    uint32_t checksum = 0;
+    for (uint32_t x = 0; x < slot.strides[0] && x < slot.dataSize; ++x) {
+        checksum += data[x];
+    }
+    if (slowMs > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(slowMs));
+    }
+    const bool dump = !dumpDir.empty() && !stream.dumped;
+    if (dump) {
+        dumpFrame(dumpDir, stream, slot, data);
+    }
+
+    // 处理期间槽被覆盖，结果作废
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.version.load(std::memory_order_relaxed) != version) {
+        stream.torn++;
+        return;
+    }
+    (void)checksum;
+    stream.dumped = stream.dumped || dump;
+    stream.frames++;
+    stream.width = slot.width;
+    stream.height = slot.height;
+}
+
+std::string defaultSocketPath() {
+    const char *runtimeDir = std::getenv("XDG_RUNTIME_DIR");
+    return runtimeDir && *runtimeDir ? std::string(runtimeDir) + "/quickstart-frames.sock"
+                                     : "/tmp/quickstart-frames-" + std::to_string(getuid()) + ".sock";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string socketPath = defaultSocketPath();
+    std::string dumpDir;
+    int slowMs = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--slow") == 0 && i + 1 < argc) {
+            slowMs = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+            dumpDir = argv[++i];
+        } else if (argv[i][0] != '-') {
+            socketPath = argv[i];
+        } else {
+            std::fprintf(stderr, "usage: %s [SOCKET] [--slow MS] [--dump DIR]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::fprintf(stderr, "socket path too long: %s\n", socketPath.c_str());
+        return 1;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size());
+    int socketFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (socketFd < 0 || connect(socketFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+        std::fprintf(stderr, "cannot connect to %s: %s\n", socketPath.c_str(), std::strerror(errno));
+        return 1;
+    }
+
+    ControlMessage message = {};
+    int eventFd = -1;
+    if (!receiveMessage(socketFd, message, eventFd) || message.type != MessageType::Hello || eventFd < 0) {
+        std::fprintf(stderr, "unexpected handshake from %s\n", socketPath.c_str());
+        return 1;
+    }
+    std::printf("connected to %s, up to %u streams\n", socketPath.c_str(), message.maxStreams);
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    MappedStream streams[64];
+    const uint32_t maxStreams = message.maxStreams < 64 ? message.maxStreams : 64;
+    auto lastReport = std::chrono::steady_clock::now();
+    while (!g_stop) {
+        pollfd fds[2] = {{socketFd, POLLIN, 0}, {eventFd, POLLIN, 0}};
+        if (poll(fds, 2, 1000) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (fds[0].revents) {
+            int fd = -1;
+            if (!receiveMessage(socketFd, message, fd)) {
+                std::printf("disconnected\n");
+                break;
+            }
+            if (message.stream >= maxStreams) {
+                if (fd >= 0) close(fd);
+            } else if (message.type == MessageType::Stream && fd >= 0) {
+                mapStream(streams[message.stream], message, fd);
+            } else if (message.type == MessageType::StreamClosed) {
+                std::printf("stream %u: closed\n", message.stream);
+                streams[message.stream].unmap();
+            } else if (fd >= 0) {
+                close(fd);
+            }
+        }
+
+        if (fds[1].revents & POLLIN) {
+            uint64_t count = 0;
+            if (read(eventFd, &count, sizeof(count)) == sizeof(count)) {
+                for (uint32_t i = 0; i < maxStreams; ++i) {
+                    if (streams[i].base) {
+                        consumeLatest(streams[i], slowMs, dumpDir);
+                    }
+                }
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - lastReport).count();
+        if (elapsed >= 1.0) {
+            for (uint32_t i = 0; i < maxStreams; ++i) {
+                MappedStream &stream = streams[i];
+                if (!stream.base) continue;
+                std::printf("%-24s %4ux%-4u %6.1f fps  skipped %-6" PRIu64 " torn %" PRIu64 "\n",
+                            stream.name.c_str(), stream.width, stream.height, stream.frames / elapsed,
+                            stream.skipped, stream.torn);
+                stream.frames = 0;
+                stream.skipped = 0;
+                stream.torn = 0;
+            }
+            std::fflush(stdout);
+            lastReport = now;
+        }
+    }
+
+    for (MappedStream &stream : streams) {
+        stream.unmap();
+    }
+    close(eventFd);
+    close(socketFd);
+    return 0;
+}
@@ -0,0 +1,243 @@
+/**
+ * 查看与导出通话录制文件（QUICKSTART_RECORD 生成的 .qsrec）
+ *
+ *   ./RecordingInfo FILE                        各轨道的记录数、字节数、时长与丢包前后的时间范围
+ *   ./RecordingInfo FILE --text                 按时间打印对话文本
+ *   ./RecordingInfo FILE --wav mic|playback OUT 导出麦克风或播放音频为 WAV
+ *   ./RecordingInfo FILE --frames DIR           导出视频帧（.jpg 或 .i420）
+ *   ./RecordingInfo FILE --seek SECONDS ...     通过索引从该时间之前最近的写盘块开始读取
+ *
+ * 文件没有索引（录制进程异常退出）时从头顺序读取，--seek 退化为跳过较早的记录。
+ */
+#include "RecordingFormat.h"
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+using namespace RecordingFormat;
+
+namespace {
+
+struct TrackSummary {
+    uint64_t records = 0;
+    uint64_t bytes = 0;
+    int64_t firstUs = -1;
+    int64_t lastUs = -1;
+    uint64_t samples = 0;      // 音频：每声道采样数
+    uint32_t sampleRate = 0;
+    uint16_t channels = 0;
+};
+
+const char *trackName(RecordType type) {
+    switch (type) {
+        case RecordType::MicAudio: return "mic";
+        case RecordType::PlaybackAudio: return "playback";
+        case RecordType::Video: return "video";
+        case RecordType::Text: return "text";
+        default: return "padding";
+    }
+}
+
+void writeLe32(FILE *out, uint32_t value) {
+    std::fwrite(&value, 4, 1, out);
+}
+
+void writeLe16(FILE *out, uint16_t value) {
+    std::fwrite(&value, 2, 1, out);
+}
+
+/** 采样数在导出结束后回填 */
+void writeWavHeader(FILE *out, uint32_t sampleRate, uint16_t channels, uint32_t dataBytes) {
+    std::fseek(out, 0, SEEK_SET);
+    std::fwrite("RIFF", 1, 4, out);
+    writeLe32(out, 36 + dataBytes);
+    std::fwrite("WAVEfmt ", 1, 8, out);
+    writeLe32(out, 16);
+    writeLe16(out, 1);
+    writeLe16(out, channels);
+    writeLe32(out, sampleRate);
+    writeLe32(out, sampleRate * channels * 2);
+    writeLe16(out, static_cast<uint16_t>(channels * 2));
+    writeLe16(out, 16);
+    std::fwrite("data", 1, 4, out);
+    writeLe32(out, dataBytes);
+}
+
+int usage() {
+    std::fprintf(stderr, "usage: RecordingInfo FILE [--seek SECONDS] [--text] [--wav mic|playback OUT] [--frames DIR]\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        return usage();
+    }
+    const char *path = argv[1];
+    double seekSeconds = -1.0;
+    bool printText = false;
+    RecordType wavTrack = RecordType::Padding;
+    const char *wavPath = nullptr;
+    const char *framesDir = nullptr;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--seek") == 0 && i + 1 < argc) {
+            seekSeconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--text") == 0) {
+            printText = true;
+        } else if (std::strcmp(argv[i], "--wav") == 0 && i + 2 < argc) {
+            wavTrack = std::strcmp(argv[i + 1], "mic") == 0 ? RecordType::MicAudio : RecordType::PlaybackAudio;
+            wavPath = argv[i + 2];
+            i += 2;
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            framesDir = argv[++i];
+        } else {
+            return usage();
+        }
+    }
+
+    FILE *file = std::fopen(path, "rb");
+    if (!file) {
+        std::perror(path);
+        return 1;
+    }
+    RecordingFileHeader header{};
+    if (std::fread(&header, sizeof(header), 1, file) != 1 || std::memcmp(header.magic, kFileMagic, 8) != 0) {
+        std::fprintf(stderr, "%s: not a recording\n", path);
+        return 1;
+    }
+
+    // 文件尾在最后 32 字节
+    std::fseek(file, 0, SEEK_END);
+    const uint64_t fileSize = static_cast<uint64_t>(std::ftell(file));
+    uint64_t dataEnd = fileSize;
+    std::vector<RecordingIndexEntry> index;
+    RecordingFileFooter footer{};
+    if (fileSize >= header.headerSize + sizeof(footer)) {
+        std::fseek(file, static_cast<long>(fileSize - sizeof(footer)), SEEK_SET);
+        if (std::fread(&footer, sizeof(footer), 1, file) == 1 && std::memcmp(footer.magic, kFooterMagic, 8) == 0) {
+            dataEnd = footer.dataEnd;
+            index.resize(footer.indexCount);
+            std::fseek(file, static_cast<long>(footer.indexOffset), SEEK_SET);
+            if (!index.empty() && std::fread(index.data(), sizeof(RecordingIndexEntry), index.size(), file) != index.size()) {
+                index.clear();
+            }
+        }
+    }
+
+    uint64_t offset = header.headerSize;
+    const int64_t seekUs = seekSeconds >= 0 ? static_cast<int64_t>(seekSeconds * 1e6) : -1;
+    if (seekUs >= 0) {
+        // 不同轨道的记录最多相差约 flush_ms，从目标之前一个写盘块开始读，再跳过较早的记录
+        for (size_t i = 0; i < index.size() && index[i].timestampUs <= seekUs; ++i) {
+            offset = index[i > 0 ? i - 1 : 0].offset;
+        }
+    }
+
+    FILE *wav = nullptr;
+    uint64_t wavBytes = 0;
+    TrackSummary summary[kRecordTypeCount];
+    if (wavPath) {
+        wav = std::fopen(wavPath, "wb");
+        if (!wav) {
+            std::perror(wavPath);
+            return 1;
+        }
+        writeWavHeader(wav, 16000, 1, 0);
+    }
+    if (framesDir) {
+        mkdir(framesDir, 0755);
+    }
+
+    std::vector<uint8_t> payload;
+    uint64_t frameIndex = 0;
+    bool truncated = false;
+    std::fseek(file, static_cast<long>(offset), SEEK_SET);
+    while (offset + sizeof(RecordHeader) <= dataEnd) {
+        RecordHeader record{};
+        if (std::fread(&record, sizeof(record), 1, file) != 1) {
+            truncated = true;
+            break;
+        }
+        const size_t padded = alignRecord(record.size);
+        payload.resize(padded);
+        if (padded > 0 && std::fread(payload.data(), 1, padded, file) != padded) {
+            truncated = true;
+            break;
+        }
+        offset += sizeof(record) + padded;
+        if (record.type == RecordType::Padding || static_cast<int>(record.type) >= kRecordTypeCount) continue;
+        if (seekUs >= 0 && record.timestampUs < seekUs) continue;
+
+        TrackSummary &track = summary[static_cast<int>(record.type)];
+        ++track.records;
+        track.bytes += record.size;
+        if (track.firstUs < 0) track.firstUs = record.timestampUs;
+        track.lastUs = record.timestampUs;
+
+        if (record.type == RecordType::MicAudio || record.type == RecordType::PlaybackAudio) {
+            AudioHeader audio;
+            std::memcpy(&audio, payload.data(), sizeof(audio));
+            const size_t pcmBytes = record.size - sizeof(audio);
+            track.sampleRate = audio.sampleRate;
+            track.channels = audio.channels;
+            track.samples += audio.channels ? pcmBytes / 2 / audio.channels : 0;
+            if (wav && record.type == wavTrack) {
+                if (wavBytes == 0) writeWavHeader(wav, audio.sampleRate, audio.channels, 0);
+                std::fwrite(payload.data() + sizeof(audio), 1, pcmBytes, wav);
+                wavBytes += pcmBytes;
+            }
+        } else if (record.type == RecordType::Text && printText) {
+            TextHeader text;
+            std::memcpy(&text, payload.data(), sizeof(text));
+            const char *label = text.kind == TextKind::User ? "user" : text.kind == TextKind::AgentDelta ? "agent" : "end";
+            std::printf("%10.3f %-5s %.*s\n", record.timestampUs / 1e6, label,
+                        static_cast<int>(record.size - sizeof(text)), payload.data() + sizeof(text));
+        } else if (record.type == RecordType::Video && framesDir) {
+            VideoHeader video;
+            std::memcpy(&video, payload.data(), sizeof(video));
+            const std::string stream(reinterpret_cast<const char *>(payload.data() + sizeof(video)), video.streamIdSize);
+            const size_t dataOffset = sizeof(video) + video.streamIdSize;
+            char name[512];
+            std::snprintf(name, sizeof(name), "%s/%06" PRIu64 "-%s-%" PRId64 "ms-%ux%u.%s", framesDir, frameIndex++,
+                          stream.empty() ? "local" : stream.c_str(), record.timestampUs / 1000,
+                          video.width, video.height, video.codec == VideoCodec::Jpeg ? "jpg" : "i420");
+            if (FILE *out = std::fopen(name, "wb")) {
+                std::fwrite(payload.data() + dataOffset, 1, record.size - dataOffset, out);
+                std::fclose(out);
+            }
+        }
+    }
+
+    if (wav) {
+        writeWavHeader(wav, summary[static_cast<int>(wavTrack)].sampleRate ? summary[static_cast<int>(wavTrack)].sampleRate : 16000,
+                       summary[static_cast<int>(wavTrack)].channels ? summary[static_cast<int>(wavTrack)].channels : 1,
+                       static_cast<uint32_t>(wavBytes));
+        std::fclose(wav);
+    }
+    std::fclose(file);
+
+    std::printf("%s: room %s, started %" PRId64 " (unix ms), %" PRIu64 " bytes, %zu index entries%s\n",
+                path, header.roomId, header.startUnixMs, fileSize, index.size(),
+                index.empty() ? " (no index, read sequentially)" : "");
+    for (int type = 1; type < kRecordTypeCount; ++type) {
+        const TrackSummary &track = summary[type];
+        if (track.records == 0) continue;
+        std::printf("  %-8s %8" PRIu64 " records %10" PRIu64 " bytes  %8.3f - %8.3f s",
+                    trackName(static_cast<RecordType>(type)), track.records, track.bytes,
+                    track.firstUs / 1e6, track.lastUs / 1e6);
+        if (track.sampleRate) {
+            std::printf("  %u Hz x%u, %.3f s of audio", track.sampleRate, track.channels,
+                        static_cast<double>(track.samples) / track.sampleRate);
+        }
+        std::printf("\n");
+    }
+    if (truncated) {
+        std::printf("  file ends inside a record (recording was interrupted)\n");
+    }
+    return 0;
+}